@@ -10,7 +10,9 @@
 
 namespace carla {
 
-  /// A very simple atomic shared ptr with relaxed memory order.
+  /// A very simple atomic shared ptr with release-acquire memory ordering, so
+  /// an object fully built before being stored is visible to the threads that
+  /// load it.
   template <typename T>
   class AtomicSharedPtr {
   public:
@@ -25,7 +27,7 @@ namespace carla {
     AtomicSharedPtr(AtomicSharedPtr &&) = delete;
 
     void store(std::shared_ptr<T> ptr) {
-      std::atomic_store_explicit(&_ptr, ptr, std::memory_order_relaxed);
+      std::atomic_store_explicit(&_ptr, ptr, std::memory_order_release);
     }
 
     void reset(std::shared_ptr<T> ptr = nullptr) {
@@ -33,7 +35,7 @@ namespace carla {
     }
 
     std::shared_ptr<T> load() const {
-      return std::atomic_load_explicit(&_ptr, std::memory_order_relaxed);
+      return std::atomic_load_explicit(&_ptr, std::memory_order_acquire);
     }
 
     AtomicSharedPtr &operator=(std::shared_ptr<T> ptr) {
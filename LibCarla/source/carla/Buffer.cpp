@@ -11,4 +11,13 @@ namespace carla {
     }
   }
 
+  void Buffer::UpdatePoolAccounting(
+      const size_type old_capacity,
+      const size_type new_capacity) noexcept {
+    auto pool = _parent_pool.lock();
+    if (pool != nullptr) {
+      pool->UpdateOutstandingBytes(old_capacity, new_capacity);
+    }
+  }
+
 } // namespace carla
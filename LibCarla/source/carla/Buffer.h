@@ -111,6 +111,10 @@ namespace carla {
     Buffer &operator=(const Buffer &) = delete;
 
     Buffer &operator=(Buffer &&rhs) noexcept {
+      if ((_capacity > 0u) && !_parent_pool.expired()) {
+        // The memory of this buffer is deleted instead of returning to the pool.
+        UpdatePoolAccounting(_capacity, 0u);
+      }
       _parent_pool = std::move(rhs._parent_pool);
       _size = rhs._size;
       _capacity = rhs._capacity;
@@ -238,6 +242,9 @@ namespace carla {
       if (_capacity < size) {
         log_debug("allocating buffer of", size, "bytes");
         _data = std::make_unique<value_type[]>(size);
+        if (!_parent_pool.expired()) {
+          UpdatePoolAccounting(_capacity, size);
+        }
         _capacity = size;
       }
       _size = size;
@@ -252,6 +259,9 @@ namespace carla {
     /// Release the contents of this buffer and set its size and capacity to
     /// zero.
     std::unique_ptr<value_type[]> pop() noexcept {
+      if ((_capacity > 0u) && !_parent_pool.expired()) {
+        UpdatePoolAccounting(_capacity, 0u);
+      }
       _size = 0u;
       _capacity = 0u;
       return std::move(_data);
@@ -331,6 +341,10 @@ namespace carla {
 
     void ReuseThisBuffer();
 
+    /// Let the parent pool know the capacity of this buffer changed while
+    /// out of the pool.
+    void UpdatePoolAccounting(size_type old_capacity, size_type new_capacity) noexcept;
+
     friend class BufferPool;
 
     std::weak_ptr<BufferPool> _parent_pool;
@@ -0,0 +1,206 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/BufferPool.h"
+
+#include <vector>
+
+namespace carla {
+
+  BufferPool::BufferPool(const size_t estimated_size)
+    : _estimated_size(estimated_size) {}
+
+  BufferPool::~BufferPool() {
+    for (auto &size_class : _size_classes) {
+      delete size_class.load();
+    }
+  }
+
+  Buffer BufferPool::Pop() {
+    Buffer item;
+    for (auto i = NUMBER_OF_SIZE_CLASSES; (i > 0u) && (item.capacity() == 0u); --i) {
+      item = Take(i - 1u);
+    }
+    if (item.capacity() > 0u) {
+      ++_hits;
+    } else {
+      ++_misses;
+    }
+    return Adopt(std::move(item));
+  }
+
+  Buffer BufferPool::Pop(const size_type size) {
+    Buffer item;
+    const auto first = GetSizeClassToFit(size);
+    if (first < NUMBER_OF_SIZE_CLASSES) {
+      // Take a buffer up to two size classes bigger to avoid allocating, but
+      // don't waste the really big ones.
+      const auto last = first + 3u < NUMBER_OF_SIZE_CLASSES ? first + 3u : NUMBER_OF_SIZE_CLASSES;
+      for (auto i = first; (i < last) && (item.capacity() == 0u); ++i) {
+        item = Take(i);
+      }
+      if (item.capacity() > 0u) {
+        ++_hits;
+      } else {
+        ++_misses;
+      }
+    }
+    item = Adopt(std::move(item));
+    if ((item.capacity() == 0u) && (first < NUMBER_OF_SIZE_CLASSES)) {
+      item.reset(size_type(1u) << first);
+    }
+    item.reset(size);
+    return item;
+  }
+
+  void BufferPool::SetMaxPooledBytes(const size_t max_pooled_bytes) {
+    _max_pooled_bytes = max_pooled_bytes;
+    while ((_pooled_bytes > max_pooled_bytes) && EvictOne(NUMBER_OF_SIZE_CLASSES - 1u));
+  }
+
+  void BufferPool::SetMaxIdleTime(const time_duration max_idle_time) {
+    _max_idle_time = std::chrono::duration_cast<clock_type::duration>(max_idle_time.to_chrono()).count();
+    // Next buffer returning checks the idle buffers with the new time.
+    _next_trim = 0;
+  }
+
+  void BufferPool::Trim(const time_duration max_idle_time) {
+    EvictReturnedBefore(clock_type::now() - max_idle_time.to_chrono());
+  }
+
+  void BufferPool::Clear() {
+    for (auto i = 0u; i < NUMBER_OF_SIZE_CLASSES; ++i) {
+      while (Evict(i));
+    }
+  }
+
+  BufferPool::Statistics BufferPool::GetStatistics() const {
+    Statistics result;
+    result.pooled_bytes = _pooled_bytes;
+    result.pooled_buffers = _pooled_buffers;
+    result.outstanding_bytes = _outstanding_bytes;
+    result.hits = _hits;
+    result.misses = _misses;
+    result.evictions = _evictions;
+    return result;
+  }
+
+  Buffer BufferPool::Adopt(Buffer item) {
+    _outstanding_bytes += item.capacity();
+#if __cplusplus >= 201703L // C++17
+    item._parent_pool = weak_from_this();
+#else
+    item._parent_pool = shared_from_this();
+#endif
+    return item;
+  }
+
+  void BufferPool::Push(Buffer buffer) {
+    const auto capacity = buffer.capacity();
+    DEBUG_ASSERT(capacity > 0u);
+    _outstanding_bytes -= capacity;
+    // Buffers waiting in the pool don't return to it when deleted.
+    buffer._parent_pool.reset();
+    const auto now = clock_type::now();
+    const clock_type::duration max_idle_time(_max_idle_time.load());
+    auto next_trim = _next_trim.load();
+    if ((now.time_since_epoch().count() >= next_trim) &&
+        _next_trim.compare_exchange_strong(next_trim, (now + max_idle_time).time_since_epoch().count())) {
+      EvictReturnedBefore(now - max_idle_time);
+    }
+    if (capacity > _max_pooled_bytes) {
+      ++_evictions;
+      return;
+    }
+    // Make room for the buffer, the buffers of its own size class go first.
+    const auto index = GetSizeClass(capacity);
+    while ((_pooled_bytes += capacity) > _max_pooled_bytes) {
+      _pooled_bytes -= capacity;
+      if (!EvictOne(index)) {
+        // The buffers counted are still on their way to the pool.
+        ++_evictions;
+        return;
+      }
+    }
+    ++_pooled_buffers;
+    if (!GetOrCreateSizeClass(index).enqueue(PooledBuffer{std::move(buffer), now})) {
+      _pooled_bytes -= capacity;
+      --_pooled_buffers;
+      ++_evictions;
+    }
+  }
+
+  BufferPool::SizeClass &BufferPool::GetOrCreateSizeClass(const size_type index) {
+    auto *size_class = GetSizeClassIfCreated(index);
+    if (size_class == nullptr) {
+      auto created = std::make_unique<SizeClass>(_estimated_size);
+      if (_size_classes[index].compare_exchange_strong(
+              size_class,
+              created.get(),
+              std::memory_order_acq_rel,
+              std::memory_order_acquire)) {
+        size_class = created.release();
+      }
+    }
+    return *size_class;
+  }
+
+  Buffer BufferPool::Take(const size_type index) {
+    auto *size_class = GetSizeClassIfCreated(index);
+    PooledBuffer item;
+    if ((size_class == nullptr) || !size_class->try_dequeue(item)) {
+      return Buffer();
+    }
+    _pooled_bytes -= item.buffer.capacity();
+    --_pooled_buffers;
+    return std::move(item.buffer);
+  }
+
+  bool BufferPool::Evict(const size_type index) {
+    auto buffer = Take(index);
+    if (buffer.capacity() == 0u) {
+      return false;
+    }
+    ++_evictions;
+    return true;
+  }
+
+  bool BufferPool::EvictOne(const size_type first) {
+    if (Evict(first)) {
+      return true;
+    }
+    for (auto i = NUMBER_OF_SIZE_CLASSES; i > 0u; --i) {
+      if (Evict(i - 1u)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void BufferPool::EvictReturnedBefore(const clock_type::time_point time) {
+    std::vector<PooledBuffer> items;
+    for (auto &atomic_size_class : _size_classes) {
+      auto *size_class = atomic_size_class.load(std::memory_order_acquire);
+      if (size_class == nullptr) {
+        continue;
+      }
+      // The queue can't be searched, take every buffer and put back the ones
+      // returned after the time.
+      items.resize(size_class->size_approx());
+      items.resize(size_class->try_dequeue_bulk(items.begin(), items.size()));
+      for (auto &&item : items) {
+        const auto capacity = item.buffer.capacity();
+        if ((item.returned < time) || !size_class->enqueue(std::move(item))) {
+          _pooled_bytes -= capacity;
+          --_pooled_buffers;
+          ++_evictions;
+        }
+      }
+      items.clear();
+    }
+  }
+
+} // namespace carla
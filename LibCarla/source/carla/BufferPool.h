@@ -7,9 +7,14 @@
 #pragma once
 
 #include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/Time.h"
 
 #include "moodycamel/ConcurrentQueue.h"
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <memory>
 
 namespace carla {
@@ -17,37 +22,170 @@ namespace carla {
   /// A pool of Buffer. Buffers popped from this pool automatically return to
   /// the pool on destruction so the allocated memory can be reused.
   ///
+  /// Buffers are kept in power-of-two size classes by capacity, so Pop(size)
+  /// returns a buffer that is already big enough without searching the whole
+  /// pool. Buffers allocated by Pop(size) round their capacity up to the next
+  /// power of two so they return to the same size class. Each size class is
+  /// a lock-free queue, popping and returning buffers takes no lock.
+  ///
+  /// The memory kept in the pool is bounded, when a returning buffer does not
+  /// fit, the oldest buffers of its size class are deleted first, then those
+  /// of the biggest size classes. Once per maximum idle time, a returning
+  /// buffer deletes the buffers idle for longer than that.
+  ///
   /// @warning Buffers adjust their size only by growing, they never shrink
-  /// unless explicitly cleared. The allocated memory is only deleted when this
-  /// pool is destroyed.
-  class BufferPool : public std::enable_shared_from_this<BufferPool> {
+  /// unless explicitly cleared.
+  class BufferPool
+    : public std::enable_shared_from_this<BufferPool>,
+      private NonCopyable {
   public:
 
+    using size_type = Buffer::size_type;
+
+    /// Snapshot of the counters of the pool. The counters are updated one by
+    /// one, a snapshot taken while buffers come and go may not add up.
+    struct Statistics {
+      /// Capacity of the buffers waiting in the pool.
+      size_t pooled_bytes = 0u;
+      /// Number of buffers waiting in the pool.
+      size_t pooled_buffers = 0u;
+      /// Capacity of the buffers popped from the pool and not yet returned.
+      size_t outstanding_bytes = 0u;
+      /// Pops that reused a buffer from the pool.
+      size_t hits = 0u;
+      /// Pops that found no buffer to reuse.
+      size_t misses = 0u;
+      /// Buffers deleted to respect the limits of the pool.
+      size_t evictions = 0u;
+
+      double hit_rate() const {
+        const auto pops = hits + misses;
+        return pops > 0u ? static_cast<double>(hits) / static_cast<double>(pops) : 0.0;
+      }
+    };
+
     BufferPool() = default;
 
-    explicit BufferPool(size_t estimated_size) : _queue(estimated_size) {}
+    /// @a estimated_size is the number of buffers expected per size class,
+    /// the space for them is allocated when a size class receives its first
+    /// buffer.
+    explicit BufferPool(size_t estimated_size);
+
+    ~BufferPool();
 
     /// Pop a Buffer from the queue, creates a new one if the queue is empty.
-    Buffer Pop() {
-      Buffer item;
-      _queue.try_dequeue(item); // we don't care if it fails.
-#if __cplusplus >= 201703L // C++17
-      item._parent_pool = weak_from_this();
-#else
-      item._parent_pool = shared_from_this();
-#endif
-      return item;
-    }
+    /// The biggest buffers available are returned first.
+    Buffer Pop();
+
+    /// Pop a Buffer of @a size bytes. Buffers in the pool big enough are
+    /// reused, otherwise a new one is allocated.
+    Buffer Pop(size_type size);
+
+    /// Maximum capacity in bytes kept in the pool, 256 MiB by default.
+    void SetMaxPooledBytes(size_t max_pooled_bytes);
+
+    /// Buffers idle in the pool for longer than @a max_idle_time are deleted
+    /// next time a buffer returns to the pool, 10 seconds by default.
+    void SetMaxIdleTime(time_duration max_idle_time);
+
+    /// Delete the buffers idle in the pool for longer than @a max_idle_time.
+    /// The buffers checked can't be popped meanwhile.
+    void Trim(time_duration max_idle_time);
+
+    /// Delete every buffer in the pool.
+    void Clear();
+
+    Statistics GetStatistics() const;
 
   private:
 
     friend class Buffer;
 
-    void Push(Buffer buffer) {
-      _queue.enqueue(std::move(buffer));
+    using clock_type = std::chrono::steady_clock;
+
+    struct PooledBuffer {
+      Buffer buffer;
+      clock_type::time_point returned;
+    };
+
+    /// Buffers of a size class, in the order they returned for each thread.
+    using SizeClass = moodycamel::ConcurrentQueue<PooledBuffer>;
+
+    /// Size class n holds the buffers with capacity in [2^n, 2^(n+1)).
+    static constexpr size_type NUMBER_OF_SIZE_CLASSES = 32u;
+
+    /// Size class of a buffer with @a capacity bytes.
+    static size_type GetSizeClass(size_type capacity) {
+      size_type size_class = 0u;
+      while ((capacity >>= 1u) > 0u) {
+        ++size_class;
+      }
+      return size_class;
+    }
+
+    /// Smallest size class whose buffers are all at least @a size bytes, or
+    /// NUMBER_OF_SIZE_CLASSES if none is.
+    static size_type GetSizeClassToFit(const size_type size) {
+      const auto size_class = GetSizeClass(size);
+      const bool is_power_of_two = (size & (size - 1u)) == 0u;
+      return is_power_of_two ? size_class : size_class + 1u;
+    }
+
+    Buffer Adopt(Buffer item);
+
+    void Push(Buffer buffer);
+
+    /// Size class @a index, nullptr if it never received a buffer.
+    SizeClass *GetSizeClassIfCreated(size_type index) const {
+      return _size_classes[index].load(std::memory_order_acquire);
+    }
+
+    SizeClass &GetOrCreateSizeClass(size_type index);
+
+    /// Take the next buffer of size class @a index, an empty buffer if there
+    /// is none.
+    Buffer Take(size_type index);
+
+    /// Delete the next buffer of size class @a index. Returns false if there
+    /// is none.
+    bool Evict(size_type index);
+
+    /// Delete a buffer of size class @a first, or else of the biggest size
+    /// class with buffers. Returns false if the pool is empty.
+    bool EvictOne(size_type first);
+
+    /// Delete the buffers returned before @a time.
+    void EvictReturnedBefore(clock_type::time_point time);
+
+    void UpdateOutstandingBytes(size_type old_capacity, size_type new_capacity) noexcept {
+      _outstanding_bytes += new_capacity;
+      _outstanding_bytes -= old_capacity;
     }
 
-    moodycamel::ConcurrentQueue<Buffer> _queue;
+    const size_t _estimated_size = 0u;
+
+    /// Created on first use.
+    std::array<std::atomic<SizeClass *>, NUMBER_OF_SIZE_CLASSES> _size_classes{};
+
+    std::atomic_size_t _max_pooled_bytes{256u * 1024u * 1024u};
+
+    std::atomic<clock_type::rep> _max_idle_time{
+        std::chrono::duration_cast<clock_type::duration>(std::chrono::seconds(10)).count()};
+
+    /// Time at which the next returning buffer deletes the idle buffers.
+    std::atomic<clock_type::rep> _next_trim{0};
+
+    std::atomic_size_t _pooled_bytes{0u};
+
+    std::atomic_size_t _pooled_buffers{0u};
+
+    std::atomic_size_t _outstanding_bytes{0u};
+
+    std::atomic_size_t _hits{0u};
+
+    std::atomic_size_t _misses{0u};
+
+    std::atomic_size_t _evictions{0u};
   };
 
 } // namespace carla
@@ -0,0 +1,81 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/NonCopyable.h"
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace carla {
+
+  /// Cache of up to a fixed number of values, when full the least recently
+  /// used value is dropped to make room for new ones. Not thread-safe.
+  template <typename Key, typename Value, typename Hash = std::hash<Key>>
+  class LruCache : private NonCopyable {
+  public:
+
+    explicit LruCache(size_t capacity)
+      : _capacity(capacity) {
+      DEBUG_ASSERT(_capacity > 0u);
+    }
+
+    /// Value of @a key, or nullptr if it is not in the cache. The pointer is
+    /// valid until the next call to Put or clear.
+    const Value *Get(const Key &key) {
+      auto it = _index.find(key);
+      if (it == _index.end()) {
+        return nullptr;
+      }
+      // Move it to the front of the list.
+      _entries.splice(_entries.begin(), _entries, it->second);
+      return &it->second->second;
+    }
+
+    /// Add @a value to the cache, replacing any previous value of @a key.
+    void Put(const Key &key, Value value) {
+      auto it = _index.find(key);
+      if (it != _index.end()) {
+        it->second->second = std::move(value);
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return;
+      }
+      if (_entries.size() >= _capacity) {
+        _index.erase(_entries.back().first);
+        _entries.pop_back();
+      }
+      _entries.emplace_front(key, std::move(value));
+      _index.emplace(key, _entries.begin());
+    }
+
+    size_t size() const {
+      return _entries.size();
+    }
+
+    size_t capacity() const {
+      return _capacity;
+    }
+
+    void clear() {
+      _index.clear();
+      _entries.clear();
+    }
+
+  private:
+
+    const size_t _capacity;
+
+    /// Most recently used first.
+    std::list<std::pair<Key, Value>> _entries;
+
+    std::unordered_map<Key, typename decltype(_entries)::iterator, Hash> _index;
+  };
+
+} // namespace carla
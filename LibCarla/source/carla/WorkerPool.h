@@ -0,0 +1,156 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/ThreadGroup.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace carla {
+
+  /// Set of threads that run the iterations of a parallel loop, see
+  /// ParallelFor. The threads are started on first use and reused by every
+  /// loop afterwards.
+  class WorkerPool : private NonCopyable {
+  public:
+
+    /// Pool shared by the whole process, with a worker per hardware thread
+    /// besides the calling one.
+    static WorkerPool &GetShared() {
+      static WorkerPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1u);
+      return pool;
+    }
+
+    explicit WorkerPool(size_t worker_threads)
+      : _worker_threads(worker_threads) {}
+
+    ~WorkerPool() {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+      }
+      _job_available.notify_all();
+      _workers.JoinAll();
+    }
+
+    /// Number of threads that run a loop, the calling thread included.
+    size_t size() const {
+      return _worker_threads + 1u;
+    }
+
+    /// Call @a functor with every index in [0, @a count), split among the
+    /// workers and the calling thread. Returns once every call finished.
+    /// Loops run one at a time, concurrent calls wait for their turn, so
+    /// @a functor must not start a loop on the same pool.
+    ///
+    /// If a call throws, the remaining indices are skipped and the first
+    /// exception is rethrown here once every running call finished.
+    void ParallelFor(size_t count, std::function<void(size_t)> functor) {
+      std::lock_guard<std::mutex> loop_lock(_loop_mutex);
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_started) {
+          _workers.CreateThreads(_worker_threads, [this]() { Work(); });
+          _started = true;
+        }
+        _job = std::move(functor);
+        _count = count;
+        _next = 0u;
+        _busy_workers = _worker_threads;
+        ++_generation;
+      }
+      _job_available.notify_all();
+      RunIterations();
+      std::unique_lock<std::mutex> lock(_mutex);
+      _job_done.wait(lock, [this]() { return _busy_workers == 0u; });
+      _job = nullptr;
+      auto exception = std::move(_exception);
+      _exception = nullptr;
+      lock.unlock();
+      if (exception != nullptr) {
+        std::rethrow_exception(exception);
+      }
+    }
+
+  private:
+
+    void RunIterations() {
+      try {
+        for (auto i = _next++; i < _count; i = _next++) {
+          _job(i);
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_exception == nullptr) {
+          _exception = std::current_exception();
+        }
+        _next = _count;
+      }
+    }
+
+    void Work() {
+      uint64_t generation = 0u;
+      for (;;) {
+        {
+          std::unique_lock<std::mutex> lock(_mutex);
+          _job_available.wait(lock, [&]() {
+            return _stop || (_generation != generation);
+          });
+          if (_stop) {
+            return;
+          }
+          generation = _generation;
+        }
+        RunIterations();
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          --_busy_workers;
+        }
+        _job_done.notify_one();
+      }
+    }
+
+    const size_t _worker_threads;
+
+    /// Held by the loop running.
+    std::mutex _loop_mutex;
+
+    std::mutex _mutex;
+
+    std::condition_variable _job_available;
+
+    std::condition_variable _job_done;
+
+    bool _started = false;
+
+    bool _stop = false;
+
+    uint64_t _generation = 0u;
+
+    size_t _busy_workers = 0u;
+
+    std::function<void(size_t)> _job;
+
+    size_t _count = 0u;
+
+    std::atomic_size_t _next{0u};
+
+    /// First exception thrown by the current loop.
+    std::exception_ptr _exception;
+
+    ThreadGroup _workers;
+  };
+
+} // namespace carla
@@ -33,6 +33,12 @@ namespace client {
       _simulator->SetNetworkingTimeout(timeout);
     }
 
+    /// Cache the maps in @a directory, so the OpenDRIVE of each map is parsed
+    /// only the first time. The directory can be shared by several clients.
+    void SetMapCacheDirectory(const std::string &directory) {
+      _simulator->SetMapCacheDirectory(directory);
+    }
+
     /// Return the version string of this client API.
     std::string GetClientVersion() const {
       return _simulator->GetClientVersion();
@@ -43,11 +49,28 @@ namespace client {
       return _simulator->GetServerVersion();
     }
 
+    /// Same as GetServerVersion but returns immediately.
+    detail::Future<std::string> GetServerVersionAsync() const {
+      return _simulator->GetServerVersionAsync();
+    }
+
     /// Return an instance of the world currently active in the simulator.
     World GetWorld() const {
       return World{_simulator->GetCurrentEpisode()};
     }
 
+    /// Execute @a commands in order in a single call to the simulator, and
+    /// return the response of each command. Much faster than one call per
+    /// command when spawning or controlling many actors.
+    std::vector<rpc::CommandResponse> ApplyBatch(std::vector<rpc::Command> commands) const {
+      return _simulator->ApplyBatch(std::move(commands));
+    }
+
+    /// Same as ApplyBatch but does not wait for the commands to be executed.
+    void ApplyBatchAsync(std::vector<rpc::Command> commands) const {
+      _simulator->ApplyBatchAsync(std::move(commands));
+    }
+
   private:
 
     std::shared_ptr<detail::Simulator> _simulator;
@@ -81,13 +81,11 @@ namespace client {
   SharedPtr<sensor::SensorData> LaneDetector::TickLaneDetector(
       const Timestamp &timestamp) {
     try {
-      const auto new_bounds = GetVehicleBounds(*_vehicle);
+      const auto bounds = GetVehicleBounds(*_vehicle);
       std::vector<road::element::LaneMarking> crossed_lanes;
-      for (auto i = 0u; i < _bounds.size(); ++i) {
-        const auto lanes = _map->CalculateCrossedLanes(_bounds[i], new_bounds[i]);
-        crossed_lanes.insert(crossed_lanes.end(), lanes.begin(), lanes.end());
+      for (auto i = 0u; i < bounds.size(); ++i) {
+        _map->CalculateCrossedLanes(_trackers[i], bounds[i], crossed_lanes);
       }
-      _bounds = new_bounds;
       return crossed_lanes.empty() ?
           nullptr :
           MakeShared<sensor::data::LaneInvasionEvent>(
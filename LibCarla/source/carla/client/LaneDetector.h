@@ -8,6 +8,7 @@
 
 #include "carla/client/ClientSideSensor.h"
 #include "carla/geom/Location.h"
+#include "carla/road/element/LaneCrossingCalculator.h"
 
 #include <array>
 
@@ -51,7 +52,8 @@ namespace client {
 
     SharedPtr<Vehicle> _vehicle;
 
-    std::array<geom::Location, 4u> _bounds;
+    /// One per corner of the vehicle's bounding box.
+    std::array<road::element::LaneCrossingTracker, 4u> _trackers;
   };
 
 } // namespace client
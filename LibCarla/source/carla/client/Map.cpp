@@ -9,6 +9,7 @@
 #include "carla/client/Waypoint.h"
 #include "carla/opendrive/OpenDrive.h"
 #include "carla/road/Map.h"
+#include "carla/road/Router.h"
 #include "carla/road/WaypointGenerator.h"
 
 #include <sstream>
@@ -16,14 +17,19 @@
 namespace carla {
 namespace client {
 
-  static auto MakeMap(const std::string &opendrive_contents) {
+  static auto MakeMap(
+      const std::string &opendrive_contents,
+      const std::string &cache_directory) {
+    if (!cache_directory.empty()) {
+      return opendrive::OpenDrive::LoadCached(opendrive_contents, cache_directory);
+    }
     auto stream = std::istringstream(opendrive_contents);
     return opendrive::OpenDrive::Load(stream);
   }
 
-  Map::Map(rpc::MapInfo description)
+  Map::Map(rpc::MapInfo description, const std::string &cache_directory)
     : _description(std::move(description)),
-      _map(MakeMap(_description.open_drive_file)) {}
+      _map(MakeMap(_description.open_drive_file, cache_directory)) {}
 
   Map::~Map() = default;
 
@@ -42,6 +48,13 @@ namespace client {
         nullptr;
   }
 
+  std::vector<road::element::WaypointInfo> Map::GetWaypoints(
+      const std::vector<geom::Location> &locations,
+      bool project_to_road) const {
+    DEBUG_ASSERT(_map != nullptr);
+    return _map->GetWaypoints(locations, project_to_road);
+  }
+
   Map::TopologyList Map::GetTopology() const {
     DEBUG_ASSERT(_map != nullptr);
     namespace re = carla::road::element;
@@ -79,6 +92,11 @@ namespace client {
     return result;
   }
 
+  road::element::WaypointArrays Map::GenerateWaypointArrays(double distance) const {
+    DEBUG_ASSERT(_map != nullptr);
+    return road::WaypointGenerator::GenerateAllArrays(*_map, distance);
+  }
+
   std::vector<road::element::LaneMarking> Map::CalculateCrossedLanes(
       const geom::Location &origin,
       const geom::Location &destination) const {
@@ -86,5 +104,70 @@ namespace client {
     return _map->CalculateCrossedLanes(origin, destination);
   }
 
+  void Map::CalculateCrossedLanes(
+      road::element::LaneCrossingTracker &tracker,
+      const geom::Location &destination,
+      std::vector<road::element::LaneMarking> &out) const {
+    DEBUG_ASSERT(_map != nullptr);
+    _map->CalculateCrossedLanes(tracker, destination, out);
+  }
+
+  const std::vector<road::element::Signal> &Map::GetSignals() const {
+    DEBUG_ASSERT(_map != nullptr);
+    return _map->GetData().GetSignals();
+  }
+
+  const road::element::Signal *Map::GetNextSignal(const Waypoint &waypoint) const {
+    DEBUG_ASSERT(_map != nullptr);
+    const auto &w = waypoint._waypoint;
+    return _map->GetData().GetNextSignal(w.GetRoadId(), w.GetLaneId(), w.GetDistance());
+  }
+
+  std::vector<road::lane_junction_t> Map::GetJunctionConnections(const int junction_id) const {
+    DEBUG_ASSERT(_map != nullptr);
+    const auto connections = _map->GetData().GetJunctionConnections(junction_id);
+    return {connections.begin(), connections.end()};
+  }
+
+  const road::Router &Map::GetRouter() const {
+    DEBUG_ASSERT(_map != nullptr);
+    std::lock_guard<std::mutex> lock(_router_mutex);
+    if (_router == nullptr) {
+      _router = std::make_unique<road::Router>(*_map);
+    }
+    return *_router;
+  }
+
+  Map::Route Map::MakeRoute(const std::vector<road::element::Waypoint> &waypoints) const {
+    Route result;
+    result.reserve(waypoints.size());
+    for (const auto &waypoint : waypoints) {
+      result.emplace_back(SharedPtr<Waypoint>(new Waypoint{shared_from_this(), waypoint}));
+    }
+    return result;
+  }
+
+  Map::Route Map::ComputeRoute(const Waypoint &origin, const Waypoint &destination) const {
+    const auto route = GetRouter().ComputeRoute(origin._waypoint, destination._waypoint);
+    return MakeRoute(route.waypoints);
+  }
+
+  std::vector<Map::Route> Map::ComputeRoutes(
+      const std::vector<std::pair<SharedPtr<Waypoint>, SharedPtr<Waypoint>>> &pairs) const {
+    std::vector<std::pair<road::element::Waypoint, road::element::Waypoint>> input;
+    input.reserve(pairs.size());
+    for (const auto &pair : pairs) {
+      DEBUG_ASSERT(pair.first != nullptr);
+      DEBUG_ASSERT(pair.second != nullptr);
+      input.emplace_back(pair.first->_waypoint, pair.second->_waypoint);
+    }
+    std::vector<Route> result;
+    result.reserve(pairs.size());
+    for (const auto &route : GetRouter().ComputeRoutes(input)) {
+      result.emplace_back(MakeRoute(route.waypoints));
+    }
+    return result;
+  }
+
 } // namespace client
 } // namespace carla
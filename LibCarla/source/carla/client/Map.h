@@ -8,13 +8,26 @@
 
 #include "carla/Memory.h"
 #include "carla/NonCopyable.h"
+#include "carla/road/element/LaneCrossingCalculator.h"
 #include "carla/road/element/LaneMarking.h"
+#include "carla/road/element/Signal.h"
+#include "carla/road/element/WaypointArrays.h"
+#include "carla/road/element/WaypointInfo.h"
 #include "carla/rpc/MapInfo.h"
 
+#include <memory>
+#include <mutex>
 #include <string>
 
 namespace carla {
-namespace road { class Map; }
+namespace road {
+  class Map;
+  class Router;
+  struct lane_junction_t;
+namespace element {
+  class Waypoint;
+} // namespace element
+} // namespace road
 namespace client {
 
   class Waypoint;
@@ -24,7 +37,9 @@ namespace client {
       private NonCopyable {
   public:
 
-    explicit Map(rpc::MapInfo description);
+    /// If @a cache_directory is not empty, the map is loaded from the cache
+    /// in that directory, see opendrive::OpenDrive::LoadCached.
+    explicit Map(rpc::MapInfo description, const std::string &cache_directory = "");
 
     ~Map();
 
@@ -44,21 +59,67 @@ namespace client {
         const geom::Location &location,
         bool project_to_road = true) const;
 
+    /// Batched version of GetWaypoint, returns compact waypoint information
+    /// instead of a Waypoint per location.
+    std::vector<road::element::WaypointInfo> GetWaypoints(
+        const std::vector<geom::Location> &locations,
+        bool project_to_road = true) const;
+
     using TopologyList = std::vector<std::pair<SharedPtr<Waypoint>, SharedPtr<Waypoint>>>;
 
     TopologyList GetTopology() const;
 
     std::vector<SharedPtr<Waypoint>> GenerateWaypoints(double distance) const;
 
+    /// Same waypoints as GenerateWaypoints, but stored as a struct of arrays
+    /// instead of a Waypoint object each.
+    road::element::WaypointArrays GenerateWaypointArrays(double distance) const;
+
     std::vector<road::element::LaneMarking> CalculateCrossedLanes(
         const geom::Location &origin,
         const geom::Location &destination) const;
 
+    /// Incremental version of the above, see
+    /// road::element::LaneCrossingTracker.
+    void CalculateCrossedLanes(
+        road::element::LaneCrossingTracker &tracker,
+        const geom::Location &destination,
+        std::vector<road::element::LaneMarking> &out) const;
+
+    /// Waypoints along the shortest route from @a origin to @a destination,
+    /// see road::Router. Empty if @a destination cannot be reached.
+    using Route = std::vector<SharedPtr<Waypoint>>;
+
+    Route ComputeRoute(const Waypoint &origin, const Waypoint &destination) const;
+
+    /// Batched version of ComputeRoute.
+    std::vector<Route> ComputeRoutes(
+        const std::vector<std::pair<SharedPtr<Waypoint>, SharedPtr<Waypoint>>> &pairs) const;
+
+    /// All the signals of the map, sorted by road and distance along the road.
+    const std::vector<road::element::Signal> &GetSignals() const;
+
+    /// The next signal in the driving direction of @a waypoint that is valid
+    /// for its lane, or nullptr if there is none ahead in the same road.
+    const road::element::Signal *GetNextSignal(const Waypoint &waypoint) const;
+
+    /// Lane connections of the junction @a junction_id.
+    std::vector<road::lane_junction_t> GetJunctionConnections(int junction_id) const;
+
   private:
 
+    /// The router is built the first time a route is requested.
+    const road::Router &GetRouter() const;
+
+    Route MakeRoute(const std::vector<road::element::Waypoint> &waypoints) const;
+
     rpc::MapInfo _description;
 
     SharedPtr<road::Map> _map;
+
+    mutable std::mutex _router_mutex;
+
+    mutable std::unique_ptr<road::Router> _router;
   };
 
 } // namespace client
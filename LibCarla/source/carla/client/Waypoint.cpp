@@ -14,11 +14,17 @@ namespace client {
 
   Waypoint::Waypoint(SharedPtr<const Map> parent, road::element::Waypoint waypoint)
     : _parent(std::move(parent)),
-      _waypoint(std::move(waypoint)),
-      _transform(_waypoint.ComputeTransform()) {}
+      _waypoint(std::move(waypoint)) {}
 
   Waypoint::~Waypoint() = default;
 
+  const geom::Transform &Waypoint::GetTransform() const {
+    std::call_once(_transform_flag, [this]() {
+      _transform = _waypoint.ComputeTransform();
+    });
+    return _transform;
+  }
+
   std::vector<SharedPtr<Waypoint>> Waypoint::Next(double distance) const {
     auto waypoints = road::WaypointGenerator::GetNext(_waypoint, distance);
     std::vector<SharedPtr<Waypoint>> result;
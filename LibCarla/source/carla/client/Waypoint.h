@@ -10,6 +10,8 @@
 #include "carla/NonCopyable.h"
 #include "carla/road/element/Waypoint.h"
 
+#include <mutex>
+
 namespace carla {
 namespace client {
 
@@ -22,9 +24,8 @@ namespace client {
 
     ~Waypoint();
 
-    const geom::Transform &GetTransform() const {
-      return _transform;
-    }
+    /// The transform is computed the first time it is requested.
+    const geom::Transform &GetTransform() const;
 
     bool IsIntersection() const {
       return _waypoint.IsIntersection();
@@ -54,7 +55,9 @@ namespace client {
 
     road::element::Waypoint _waypoint;
 
-    geom::Transform _transform;
+    mutable std::once_flag _transform_flag;
+
+    mutable geom::Transform _transform;
   };
 
 } // namespace client
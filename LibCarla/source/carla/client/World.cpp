@@ -45,6 +45,22 @@ namespace client {
     _episode.Lock()->SetWeatherParameters(weather);
   }
 
+  detail::Future<SharedPtr<Map>> World::GetMapAsync() const {
+    return _episode.Lock()->GetCurrentMapAsync();
+  }
+
+  detail::Future<SharedPtr<BlueprintLibrary>> World::GetBlueprintLibraryAsync() const {
+    return _episode.Lock()->GetBlueprintLibraryAsync();
+  }
+
+  detail::Future<SharedPtr<Actor>> World::GetSpectatorAsync() const {
+    return _episode.Lock()->GetSpectatorAsync();
+  }
+
+  detail::Future<rpc::WeatherParameters> World::GetWeatherAsync() const {
+    return _episode.Lock()->GetWeatherParametersAsync();
+  }
+
   SharedPtr<ActorList> World::GetActors() const {
     return SharedPtr<ActorList>{new ActorList{
         _episode,
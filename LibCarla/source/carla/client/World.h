@@ -11,6 +11,7 @@
 #include "carla/client/DebugHelper.h"
 #include "carla/client/Timestamp.h"
 #include "carla/client/detail/EpisodeProxy.h"
+#include "carla/client/detail/Future.h"
 #include "carla/geom/Transform.h"
 #include "carla/rpc/WeatherParameters.h"
 
@@ -57,6 +58,22 @@ namespace client {
     /// Change the weather in the simulation.
     void SetWeather(const rpc::WeatherParameters &weather);
 
+    /// @name Asynchronous queries
+    ///
+    /// Same as the getters above but return immediately, independent queries
+    /// in flight at the same time cost about a single round trip.
+    /// @{
+
+    detail::Future<SharedPtr<Map>> GetMapAsync() const;
+
+    detail::Future<SharedPtr<BlueprintLibrary>> GetBlueprintLibraryAsync() const;
+
+    detail::Future<SharedPtr<Actor>> GetSpectatorAsync() const;
+
+    detail::Future<rpc::WeatherParameters> GetWeatherAsync() const;
+
+    /// @}
+
     /// Return a list with all the actors currently present in the world.
     SharedPtr<ActorList> GetActors() const;
 
@@ -6,6 +6,7 @@
 
 #include "carla/client/detail/Client.h"
 
+#include "carla/Optional.h"
 #include "carla/Version.h"
 #include "carla/rpc/ActorDescription.h"
 #include "carla/rpc/Client.h"
@@ -13,6 +14,9 @@
 #include "carla/rpc/VehicleControl.h"
 #include "carla/streaming/Client.h"
 
+#include <chrono>
+#include <future>
+#include <stdexcept>
 #include <thread>
 
 namespace carla {
@@ -44,8 +48,37 @@ namespace detail {
       rpc_client.async_call(function, std::forward<Args>(args)...);
     }
 
+    template <typename T, typename... Args>
+    Future<T> CallAsync(const std::string &function, Args &&... args) {
+      using clock = std::chrono::steady_clock;
+      auto future = rpc_client.async_call(function, std::forward<Args>(args)...).share();
+      const bool has_deadline = timeout.has_value();
+      const auto deadline = has_deadline ?
+          clock::now() + timeout->to_chrono() :
+          clock::time_point{};
+      auto wait_for = [future](time_duration time) {
+        return future.wait_for(time.to_chrono()) == std::future_status::ready;
+      };
+      auto get = [future, has_deadline, deadline, function]() {
+        if (has_deadline && (future.wait_until(deadline) != std::future_status::ready)) {
+          throw std::runtime_error("rpc call '" + function + "': time-out");
+        }
+        return future.get().get().template as<T>();
+      };
+      return Future<T>{std::move(wait_for), std::move(get)};
+    }
+
+    void SetTimeout(time_duration value) {
+      rpc_client.set_timeout(value.milliseconds());
+      timeout = value;
+    }
+
     rpc::Client rpc_client;
 
+    /// Networking timeout, applied by rpc_client to the synchronous calls and
+    /// by us to the asynchronous ones.
+    Optional<time_duration> timeout;
+
     streaming::Client streaming_client;
   };
 
@@ -62,7 +95,7 @@ namespace detail {
   Client::~Client() = default;
 
   void Client::SetTimeout(time_duration timeout) {
-    _pimpl->rpc_client.set_timeout(timeout.milliseconds());
+    _pimpl->SetTimeout(timeout);
   }
 
   std::string Client::GetClientVersion() {
@@ -143,6 +176,15 @@ namespace detail {
     _pimpl->AsyncCall("apply_control_to_actor", vehicle, control);
   }
 
+  std::vector<rpc::CommandResponse> Client::ApplyBatch(std::vector<rpc::Command> commands) {
+    using return_t = std::vector<rpc::CommandResponse>;
+    return _pimpl->CallAndWait<return_t>("apply_batch", std::move(commands));
+  }
+
+  void Client::ApplyBatchAsync(std::vector<rpc::Command> commands) {
+    _pimpl->AsyncCall("apply_batch", std::move(commands));
+  }
+
   void Client::SubscribeToStream(
       const streaming::Token &token,
       std::function<void(Buffer)> callback) {
@@ -157,6 +199,36 @@ namespace detail {
     _pimpl->AsyncCall("draw_debug_shape", shape);
   }
 
+  Future<std::string> Client::GetServerVersionAsync() {
+    return _pimpl->CallAsync<std::string>("version");
+  }
+
+  Future<rpc::EpisodeInfo> Client::GetEpisodeInfoAsync() {
+    return _pimpl->CallAsync<rpc::EpisodeInfo>("get_episode_info");
+  }
+
+  Future<rpc::MapInfo> Client::GetMapInfoAsync() {
+    return _pimpl->CallAsync<rpc::MapInfo>("get_map_info");
+  }
+
+  Future<std::vector<rpc::ActorDefinition>> Client::GetActorDefinitionsAsync() {
+    return _pimpl->CallAsync<std::vector<rpc::ActorDefinition>>("get_actor_definitions");
+  }
+
+  Future<rpc::Actor> Client::GetSpectatorAsync() {
+    return _pimpl->CallAsync<rpc::Actor>("get_spectator");
+  }
+
+  Future<rpc::WeatherParameters> Client::GetWeatherParametersAsync() {
+    return _pimpl->CallAsync<rpc::WeatherParameters>("get_weather_parameters");
+  }
+
+  Future<std::vector<rpc::Actor>> Client::GetActorsByIdAsync(
+      const std::vector<actor_id_type> &ids) {
+    using return_t = std::vector<rpc::Actor>;
+    return _pimpl->CallAsync<return_t>("get_actors_by_id", ids);
+  }
+
 } // namespace detail
 } // namespace client
 } // namespace carla
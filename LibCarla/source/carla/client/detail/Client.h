@@ -9,9 +9,12 @@
 #include "carla/Memory.h"
 #include "carla/NonCopyable.h"
 #include "carla/Time.h"
+#include "carla/client/detail/Future.h"
 #include "carla/geom/Transform.h"
 #include "carla/rpc/Actor.h"
 #include "carla/rpc/ActorDefinition.h"
+#include "carla/rpc/Command.h"
+#include "carla/rpc/CommandResponse.h"
 #include "carla/rpc/EpisodeInfo.h"
 #include "carla/rpc/MapInfo.h"
 #include "carla/rpc/WeatherParameters.h"
@@ -102,6 +105,14 @@ namespace detail {
         const rpc::Actor &vehicle,
         const rpc::VehicleControl &control);
 
+    /// Execute @a commands in order in a single call, returns the response of
+    /// each command.
+    std::vector<rpc::CommandResponse> ApplyBatch(std::vector<rpc::Command> commands);
+
+    /// Same as ApplyBatch but does not wait for the commands to be executed,
+    /// their responses are discarded.
+    void ApplyBatchAsync(std::vector<rpc::Command> commands);
+
     void SubscribeToStream(
         const streaming::Token &token,
         std::function<void(Buffer)> callback);
@@ -110,6 +121,29 @@ namespace detail {
 
     void DrawDebugShape(const rpc::DebugShape &shape);
 
+    /// @name Asynchronous queries
+    ///
+    /// Same as the queries above but return immediately, several queries in
+    /// flight cost about a single round trip. The networking timeout applies
+    /// from the moment the query is sent.
+    /// @{
+
+    Future<std::string> GetServerVersionAsync();
+
+    Future<rpc::EpisodeInfo> GetEpisodeInfoAsync();
+
+    Future<rpc::MapInfo> GetMapInfoAsync();
+
+    Future<std::vector<rpc::ActorDefinition>> GetActorDefinitionsAsync();
+
+    Future<rpc::Actor> GetSpectatorAsync();
+
+    Future<rpc::WeatherParameters> GetWeatherParametersAsync();
+
+    Future<std::vector<rpc::Actor>> GetActorsByIdAsync(const std::vector<actor_id_type> &ids);
+
+    /// @}
+
   private:
 
     class Pimpl;
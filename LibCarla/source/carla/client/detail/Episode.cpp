@@ -43,6 +43,9 @@ namespace detail {
         auto data = sensor::Deserializer::Deserialize(std::move(buffer));
         auto prev = self->_state.load();
         auto next = prev->DeriveNextStep(CastData(*data));
+        if (next == nullptr) {
+          return;
+        }
         /// @todo Check that this state occurred after.
         self->_state = next;
         self->_timestamp.SetValue(next->GetTimestamp());
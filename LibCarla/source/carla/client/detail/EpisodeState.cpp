@@ -6,6 +6,10 @@
 
 #include "carla/client/detail/EpisodeState.h"
 
+#include "carla/Logging.h"
+
+#include <algorithm>
+
 namespace carla {
 namespace client {
 namespace detail {
@@ -22,28 +26,128 @@ namespace detail {
     return acc;
   }
 
+  static bool CompareIds(
+      const std::pair<actor_id_type, EpisodeState::ActorState> &lhs,
+      const std::pair<actor_id_type, EpisodeState::ActorState> &rhs) {
+    return lhs.first < rhs.first;
+  }
+
   std::shared_ptr<const EpisodeState> EpisodeState::DeriveNextStep(
       const sensor::data::RawEpisodeState &state) const {
+    using FrameType = sensor::data::RawEpisodeState::FrameType;
+    const auto frame_type = state.GetFrameType();
+    if ((frame_type == FrameType::Delta) &&
+        (!_is_delta_base || (state.GetSequence() != _sequence + 1u))) {
+      log_debug("episode state: waiting for a keyframe");
+      return nullptr;
+    }
     auto next = std::make_shared<EpisodeState>();
     next->_timestamp.frame_count = state.GetFrameNumber();
     next->_timestamp.elapsed_seconds = state.GetGameTimeStamp();
     next->_timestamp.platform_timestamp = state.GetPlatformTimeStamp();
     next->_timestamp.delta_seconds = next->_timestamp.elapsed_seconds - _timestamp.elapsed_seconds;
-    next->_actors.reserve(state.size());
-    for (auto &&actor : state) {
-      auto acceleration = DeriveAcceleration(
-          next->_timestamp.delta_seconds,
-          GetActorState(actor.id).velocity,
-          actor.velocity);
-      DEBUG_ONLY(auto result = )
-      next->_actors.emplace(
-          actor.id,
-          ActorState{actor.transform, actor.velocity, acceleration, actor.state});
-      DEBUG_ASSERT(result.second);
+    switch (frame_type) {
+      case FrameType::Full:
+        next->AddActorsFromFullFrame(*this, state);
+        break;
+      case FrameType::Keyframe:
+        next->AddActorsFromKeyframe(*this, state);
+        break;
+      case FrameType::Delta:
+        next->AddActorsFromDelta(*this, state);
+        break;
     }
+    if (frame_type != FrameType::Full) {
+      next->_is_delta_base = true;
+      next->_sequence = state.GetSequence();
+    }
+    DEBUG_ASSERT(std::is_sorted(next->_actors.begin(), next->_actors.end(), CompareIds));
+    DEBUG_ASSERT(std::adjacent_find(next->_actors.begin(), next->_actors.end(),
+        [](const auto &lhs, const auto &rhs) { return lhs.first == rhs.first; }) == next->_actors.end());
     return next;
   }
 
+  const EpisodeState::ActorState *EpisodeState::FindActorState(actor_id_type id) const {
+    auto it = std::lower_bound(
+        _actors.begin(),
+        _actors.end(),
+        id,
+        [](const auto &pair, actor_id_type id) { return pair.first < id; });
+    return ((it != _actors.end()) && (it->first == id)) ? &it->second : nullptr;
+  }
+
+  void EpisodeState::AddActor(
+      const sensor::data::ActorDynamicState &actor,
+      const geom::Vector3D &previous_velocity) {
+    auto acceleration = DeriveAcceleration(
+        _timestamp.delta_seconds,
+        previous_velocity,
+        actor.velocity);
+    _actors.emplace_back(
+        actor.id,
+        ActorState{actor.transform, actor.velocity, acceleration, actor.state});
+  }
+
+  void EpisodeState::AddActorsFromFullFrame(
+      const EpisodeState &previous,
+      const sensor::data::RawEpisodeState &state) {
+    auto actors = state.GetActors();
+    _actors.reserve(actors.size());
+    for (auto &&actor : actors) {
+      AddActor(actor, previous.GetActorState(actor.id).velocity);
+    }
+    std::sort(_actors.begin(), _actors.end(), CompareIds);
+  }
+
+  void EpisodeState::AddActorsFromKeyframe(
+      const EpisodeState &previous,
+      const sensor::data::RawEpisodeState &state) {
+    auto actors = state.GetUpdatedActors();
+    _actors.reserve(actors.size());
+    for (auto &&quantized : actors) {
+      const sensor::data::ActorDynamicState actor = quantized;
+      AddActor(actor, previous.GetActorState(actor.id).velocity);
+    }
+  }
+
+  void EpisodeState::AddActorsFromDelta(
+      const EpisodeState &previous,
+      const sensor::data::RawEpisodeState &state) {
+    auto updated = state.GetUpdatedActors();
+    auto removed = state.GetRemovedActors();
+    _actors.reserve(previous._actors.size() + updated.size());
+    auto u = updated.begin();
+    auto r = removed.begin();
+    // Merge the previous state and the updated actors, both sorted by id,
+    // skipping the removed ones.
+    for (auto &&pair : previous._actors) {
+      for (; (u != updated.end()) && (u->GetId() < pair.first); ++u) {
+        AddActor(*u, geom::Vector3D{});
+      }
+      while ((r != removed.end()) && (*r < pair.first)) {
+        ++r;
+      }
+      if ((r != removed.end()) && (*r == pair.first)) {
+        continue;
+      }
+      const auto &velocity = pair.second.velocity;
+      if ((u != updated.end()) && (u->GetId() == pair.first)) {
+        AddActor(*u, velocity);
+        ++u;
+      } else {
+        // Same as a full frame with the actor unchanged.
+        _actors.emplace_back(pair);
+        _actors.back().second.acceleration = DeriveAcceleration(
+            _timestamp.delta_seconds,
+            velocity,
+            velocity);
+      }
+    }
+    for (; u != updated.end(); ++u) {
+      AddActor(*u, geom::Vector3D{});
+    }
+  }
+
 } // namespace detail
 } // namespace client
 } // namespace carla
@@ -13,8 +13,10 @@
 #include "carla/sensor/data/ActorDynamicState.h"
 #include "carla/sensor/data/RawEpisodeState.h"
 
+#include <cstdint>
 #include <memory>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace carla {
 namespace client {
@@ -39,9 +41,9 @@ namespace detail {
 
     ActorState GetActorState(actor_id_type id) const {
       ActorState state;
-      auto it = _actors.find(id);
-      if (it != _actors.end()) {
-        state = it->second;
+      auto *found = FindActorState(id);
+      if (found != nullptr) {
+        state = *found;
       } else {
         log_debug("actor", id, "not found in episode");
       }
@@ -54,14 +56,44 @@ namespace detail {
           iterator::make_map_keys_iterator(_actors.end()));
     }
 
+    /// Returns nullptr if @a state is a delta that cannot be applied on top of
+    /// this state, i.e. the stream was joined after the last keyframe or a
+    /// frame was lost.
     std::shared_ptr<const EpisodeState> DeriveNextStep(
         const sensor::data::RawEpisodeState &state) const;
 
   private:
 
+    using ActorStateList = std::vector<std::pair<actor_id_type, ActorState>>;
+
+    const ActorState *FindActorState(actor_id_type id) const;
+
+    void AddActor(
+        const sensor::data::ActorDynamicState &actor,
+        const geom::Vector3D &previous_velocity);
+
+    void AddActorsFromFullFrame(
+        const EpisodeState &previous,
+        const sensor::data::RawEpisodeState &state);
+
+    void AddActorsFromKeyframe(
+        const EpisodeState &previous,
+        const sensor::data::RawEpisodeState &state);
+
+    void AddActorsFromDelta(
+        const EpisodeState &previous,
+        const sensor::data::RawEpisodeState &state);
+
     Timestamp _timestamp;
 
-    std::unordered_map<actor_id_type, ActorState> _actors;
+    /// Sorted by id. Cheaper to copy than a hash map when applying deltas.
+    ActorStateList _actors;
+
+    /// Whether this state was decoded from a keyframe or a delta, and can be
+    /// the base of the delta with the next sequence number.
+    bool _is_delta_base = false;
+
+    uint32_t _sequence = 0u;
   };
 
 } // namespace detail
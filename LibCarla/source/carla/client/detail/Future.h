@@ -0,0 +1,112 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/Optional.h"
+#include "carla/Time.h"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  /// Result of an asynchronous call to the simulator. Calls in flight are
+  /// pipelined through the same connection, so waiting for N independent
+  /// futures costs about a single round trip instead of N.
+  ///
+  /// Unlike std::future it can be polled, and the result can be retrieved any
+  /// number of times.
+  template <typename T>
+  class Future {
+  public:
+
+    using value_type = T;
+
+    /// @a wait_for blocks up to the given timeout until the result is
+    /// available and returns whether it is; @a get returns the result, or
+    /// throws the error of the call.
+    Future(
+        std::function<bool(time_duration)> wait_for,
+        std::function<T()> get)
+      : _wait_for(std::move(wait_for)),
+        _get(std::move(get)) {
+      DEBUG_ASSERT(_wait_for != nullptr);
+      DEBUG_ASSERT(_get != nullptr);
+    }
+
+    bool IsReady() const {
+      return _wait_for(time_duration{});
+    }
+
+    /// Block until the result is available or @a timeout expires, return
+    /// whether the result is available.
+    bool WaitFor(time_duration timeout) const {
+      return _wait_for(timeout);
+    }
+
+    /// Block until the result is available and return it. Throws if the call
+    /// failed or the networking timeout expired.
+    T Get() const {
+      return _get();
+    }
+
+    /// Return a future whose result is @a callback applied to the result of
+    /// this one. The callback runs once, on the first thread that retrieves
+    /// the result; if it throws the next retrieval tries again.
+    template <typename F>
+    auto Then(F callback) const {
+      using U = decltype(callback(std::declval<T>()));
+      struct SharedState {
+        std::once_flag flag;
+        Optional<U> result;
+      };
+      auto state = std::make_shared<SharedState>();
+      return Future<U>{_wait_for, [get=_get, cb=std::move(callback), state]() -> U {
+        std::call_once(state->flag, [&]() {
+          state->result.emplace(cb(get()));
+        });
+        return *state->result;
+      }};
+    }
+
+  private:
+
+    std::function<bool(time_duration)> _wait_for;
+
+    std::function<T()> _get;
+  };
+
+  /// Wait for all the @a futures and return their results in order. Throws
+  /// the first error found.
+  template <typename... Ts>
+  std::tuple<Ts...> WaitAll(const Future<Ts> &... futures) {
+    // Braced initialization retrieves the results from left to right.
+    return std::tuple<Ts...>{futures.Get()...};
+  }
+
+  /// Wait for all the @a futures and return their results in order. Throws
+  /// the first error found.
+  template <typename T>
+  std::vector<T> WaitAll(const std::vector<Future<T>> &futures) {
+    std::vector<T> result;
+    result.reserve(futures.size());
+    for (auto &&future : futures) {
+      result.emplace_back(future.Get());
+    }
+    return result;
+  }
+
+} // namespace detail
+} // namespace client
+} // namespace carla
@@ -25,9 +25,7 @@ namespace detail {
   // -- Static local methods ---------------------------------------------------
   // ===========================================================================
 
-  static void ValidateVersions(Client &client) {
-    const auto vc = client.GetClientVersion();
-    const auto vs = client.GetServerVersion();
+  static void ValidateVersions(const std::string &vc, const std::string &vs) {
     if (vc != vs) {
       log_warning(
           "Version mismatch detected: You are trying to connect to a simulator",
@@ -57,38 +55,49 @@ namespace detail {
 
   EpisodeProxy Simulator::GetCurrentEpisode() {
     if (_episode == nullptr) {
-      ValidateVersions(_client);
-      _episode = std::make_shared<Episode>(_client);
-      _episode->Listen();
+      // Keep the version query in flight while the episode info is retrieved.
+      auto server_version = _client.GetServerVersionAsync();
+      auto episode = std::make_shared<Episode>(_client);
+      ValidateVersions(_client.GetClientVersion(), server_version.Get());
+      episode->Listen();
+      _episode = std::move(episode);
     }
     return EpisodeProxy{shared_from_this()};
   }
 
-  SharedPtr<Map> Simulator::GetCurrentMap() {
-    return MakeShared<Map>(_client.GetMapInfo());
-  }
-
   // ===========================================================================
-  // -- Access to global objects in the episode --------------------------------
+  // -- Asynchronous queries ---------------------------------------------------
   // ===========================================================================
 
-  SharedPtr<BlueprintLibrary> Simulator::GetBlueprintLibrary() {
-    auto defs = _client.GetActorDefinitions();
-    { /// @todo
-      rpc::ActorDefinition def;
-      def.id = "sensor.other.lane_detector";
-      def.tags = "sensor,other,lane_detector";
-      defs.emplace_back(def);
-    }
-    return MakeShared<BlueprintLibrary>(std::move(defs));
+  Future<SharedPtr<Map>> Simulator::GetCurrentMapAsync() {
+    return _client.GetMapInfoAsync().Then(
+        [directory=_map_cache_directory](rpc::MapInfo info) {
+      return MakeShared<Map>(std::move(info), directory);
+    });
+  }
+
+  Future<SharedPtr<BlueprintLibrary>> Simulator::GetBlueprintLibraryAsync() {
+    return _client.GetActorDefinitionsAsync().Then(
+        [](std::vector<rpc::ActorDefinition> defs) {
+      { /// @todo
+        rpc::ActorDefinition def;
+        def.id = "sensor.other.lane_detector";
+        def.tags = "sensor,other,lane_detector";
+        defs.emplace_back(def);
+      }
+      return MakeShared<BlueprintLibrary>(std::move(defs));
+    });
   }
 
-  SharedPtr<Actor> Simulator::GetSpectator() {
-    return ActorFactory::MakeActor(
-        GetCurrentEpisode(),
-        _client.GetSpectator(),
-        nullptr,
-        GarbageCollectionPolicy::Disabled);
+  Future<SharedPtr<Actor>> Simulator::GetSpectatorAsync() {
+    return _client.GetSpectatorAsync().Then(
+        [self=shared_from_this()](rpc::Actor spectator) {
+      return ActorFactory::MakeActor(
+          self->GetCurrentEpisode(),
+          std::move(spectator),
+          nullptr,
+          GarbageCollectionPolicy::Disabled);
+    });
   }
 
   // ===========================================================================
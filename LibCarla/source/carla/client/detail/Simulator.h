@@ -68,7 +68,14 @@ namespace detail {
 
     EpisodeProxy GetCurrentEpisode();
 
-    SharedPtr<Map> GetCurrentMap();
+    SharedPtr<Map> GetCurrentMap() {
+      return GetCurrentMapAsync().Get();
+    }
+
+    /// Directory where the maps are cached, if empty maps are not cached.
+    void SetMapCacheDirectory(std::string directory) {
+      _map_cache_directory = std::move(directory);
+    }
 
     /// @}
     // =========================================================================
@@ -98,6 +105,10 @@ namespace detail {
       return _client.GetServerVersion();
     }
 
+    Future<std::string> GetServerVersionAsync() {
+      return _client.GetServerVersionAsync();
+    }
+
     /// @}
     // =========================================================================
     /// @name Tick
@@ -120,9 +131,13 @@ namespace detail {
     // =========================================================================
     /// @{
 
-    SharedPtr<BlueprintLibrary> GetBlueprintLibrary();
+    SharedPtr<BlueprintLibrary> GetBlueprintLibrary() {
+      return GetBlueprintLibraryAsync().Get();
+    }
 
-    SharedPtr<Actor> GetSpectator();
+    SharedPtr<Actor> GetSpectator() {
+      return GetSpectatorAsync().Get();
+    }
 
     rpc::WeatherParameters GetWeatherParameters() {
       return _client.GetWeatherParameters();
@@ -132,6 +147,23 @@ namespace detail {
       _client.SetWeatherParameters(weather);
     }
 
+    /// @}
+    // =========================================================================
+    /// @name Asynchronous queries
+    // =========================================================================
+    /// @{
+
+    /// The map is built from the response on the thread that retrieves it.
+    Future<SharedPtr<Map>> GetCurrentMapAsync();
+
+    Future<SharedPtr<BlueprintLibrary>> GetBlueprintLibraryAsync();
+
+    Future<SharedPtr<Actor>> GetSpectatorAsync();
+
+    Future<rpc::WeatherParameters> GetWeatherParametersAsync() {
+      return _client.GetWeatherParametersAsync();
+    }
+
     /// @}
     // =========================================================================
     /// @name General operations with actors
@@ -188,6 +220,20 @@ namespace detail {
       _client.SetActorSimulatePhysics(actor.Serialize(), enabled);
     }
 
+    /// @}
+    // =========================================================================
+    /// @name Batched operations
+    // =========================================================================
+    /// @{
+
+    std::vector<rpc::CommandResponse> ApplyBatch(std::vector<rpc::Command> commands) {
+      return _client.ApplyBatch(std::move(commands));
+    }
+
+    void ApplyBatchAsync(std::vector<rpc::Command> commands) {
+      _client.ApplyBatchAsync(std::move(commands));
+    }
+
     /// @}
     // =========================================================================
     /// @name Operations with vehicles
@@ -233,6 +279,8 @@ namespace detail {
     std::shared_ptr<Episode> _episode;
 
     GarbageCollectionPolicy _gc_policy;
+
+    std::string _map_cache_directory;
   };
 
 } // namespace detail
@@ -8,6 +8,16 @@
 
 #include "../road/MapBuilder.h"
 #include "carla/Debug.h"
+#include "carla/FileSystem.h"
+#include "carla/Logging.h"
+#include "carla/road/MapSerializer.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
 
 namespace carla {
 namespace opendrive {
@@ -23,6 +33,17 @@ namespace opendrive {
     }
   }
 
+  static const char *fnc_contact_point_name(opendrive::types::ContactPoint contact_point) {
+    switch (contact_point) {
+      case opendrive::types::ContactPoint::Start:
+        return "start";
+      case opendrive::types::ContactPoint::End:
+        return "end";
+      default:
+        return "";
+    }
+  }
+
   static void fnc_generate_junctions_data(
       opendrive::types::OpenDriveData &openDriveRoad,
       std::map<int,
@@ -37,7 +58,8 @@ namespace opendrive {
 
         junctionData.incomming_road = incommingRoad;
         junctionData.connection_road = connectingRoad;
-        junctionData.contact_point = openDriveRoad.junctions[i].connections[j].attributes.contact_point;
+        junctionData.contact_point = fnc_contact_point_name(
+            openDriveRoad.junctions[i].connections[j].attributes.contact_point);
 
         for (size_t k = 0; k < openDriveRoad.junctions[i].connections[j].links.size(); ++k) {
           junctionData.from_lane.emplace_back(openDriveRoad.junctions[i].connections[j].links[k].from);
@@ -73,6 +95,36 @@ namespace opendrive {
     }
   }
 
+  static road::element::Signal fnc_make_signal(
+      const int road_id,
+      const opendrive::types::TrafficSignalInformation &info) {
+    road::element::Signal signal;
+    signal.id = info.id;
+    signal.road_id = static_cast<road::element::id_type>(road_id);
+    signal.s = info.start_position;
+    signal.t = info.track_position;
+    signal.zoffset = info.zoffset;
+    signal.value = info.value;
+    signal.name = info.name;
+    signal.is_dynamic = info.dynamic;
+    switch (info.orientation) {
+      case opendrive::types::SignalOrientation::Positive:
+        signal.orientation = road::element::SignalOrientation::Positive;
+        break;
+      case opendrive::types::SignalOrientation::Negative:
+        signal.orientation = road::element::SignalOrientation::Negative;
+        break;
+      default:
+        signal.orientation = road::element::SignalOrientation::Both;
+        break;
+    }
+    signal.country = info.country;
+    signal.type = info.type;
+    signal.subtype = info.subtype;
+    signal.validity = info.validity;
+    return signal;
+  }
+
   // HACK(Andrei):
   static int fnc_get_first_driving_line(opendrive::types::RoadInformation *roadInfo, int id = 0) {
     if (roadInfo == nullptr) {
@@ -83,7 +135,7 @@ namespace opendrive {
         itSec != roadInfo->lanes.lane_sections.rend() - 1;
         ++itSec) {
       for (auto itLane = itSec->left.begin(); itLane != itSec->left.end(); ++itLane) {
-        if (itLane->attributes.type == "driving" && itLane->attributes.id == id) {
+        if (itLane->attributes.type == opendrive::types::LaneType::Driving && itLane->attributes.id == id) {
           id = itLane->link ? itLane->link->predecessor_id : 0;
           break;
         }
@@ -93,13 +145,7 @@ namespace opendrive {
     return id;
   }
 
-  SharedPtr<road::Map> OpenDrive::Load(
-      const std::string &file,
-      XmlInputType inputType,
-      std::string *out_error) {
-    carla::opendrive::types::OpenDriveData open_drive_road;
-
-    OpenDriveParser::Parse(file.c_str(), open_drive_road, inputType, out_error);
+  static SharedPtr<road::Map> fnc_build_map(opendrive::types::OpenDriveData &open_drive_road) {
     carla::road::MapBuilder mapBuilder;
 
     if (open_drive_road.roads.empty()) {
@@ -144,7 +190,7 @@ namespace opendrive {
 
       for (auto &&leftlanes : it->second->lanes.lane_sections[0].left) {
         if (leftlanes.link != nullptr) {
-          if (leftlanes.attributes.type != "driving") {
+          if (leftlanes.attributes.type != opendrive::types::LaneType::Driving) {
             continue;
           }
           if (leftlanes.link->successor_id != 0) {
@@ -158,7 +204,7 @@ namespace opendrive {
 
       for (auto &&rightlanes : it->second->lanes.lane_sections[0].right) {
         if (rightlanes.link != nullptr) {
-          if (rightlanes.attributes.type != "driving") {
+          if (rightlanes.attributes.type != opendrive::types::LaneType::Driving) {
             continue;
           }
           if (rightlanes.link->successor_id != 0) {
@@ -215,7 +261,7 @@ namespace opendrive {
       }
 
       if (it->second->road_link.successor != nullptr) {
-        if (it->second->road_link.successor->element_type == "junction") {
+        if (it->second->road_link.successor->element_type == opendrive::types::ElementType::Junction) {
           std::vector<carla::road::lane_junction_t> &options =
               junctionsData[it->second->road_link.successor->id][it->first];
           for (size_t i = 0; i < options.size(); ++i) {
@@ -233,7 +279,7 @@ namespace opendrive {
             }
           }
         } else {
-          bool is_start = it->second->road_link.successor->contact_point == "start";
+          bool is_start = it->second->road_link.successor->contact_point == opendrive::types::ContactPoint::Start;
           roadSegment.AddSuccessorID(it->second->road_link.successor->id, is_start);
 
           for (auto &&lanes : rightLanesGoToSuccessor) {
@@ -247,7 +293,7 @@ namespace opendrive {
       }
 
       if (it->second->road_link.predecessor != nullptr) {
-        if (it->second->road_link.predecessor->element_type == "junction") {
+        if (it->second->road_link.predecessor->element_type == opendrive::types::ElementType::Junction) {
           std::vector<carla::road::lane_junction_t> &options =
               junctionsData[it->second->road_link.predecessor->id][it->first];
           for (size_t i = 0; i < options.size(); ++i) {
@@ -265,7 +311,7 @@ namespace opendrive {
             }
           }
         } else {
-          bool is_start = it->second->road_link.predecessor->contact_point == "start";
+          bool is_start = it->second->road_link.predecessor->contact_point == opendrive::types::ContactPoint::Start;
           roadSegment.AddPredecessorID(it->second->road_link.predecessor->id, is_start);
 
           for (auto &&lanes : rightLanesGoToPredecessor) {
@@ -329,22 +375,115 @@ namespace opendrive {
         }
       }
 
+      for (auto &&elevation : it->second->road_profiles.elevation_profile) {
+        roadSegment.AddElevation({
+            elevation.start_position,
+            elevation.elevation,
+            elevation.slope,
+            elevation.vertical_curvature,
+            elevation.curvature_change});
+      }
+
+      for (auto &&superelevation : it->second->road_profiles.lateral_profile) {
+        roadSegment.AddSuperelevation({
+            superelevation.start_position,
+            superelevation.elevation,
+            superelevation.slope,
+            superelevation.vertical_curvature,
+            superelevation.curvature_change});
+      }
+
+      for (auto &&signal : it->second->trafic_signals) {
+        mapBuilder.AddSignal(fnc_make_signal(it->first, signal));
+      }
+
       mapBuilder.AddRoadSegmentDefinition(roadSegment);
     }
 
     return mapBuilder.Build();
   }
 
+  SharedPtr<road::Map> OpenDrive::Load(
+      const std::string &file,
+      XmlInputType inputType,
+      std::string *out_error) {
+    carla::opendrive::types::OpenDriveData open_drive_road;
+    OpenDriveParser::Parse(file.c_str(), open_drive_road, inputType, out_error);
+    return fnc_build_map(open_drive_road);
+  }
+
   SharedPtr<road::Map> OpenDrive::Load(std::istream &input, std::string *out_error) {
+    // Read the whole stream at once, the parser uses this buffer in place.
+    std::string fileContent{std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
 
-    std::string fileContent;
-    std::string line;
+    carla::opendrive::types::OpenDriveData open_drive_road;
+    OpenDriveParser::ParseInPlace(&fileContent[0], fileContent.size(), open_drive_road, out_error);
+    return fnc_build_map(open_drive_road);
+  }
 
-    while (std::getline(input, line)) {
-      fileContent.append(line);
+  static SharedPtr<road::Map> ReadCachedMap(const std::string &path, const uint64_t key) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+      return nullptr;
     }
+    const auto size = static_cast<size_t>(file.tellg());
+    std::vector<unsigned char> data(size);
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char *>(data.data()), size)) {
+      return nullptr;
+    }
+    return road::MapSerializer::Deserialize(data.data(), data.size(), key);
+  }
 
-    return Load(fileContent, XmlInputType::CONTENT, out_error);
+  static void WriteCachedMap(std::string path, const road::Map &map, const uint64_t key) {
+    try {
+      FileSystem::ValidateFilePath(path);
+    } catch (const std::exception &e) {
+      log_warning("failed to create map cache directory:", e.what());
+      return;
+    }
+    const auto data = road::MapSerializer::Serialize(map, key);
+    // Other processes may be reading or writing the same file, write to a
+    // temporary file and move it to its place once complete.
+    const auto temp_path = path + "." + std::to_string(std::random_device{}()) + ".tmp";
+    {
+      std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+      file.write(reinterpret_cast<const char *>(data.data()), data.size());
+      if (!file) {
+        log_warning("failed to write map cache:", temp_path);
+        std::remove(temp_path.c_str());
+        return;
+      }
+    }
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+      // Probably the file already exists and the system does not replace it.
+      std::remove(temp_path.c_str());
+    }
+  }
+
+  SharedPtr<road::Map> OpenDrive::LoadCached(
+      const std::string &opendrive,
+      const std::string &cache_directory,
+      std::string *out_error) {
+    const auto key = road::MapSerializer::Hash(opendrive);
+    char file_name[32u];
+    std::snprintf(file_name, sizeof(file_name), "%016" PRIx64 ".bin", key);
+    const auto path = cache_directory + "/" + file_name;
+
+    auto map = ReadCachedMap(path, key);
+    if (map != nullptr) {
+      return map;
+    }
+
+    std::string error;
+    std::istringstream stream(opendrive);
+    map = Load(stream, &error);
+    if (error.empty()) {
+      WriteCachedMap(path, *map, key);
+    } else if (out_error != nullptr) {
+      *out_error = error;
+    }
+    return map;
   }
 
 } // namespace opendrive
@@ -29,6 +29,14 @@ namespace opendrive {
         XmlInputType inputType,
         std::string *out_error = nullptr);
 
+    /// Same as Load(std::istream &), but the map built is cached in
+    /// @a cache_directory keyed by a hash of @a opendrive. The XML is only
+    /// parsed if the cache does not contain the map yet.
+    static SharedPtr<road::Map> LoadCached(
+        const std::string &opendrive,
+        const std::string &cache_directory,
+        std::string *out_error = nullptr);
+
     static void Dump(const road::Map &map, std::ostream &output);
   };
 
@@ -0,0 +1,107 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "EnumParser.h"
+
+#include <cstring>
+#include <utility>
+
+using namespace carla::opendrive::types;
+
+template <typename T, size_t N>
+static T FindValue(
+    const char *value,
+    const std::pair<const char *, T> (&values)[N],
+    const T unknown) {
+  for (auto &&item : values) {
+    if (std::strcmp(value, item.first) == 0) {
+      return item.second;
+    }
+  }
+  return unknown;
+}
+
+LaneType carla::opendrive::parser::EnumParser::ParseLaneType(const char *value) {
+  return carla::road::element::LaneTypeFromString(value);
+}
+
+RoadMarkType carla::opendrive::parser::EnumParser::ParseRoadMarkType(const char *value) {
+  static const std::pair<const char *, RoadMarkType> values[] = {
+    {"none", RoadMarkType::None},
+    {"solid", RoadMarkType::Solid},
+    {"broken", RoadMarkType::Broken},
+    {"solid solid", RoadMarkType::SolidSolid},
+    {"solid broken", RoadMarkType::SolidBroken},
+    {"broken solid", RoadMarkType::BrokenSolid},
+    {"broken broken", RoadMarkType::BrokenBroken},
+    {"botts dots", RoadMarkType::BottsDots},
+    {"grass", RoadMarkType::Grass},
+    {"curb", RoadMarkType::Curb}
+  };
+  return FindValue(value, values, RoadMarkType::Unknown);
+}
+
+RoadMarkWeight carla::opendrive::parser::EnumParser::ParseRoadMarkWeight(const char *value) {
+  static const std::pair<const char *, RoadMarkWeight> values[] = {
+    {"standard", RoadMarkWeight::Standard},
+    {"bold", RoadMarkWeight::Bold}
+  };
+  return FindValue(value, values, RoadMarkWeight::Unknown);
+}
+
+RoadMarkColor carla::opendrive::parser::EnumParser::ParseRoadMarkColor(const char *value) {
+  static const std::pair<const char *, RoadMarkColor> values[] = {
+    {"standard", RoadMarkColor::Standard},
+    {"blue", RoadMarkColor::Blue},
+    {"green", RoadMarkColor::Green},
+    {"red", RoadMarkColor::Red},
+    {"white", RoadMarkColor::White},
+    {"yellow", RoadMarkColor::Yellow}
+  };
+  return FindValue(value, values, RoadMarkColor::Unknown);
+}
+
+LaneChange carla::opendrive::parser::EnumParser::ParseLaneChange(const char *value) {
+  static const std::pair<const char *, LaneChange> values[] = {
+    {"increase", LaneChange::Increase},
+    {"decrease", LaneChange::Decrease},
+    {"both", LaneChange::Both},
+    {"none", LaneChange::None}
+  };
+  return FindValue(value, values, LaneChange::Unknown);
+}
+
+ElementType carla::opendrive::parser::EnumParser::ParseElementType(const char *value) {
+  static const std::pair<const char *, ElementType> values[] = {
+    {"road", ElementType::Road},
+    {"junction", ElementType::Junction}
+  };
+  return FindValue(value, values, ElementType::Unknown);
+}
+
+ContactPoint carla::opendrive::parser::EnumParser::ParseContactPoint(const char *value) {
+  static const std::pair<const char *, ContactPoint> values[] = {
+    {"start", ContactPoint::Start},
+    {"end", ContactPoint::End}
+  };
+  return FindValue(value, values, ContactPoint::Unknown);
+}
+
+SignalOrientation carla::opendrive::parser::EnumParser::ParseSignalOrientation(const char *value) {
+  static const std::pair<const char *, SignalOrientation> values[] = {
+    {"+", SignalOrientation::Positive},
+    {"-", SignalOrientation::Negative},
+    {"none", SignalOrientation::Both}
+  };
+  return FindValue(value, values, SignalOrientation::Unknown);
+}
+
+bool carla::opendrive::parser::EnumParser::ParseBool(const char *value) {
+  return
+      (std::strcmp(value, "true") == 0) ||
+      (std::strcmp(value, "yes") == 0) ||
+      (std::strcmp(value, "1") == 0);
+}
@@ -0,0 +1,43 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "../types.h"
+
+namespace carla {
+namespace opendrive {
+namespace parser {
+
+  /// Converts the values of attributes with a small set of possible values
+  /// to their enum. Values not defined by OpenDRIVE, or missing attributes,
+  /// give the Unknown value of the enum.
+  class EnumParser {
+  public:
+
+    static types::LaneType ParseLaneType(const char *value);
+
+    static types::RoadMarkType ParseRoadMarkType(const char *value);
+
+    static types::RoadMarkWeight ParseRoadMarkWeight(const char *value);
+
+    static types::RoadMarkColor ParseRoadMarkColor(const char *value);
+
+    static types::LaneChange ParseLaneChange(const char *value);
+
+    static types::ElementType ParseElementType(const char *value);
+
+    static types::ContactPoint ParseContactPoint(const char *value);
+
+    static types::SignalOrientation ParseSignalOrientation(const char *value);
+
+    /// "true", "yes" and "1" are true, anything else is false.
+    static bool ParseBool(const char *value);
+  };
+
+}
+}
+}
@@ -6,6 +6,8 @@
 
 #include "JunctionParser.h"
 
+#include "EnumParser.h"
+
 void carla::opendrive::parser::JunctionParser::Parse(
     const pugi::xml_node &xmlNode,
     std::vector<carla::opendrive::types::Junction> &out_junction) {
@@ -28,7 +30,8 @@ void carla::opendrive::parser::JunctionParser::ParseConnection(
     carla::opendrive::types::JunctionConnection jConnection;
 
     jConnection.attributes.id = std::atoi(junctionConnection.attribute("id").value());
-    jConnection.attributes.contact_point = junctionConnection.attribute("contactPoint").value();
+    jConnection.attributes.contact_point =
+        EnumParser::ParseContactPoint(junctionConnection.attribute("contactPoint").value());
 
     jConnection.attributes.incoming_road = std::atoi(junctionConnection.attribute("incomingRoad").value());
     jConnection.attributes.connecting_road =
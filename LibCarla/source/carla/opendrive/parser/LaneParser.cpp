@@ -6,14 +6,16 @@
 
 #include "LaneParser.h"
 
+#include "EnumParser.h"
+
 void carla::opendrive::parser::LaneParser::ParseLane(
     const pugi::xml_node &xmlNode,
     std::vector<carla::opendrive::types::LaneInfo> &out_lane) {
   for (pugi::xml_node lane = xmlNode.child("lane"); lane; lane = lane.next_sibling("lane")) {
     carla::opendrive::types::LaneInfo currentLane;
 
-    currentLane.attributes.type = lane.attribute("type").value();
-    currentLane.attributes.level = lane.attribute("level").value();
+    currentLane.attributes.type = EnumParser::ParseLaneType(lane.attribute("type").value());
+    currentLane.attributes.level = EnumParser::ParseBool(lane.attribute("level").value());
     currentLane.attributes.id = std::atoi(lane.attribute("id").value());
 
     ParseLaneSpeed(lane, currentLane.lane_speed);
@@ -96,29 +98,11 @@ void carla::opendrive::parser::LaneParser::ParseLaneRoadMark(
     roadMarker.width = 0.0;
   }
 
-  if (xmlNode.attribute("type") != nullptr) {
-    roadMarker.type = xmlNode.attribute("type").value();
-  } else {
-    roadMarker.type = "";
-  }
-
-  if (xmlNode.attribute("weight") != nullptr) {
-    roadMarker.weigth = xmlNode.attribute("weight").value();
-  } else {
-    roadMarker.weigth = "";
-  }
-
-  if (xmlNode.attribute("color") != nullptr) {
-    roadMarker.color = xmlNode.attribute("color").value();
-  } else {
-    roadMarker.color = "";
-  }
-
-  if (xmlNode.attribute("laneChange") != nullptr) {
-    roadMarker.lange_change = xmlNode.attribute("laneChange").value();
-  } else {
-    roadMarker.lange_change = "";
-  }
+  // Missing attributes are empty, parsed as unknown.
+  roadMarker.type = EnumParser::ParseRoadMarkType(xmlNode.attribute("type").value());
+  roadMarker.weigth = EnumParser::ParseRoadMarkWeight(xmlNode.attribute("weight").value());
+  roadMarker.color = EnumParser::ParseRoadMarkColor(xmlNode.attribute("color").value());
+  roadMarker.lange_change = EnumParser::ParseLaneChange(xmlNode.attribute("laneChange").value());
 
   out_lane_mark.emplace_back(roadMarker);
 }
@@ -0,0 +1,153 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "OpenDriveParser.h"
+
+#include "carla/ThreadGroup.h"
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <vector>
+
+/// Minimum number of roads per thread, fewer don't pay off the cost of
+/// starting a thread.
+static constexpr size_t MIN_ROADS_PER_THREAD = 64u;
+
+bool OpenDriveParser::Parse(
+    const char *xml,
+    carla::opendrive::types::OpenDriveData &out_open_drive_data,
+    XmlInputType inputType,
+    std::string *out_error) {
+  pugi::xml_document xmlDoc;
+  pugi::xml_parse_result pugiParseResult;
+
+  switch (inputType) {
+    case XmlInputType::FILE: {
+      pugiParseResult = xmlDoc.load_file(xml);
+    } break;
+
+    case XmlInputType::CONTENT: {
+      pugiParseResult = xmlDoc.load_string(xml);
+    } break;
+
+    default: {
+      // TODO(Andrei): Log some kind of error
+      return false;
+    } break;
+  }
+
+  return ParseDocument(xmlDoc, pugiParseResult, out_open_drive_data, out_error, 0u);
+}
+
+bool OpenDriveParser::ParseInPlace(
+    char *xml,
+    size_t size,
+    carla::opendrive::types::OpenDriveData &out_open_drive_data,
+    std::string *out_error,
+    size_t number_of_threads) {
+  pugi::xml_document xmlDoc;
+  pugi::xml_parse_result pugiParseResult = xmlDoc.load_buffer_inplace(xml, size);
+  return ParseDocument(xmlDoc, pugiParseResult, out_open_drive_data, out_error, number_of_threads);
+}
+
+bool OpenDriveParser::ParseDocument(
+    const pugi::xml_document &xmlDoc,
+    const pugi::xml_parse_result &pugiParseResult,
+    carla::opendrive::types::OpenDriveData &out_open_drive_data,
+    std::string *out_error,
+    size_t number_of_threads) {
+  if (pugiParseResult == false) {
+    if (out_error != nullptr) {
+      *out_error = pugiParseResult.description();
+    }
+
+    return false;
+  }
+
+  // Find every road first, then parse them in parallel, each thread writes
+  // to its own range of roads. The document is only read.
+  std::vector<pugi::xml_node> roads;
+  for (pugi::xml_node road = xmlDoc.child("OpenDRIVE").child("road");
+      road;
+      road = road.next_sibling("road")) {
+    roads.emplace_back(road);
+  }
+
+  auto &out_roads = out_open_drive_data.roads;
+  const size_t first = out_roads.size();
+  out_roads.resize(first + roads.size());
+
+  auto parse = [&](const size_t begin, const size_t end) {
+    for (auto i = begin; i < end; ++i) {
+      ParseRoad(roads[i], out_roads[first + i]);
+    }
+  };
+
+  if (number_of_threads == 0u) {
+    number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  number_of_threads = std::min(number_of_threads, roads.size() / MIN_ROADS_PER_THREAD);
+  if (number_of_threads <= 1u) {
+    parse(0u, roads.size());
+  } else {
+    // Every thread, this one included, takes a contiguous chunk.
+    // An exception thrown by a thread is kept and rethrown here once every
+    // thread finished, as the serial parse would throw it.
+    const size_t chunk = (roads.size() + number_of_threads - 1u) / number_of_threads;
+    std::vector<std::exception_ptr> exceptions(number_of_threads);
+    carla::ThreadGroup workers;
+    for (size_t i = 1u; i < number_of_threads; ++i) {
+      workers.CreateThread([&parse, &roads, &exceptions, chunk, i]() {
+        try {
+          parse(i * chunk, std::min((i + 1u) * chunk, roads.size()));
+        } catch (...) {
+          exceptions[i] = std::current_exception();
+        }
+      });
+    }
+    try {
+      parse(0u, chunk);
+    } catch (...) {
+      exceptions[0u] = std::current_exception();
+    }
+    workers.JoinAll();
+    for (auto &exception : exceptions) {
+      if (exception != nullptr) {
+        std::rethrow_exception(exception);
+      }
+    }
+  }
+
+  for (pugi::xml_node junction = xmlDoc.child("OpenDRIVE").child("junction");
+      junction;
+      junction = junction.next_sibling("junction")) {
+    carla::opendrive::parser::JunctionParser::Parse(junction, out_open_drive_data.junctions);
+  }
+
+  return true;
+}
+
+void OpenDriveParser::ParseRoad(
+    const pugi::xml_node &road,
+    carla::opendrive::types::RoadInformation &openDriveRoadInformation) {
+  openDriveRoadInformation.attributes.name = road.attribute("name").value();
+  openDriveRoadInformation.attributes.id = std::atoi(road.attribute("id").value());
+  openDriveRoadInformation.attributes.length = std::stod(road.attribute("length").value());
+  openDriveRoadInformation.attributes.junction = std::atoi(road.attribute("junction").value());
+
+  ///////////////////////////////////////////////////////////////////////////////
+
+  carla::opendrive::parser::ProfilesParser::Parse(road, openDriveRoadInformation.road_profiles);
+
+  carla::opendrive::parser::RoadLinkParser::Parse(road.child("link"), openDriveRoadInformation.road_link);
+  carla::opendrive::parser::TrafficSignalsParser::Parse(road.child("signals"),
+      openDriveRoadInformation.trafic_signals);
+
+  carla::opendrive::parser::LaneParser::Parse(road.child("lanes"), openDriveRoadInformation.lanes);
+  carla::opendrive::parser::GeometryParser::Parse(road.child("planView"),
+      openDriveRoadInformation.geometry_attributes);
+}
@@ -28,64 +28,31 @@ struct OpenDriveParser {
       const char *xml,
       carla::opendrive::types::OpenDriveData &out_open_drive_data,
       XmlInputType inputType,
-      std::string *out_error = nullptr) {
-    pugi::xml_document xmlDoc;
-    pugi::xml_parse_result pugiParseResult;
-
-    switch (inputType) {
-      case XmlInputType::FILE: {
-        pugiParseResult = xmlDoc.load_file(xml);
-      } break;
-
-      case XmlInputType::CONTENT: {
-        pugiParseResult = xmlDoc.load_string(xml);
-      } break;
-
-      default: {
-        // TODO(Andrei): Log some kind of error
-        return false;
-      } break;
-    }
-
-    if (pugiParseResult == false) {
-      if (out_error != nullptr) {
-        *out_error = pugiParseResult.description();
-      }
-
-      return false;
-    }
-
-    for (pugi::xml_node road = xmlDoc.child("OpenDRIVE").child("road");
-        road;
-        road = road.next_sibling("road")) {
-      carla::opendrive::types::RoadInformation openDriveRoadInformation;
-
-      openDriveRoadInformation.attributes.name = road.attribute("name").value();
-      openDriveRoadInformation.attributes.id = std::atoi(road.attribute("id").value());
-      openDriveRoadInformation.attributes.length = std::stod(road.attribute("length").value());
-      openDriveRoadInformation.attributes.junction = std::atoi(road.attribute("junction").value());
-
-      ///////////////////////////////////////////////////////////////////////////////
-
-      carla::opendrive::parser::ProfilesParser::Parse(road, openDriveRoadInformation.road_profiles);
-
-      carla::opendrive::parser::RoadLinkParser::Parse(road.child("link"), openDriveRoadInformation.road_link);
-      carla::opendrive::parser::TrafficSignalsParser::Parse(road.child("signals"),
-          openDriveRoadInformation.trafic_signals);
-
-      carla::opendrive::parser::LaneParser::Parse(road.child("lanes"), openDriveRoadInformation.lanes);
-      carla::opendrive::parser::GeometryParser::Parse(road.child("planView"),
-          openDriveRoadInformation.geometry_attributes);
+      std::string *out_error = nullptr);
+
+  /// Parse the @a size bytes of OpenDRIVE in @a xml, using the buffer to
+  /// store the document instead of copying it. The contents of @a xml are
+  /// modified.
+  ///
+  /// The roads are parsed in parallel by up to @a number_of_threads, or by
+  /// as many threads as the hardware supports if zero.
+  static bool ParseInPlace(
+      char *xml,
+      size_t size,
+      carla::opendrive::types::OpenDriveData &out_open_drive_data,
+      std::string *out_error = nullptr,
+      size_t number_of_threads = 0u);
 
-      out_open_drive_data.roads.emplace_back(std::move(openDriveRoadInformation));
-    }
+private:
 
-    for (pugi::xml_node junction = xmlDoc.child("OpenDRIVE").child("junction");
-        junction;
-        junction = junction.next_sibling("junction")) {
-      carla::opendrive::parser::JunctionParser::Parse(junction, out_open_drive_data.junctions);
-    }
+  static bool ParseDocument(
+      const pugi::xml_document &xmlDoc,
+      const pugi::xml_parse_result &pugiParseResult,
+      carla::opendrive::types::OpenDriveData &out_open_drive_data,
+      std::string *out_error,
+      size_t number_of_threads);
 
-    return true;
-  }
+  static void ParseRoad(
+      const pugi::xml_node &road,
+      carla::opendrive::types::RoadInformation &out_road_information);
 };
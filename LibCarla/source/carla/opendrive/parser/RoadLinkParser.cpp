@@ -6,14 +6,16 @@
 
 #include "RoadLinkParser.h"
 
+#include "EnumParser.h"
+
 #include <cstdlib>
 
 void carla::opendrive::parser::RoadLinkParser::ParseLink(
     const pugi::xml_node &xmlNode,
     carla::opendrive::types::RoadLinkInformation *out_link_information) {
   out_link_information->id = std::atoi(xmlNode.attribute("elementId").value());
-  out_link_information->element_type = xmlNode.attribute("elementType").value();
-  out_link_information->contact_point = xmlNode.attribute("contactPoint").value();
+  out_link_information->element_type = EnumParser::ParseElementType(xmlNode.attribute("elementType").value());
+  out_link_information->contact_point = EnumParser::ParseContactPoint(xmlNode.attribute("contactPoint").value());
 }
 
 void carla::opendrive::parser::RoadLinkParser::Parse(
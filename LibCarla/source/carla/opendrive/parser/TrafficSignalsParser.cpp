@@ -6,6 +6,8 @@
 
 #include "TrafficSignalsParser.h"
 
+#include "EnumParser.h"
+
 void carla::opendrive::parser::TrafficSignalsParser::Parse(
     const pugi::xml_node &xmlNode,
     std::vector<carla::opendrive::types::TrafficSignalInformation> &out_traffic_signals) {
@@ -21,13 +23,22 @@ void carla::opendrive::parser::TrafficSignalsParser::Parse(
     trafficSignalInformation.value = std::stod(signal.attribute("value").value());
 
     trafficSignalInformation.name = signal.attribute("name").value();
-    trafficSignalInformation.dynamic = signal.attribute("dynamic").value();
-    trafficSignalInformation.orientation = signal.attribute("orientation").value();
+    trafficSignalInformation.dynamic = EnumParser::ParseBool(signal.attribute("dynamic").value());
+    trafficSignalInformation.orientation =
+        EnumParser::ParseSignalOrientation(signal.attribute("orientation").value());
 
     trafficSignalInformation.type = signal.attribute("type").value();
     trafficSignalInformation.subtype = signal.attribute("subtype").value();
     trafficSignalInformation.country = signal.attribute("country").value();
 
+    for (pugi::xml_node validity = signal.child("validity");
+         validity;
+         validity = validity.next_sibling("validity")) {
+      trafficSignalInformation.validity.emplace_back(
+          std::atoi(validity.attribute("fromLane").value()),
+          std::atoi(validity.attribute("toLane").value()));
+    }
+
     out_traffic_signals.emplace_back(trafficSignalInformation);
   }
 }
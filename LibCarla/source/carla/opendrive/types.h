@@ -6,8 +6,12 @@
 
 #pragma once
 
+#include "carla/road/element/LaneType.h"
+
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace carla {
@@ -47,10 +51,72 @@ namespace types {
 
   /////////////////////////////////////////////////////////////////
 
+  // Attributes with a small set of possible values are stored as enums
+  // instead of strings, see parser/EnumParser.h.
+
+  using LaneType = road::element::LaneType;
+
+  enum class RoadMarkType : uint8_t {
+    None,
+    Solid,
+    Broken,
+    SolidSolid,
+    SolidBroken,
+    BrokenSolid,
+    BrokenBroken,
+    BottsDots,
+    Grass,
+    Curb,
+    Unknown
+  };
+
+  enum class RoadMarkWeight : uint8_t {
+    Standard,
+    Bold,
+    Unknown
+  };
+
+  enum class RoadMarkColor : uint8_t {
+    Standard,
+    Blue,
+    Green,
+    Red,
+    White,
+    Yellow,
+    Unknown
+  };
+
+  enum class LaneChange : uint8_t {
+    Increase,
+    Decrease,
+    Both,
+    None,
+    Unknown
+  };
+
+  enum class ElementType : uint8_t {
+    Road,
+    Junction,
+    Unknown
+  };
+
+  enum class ContactPoint : uint8_t {
+    Start,
+    End,
+    Unknown
+  };
+
+  enum class SignalOrientation : uint8_t {
+    Positive,                               // "+"
+    Negative,                               // "-"
+    Both,                                   // "none"
+    Unknown
+  };
+
   struct LaneAttributes {
     int id;
-    std::string type;
-    std::string level;
+    LaneType type;
+    bool level;
   };
 
   struct LaneWidth {
@@ -66,11 +132,11 @@ namespace types {
     double soffset;
     double width;
 
-    std::string type;
-    std::string weigth;
+    RoadMarkType type;
+    RoadMarkWeight weigth;
 
-    std::string color;
-    std::string lange_change;
+    RoadMarkColor color;
+    LaneChange lange_change;
   };
 
   struct LaneOffset {
@@ -147,10 +213,10 @@ namespace types {
 
     std::string name;                       // name of the signal (e.g. gfx bead
                                             // name)
-    std::string dynamic;                    // boolean identification whether
+    bool dynamic;                           // boolean identification whether
                                             // signal is a dynamic
                                             // signal(e.g.traffic light)
-    std::string orientation;                // "+" = valid in positive track
+    SignalOrientation orientation;          // "+" = valid in positive track
                                             // direction; "-" = valid in
                                             // negative track direction; "none"
                                             // = valid in both directions
@@ -160,6 +226,9 @@ namespace types {
                                             // country code or "-1" / "none"
     std::string subtype;                    // subtype identifier according to
                                             // country code or "-1" / "none"
+
+    std::vector<std::pair<int, int>> validity; // fromLane and toLane of each
+                                               // validity record
   };
 
   /////////////////////////////////////////////////////////////////
@@ -176,10 +245,12 @@ namespace types {
 
   struct RoadLinkInformation {
     int id;
-    std::string element_type;
-    std::string contact_point;
+    ElementType element_type;
+    ContactPoint contact_point;
 
-    RoadLinkInformation() : id(-1) {}
+    RoadLinkInformation() : id(-1),
+                            element_type(ElementType::Unknown),
+                            contact_point(ContactPoint::Unknown) {}
   };
 
   struct RoadLink {
@@ -211,11 +282,12 @@ namespace types {
     int id;
     int incoming_road;
     int connecting_road;
-    std::string contact_point;
+    ContactPoint contact_point;
 
     JunctionConnectionAttributes() : id(-1),
                                      incoming_road(-1),
-                                     connecting_road(-1) {}
+                                     connecting_road(-1),
+                                     contact_point(ContactPoint::Unknown) {}
   };
 
   struct JunctionLaneLink {
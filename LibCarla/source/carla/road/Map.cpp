@@ -6,13 +6,20 @@
 
 #include "carla/road/Map.h"
 
+#include "carla/WorkerPool.h"
 #include "carla/road/element/LaneCrossingCalculator.h"
 
+#include <algorithm>
+
 namespace carla {
 namespace road {
 
   using namespace element;
 
+  /// Minimum number of locations per thread in GetWaypoints, fewer don't pay
+  /// off the cost of waking up a thread.
+  static constexpr size_t MIN_LOCATIONS_PER_THREAD = 256u;
+
   Waypoint Map::GetClosestWaypointOnRoad(const geom::Location &loc) const {
     return Waypoint(shared_from_this(), loc);
   }
@@ -29,12 +36,56 @@ namespace road {
     return Optional<Waypoint>();
   }
 
+  std::vector<WaypointInfo> Map::GetWaypoints(
+      const std::vector<geom::Location> &locations,
+      const bool project_to_road) const {
+    std::vector<WaypointInfo> result(locations.size());
+
+    auto project = [&](const size_t begin, const size_t end) {
+      for (auto i = begin; i < end; ++i) {
+        const auto waypoint = project_to_road ?
+            Optional<Waypoint>(GetClosestWaypointOnRoad(locations[i])) :
+            GetWaypoint(locations[i]);
+        if (waypoint.has_value()) {
+          auto &info = result[i];
+          info.road_id = static_cast<uint32_t>(waypoint->GetRoadId());
+          info.lane_id = waypoint->GetLaneId();
+          info.s = waypoint->GetDistance();
+          info.transform = waypoint->ComputeTransform();
+          info.is_valid = true;
+        }
+      }
+    };
+
+    auto &workers = WorkerPool::GetShared();
+    const size_t number_of_threads = std::min<size_t>(
+        workers.size(),
+        locations.size() / MIN_LOCATIONS_PER_THREAD);
+    if (number_of_threads <= 1u) {
+      project(0u, locations.size());
+      return result;
+    }
+    // Every thread, this one included, takes a contiguous chunk.
+    const size_t chunk = (locations.size() + number_of_threads - 1u) / number_of_threads;
+    workers.ParallelFor(number_of_threads, [&project, &locations, chunk](size_t i) {
+      project(i * chunk, std::min((i + 1u) * chunk, locations.size()));
+    });
+    return result;
+  }
+
   std::vector<element::LaneMarking> Map::CalculateCrossedLanes(
       const geom::Location &origin,
       const geom::Location &destination) const {
     return element::LaneCrossingCalculator::Calculate(*this, origin, destination);
   }
 
+  void Map::CalculateCrossedLanes(
+      element::LaneCrossingTracker &tracker,
+      const geom::Location &destination,
+      std::vector<element::LaneMarking> &out) const {
+    tracker.Move(*this, destination, out);
+  }
+
   const MapData &Map::GetData() const {
     return _data;
   }
@@ -10,8 +10,10 @@
 #include "carla/NonCopyable.h"
 #include "carla/Optional.h"
 #include "carla/road/MapData.h"
+#include "carla/road/element/LaneCrossingCalculator.h"
 #include "carla/road/element/LaneMarking.h"
 #include "carla/road/element/Waypoint.h"
+#include "carla/road/element/WaypointInfo.h"
 
 #include <vector>
 
@@ -31,10 +33,24 @@ namespace road {
 
     Optional<element::Waypoint> GetWaypoint(const geom::Location &) const;
 
+    /// Query the waypoint of every location in @a locations, as
+    /// GetClosestWaypointOnRoad if @a project_to_road, as GetWaypoint
+    /// otherwise. Big batches are split among the threads of the shared
+    /// WorkerPool.
+    std::vector<element::WaypointInfo> GetWaypoints(
+        const std::vector<geom::Location> &locations,
+        bool project_to_road = true) const;
+
     std::vector<element::LaneMarking> CalculateCrossedLanes(
         const geom::Location &origin,
         const geom::Location &destination) const;
 
+    /// Incremental version of the above, see element::LaneCrossingTracker.
+    void CalculateCrossedLanes(
+        element::LaneCrossingTracker &tracker,
+        const geom::Location &destination,
+        std::vector<element::LaneMarking> &out) const;
+
     const MapData &GetData() const;
 
   private:
@@ -7,6 +7,9 @@
 #include "carla/road/MapBuilder.h"
 #include "carla/road/element/RoadInfoVisitor.h"
 
+#include <algorithm>
+#include <tuple>
+
 using namespace carla::road::element;
 
 namespace carla {
@@ -18,17 +21,29 @@ namespace road {
   }
 
   SharedPtr<Map> MapBuilder::Build() {
-    // Move the RoadSegmentDefinitions needed information to a RoadSegments
+    // Move the RoadSegmentDefinitions needed information to a RoadSegments,
+    // _temp_sections is sorted by id so are the segments.
+    _map_data._elements.reserve(_temp_sections.size());
     for (auto &&id_seg : _temp_sections) {
-      MakeElement<RoadSegment>(id_seg.first, std::move(id_seg.second));
+      _map_data._elements.emplace_back(std::move(id_seg.second));
     }
 
     SetTotalRoadSegmentLength();
 
+    BakeArcLengthTables();
+
+    BakeProfileTables();
+
     CreatePointersBetweenRoadSegments();
 
     ComputeLaneCenterOffset();
 
+    BuildSignalIndex();
+
+    // The road segments are not modified after this point, the index keeps
+    // pointers to them.
+    _map_data._spatial_index.Build(_map_data);
+
     // _map_data is a memeber of MapBuilder so you must especify if
     // you want to keep it (will return copy -> Map(const Map &))
     // or move it (will return move -> Map(Map &&))
@@ -36,70 +51,136 @@ namespace road {
   }
 
   void MapBuilder::SetTotalRoadSegmentLength() {
-    for (auto &&id_seg : _map_data._elements) {
+    for (auto &&road_seg : _map_data._elements) {
       double total_length = 0.0;
-      for (auto &&geom : id_seg.second.get()->_geom) {
-        total_length += geom.get()->GetLength();
+      for (auto &&geom : road_seg._geometries) {
+        total_length += geom.GetLength();
       }
-      id_seg.second.get()->_length = total_length;
+      road_seg._length = total_length;
+    }
+  }
+
+  void MapBuilder::BakeArcLengthTables() {
+    for (auto &&road_seg : _map_data._elements) {
+      road_seg._arc_length_table.Build(road_seg._geometries, _arc_length_table_tolerance);
+    }
+  }
+
+  void MapBuilder::BakeProfileTables() {
+    for (auto &&road_seg : _map_data._elements) {
+      road_seg._elevation.Bake(road_seg._length, _profile_table_tolerance);
+      road_seg._superelevation.Bake(road_seg._length, _profile_table_tolerance);
     }
   }
 
   void MapBuilder::CreatePointersBetweenRoadSegments() {
+    auto &elements = _map_data._elements;
     for (auto &&id_seg : _temp_sections) {
-      for (auto &t : id_seg.second.GetPredecessorID()) {
-        _map_data._elements[id_seg.first]->PredEmplaceBack(_map_data._elements[t].get());
+      RoadSegment *road_seg = MapData::FindRoad(elements, id_seg.first);
+      DEBUG_ASSERT(road_seg != nullptr);
+      // Links to roads missing in the map are dropped, with their contact
+      // point.
+      const auto &predecessors = id_seg.second.GetPredecessorID();
+      const auto &predecessors_is_start = id_seg.second.GetPredecessorIsStart();
+      for (auto i = 0u; i < predecessors.size(); ++i) {
+        RoadSegment *predecessor = MapData::FindRoad(elements, predecessors[i]);
+        if (predecessor != nullptr) {
+          road_seg->PredEmplaceBack(predecessor, predecessors_is_start[i]);
+        }
       }
-      for (auto &t : id_seg.second.GetSuccessorID()) {
-        _map_data._elements[id_seg.first]->SuccEmplaceBack(_map_data._elements[t].get());
+      const auto &successors = id_seg.second.GetSuccessorID();
+      const auto &successors_is_start = id_seg.second.GetSuccessorIsStart();
+      for (auto i = 0u; i < successors.size(); ++i) {
+        RoadSegment *successor = MapData::FindRoad(elements, successors[i]);
+        if (successor != nullptr) {
+          road_seg->SuccEmplaceBack(successor, successors_is_start[i]);
+        }
       }
     }
   }
 
   void MapBuilder::ComputeLaneCenterOffset() {
-    for (auto &&element : _map_data._elements) {
-      RoadSegment *road_seg = element.second.get();
+    for (auto &&road_seg : _map_data._elements) {
 
-      // get all the RoadGeneralInfo given the type and a distance 0.0
-      auto up_bound_g = decltype(road_seg->_info)::reverse_iterator(road_seg->_info.upper_bound(0.0));
-      auto general_info = MakeRoadInfoIterator<RoadGeneralInfo>(up_bound_g, road_seg->_info.rend());
+      // get the RoadGeneralInfo given the type and a distance 0.0
+      RoadGeneralInfo *general_info = road_seg.FindInfo<RoadGeneralInfo>(0.0);
 
-      // get all the RoadInfoLane given the type and a distance 0.0
-      auto up_bound_l = decltype(road_seg->_info)::reverse_iterator(road_seg->_info.upper_bound(0.0));
-      auto lane_info = MakeRoadInfoIterator<RoadInfoLane>(up_bound_l, road_seg->_info.rend());
+      // get the RoadInfoLane given the type and a distance 0.0
+      RoadInfoLane *lane_info = road_seg.FindInfo<RoadInfoLane>(0.0);
 
       // check that have a RoadGeneralInfo
-      if (!lane_info.IsAtEnd()) {
+      if (lane_info != nullptr) {
 
         double lane_offset = 0.0;
-        if (!general_info.IsAtEnd()) {
-          lane_offset = (*general_info)->GetLanesOffset().at(0).second;
+        if (general_info != nullptr) {
+          lane_offset = general_info->GetLanesOffset().at(0).second;
         }
 
         double current_width = lane_offset;
 
         for (auto &&current_lane_id :
-            (*lane_info)->getLanesIDs(element::RoadInfoLane::which_lane_e::Left)) {
-          const double half_width = (*lane_info)->getLane(current_lane_id)->_width * 0.5;
+            lane_info->getLanesIDs(element::RoadInfoLane::which_lane_e::Left)) {
+          const double half_width = lane_info->getLane(current_lane_id)->_width * 0.5;
 
           current_width += half_width;
-          (*lane_info)->_lanes[current_lane_id]._lane_center_offset = current_width;
+          lane_info->_lanes[current_lane_id]._lane_center_offset = current_width;
           current_width += half_width;
         }
 
         current_width = lane_offset;
 
         for (auto &&current_lane_id :
-            (*lane_info)->getLanesIDs(element::RoadInfoLane::which_lane_e::Right)) {
-          const double half_width = (*lane_info)->getLane(current_lane_id)->_width * 0.5;
+            lane_info->getLanesIDs(element::RoadInfoLane::which_lane_e::Right)) {
+          const double half_width = lane_info->getLane(current_lane_id)->_width * 0.5;
 
           current_width -= half_width;
-          (*lane_info)->_lanes[current_lane_id]._lane_center_offset = current_width;
+          lane_info->_lanes[current_lane_id]._lane_center_offset = current_width;
           current_width -= half_width;
         }
       }
     }
   }
 
+  void MapBuilder::BuildSignalIndex() {
+    auto &signals = _map_data._signals;
+    std::stable_sort(signals.begin(), signals.end(), [](const Signal &lhs, const Signal &rhs) {
+      return std::tie(lhs.road_id, lhs.s) < std::tie(rhs.road_id, rhs.s);
+    });
+
+    // Signals on roads missing in the map are not indexed.
+    std::vector<std::pair<uint64_t, MapData::LaneSignal>> entries;
+    for (uint32_t i = 0u; i < signals.size(); ++i) {
+      const auto &signal = signals[i];
+      const auto *road = _map_data.GetRoad(signal.road_id);
+      const auto *lanes = road != nullptr ? road->GetInfo<RoadInfoLane>(signal.s) : nullptr;
+      if (lanes == nullptr) {
+        continue;
+      }
+      for (auto &&lane : lanes->GetLanes()) {
+        if ((lane._type == LaneType::Driving) && signal.IsValidFor(lane._id)) {
+          entries.emplace_back(
+              MapData::MakeLaneKey(signal.road_id, lane._id),
+              MapData::LaneSignal{signal.s, i});
+        }
+      }
+    }
+    // Signals are already sorted by s within each road.
+    std::stable_sort(entries.begin(), entries.end(), [](const auto &lhs, const auto &rhs) {
+      return lhs.first < rhs.first;
+    });
+
+    auto &lane_signals = _map_data._lane_signals;
+    auto &ranges = _map_data._lane_signal_ranges;
+    lane_signals.clear();
+    ranges.clear();
+    lane_signals.reserve(entries.size());
+    for (auto &&entry : entries) {
+      const auto index = static_cast<uint32_t>(lane_signals.size());
+      auto result = ranges.emplace(entry.first, std::make_pair(index, index));
+      ++result.first->second.second;
+      lane_signals.emplace_back(entry.second);
+    }
+  }
+
 } // namespace road
 } // namespace carla
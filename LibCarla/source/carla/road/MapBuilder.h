@@ -23,18 +23,29 @@ namespace road {
       _map_data.SetJunctionInformation(junctionInfo);
     }
 
-    SharedPtr<Map> Build();
+    void AddSignal(element::Signal signal) {
+      _map_data._signals.emplace_back(std::move(signal));
+    }
 
-  private:
+    /// Bake a table of samples of the geometries of each road segment, with
+    /// positions within @a tolerance meters and headings within @a tolerance
+    /// radians of the geometries. A tolerance of zero disables the tables.
+    void SetArcLengthTableTolerance(double tolerance) {
+      _arc_length_table_tolerance = tolerance;
+    }
 
-    template <typename T, typename ... Args>
-    T &MakeElement(element::id_type id, Args && ... args) {
-      auto inst = std::make_unique<T>(std::forward<Args>(args) ...);
-      T &r = *inst;
-      _map_data._elements.emplace(id, std::move(inst));
-      return r;
+    /// Bake a table of samples of the elevation and superelevation profiles
+    /// of each road segment, with elevations within @a tolerance meters and
+    /// superelevations within @a tolerance radians of the profiles. A
+    /// tolerance of zero disables the tables.
+    void SetProfileTableTolerance(double tolerance) {
+      _profile_table_tolerance = tolerance;
     }
 
+    SharedPtr<Map> Build();
+
+  private:
+
     /// Set the total length of each road based on the geometries
     void SetTotalRoadSegmentLength();
 
@@ -44,9 +55,20 @@ namespace road {
     /// Set the _lane_center_offset of all the lanes
     void ComputeLaneCenterOffset();
 
+    /// Sample the geometries of each road segment into its ArcLengthTable
+    void BakeArcLengthTables();
+
+    /// Sample the profiles of each road segment, see CubicProfile::Bake
+    void BakeProfileTables();
+
+    /// Sort the signals and index them by the lanes they are valid for
+    void BuildSignalIndex();
+
   private:
 
     MapData _map_data;
+    double _arc_length_table_tolerance = 0.01;
+    double _profile_table_tolerance = 0.01;
     std::map<element::id_type, element::RoadSegmentDefinition> _temp_sections;
   };
 
@@ -0,0 +1,37 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/MapData.h"
+
+namespace carla {
+namespace road {
+
+  const element::Signal *MapData::GetNextSignal(
+      const element::id_type road_id,
+      const int lane_id,
+      const double s) const {
+    auto it = _lane_signal_ranges.find(MakeLaneKey(road_id, lane_id));
+    if (it == _lane_signal_ranges.end()) {
+      return nullptr;
+    }
+    const auto begin = _lane_signals.begin() + it->second.first;
+    const auto end = _lane_signals.begin() + it->second.second;
+    if (lane_id < 0) {
+      // Driving forward, first signal at or after s.
+      auto next = std::lower_bound(begin, end, s, [](const LaneSignal &signal, double value) {
+        return signal.s < value;
+      });
+      return next != end ? &_signals[next->signal] : nullptr;
+    }
+    // Driving backward, last signal at or before s.
+    auto next = std::upper_bound(begin, end, s, [](double value, const LaneSignal &signal) {
+      return value < signal.s;
+    });
+    return next != begin ? &_signals[std::prev(next)->signal] : nullptr;
+  }
+
+} // namespace road
+} // namespace carla
@@ -6,14 +6,18 @@
 
 #pragma once
 
-#include "carla/Iterator.h"
 #include "carla/ListView.h"
 #include "carla/NonCopyable.h"
+#include "carla/road/SpatialIndex.h"
 #include "carla/road/element/RoadSegment.h"
+#include "carla/road/element/Signal.h"
 
 #include <boost/iterator/transform_iterator.hpp>
 
+#include <algorithm>
+#include <cstdint>
 #include <unordered_map>
+#include <vector>
 
 namespace carla {
 namespace road {
@@ -34,30 +38,52 @@ namespace road {
   public:
 
     const element::RoadSegment *GetRoad(element::id_type id) const {
-      auto it = _elements.find(id);
-      return it != _elements.end() ? it->second.get() : nullptr;
+      return FindRoad(_elements, id);
     }
 
     auto GetAllIds() const {
+      auto get = [](const element::RoadSegment &road) { return road.GetId(); };
       return MakeListView(
-          iterator::make_map_keys_iterator(_elements.begin()),
-          iterator::make_map_keys_iterator(_elements.end()));
+          boost::make_transform_iterator(_elements.begin(), get),
+          boost::make_transform_iterator(_elements.end(), get));
     }
 
     size_t GetRoadCount() const {
       return _elements.size();
     }
 
+    /// Connections of every junction, sorted by junction id.
     const std::vector<lane_junction_t> &GetJunctionInformation() const {
       return _junction_information;
     }
 
+    /// Connections of the junction with @a junction_id.
+    auto GetJunctionConnections(const int junction_id) const {
+      auto range = std::equal_range(
+          _junction_information.begin(),
+          _junction_information.end(),
+          junction_id,
+          JunctionIdLess());
+      return MakeListView(range.first, range.second);
+    }
+
+    /// Signals sorted by road and distance along the road.
+    const std::vector<element::Signal> &GetSignals() const {
+      return _signals;
+    }
+
+    /// The signal governing lane @a lane_id of road @a road_id at @a s; i.e.,
+    /// the first signal valid for the lane found driving from @a s to the
+    /// end of the road. Returns nullptr if there is none.
+    const element::Signal *GetNextSignal(element::id_type road_id, int lane_id, double s) const;
+
+    /// Road segments sorted by id.
     auto GetRoadSegments() const {
-      using const_ref = const element::RoadSegment &;
-      auto get = [](auto &pair) -> const_ref { return *pair.second; };
-      return MakeListView(
-          boost::make_transform_iterator(_elements.begin(), get),
-          boost::make_transform_iterator(_elements.end(), get));
+      return MakeListView(_elements.cbegin(), _elements.cend());
+    }
+
+    const SpatialIndex &GetSpatialIndex() const {
+      return _spatial_index;
     }
 
   private:
@@ -68,13 +94,65 @@ namespace road {
 
     void SetJunctionInformation(const std::vector<lane_junction_t> &junctionInfo) {
       _junction_information = junctionInfo;
+      std::stable_sort(
+          _junction_information.begin(),
+          _junction_information.end(),
+          JunctionIdLess());
+    }
+
+    struct JunctionIdLess {
+      bool operator()(const lane_junction_t &lhs, const lane_junction_t &rhs) const {
+        return lhs.junction_id < rhs.junction_id;
+      }
+      bool operator()(const lane_junction_t &lhs, int rhs) const {
+        return lhs.junction_id < rhs;
+      }
+      bool operator()(int lhs, const lane_junction_t &rhs) const {
+        return lhs < rhs.junction_id;
+      }
+    };
+
+    static uint64_t MakeLaneKey(element::id_type road_id, int lane_id) {
+      return (static_cast<uint64_t>(road_id) << 32u) | static_cast<uint32_t>(lane_id);
+    }
+
+    /// A signal valid for a lane.
+    struct LaneSignal {
+      double s;
+      uint32_t signal;
+    };
+
+    /// Road segment with @a id in @a elements, or nullptr if there is none.
+    template <typename RoadSegments>
+    static auto FindRoad(RoadSegments &elements, element::id_type id)
+        -> decltype(&elements.front()) {
+      using pointer = decltype(&elements.front());
+      // Ids are usually consecutive, try first the segment at index id.
+      if ((id < elements.size()) && (elements[id].GetId() == id)) {
+        return &elements[id];
+      }
+      auto it = std::lower_bound(elements.begin(), elements.end(), id,
+          [](const element::RoadSegment &road, element::id_type i) {
+            return road.GetId() < i;
+          });
+      return ((it != elements.end()) && (it->GetId() == id)) ? &*it : pointer(nullptr);
     }
 
     std::vector<lane_junction_t> _junction_information;
 
-    std::unordered_map<
-        element::id_type,
-        std::unique_ptr<element::RoadSegment>> _elements;
+    std::vector<element::Signal> _signals;
+
+    /// Signals of each lane sorted by s, each lane a contiguous range.
+    std::vector<LaneSignal> _lane_signals;
+
+    /// Range of each lane in _lane_signals, keyed by MakeLaneKey.
+    std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>> _lane_signal_ranges;
+
+    /// Sorted by id. The segments point to each other, they cannot move once
+    /// the map is built.
+    std::vector<element::RoadSegment> _elements;
+
+    SpatialIndex _spatial_index;
   };
 
 } // namespace road
@@ -0,0 +1,581 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/MapSerializer.h"
+
+#include "carla/Debug.h"
+#include "carla/road/MapBuilder.h"
+#include "carla/road/element/RoadInfoVisitor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace carla {
+namespace road {
+
+  using namespace element;
+
+  static constexpr char MAGIC[8u] = {'C', 'A', 'R', 'L', 'A', 'M', 'A', 'P'};
+
+  /// Written as is, reads differently on machines with another byte order.
+  static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304u;
+
+#pragma pack(push, 1)
+  struct MapHeader {
+    char magic[8u];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t key;
+    uint64_t payload_size;
+    uint64_t payload_hash;
+  };
+#pragma pack(pop)
+
+  enum class InfoType : uint8_t {
+    General,
+    Velocity,
+    Lane
+  };
+
+  /// 64-bit FNV-1a.
+  static uint64_t HashBytes(const unsigned char *data, const size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0u; i < size; ++i) {
+      hash ^= data[i];
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+
+namespace detail {
+
+  class MapWriter : private RoadInfoVisitor {
+  public:
+
+    template <typename T>
+    void Write(const T &value) {
+      static_assert(std::is_arithmetic<T>::value, "Only numbers are written as is.");
+      const auto *data = reinterpret_cast<const unsigned char *>(&value);
+      _data.insert(_data.end(), data, data + sizeof(T));
+    }
+
+    void WriteSize(const size_t size) {
+      DEBUG_ASSERT(size <= std::numeric_limits<uint32_t>::max());
+      Write(static_cast<uint32_t>(size));
+    }
+
+    void Write(const std::string &str) {
+      WriteSize(str.size());
+      _data.insert(_data.end(), str.begin(), str.end());
+    }
+
+    void Write(const std::vector<bool> &vector) {
+      WriteSize(vector.size());
+      for (bool item : vector) {
+        Write<uint8_t>(item ? 1u : 0u);
+      }
+    }
+
+    void Write(const LaneLinkTable &lanes) {
+      WriteSize(lanes.size());
+      lanes.ForEach([this](int lane_id, LaneLinkTable::view_type links) {
+        Write<int32_t>(lane_id);
+        WriteSize(static_cast<size_t>(links.size()));
+        for (auto &&next : links) {
+          Write<int32_t>(next.first);
+          Write<int32_t>(next.second);
+        }
+      });
+    }
+
+    void Write(const GeometryRecord &geometry) {
+      Write<uint8_t>(static_cast<uint8_t>(geometry.GetType()));
+      Write(geometry.GetStartOffset());
+      Write(geometry.GetLength());
+      Write(geometry.GetHeading());
+      Write(geometry.GetStartPosition().x);
+      Write(geometry.GetStartPosition().y);
+      Write(geometry.GetStartPosition().z);
+      switch (geometry.GetType()) {
+        case GeometryType::LINE:
+          break;
+        case GeometryType::ARC:
+          Write(geometry.GetCurvature());
+          break;
+        case GeometryType::SPIRAL: {
+          const auto &spiral = geometry.GetSpiral();
+          Write(spiral.GetCurveStart());
+          Write(spiral.GetCurveEnd());
+          break;
+        }
+      }
+    }
+
+    void Write(RoadInfo &info) {
+      info.AcceptVisitor(*this);
+    }
+
+    void Write(const CubicProfile &profile) {
+      const auto &records = profile.GetRecords();
+      WriteSize(records.size());
+      for (auto &&record : records) {
+        Write(record.s);
+        Write(record.a);
+        Write(record.b);
+        Write(record.c);
+        Write(record.d);
+      }
+    }
+
+    void Write(const lane_junction_t &junction) {
+      Write(junction.contact_point);
+      Write<int32_t>(junction.junction_id);
+      Write<int32_t>(junction.connection_road);
+      Write<int32_t>(junction.incomming_road);
+      WriteSize(junction.from_lane.size());
+      for (auto lane : junction.from_lane) {
+        Write<int32_t>(lane);
+      }
+      WriteSize(junction.to_lane.size());
+      for (auto lane : junction.to_lane) {
+        Write<int32_t>(lane);
+      }
+    }
+
+    void Write(const Signal &signal) {
+      Write<int32_t>(signal.id);
+      Write<uint64_t>(signal.road_id);
+      Write(signal.s);
+      Write(signal.t);
+      Write(signal.zoffset);
+      Write(signal.value);
+      Write(signal.name);
+      Write<uint8_t>(signal.is_dynamic ? 1u : 0u);
+      Write<uint8_t>(static_cast<uint8_t>(signal.orientation));
+      Write(signal.country);
+      Write(signal.type);
+      Write(signal.subtype);
+      WriteSize(signal.validity.size());
+      for (auto &&range : signal.validity) {
+        Write<int32_t>(range.first);
+        Write<int32_t>(range.second);
+      }
+    }
+
+    std::vector<unsigned char> &data() {
+      return _data;
+    }
+
+  private:
+
+    void Visit(RoadGeneralInfo &info) final {
+      Write<uint8_t>(static_cast<uint8_t>(InfoType::General));
+      Write(info.d);
+      Write<int32_t>(info.GetJunctionId());
+      const auto offsets = info.GetLanesOffset();
+      WriteSize(offsets.size());
+      for (auto &&offset : offsets) {
+        Write(offset.first);
+        Write(offset.second);
+      }
+    }
+
+    void Visit(RoadInfoVelocity &info) final {
+      Write<uint8_t>(static_cast<uint8_t>(InfoType::Velocity));
+      Write(info.d);
+      Write(info.velocity);
+    }
+
+    void Visit(RoadInfoLane &info) final {
+      Write<uint8_t>(static_cast<uint8_t>(InfoType::Lane));
+      Write(info.d);
+      const auto ids = info.getLanesIDs();
+      WriteSize(ids.size());
+      for (auto id : ids) {
+        const auto *lane = info.getLane(id);
+        DEBUG_ASSERT(lane != nullptr);
+        Write<int32_t>(lane->_id);
+        Write(lane->_width);
+        Write<uint8_t>(static_cast<uint8_t>(lane->_type));
+      }
+    }
+
+    std::vector<unsigned char> _data;
+  };
+
+  /// Reads the values written by MapWriter. On any error the reader fails,
+  /// and every read after that returns a default value.
+  class MapReader {
+  public:
+
+    MapReader(const unsigned char *begin, const unsigned char *end)
+      : _it(begin),
+        _end(end) {}
+
+    bool failed() const {
+      return _failed;
+    }
+
+    template <typename T>
+    T Read() {
+      static_assert(std::is_arithmetic<T>::value, "Only numbers are read as is.");
+      T value{};
+      if (!Require(sizeof(T))) {
+        return value;
+      }
+      std::memcpy(&value, _it, sizeof(T));
+      _it += sizeof(T);
+      return value;
+    }
+
+    /// Read a number of elements, at least @a min_element_size bytes each, so
+    /// that a corrupt size cannot make us allocate more than the binary.
+    size_t ReadSize(const size_t min_element_size = 1u) {
+      const size_t size = Read<uint32_t>();
+      return Require(size * min_element_size) ? size : 0u;
+    }
+
+    std::string ReadString() {
+      const auto size = ReadSize();
+      std::string str(reinterpret_cast<const char *>(_it), size);
+      _it += size;
+      return str;
+    }
+
+    std::vector<bool> ReadBools() {
+      std::vector<bool> result(ReadSize());
+      for (auto i = 0u; i < result.size(); ++i) {
+        result[i] = (Read<uint8_t>() != 0u);
+      }
+      return result;
+    }
+
+    std::vector<int> ReadInts() {
+      std::vector<int> result(ReadSize(sizeof(int32_t)));
+      for (auto &item : result) {
+        item = Read<int32_t>();
+      }
+      return result;
+    }
+
+    void Fail() {
+      _failed = true;
+      _it = _end;
+    }
+
+  private:
+
+    bool Require(const size_t size) {
+      if (_failed || (static_cast<size_t>(_end - _it) < size)) {
+        Fail();
+        return false;
+      }
+      return true;
+    }
+
+    const unsigned char *_it;
+
+    const unsigned char *_end;
+
+    bool _failed = false;
+  };
+
+} // namespace detail
+
+  static void ReadGeometry(detail::MapReader &reader, RoadSegmentDefinition &def) {
+    const auto type = reader.Read<uint8_t>();
+    const auto start_offset = reader.Read<double>();
+    const auto length = reader.Read<double>();
+    const auto heading = reader.Read<double>();
+    geom::Location start_position;
+    start_position.x = reader.Read<decltype(start_position.x)>();
+    start_position.y = reader.Read<decltype(start_position.y)>();
+    start_position.z = reader.Read<decltype(start_position.z)>();
+    if (reader.failed()) {
+      return;
+    }
+    switch (static_cast<GeometryType>(type)) {
+      case GeometryType::LINE:
+        def.MakeGeometry<GeometryLine>(start_offset, length, heading, start_position);
+        break;
+      case GeometryType::ARC: {
+        const auto curvature = reader.Read<double>();
+        def.MakeGeometry<GeometryArc>(start_offset, length, heading, start_position, curvature);
+        break;
+      }
+      case GeometryType::SPIRAL: {
+        const auto curve_start = reader.Read<double>();
+        const auto curve_end = reader.Read<double>();
+        def.MakeGeometry<GeometrySpiral>(
+            start_offset,
+            length,
+            heading,
+            start_position,
+            curve_start,
+            curve_end);
+        break;
+      }
+      default:
+        reader.Fail();
+    }
+  }
+
+  static void ReadInfo(detail::MapReader &reader, RoadSegmentDefinition &def) {
+    const auto type = reader.Read<uint8_t>();
+    const auto d = reader.Read<double>();
+    switch (static_cast<InfoType>(type)) {
+      case InfoType::General: {
+        auto *info = def.MakeInfo<RoadGeneralInfo>();
+        info->d = d;
+        info->SetJunctionId(reader.Read<int32_t>());
+        const auto count = reader.ReadSize(2u * sizeof(double));
+        for (auto i = 0u; i < count; ++i) {
+          const auto offset = reader.Read<double>();
+          info->SetLanesOffset(offset, reader.Read<double>());
+        }
+        break;
+      }
+      case InfoType::Velocity:
+        def.MakeInfo<RoadInfoVelocity>(d, reader.Read<double>());
+        break;
+      case InfoType::Lane: {
+        auto *info = def.MakeInfo<RoadInfoLane>();
+        info->d = d;
+        const auto count = reader.ReadSize(sizeof(int32_t) + sizeof(double));
+        for (auto i = 0u; i < count; ++i) {
+          const auto id = reader.Read<int32_t>();
+          const auto width = reader.Read<double>();
+          const auto type = reader.Read<uint8_t>();
+          if (type > static_cast<uint8_t>(LaneType::Unknown)) {
+            reader.Fail();
+          }
+          info->addLaneInfo(id, width, static_cast<LaneType>(type));
+        }
+        break;
+      }
+      default:
+        reader.Fail();
+    }
+  }
+
+  template <typename AddRecord>
+  static void ReadProfile(detail::MapReader &reader, AddRecord &&add) {
+    const auto count = reader.ReadSize(5u * sizeof(double));
+    for (auto i = 0u; i < count; ++i) {
+      CubicProfile::Record record;
+      record.s = reader.Read<double>();
+      record.a = reader.Read<double>();
+      record.b = reader.Read<double>();
+      record.c = reader.Read<double>();
+      record.d = reader.Read<double>();
+      add(record);
+    }
+  }
+
+  template <typename AddLaneInfo>
+  static void ReadLaneLinks(detail::MapReader &reader, AddLaneInfo &&add) {
+    const auto count = reader.ReadSize(sizeof(int32_t));
+    for (auto i = 0u; i < count; ++i) {
+      const auto lane_id = reader.Read<int32_t>();
+      const auto links = reader.ReadSize(2u * sizeof(int32_t));
+      for (auto j = 0u; j < links; ++j) {
+        const auto next_lane_id = reader.Read<int32_t>();
+        add(lane_id, next_lane_id, reader.Read<int32_t>());
+      }
+    }
+  }
+
+  uint64_t MapSerializer::Hash(const std::string &opendrive) {
+    return HashBytes(reinterpret_cast<const unsigned char *>(opendrive.data()), opendrive.size());
+  }
+
+  std::vector<unsigned char> MapSerializer::Serialize(const Map &map, const uint64_t key) {
+    const auto &map_data = map.GetData();
+    detail::MapWriter writer;
+    writer.data().resize(sizeof(MapHeader));
+
+    // Sorted so the same map always gives the same binary.
+    std::vector<id_type> ids;
+    for (auto &&road : map_data.GetRoadSegments()) {
+      ids.emplace_back(road.GetId());
+    }
+    std::sort(ids.begin(), ids.end());
+
+    writer.WriteSize(ids.size());
+    for (auto id : ids) {
+      const auto &road = *map_data.GetRoad(id);
+      writer.Write<uint64_t>(road.GetId());
+      writer.WriteSize(road._successors.size());
+      for (auto *successor : road._successors) {
+        writer.Write<uint64_t>(successor->GetId());
+      }
+      writer.Write(road._successors_is_start);
+      writer.WriteSize(road._predecessors.size());
+      for (auto *predecessor : road._predecessors) {
+        writer.Write<uint64_t>(predecessor->GetId());
+      }
+      writer.Write(road._predecessors_is_start);
+      writer.WriteSize(road._geometries.size());
+      for (auto &&geometry : road._geometries) {
+        writer.Write(geometry);
+      }
+      writer.WriteSize(road._info.size());
+      for (auto &&info : road._info) {
+        writer.Write(*info);
+      }
+      writer.Write(road._next_lane);
+      writer.Write(road._prev_lane);
+      writer.Write(road._elevation);
+      writer.Write(road._superelevation);
+    }
+
+    const auto &junctions = map_data.GetJunctionInformation();
+    writer.WriteSize(junctions.size());
+    for (auto &&junction : junctions) {
+      writer.Write(junction);
+    }
+
+    const auto &signals = map_data.GetSignals();
+    writer.WriteSize(signals.size());
+    for (auto &&signal : signals) {
+      writer.Write(signal);
+    }
+
+    auto &data = writer.data();
+    MapHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.key = key;
+    header.payload_size = data.size() - sizeof(MapHeader);
+    header.payload_hash = HashBytes(data.data() + sizeof(MapHeader), header.payload_size);
+    std::memcpy(data.data(), &header, sizeof(MapHeader));
+    return std::move(data);
+  }
+
+  SharedPtr<Map> MapSerializer::Deserialize(
+      const unsigned char *data,
+      const size_t size,
+      const uint64_t key) {
+    if (size < sizeof(MapHeader)) {
+      return nullptr;
+    }
+    MapHeader header;
+    std::memcpy(&header, data, sizeof(MapHeader));
+    const auto *payload = data + sizeof(MapHeader);
+    if ((std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) ||
+        (header.version != VERSION) ||
+        (header.byte_order != BYTE_ORDER_MARK) ||
+        (header.key != key) ||
+        (header.payload_size != size - sizeof(MapHeader)) ||
+        (header.payload_hash != HashBytes(payload, header.payload_size))) {
+      return nullptr;
+    }
+
+    detail::MapReader reader(payload, payload + header.payload_size);
+    MapBuilder builder;
+
+    const auto number_of_roads = reader.ReadSize(sizeof(uint64_t));
+    for (auto i = 0u; i < number_of_roads; ++i) {
+      RoadSegmentDefinition def(reader.Read<uint64_t>());
+      std::vector<id_type> successor_ids(reader.ReadSize(sizeof(uint64_t)));
+      for (auto &id : successor_ids) {
+        id = reader.Read<uint64_t>();
+      }
+      const auto successors_is_start = reader.ReadBools();
+      std::vector<id_type> predecessor_ids(reader.ReadSize(sizeof(uint64_t)));
+      for (auto &id : predecessor_ids) {
+        id = reader.Read<uint64_t>();
+      }
+      const auto predecessors_is_start = reader.ReadBools();
+      if ((successor_ids.size() != successors_is_start.size()) ||
+          (predecessor_ids.size() != predecessors_is_start.size())) {
+        return nullptr;
+      }
+      for (auto j = 0u; j < successor_ids.size(); ++j) {
+        def.AddSuccessorID(successor_ids[j], successors_is_start[j]);
+      }
+      for (auto j = 0u; j < predecessor_ids.size(); ++j) {
+        def.AddPredecessorID(predecessor_ids[j], predecessors_is_start[j]);
+      }
+
+      const auto number_of_geometries = reader.ReadSize();
+      for (auto j = 0u; j < number_of_geometries; ++j) {
+        ReadGeometry(reader, def);
+      }
+      const auto number_of_infos = reader.ReadSize();
+      for (auto j = 0u; j < number_of_infos; ++j) {
+        ReadInfo(reader, def);
+      }
+      ReadLaneLinks(reader, [&](int lane, int next_lane, int next_road) {
+        def.AddNextLaneInfo(lane, next_lane, next_road);
+      });
+      ReadLaneLinks(reader, [&](int lane, int prev_lane, int prev_road) {
+        def.AddPrevLaneInfo(lane, prev_lane, prev_road);
+      });
+      ReadProfile(reader, [&](const CubicProfile::Record &record) {
+        def.AddElevation(record);
+      });
+      ReadProfile(reader, [&](const CubicProfile::Record &record) {
+        def.AddSuperelevation(record);
+      });
+      if (reader.failed()) {
+        return nullptr;
+      }
+      builder.AddRoadSegmentDefinition(def);
+    }
+
+    const auto number_of_junctions = reader.ReadSize();
+    std::vector<lane_junction_t> junctions(number_of_junctions);
+    for (auto &junction : junctions) {
+      junction.contact_point = reader.ReadString();
+      junction.junction_id = reader.Read<int32_t>();
+      junction.connection_road = reader.Read<int32_t>();
+      junction.incomming_road = reader.Read<int32_t>();
+      junction.from_lane = reader.ReadInts();
+      junction.to_lane = reader.ReadInts();
+    }
+    if (reader.failed()) {
+      return nullptr;
+    }
+    builder.SetJunctionInformation(junctions);
+
+    const auto number_of_signals = reader.ReadSize();
+    for (auto i = 0u; i < number_of_signals; ++i) {
+      Signal signal;
+      signal.id = reader.Read<int32_t>();
+      signal.road_id = reader.Read<uint64_t>();
+      signal.s = reader.Read<double>();
+      signal.t = reader.Read<double>();
+      signal.zoffset = reader.Read<double>();
+      signal.value = reader.Read<double>();
+      signal.name = reader.ReadString();
+      signal.is_dynamic = (reader.Read<uint8_t>() != 0u);
+      const auto orientation = reader.Read<uint8_t>();
+      if (orientation > static_cast<uint8_t>(SignalOrientation::Both)) {
+        reader.Fail();
+      }
+      signal.orientation = static_cast<SignalOrientation>(orientation);
+      signal.country = reader.ReadString();
+      signal.type = reader.ReadString();
+      signal.subtype = reader.ReadString();
+      signal.validity.resize(reader.ReadSize(2u * sizeof(int32_t)));
+      for (auto &range : signal.validity) {
+        range.first = reader.Read<int32_t>();
+        range.second = reader.Read<int32_t>();
+      }
+      builder.AddSignal(std::move(signal));
+    }
+    if (reader.failed()) {
+      return nullptr;
+    }
+    return builder.Build();
+  }
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,50 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Memory.h"
+#include "carla/road/Map.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  /// Compact binary serialization of a road::Map, used to cache the maps
+  /// built from OpenDRIVE files.
+  ///
+  /// The binary contains the road segments as they were defined to the
+  /// MapBuilder: geometries, elevation profiles, road infos, lanes, links
+  /// between roads, junctions and signals. Deserializing builds the map again
+  /// from them, skipping the parsing of the XML. Numbers are stored in the
+  /// byte order of the machine, binaries with a different version or byte
+  /// order are rejected.
+  class MapSerializer {
+  public:
+
+    /// Increase every time the format of the binary changes.
+    static constexpr uint32_t VERSION = 4u;
+
+    /// Hash of the contents of an OpenDRIVE file, used as key of its binary.
+    static uint64_t Hash(const std::string &opendrive);
+
+    /// Serialize @a map, tagging the binary with @a key.
+    static std::vector<unsigned char> Serialize(const Map &map, uint64_t key);
+
+    /// Build the map serialized in @a data. Returns nullptr if @a data is not
+    /// a valid binary of this version or was serialized with a different
+    /// key.
+    static SharedPtr<Map> Deserialize(
+        const unsigned char *data,
+        size_t size,
+        uint64_t key);
+  };
+
+} // namespace road
+} // namespace carla
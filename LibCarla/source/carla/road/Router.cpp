@@ -0,0 +1,260 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/Router.h"
+
+#include "carla/Logging.h"
+#include "carla/WorkerPool.h"
+#include "carla/geom/Math.h"
+#include "carla/road/Map.h"
+#include "carla/road/WaypointGenerator.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace carla {
+namespace road {
+
+  using namespace element;
+
+  /// Minimum number of routes per thread in ComputeRoutes, fewer don't pay
+  /// off the cost of waking up a thread.
+  static constexpr size_t MIN_ROUTES_PER_THREAD = 8u;
+
+  Router::Router(const Map &map, const double lane_change_cost, const size_t cache_size)
+    : _lane_change_cost(lane_change_cost),
+      _cache(cache_size) {
+    DEBUG_ASSERT(_lane_change_cost >= 0.0);
+    std::vector<std::vector<Edge>> edges;
+
+    auto get_or_add_node = [&](const Waypoint &waypoint) {
+      const auto key = MakeKey(waypoint.GetRoadId(), waypoint.GetLaneId());
+      auto result = _node_index.emplace(key, static_cast<node_id>(_nodes.size()));
+      if (result.second) {
+        _nodes.push_back(Node{
+            waypoint,
+            waypoint.GetRoadSegment().GetDirectedPointIn(waypoint.GetDistance()).location,
+            waypoint.GetRoadSegment().GetLength(),
+            0u,
+            0u});
+        edges.emplace_back();
+      }
+      return result.first->second;
+    };
+
+    for (auto &&pair : WaypointGenerator::GenerateTopology(map)) {
+      const auto from = get_or_add_node(pair.first);
+      const auto to = get_or_add_node(pair.second);
+      edges[from].push_back(Edge{to, false, _nodes[from].length});
+    }
+
+    // Lane changes to the adjacent lanes going in the same direction.
+    for (node_id id = 0u; id < _nodes.size(); ++id) {
+      const auto &entry = _nodes[id].entry;
+      const int lane_id = entry.GetLaneId();
+      for (int adjacent : {lane_id - 1, lane_id + 1}) {
+        if ((adjacent == 0) || ((adjacent < 0) != (lane_id < 0))) {
+          continue;
+        }
+        auto it = _node_index.find(MakeKey(entry.GetRoadId(), adjacent));
+        if (it != _node_index.end()) {
+          edges[id].push_back(Edge{it->second, true, _lane_change_cost});
+        }
+      }
+    }
+
+    for (node_id id = 0u; id < _nodes.size(); ++id) {
+      _nodes[id].edges_begin = _edges.size();
+      _edges.insert(_edges.end(), edges[id].begin(), edges[id].end());
+      _nodes[id].edges_end = _edges.size();
+    }
+  }
+
+  const Router::Node *Router::FindNode(const Waypoint &waypoint, node_id &out_id) const {
+    auto it = _node_index.find(MakeKey(waypoint.GetRoadId(), waypoint.GetLaneId()));
+    if (it == _node_index.end()) {
+      return nullptr;
+    }
+    out_id = it->second;
+    return &_nodes[out_id];
+  }
+
+  double Router::GetProgress(const Node &node, const Waypoint &waypoint) {
+    return waypoint.GetLaneId() < 0 ?
+        waypoint.GetDistance() :
+        node.length - waypoint.GetDistance();
+  }
+
+  bool Router::IsLaneChange(const node_id from, const node_id to) const {
+    const auto &node = _nodes[from];
+    return std::any_of(_edges.begin() + node.edges_begin, _edges.begin() + node.edges_end,
+        [to](const Edge &edge) { return edge.is_lane_change && (edge.to == to); });
+  }
+
+  Router::Path Router::FindPath(const node_id origin, const node_id destination) const {
+    constexpr node_id NONE = std::numeric_limits<node_id>::max();
+    const auto &target = _nodes[destination].location;
+    // Costs are lengths of the reference lines measured on the plane, so the
+    // heuristic uses the reference line positions measured on the plane too to
+    // never overestimate them. Lane changes stay on the same position.
+    auto heuristic = [&](node_id id) {
+      return geom::Math::Distance2D(_nodes[id].location, target);
+    };
+
+    std::vector<double> cost(_nodes.size(), std::numeric_limits<double>::max());
+    std::vector<node_id> parent(_nodes.size(), NONE);
+    std::vector<size_t> lane_changes(_nodes.size(), 0u);
+    std::vector<bool> closed(_nodes.size(), false);
+    using entry_type = std::pair<double, node_id>;
+    std::priority_queue<entry_type, std::vector<entry_type>, std::greater<entry_type>> open;
+
+    // Where roads don't meet exactly at the ends of their reference lines the
+    // heuristic may not be consistent, reopen the lanes reached by a cheaper
+    // path to keep the route optimal.
+    auto relax = [&](node_id from, node_id to, double g, size_t changes) {
+      if (g < cost[to]) {
+        closed[to] = false;
+        cost[to] = g;
+        parent[to] = from;
+        lane_changes[to] = changes;
+        open.emplace(g + heuristic(to), to);
+      }
+    };
+
+    // Leave the origin lane by one of its successors, or by the successors
+    // of an adjacent lane after changing to it.
+    auto leave = [&](node_id lane, double g, size_t changes) {
+      const auto &node = _nodes[lane];
+      for (auto i = node.edges_begin; i < node.edges_end; ++i) {
+        if (!_edges[i].is_lane_change) {
+          relax(NONE, _edges[i].to, g + _edges[i].cost, changes);
+        }
+      }
+    };
+    leave(origin, 0.0, 0u);
+    for (auto i = _nodes[origin].edges_begin; i < _nodes[origin].edges_end; ++i) {
+      if (_edges[i].is_lane_change) {
+        leave(_edges[i].to, _edges[i].cost, 1u);
+      }
+    }
+
+    while (!open.empty()) {
+      const auto id = open.top().second;
+      open.pop();
+      if (closed[id]) {
+        continue;
+      }
+      if (id == destination) {
+        Path path;
+        for (auto node = id; node != NONE; node = parent[node]) {
+          path.nodes.push_back(node);
+        }
+        std::reverse(path.nodes.begin(), path.nodes.end());
+        path.cost = cost[id];
+        path.lane_changes = lane_changes[id];
+        path.found = true;
+        return path;
+      }
+      closed[id] = true;
+      const auto &node = _nodes[id];
+      for (auto i = node.edges_begin; i < node.edges_end; ++i) {
+        const auto &edge = _edges[i];
+        relax(id, edge.to, cost[id] + edge.cost, lane_changes[id] + (edge.is_lane_change ? 1u : 0u));
+      }
+    }
+    return Path{};
+  }
+
+  Router::Path Router::GetPath(const node_id origin, const node_id destination) const {
+    const uint64_t key = (static_cast<uint64_t>(origin) << 32u) | destination;
+    {
+      std::lock_guard<std::mutex> lock(_cache_mutex);
+      const auto *path = _cache.Get(key);
+      if (path != nullptr) {
+        return *path;
+      }
+    }
+    auto path = FindPath(origin, destination);
+    std::lock_guard<std::mutex> lock(_cache_mutex);
+    _cache.Put(key, path);
+    return path;
+  }
+
+  Router::Route Router::ComputeRoute(const Waypoint &origin, const Waypoint &destination) const {
+    Route route;
+    node_id origin_id;
+    node_id destination_id;
+    const auto *origin_node = FindNode(origin, origin_id);
+    const auto *destination_node = FindNode(destination, destination_id);
+    if ((origin_node == nullptr) || (destination_node == nullptr)) {
+      log_warning("router: waypoint is not on a drivable lane");
+      return route;
+    }
+    const double origin_progress = GetProgress(*origin_node, origin);
+    const double destination_progress = GetProgress(*destination_node, destination);
+
+    // The destination is ahead in the same lane, or in an adjacent one.
+    if (destination_progress >= origin_progress) {
+      const bool is_same_lane = (origin_id == destination_id);
+      if (is_same_lane || IsLaneChange(origin_id, destination_id)) {
+        route.waypoints = {origin, destination};
+        route.length = destination_progress - origin_progress;
+        route.lane_changes = is_same_lane ? 0u : 1u;
+        return route;
+      }
+    }
+
+    const auto path = GetPath(origin_id, destination_id);
+    if (!path.found) {
+      return route;
+    }
+    route.waypoints.reserve(path.nodes.size() + 2u);
+    route.waypoints.push_back(origin);
+    for (auto id : path.nodes) {
+      route.waypoints.push_back(_nodes[id].entry);
+    }
+    route.waypoints.push_back(destination);
+    route.length =
+        path.cost - _lane_change_cost * path.lane_changes - origin_progress + destination_progress;
+    route.lane_changes = path.lane_changes;
+    return route;
+  }
+
+  std::vector<Router::Route> Router::ComputeRoutes(
+      const std::vector<std::pair<Waypoint, Waypoint>> &pairs) const {
+    std::vector<Route> result(pairs.size());
+
+    auto compute = [&](const size_t begin, const size_t end) {
+      for (auto i = begin; i < end; ++i) {
+        result[i] = ComputeRoute(pairs[i].first, pairs[i].second);
+      }
+    };
+
+    auto &workers = WorkerPool::GetShared();
+    const size_t number_of_threads = std::min<size_t>(
+        workers.size(),
+        pairs.size() / MIN_ROUTES_PER_THREAD);
+    if (number_of_threads <= 1u) {
+      compute(0u, pairs.size());
+      return result;
+    }
+    // Every thread, this one included, takes a contiguous chunk.
+    const size_t chunk = (pairs.size() + number_of_threads - 1u) / number_of_threads;
+    workers.ParallelFor(number_of_threads, [&compute, &pairs, chunk](size_t i) {
+      compute(i * chunk, std::min((i + 1u) * chunk, pairs.size()));
+    });
+    return result;
+  }
+
+  size_t Router::GetCachedRouteCount() const {
+    std::lock_guard<std::mutex> lock(_cache_mutex);
+    return _cache.size();
+  }
+
+} // namespace road
+} // namespace carla
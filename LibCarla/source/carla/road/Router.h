@@ -0,0 +1,136 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/LruCache.h"
+#include "carla/NonCopyable.h"
+#include "carla/geom/Location.h"
+#include "carla/road/element/Waypoint.h"
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  class Map;
+
+  /// Computes routes along the lanes of a map.
+  ///
+  /// The map is turned into a graph with a node per drivable lane, and edges
+  /// from each lane to its successor lanes, as given by
+  /// WaypointGenerator::GenerateTopology, weighted by the length of the lane.
+  /// Lane changes are edges to the adjacent lanes of the same direction,
+  /// weighted by a constant cost. Routes are searched with A*, using as
+  /// heuristic the straight line to the destination.
+  ///
+  /// The routes found between each pair of lanes are kept in a cache of
+  /// limited size. The router is thread-safe.
+  class Router : private NonCopyable {
+  public:
+
+    using Waypoint = element::Waypoint;
+
+    struct Route {
+      /// The origin, the waypoint at the entrance of each lane driven, and
+      /// the destination. Empty if the destination cannot be reached.
+      std::vector<Waypoint> waypoints;
+
+      /// Distance driven from the origin to the destination [meters].
+      double length = 0.0;
+
+      size_t lane_changes = 0u;
+
+      bool empty() const {
+        return waypoints.empty();
+      }
+    };
+
+    /// @param lane_change_cost cost of changing lane, in meters of road.
+    /// @param cache_size maximum number of routes kept in the cache.
+    explicit Router(const Map &map, double lane_change_cost = 10.0, size_t cache_size = 1024u);
+
+    /// Shortest route from @a origin to @a destination.
+    Route ComputeRoute(const Waypoint &origin, const Waypoint &destination) const;
+
+    /// Compute the route of each pair of origin and destination in @a pairs.
+    /// Big batches are split among several threads.
+    std::vector<Route> ComputeRoutes(const std::vector<std::pair<Waypoint, Waypoint>> &pairs) const;
+
+    size_t GetNodeCount() const {
+      return _nodes.size();
+    }
+
+    size_t GetCachedRouteCount() const;
+
+  private:
+
+    using node_id = uint32_t;
+
+    struct Edge {
+      node_id to;
+      bool is_lane_change;
+      double cost;
+    };
+
+    struct Node {
+      /// Waypoint at the entrance of the lane.
+      Waypoint entry;
+      geom::Location location;
+      double length;
+      /// Range of the edges of this node in _edges.
+      size_t edges_begin;
+      size_t edges_end;
+    };
+
+    /// Lanes driven after leaving the origin lane, the last one is the
+    /// destination lane.
+    struct Path {
+      std::vector<node_id> nodes;
+      /// Cost from the entrance of the origin lane to the entrance of the
+      /// destination lane.
+      double cost = 0.0;
+      size_t lane_changes = 0u;
+      bool found = false;
+    };
+
+    static uint64_t MakeKey(element::id_type road_id, int lane_id) {
+      return (static_cast<uint64_t>(road_id) << 32u) | static_cast<uint32_t>(lane_id);
+    }
+
+    const Node *FindNode(const Waypoint &waypoint, node_id &out_id) const;
+
+    /// Distance driven along the lane from its entrance to @a waypoint.
+    static double GetProgress(const Node &node, const Waypoint &waypoint);
+
+    bool IsLaneChange(node_id from, node_id to) const;
+
+    /// A* search from the origin lane, leaving it by one of its successors,
+    /// to the destination lane.
+    Path FindPath(node_id origin, node_id destination) const;
+
+    /// FindPath going through the cache.
+    Path GetPath(node_id origin, node_id destination) const;
+
+    const double _lane_change_cost;
+
+    std::vector<Node> _nodes;
+
+    std::vector<Edge> _edges;
+
+    std::unordered_map<uint64_t, node_id> _node_index;
+
+    mutable std::mutex _cache_mutex;
+
+    mutable LruCache<uint64_t, Path> _cache;
+  };
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,171 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/SpatialIndex.h"
+
+#include "carla/Debug.h"
+#include "carla/road/MapData.h"
+
+#include <boost/iterator/function_output_iterator.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace carla {
+namespace road {
+
+  namespace bg = boost::geometry;
+  namespace bgi = boost::geometry::index;
+
+  using namespace element;
+
+  /// Maximum length of road covered by each box of the index [meters].
+  static constexpr double CHUNK_LENGTH = 20.0;
+
+  /// Distance between the points sampled to compute the boxes [meters]. Any
+  /// point of the reference line is at most half this distance from a sample,
+  /// the boxes are enlarged by that much.
+  static constexpr double SAMPLE_STEP = 1.0;
+
+  /// Number of nearest boxes visited per road requested before narrowing the
+  /// search to the distance of the roads found.
+  static constexpr size_t NEAREST_BOXES_PER_ROAD = 4u;
+
+  static DirectedPoint GetPointAt(const GeometryRecord &geometry, const double dist) {
+    // PosFromDist expects a positive distance.
+    return dist > 0.0 ?
+        geometry.PosFromDist(dist) :
+        DirectedPoint(geometry.GetStartPosition(), geometry.GetHeading());
+  }
+
+  void SpatialIndex::Build(const MapData &map_data) {
+    _geometries.clear();
+    _unbounded_geometries.clear();
+    std::vector<Value> values;
+    for (auto &&road : map_data.GetRoadSegments()) {
+      double road_offset = 0.0;
+      for (auto &&geometry : road._geometries) {
+        const auto index = _geometries.size();
+        _geometries.emplace_back(IndexedGeometry{&road, &geometry, road_offset});
+        road_offset += geometry.GetLength();
+
+        const double length = std::max(geometry.GetLength(), 0.0);
+        const auto number_of_chunks =
+            static_cast<size_t>(std::max(1.0, std::ceil(length / CHUNK_LENGTH)));
+        const double chunk_length = length / static_cast<double>(number_of_chunks);
+        const auto samples_per_chunk =
+            static_cast<size_t>(std::max(1.0, std::ceil(chunk_length / SAMPLE_STEP)));
+        const double step = chunk_length / static_cast<double>(samples_per_chunk);
+        const double margin = 0.5 * step;
+
+        std::vector<Value> chunks;
+        bool is_bounded = true;
+        for (auto i = 0u; (i < number_of_chunks) && is_bounded; ++i) {
+          Box box;
+          bg::assign_inverse(box);
+          for (auto j = 0u; j <= samples_per_chunk; ++j) {
+            const double dist = std::min(i * chunk_length + j * step, length);
+            const auto location = GetPointAt(geometry, dist).location;
+            if (!std::isfinite(location.x) || !std::isfinite(location.y)) {
+              is_bounded = false;
+              break;
+            }
+            bg::expand(box, Point(location.x, location.y));
+          }
+          bg::set<bg::min_corner, 0u>(box, bg::get<bg::min_corner, 0u>(box) - margin);
+          bg::set<bg::min_corner, 1u>(box, bg::get<bg::min_corner, 1u>(box) - margin);
+          bg::set<bg::max_corner, 0u>(box, bg::get<bg::max_corner, 0u>(box) + margin);
+          bg::set<bg::max_corner, 1u>(box, bg::get<bg::max_corner, 1u>(box) + margin);
+          chunks.emplace_back(box, index);
+        }
+
+        if (is_bounded) {
+          values.insert(values.end(), chunks.begin(), chunks.end());
+        } else {
+          _unbounded_geometries.emplace_back(index);
+        }
+      }
+    }
+    // The range constructor packs the tree, better than inserting one by one.
+    _rtree = decltype(_rtree)(values.begin(), values.end());
+  }
+
+  size_t SpatialIndex::FindNearestRoads(
+      const geom::Location &location,
+      NearestRoad *out,
+      const size_t max_count) const {
+    if (max_count == 0u) {
+      return 0u;
+    }
+    size_t count = 0u;
+    for (auto index : _unbounded_geometries) {
+      count = Insert(_geometries[index], location, out, count, max_count);
+    }
+    if (_rtree.empty()) {
+      return count;
+    }
+    const Point point(location.x, location.y);
+    auto insert = boost::make_function_output_iterator([&](const Value &value) {
+      count = Insert(_geometries[value.second], location, out, count, max_count);
+    });
+    // The geometries of the nearest boxes give a first guess of the distance
+    // to the nearest roads.
+    const auto number_of_guesses = static_cast<unsigned>(NEAREST_BOXES_PER_ROAD * max_count);
+    _rtree.query(bgi::nearest(point, number_of_guesses), insert);
+    if (_rtree.size() <= number_of_guesses) {
+      return count;
+    }
+    if (count < max_count) {
+      // Too few roads around, visit every geometry.
+      for (auto &&geometry : _geometries) {
+        count = Insert(geometry, location, out, count, max_count);
+      }
+      return count;
+    }
+    // Any road nearer than the farthest one found must have a box within that
+    // distance.
+    const double radius = out[count - 1u].distance;
+    const Box query_box(
+        Point(location.x - radius, location.y - radius),
+        Point(location.x + radius, location.y + radius));
+    _rtree.query(bgi::intersects(query_box), insert);
+    return count;
+  }
+
+  size_t SpatialIndex::Insert(
+      const IndexedGeometry &geometry,
+      const geom::Location &location,
+      NearestRoad *out,
+      size_t count,
+      const size_t max_count) {
+    DEBUG_ASSERT(max_count > 0u);
+    const auto dist = geometry.geometry->DistanceTo(location);
+    // Find where the road goes, replacing its previous distance if any.
+    size_t i = 0u;
+    while ((i < count) && (out[i].road != geometry.road)) {
+      ++i;
+    }
+    if (i == count) {
+      if (count < max_count) {
+        ++count;
+      } else if (dist.second < out[count - 1u].distance) {
+        i = count - 1u;
+      } else {
+        return count;
+      }
+    } else if (dist.second >= out[i].distance) {
+      return count;
+    }
+    // Keep the array sorted, ties keep the road found first.
+    for (; (i > 0u) && (out[i - 1u].distance > dist.second); --i) {
+      out[i] = out[i - 1u];
+    }
+    out[i] = NearestRoad{geometry.road, geometry.road_offset + dist.first, dist.second};
+    return count;
+  }
+
+} // namespace road
+} // namespace carla
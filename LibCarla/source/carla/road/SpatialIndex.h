@@ -0,0 +1,96 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/geom/Location.h"
+#include "carla/road/element/RoadSegment.h"
+
+#include <boost/geometry.hpp>
+#include <boost/geometry/geometries/box.hpp>
+#include <boost/geometry/geometries/point.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  class MapData;
+
+  /// Static R-tree over the geometries of the road segments of a map. Used to
+  /// find the road segments nearest to a location visiting only the
+  /// geometries around it.
+  ///
+  /// Long geometries are split in chunks, each one indexed by a box that
+  /// contains the piece of the road reference line it covers, so the
+  /// distance to the box is a lower bound of the distance to the geometry.
+  class SpatialIndex : private MovableNonCopyable {
+  public:
+
+    struct NearestRoad {
+      const element::RoadSegment *road = nullptr;
+      /// Distance along the road to the nearest point of its reference line.
+      double distance_along_road = 0.0;
+      /// Euclidean distance from the nearest point of the road to the location.
+      double distance = 0.0;
+    };
+
+    /// Index the geometries of every road segment in @a map_data. The road
+    /// segments must outlive this index.
+    void Build(const MapData &map_data);
+
+    /// Find the @a max_count road segments nearest to @a location, the same
+    /// result as calling RoadSegment::GetNearestPoint on every road segment.
+    /// Results are written to @a out sorted by distance.
+    ///
+    /// @return the number of road segments found.
+    size_t FindNearestRoads(
+        const geom::Location &location,
+        NearestRoad *out,
+        size_t max_count) const;
+
+    /// Number of boxes in the index.
+    size_t size() const {
+      return _rtree.size();
+    }
+
+  private:
+
+    using Point = boost::geometry::model::point<double, 2, boost::geometry::cs::cartesian>;
+
+    using Box = boost::geometry::model::box<Point>;
+
+    using Value = std::pair<Box, size_t>;
+
+    struct IndexedGeometry {
+      const element::RoadSegment *road;
+      const element::GeometryRecord *geometry;
+      /// Sum of the length of the previous geometries of the road.
+      double road_offset;
+    };
+
+    /// Keep the road segment of @a geometry in @a out if it is among the
+    /// nearest @a max_count, returns the new number of elements in @a out.
+    static size_t Insert(
+        const IndexedGeometry &geometry,
+        const geom::Location &location,
+        NearestRoad *out,
+        size_t count,
+        size_t max_count);
+
+    std::vector<IndexedGeometry> _geometries;
+
+    /// Geometries that could not be bounded, visited by every query.
+    std::vector<size_t> _unbounded_geometries;
+
+    boost::geometry::index::rtree<Value, boost::geometry::index::rstar<16u>> _rtree;
+  };
+
+} // namespace road
+} // namespace carla
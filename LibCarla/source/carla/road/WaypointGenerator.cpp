@@ -6,50 +6,92 @@
 
 #include "carla/road/WaypointGenerator.h"
 
+#include "carla/WorkerPool.h"
+#include "carla/geom/Math.h"
 #include "carla/road/Map.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace carla {
 namespace road {
 
   using namespace carla::road::element;
 
+  /// Minimum number of sampled road positions per thread in GenerateAll,
+  /// fewer don't pay off the cost of waking up a thread.
+  static constexpr size_t MIN_SAMPLES_PER_THREAD = 4096u;
+
   // ===========================================================================
   // -- Static local methods ---------------------------------------------------
   // ===========================================================================
 
-  template <typename T>
-  static std::vector<T> ConcatVectors(std::vector<T> dst, std::vector<T> src) {
-    if (src.size() > dst.size()) {
-      return ConcatVectors(src, dst);
-    }
-    dst.insert(
-        dst.end(),
-        std::make_move_iterator(src.begin()),
-        std::make_move_iterator(src.end()));
-    return dst;
-  }
-
   template <typename FuncT>
   static void ForEachDrivableLane(const RoadSegment &road, double s, FuncT &&func) {
     const auto *info = road.GetInfo<RoadInfoLane>(s);
     DEBUG_ASSERT(info != nullptr);
-    for (auto &&lane_id : info->getLanesIDs(RoadInfoLane::which_lane_e::Both)) {
-      if (info->getLane(lane_id)->_type == "driving") {
-        func(lane_id);
+    for (auto &&lane : info->GetLanes()) {
+      if (lane._type == LaneType::Driving) {
+        func(lane._id);
       }
     }
   }
 
+  /// Split the road segments of @a map in contiguous ranges of about the
+  /// same length, and call @a func(begin, end, out) for each range in the
+  /// shared WorkerPool. Returns the result of each range, in order.
+  template <typename ResultT, typename FuncT>
+  static std::vector<ResultT> GenerateInParallel(
+      const Map &map,
+      const double distance,
+      FuncT &&func) {
+    const auto roads = map.GetData().GetRoadSegments();
+    const auto count = static_cast<size_t>(roads.size());
+    std::vector<double> accumulated_length(count + 1u, 0.0);
+    for (size_t i = 0u; i < count; ++i) {
+      accumulated_length[i + 1u] = accumulated_length[i] + (roads.begin() + i)->GetLength();
+    }
+    const auto samples = static_cast<size_t>(accumulated_length.back() / distance);
+    auto &workers = WorkerPool::GetShared();
+    const size_t number_of_threads = std::max<size_t>(1u, std::min<size_t>(
+        workers.size(),
+        samples / MIN_SAMPLES_PER_THREAD));
+
+    // Each range ends at the first road reaching its share of the length.
+    std::vector<size_t> bounds(number_of_threads + 1u, count);
+    bounds[0u] = 0u;
+    for (size_t i = 1u; i < number_of_threads; ++i) {
+      const double length = accumulated_length.back() * i / number_of_threads;
+      bounds[i] = static_cast<size_t>(std::lower_bound(
+          accumulated_length.begin(),
+          accumulated_length.end(),
+          length) - accumulated_length.begin());
+      bounds[i] = std::max(bounds[i - 1u], std::min(bounds[i], count));
+    }
+
+    std::vector<ResultT> result(number_of_threads);
+    auto generate = [&](const size_t i) {
+      func(roads.begin() + bounds[i], roads.begin() + bounds[i + 1u], result[i]);
+    };
+    if (number_of_threads == 1u) {
+      generate(0u);
+    } else {
+      workers.ParallelFor(number_of_threads, generate);
+    }
+    return result;
+  }
+
   // ===========================================================================
   // -- WaypointGenerator ------------------------------------------------------
   // ===========================================================================
 
-  std::vector<Waypoint> WaypointGenerator::GetSuccessors(const Waypoint &waypoint) {
-    auto &map = waypoint._map;
+  template <typename FuncT>
+  void WaypointGenerator::ForEachSuccessor(const Waypoint &waypoint, FuncT &&func) {
+    const auto &map = waypoint._map;
     const auto this_lane_id = waypoint.GetLaneId();
     const auto this_road_id = waypoint.GetRoadId();
 
-    const auto &next_lanes =
+    const auto next_lanes =
         this_lane_id < 0 ?
             waypoint.GetRoadSegment().GetNextLane(this_lane_id) :
             waypoint.GetRoadSegment().GetPrevLane(this_lane_id);
@@ -58,8 +100,6 @@ namespace road {
       log_error("lane id =", this_lane_id, " road id=", this_road_id, ": missing next lanes");
     }
 
-    std::vector<Waypoint> result;
-    result.reserve(next_lanes.size());
     for (auto &&pair : next_lanes) {
       const auto lane_id = pair.first;
       const auto road_id = pair.second;
@@ -67,15 +107,31 @@ namespace road {
       DEBUG_ASSERT(lane_id != 0);
       DEBUG_ASSERT(road != nullptr);
       const auto distance = lane_id < 0 ? 0.0 : road->GetLength();
-      result.push_back(Waypoint(map, road_id, lane_id, distance));
+      func(Waypoint(map, road_id, lane_id, distance));
     }
+  }
+
+  std::vector<Waypoint> WaypointGenerator::GetSuccessors(const Waypoint &waypoint) {
+    std::vector<Waypoint> result;
+    ForEachSuccessor(waypoint, [&](Waypoint &&successor) {
+      result.push_back(std::move(successor));
+    });
     return result;
   }
 
   std::vector<Waypoint> WaypointGenerator::GetNext(
       const Waypoint &waypoint,
       double distance) {
-    auto &map = waypoint._map;
+    std::vector<Waypoint> result;
+    GetNext(waypoint, distance, result);
+    return result;
+  }
+
+  void WaypointGenerator::GetNext(
+      const Waypoint &waypoint,
+      double distance,
+      std::vector<Waypoint> &out) {
+    const auto &map = waypoint._map;
     const auto this_lane_id = waypoint.GetLaneId();
     const auto this_road_id = waypoint.GetRoadId();
 
@@ -86,36 +142,124 @@ namespace road {
       const auto total_distance = waypoint._dist + distance;
       const auto road_length = waypoint.GetRoadSegment().GetLength();
       if (total_distance <= road_length) {
-        return { Waypoint(map, this_road_id, this_lane_id, total_distance) };
+        out.push_back(Waypoint(map, this_road_id, this_lane_id, total_distance));
+        return;
       }
       distance_on_next_segment = total_distance - road_length;
     } else {
       // road goes backward.
       const auto total_distance = waypoint._dist - distance;
       if (total_distance >= 0.0) {
-        return { Waypoint(map, this_road_id, this_lane_id, total_distance) };
+        out.push_back(Waypoint(map, this_road_id, this_lane_id, total_distance));
+        return;
       }
       distance_on_next_segment = std::abs(total_distance);
     }
 
+    ForEachSuccessor(waypoint, [&](const Waypoint &next_waypoint) {
+      GetNext(next_waypoint, distance_on_next_segment, out);
+    });
+  }
+
+  std::vector<Waypoint> WaypointGenerator::GenerateAll(
+      const Map &map,
+      const double distance) {
+    DEBUG_ASSERT(distance > 0.0);
+    auto partial = GenerateInParallel<std::vector<Waypoint>>(map, distance,
+        [&](auto begin, auto end, std::vector<Waypoint> &out) {
+      const auto map_ptr = map.shared_from_this();
+      for (auto it = begin; it != end; ++it) {
+        const auto &road_segment = *it;
+        /// @todo Should distribute them equally along the segment?
+        for (double s = 0.0; s < road_segment.GetLength(); s += distance) {
+          ForEachDrivableLane(road_segment, s, [&](auto lane_id) {
+            out.push_back(Waypoint(map_ptr, road_segment.GetId(), lane_id, s));
+          });
+        }
+      }
+    });
+    if (partial.size() == 1u) {
+      return std::move(partial.front());
+    }
     std::vector<Waypoint> result;
-    for (auto &&next_waypoint : GetSuccessors(waypoint)) {
-      result = ConcatVectors(result, GetNext(next_waypoint, distance_on_next_segment));
+    size_t size = 0u;
+    for (auto &&waypoints : partial) {
+      size += waypoints.size();
+    }
+    result.reserve(size);
+    for (auto &&waypoints : partial) {
+      result.insert(
+          result.end(),
+          std::make_move_iterator(waypoints.begin()),
+          std::make_move_iterator(waypoints.end()));
     }
     return result;
   }
 
-  std::vector<Waypoint> WaypointGenerator::GenerateAll(
+  WaypointArrays WaypointGenerator::GenerateAllArrays(
       const Map &map,
       const double distance) {
-    std::vector<Waypoint> result;
-    for (auto &&road_segment : map.GetData().GetRoadSegments()) {
-      /// @todo Should distribute them equally along the segment?
-      for (double s = 0.0; s < road_segment.GetLength(); s += distance) {
-        ForEachDrivableLane(road_segment, s, [&](auto lane_id) {
-          result.push_back(Waypoint(map.shared_from_this(), road_segment.GetId(), lane_id, s));
-        });
+    DEBUG_ASSERT(distance > 0.0);
+    auto partial = GenerateInParallel<WaypointArrays>(map, distance,
+        [&](auto begin, auto end, WaypointArrays &out) {
+      // Reserve assuming the lanes at the beginning of each road.
+      size_t expected_size = 0u;
+      for (auto it = begin; it != end; ++it) {
+        size_t lanes = 0u;
+        ForEachDrivableLane(*it, 0.0, [&](int) { ++lanes; });
+        expected_size += lanes * static_cast<size_t>(std::ceil(it->GetLength() / distance));
+      }
+      out.reserve(expected_size);
+      for (auto it = begin; it != end; ++it) {
+        const auto &road_segment = *it;
+        // Same transform as Waypoint::ComputeTransform, but the point on the
+        // road is computed once for all the lanes.
+        const auto *lanes = road_segment.template GetInfo<RoadInfoLane>(0.0);
+        DEBUG_ASSERT(lanes != nullptr);
+        for (double s = 0.0; s < road_segment.GetLength(); s += distance) {
+          const auto point = road_segment.GetDirectedPointIn(s);
+          const geom::Rotation forward(
+              geom::Math::to_degrees(point.pitch),
+              geom::Math::to_degrees(point.tangent),
+              geom::Math::to_degrees(point.roll));
+          ForEachDrivableLane(road_segment, s, [&](auto lane_id) {
+            auto dp = point;
+            auto rotation = forward;
+            if (lane_id > 0) {
+              rotation.pitch = -rotation.pitch;
+              rotation.yaw += 180.0;
+              rotation.roll = -rotation.roll;
+            }
+            dp.ApplyLateralOffset(lanes->getLane(lane_id)->_lane_center_offset);
+            out.push_back(
+                static_cast<uint32_t>(road_segment.GetId()),
+                lane_id,
+                s,
+                geom::Transform(dp.location, rotation));
+          });
+        }
       }
+    });
+    if (partial.size() == 1u) {
+      return std::move(partial.front());
+    }
+    WaypointArrays result;
+    size_t size = 0u;
+    for (auto &&arrays : partial) {
+      size += arrays.size();
+    }
+    result.reserve(size);
+    auto append = [](auto &to, const auto &from) {
+      to.insert(to.end(), from.begin(), from.end());
+    };
+    for (auto &&arrays : partial) {
+      append(result.road_id, arrays.road_id);
+      append(result.lane_id, arrays.lane_id);
+      append(result.s, arrays.s);
+      append(result.x, arrays.x);
+      append(result.y, arrays.y);
+      append(result.z, arrays.z);
+      append(result.yaw, arrays.yaw);
     }
     return result;
   }
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "carla/road/element/Waypoint.h"
+#include "carla/road/element/WaypointArrays.h"
 
 #include <utility>
 #include <vector>
@@ -33,15 +34,37 @@ namespace road {
         const Waypoint &waypoint,
         double distance);
 
+    /// Same as above, but the waypoints are appended to @a out. Reusing @a
+    /// out, this does not allocate any memory.
+    static void GetNext(
+        const Waypoint &waypoint,
+        double distance,
+        std::vector<Waypoint> &out);
+
     /// Generate all the waypoints in @a map separated by @a approx_distance.
+    /// Big maps are split among several threads.
     static std::vector<Waypoint> GenerateAll(
         const Map &map,
         double approx_distance);
 
+    /// Same waypoints as GenerateAll, in the same order, but stored as a
+    /// struct of arrays with their transform already computed. Much cheaper
+    /// than GenerateAll for a dense sampling, as no Waypoint is created.
+    static element::WaypointArrays GenerateAllArrays(
+        const Map &map,
+        double approx_distance);
+
     /// Generate the minimum set of waypoints that define the topology of @a
     /// map. The waypoints are placed at the entrance of each lane.
     static std::vector<std::pair<Waypoint, Waypoint>> GenerateTopology(
         const Map &map);
+
+  private:
+
+    /// Call @a func with the waypoint at the entrance of each successor lane
+    /// of @a waypoint.
+    template <typename FuncT>
+    static void ForEachSuccessor(const Waypoint &waypoint, FuncT &&func);
   };
 
 } // namespace road
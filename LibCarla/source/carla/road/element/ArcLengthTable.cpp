@@ -0,0 +1,138 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/element/ArcLengthTable.h"
+
+#include "carla/Debug.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace carla {
+namespace road {
+namespace element {
+
+  /// Intervals are split at least to this length, so the check at the middle
+  /// is representative of the whole interval [meters].
+  static constexpr double MAX_SAMPLE_STEP = 50.0;
+
+  /// Intervals are not split below this length [meters].
+  static constexpr double MIN_SAMPLE_STEP = 0.01;
+
+  static constexpr unsigned MAX_DEPTH = 32u;
+
+  static ArcLengthTable::Sample MakeSample(const GeometryRecord &geometry, const double dist) {
+    // PosFromDist expects a positive distance.
+    const auto point = dist > 0.0 ?
+        geometry.PosFromDist(dist) :
+        DirectedPoint(geometry.GetStartPosition(), geometry.GetHeading());
+    return {
+      geometry.GetStartOffset() + dist,
+      point.location.x,
+      point.location.y,
+      point.location.z,
+      point.tangent};
+  }
+
+  static bool IsFinite(const ArcLengthTable::Sample &sample) {
+    return std::isfinite(sample.x) && std::isfinite(sample.y) &&
+           std::isfinite(sample.z) && std::isfinite(sample.heading);
+  }
+
+  static ArcLengthTable::Sample Lerp(
+      const ArcLengthTable::Sample &a,
+      const ArcLengthTable::Sample &b,
+      const double t) {
+    return {
+      a.s + t * (b.s - a.s),
+      a.x + t * (b.x - a.x),
+      a.y + t * (b.y - a.y),
+      a.z + t * (b.z - a.z),
+      a.heading + t * (b.heading - a.heading)};
+  }
+
+  void ArcLengthTable::Build(
+      const std::vector<GeometryRecord> &geometries,
+      const double tolerance) {
+    _samples.clear();
+    if (!(tolerance > 0.0)) {
+      return;
+    }
+    for (auto &&geometry : geometries) {
+      const auto first = MakeSample(geometry, 0.0);
+      const auto last = MakeSample(geometry, std::max(geometry.GetLength(), 0.0));
+      if (!IsFinite(first) || !IsFinite(last) ||
+          (!_samples.empty() && (first.s < _samples.back().s))) {
+        // Can't evaluate or not sorted by start offset, use the geometries.
+        _samples.clear();
+        return;
+      }
+      _samples.emplace_back(first);
+      AddSamples(geometry, first, last, tolerance, 0u);
+      if (_samples.empty()) {
+        return;
+      }
+      _samples.emplace_back(last);
+    }
+    _samples.shrink_to_fit();
+  }
+
+  void ArcLengthTable::AddSamples(
+      const GeometryRecord &geometry,
+      const Sample &first,
+      const Sample &last,
+      const double tolerance,
+      const unsigned depth) {
+    const double step = last.s - first.s;
+    if ((step <= MIN_SAMPLE_STEP) || (depth >= MAX_DEPTH)) {
+      return;
+    }
+    const auto middle = MakeSample(geometry, 0.5 * (first.s + last.s) - geometry.GetStartOffset());
+    if (!IsFinite(middle)) {
+      _samples.clear();
+      return;
+    }
+    const auto interpolated = Lerp(first, last, 0.5);
+    // Half the tolerance at the middle leaves room for the rest of the
+    // interval.
+    const double max_error = 0.5 * tolerance;
+    if ((step <= MAX_SAMPLE_STEP) &&
+        (std::hypot(middle.x - interpolated.x, middle.y - interpolated.y) <= max_error) &&
+        (std::abs(middle.z - interpolated.z) <= max_error) &&
+        (std::abs(middle.heading - interpolated.heading) <= max_error)) {
+      return;
+    }
+    AddSamples(geometry, first, middle, tolerance, depth + 1u);
+    if (_samples.empty()) {
+      return;
+    }
+    _samples.emplace_back(middle);
+    AddSamples(geometry, middle, last, tolerance, depth + 1u);
+  }
+
+  DirectedPoint ArcLengthTable::Evaluate(const double dist) const {
+    DEBUG_ASSERT(!_samples.empty());
+    DEBUG_ASSERT(dist >= GetStartOffset());
+    DEBUG_ASSERT(dist <= GetEndOffset());
+    // First sample at or after dist, so a distance between two geometries
+    // evaluates the end of the first one as RoadSegment does.
+    const auto next = std::lower_bound(
+        _samples.begin(),
+        _samples.end(),
+        dist,
+        [](const Sample &sample, const double d) { return sample.s < d; });
+    if ((next == _samples.begin()) || (next == _samples.end())) {
+      const auto &sample = next == _samples.end() ? _samples.back() : *next;
+      return DirectedPoint(sample.x, sample.y, sample.z, sample.heading);
+    }
+    const auto previous = std::prev(next);
+    const auto sample = Lerp(*previous, *next, (dist - previous->s) / (next->s - previous->s));
+    return DirectedPoint(sample.x, sample.y, sample.z, sample.heading);
+  }
+
+} // namespace element
+} // namespace road
+} // namespace carla
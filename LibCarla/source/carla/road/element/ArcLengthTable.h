@@ -0,0 +1,74 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/road/element/GeometryRecord.h"
+
+#include <vector>
+
+namespace carla {
+namespace road {
+namespace element {
+
+  /// Samples of the reference line of a road segment sorted by distance along
+  /// the road. Evaluating a point is a binary search plus a linear
+  /// interpolation between the two samples around it, instead of evaluating
+  /// the geometry.
+  ///
+  /// Samples are taken adaptively, an interval is split until the
+  /// interpolation at its middle is within the tolerance of the geometry.
+  class ArcLengthTable {
+  public:
+
+    struct Sample {
+      double s;
+      double x;
+      double y;
+      double z;
+      double heading;
+    };
+
+    /// Sample @a geometries so that interpolated positions are within
+    /// @a tolerance meters, and headings within @a tolerance radians, of the
+    /// geometries. The table is left empty if a geometry cannot be evaluated.
+    void Build(const std::vector<GeometryRecord> &geometries, double tolerance);
+
+    bool empty() const {
+      return _samples.empty();
+    }
+
+    size_t size() const {
+      return _samples.size();
+    }
+
+    /// Distance along the road covered by the table.
+    double GetStartOffset() const {
+      return _samples.front().s;
+    }
+
+    double GetEndOffset() const {
+      return _samples.back().s;
+    }
+
+    /// Interpolated point at @a dist, the table must cover @a dist.
+    DirectedPoint Evaluate(double dist) const;
+
+  private:
+
+    void AddSamples(
+        const GeometryRecord &geometry,
+        const Sample &first,
+        const Sample &last,
+        double tolerance,
+        unsigned depth);
+
+    std::vector<Sample> _samples;
+  };
+
+} // namespace element
+} // namespace road
+} // namespace carla
@@ -0,0 +1,118 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/element/CubicProfile.h"
+
+#include "carla/Debug.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace carla {
+namespace road {
+namespace element {
+
+  /// Samples are not further apart than this, even if the profile is linear
+  /// [meters].
+  static constexpr double MAX_SAMPLE_STEP = 10.0;
+
+  /// Profiles that need samples closer than this are not baked [meters].
+  static constexpr double MIN_SAMPLE_STEP = 0.01;
+
+  static constexpr size_t MAX_SAMPLES = 1u << 16u;
+
+  static std::pair<double, double> EvaluateRecord(
+      const CubicProfile::Record &record,
+      const double s) {
+    const double ds = s - record.s;
+    return {
+      record.a + ds * (record.b + ds * (record.c + ds * record.d)),
+      record.b + ds * (2.0 * record.c + ds * 3.0 * record.d)};
+  }
+
+  void CubicProfile::Add(const Record &record) {
+    auto it = std::upper_bound(_records.begin(), _records.end(), record.s,
+        [](const double s, const Record &r) { return s < r.s; });
+    _records.insert(it, record);
+    _samples.clear();
+  }
+
+  std::pair<double, double> CubicProfile::EvaluateRecords(const double s) const {
+    if (_records.empty()) {
+      return {0.0, 0.0};
+    }
+    // Last record starting at or before s.
+    auto it = std::upper_bound(_records.begin(), _records.end(), s,
+        [](const double d, const Record &r) { return d < r.s; });
+    return EvaluateRecord(it == _records.begin() ? *it : *std::prev(it), s);
+  }
+
+  std::pair<double, double> CubicProfile::Evaluate(const double s) const {
+    const double x = s * _inverse_step;
+    if (_samples.empty() || !(x >= 0.0) || (x > static_cast<double>(_samples.size() - 1u))) {
+      return EvaluateRecords(s);
+    }
+    const auto i = std::min(static_cast<size_t>(x), _samples.size() - 2u);
+    const double t = x - static_cast<double>(i);
+    const double slope = _samples[i + 1u] - _samples[i];
+    return {_samples[i] + t * slope, slope * _inverse_step};
+  }
+
+  void CubicProfile::Bake(const double length, const double tolerance) {
+    _samples.clear();
+    _inverse_step = 0.0;
+    if (!(tolerance > 0.0) || !(length > 0.0) || _records.empty()) {
+      return;
+    }
+    // The interpolation error of an interval h is at most h^2 * |f''| / 8
+    // within a record, and h * |df'| / 4 across a change of slope between two
+    // records. Each one gets half the tolerance.
+    double max_second_derivative = 0.0;
+    double max_slope_change = 0.0;
+    for (auto i = 0u; i < _records.size(); ++i) {
+      const auto &record = _records[i];
+      const double end = (i + 1u < _records.size()) ? _records[i + 1u].s : length;
+      const double span = std::max(end - record.s, 0.0);
+      max_second_derivative = std::max({
+          max_second_derivative,
+          std::abs(2.0 * record.c),
+          std::abs(2.0 * record.c + 6.0 * record.d * span)});
+      if (i > 0u) {
+        const auto before = EvaluateRecord(_records[i - 1u], record.s);
+        const auto after = EvaluateRecord(record, record.s);
+        if (std::abs(after.first - before.first) > tolerance) {
+          // Can't interpolate a jump.
+          return;
+        }
+        max_slope_change = std::max(max_slope_change, std::abs(after.second - before.second));
+      }
+    }
+    double step = MAX_SAMPLE_STEP;
+    if (max_second_derivative > 0.0) {
+      step = std::min(step, std::sqrt(4.0 * tolerance / max_second_derivative));
+    }
+    if (max_slope_change > 0.0) {
+      step = std::min(step, 2.0 * tolerance / max_slope_change);
+    }
+    if (!std::isfinite(step) || (step < MIN_SAMPLE_STEP)) {
+      return;
+    }
+    const auto intervals = static_cast<size_t>(std::ceil(length / step));
+    if (intervals + 1u > MAX_SAMPLES) {
+      return;
+    }
+    const double actual_step = length / static_cast<double>(intervals);
+    _samples.reserve(intervals + 1u);
+    for (auto i = 0u; i <= intervals; ++i) {
+      _samples.emplace_back(EvaluateRecords(static_cast<double>(i) * actual_step).first);
+    }
+    _inverse_step = 1.0 / actual_step;
+    DEBUG_ASSERT(_samples.size() >= 2u);
+  }
+
+} // namespace element
+} // namespace road
+} // namespace carla
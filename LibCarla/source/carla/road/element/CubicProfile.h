@@ -0,0 +1,75 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace road {
+namespace element {
+
+  /// Piecewise cubic function of the distance along a road, as the elevation
+  /// and superelevation profiles of OpenDRIVE. Each record applies from its
+  /// start distance up to the start of the next one,
+  ///
+  ///   f(s) = a + b * ds + c * ds^2 + d * ds^3,  with ds = s - record.s
+  ///
+  /// Evaluating is a binary search over the records, or an index into the
+  /// baked table if there is one.
+  class CubicProfile {
+  public:
+
+    struct Record {
+      double s;
+      double a;
+      double b;
+      double c;
+      double d;
+    };
+
+    /// Records at the same distance keep the order they were added in, the
+    /// last one applies.
+    void Add(const Record &record);
+
+    bool empty() const {
+      return _records.empty();
+    }
+
+    const std::vector<Record> &GetRecords() const {
+      return _records;
+    }
+
+    /// Value (first) and derivative (second) of the profile at @a s. Zero if
+    /// the profile is empty, before the first record the first one is
+    /// extrapolated.
+    std::pair<double, double> Evaluate(double s) const;
+
+    /// Sample the profile at a fixed step in [0, @a length] so that linear
+    /// interpolation is within @a tolerance of the records. No table is built
+    /// if @a tolerance is zero, or if the profile jumps or needs too many
+    /// samples to meet it.
+    void Bake(double length, double tolerance);
+
+    bool IsBaked() const {
+      return !_samples.empty();
+    }
+
+  private:
+
+    std::pair<double, double> EvaluateRecords(double s) const;
+
+    std::vector<Record> _records;
+
+    double _inverse_step = 0.0;
+
+    std::vector<double> _samples;
+  };
+
+} // namespace element
+} // namespace road
+} // namespace carla
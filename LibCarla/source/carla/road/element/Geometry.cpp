@@ -0,0 +1,223 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/element/Geometry.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace carla {
+namespace road {
+namespace element {
+
+  /// Maximum distance between the points sampled along a spiral [meters].
+  static constexpr double SPIRAL_SAMPLE_STEP = 1.0;
+
+  static constexpr unsigned SPIRAL_MAX_ITERATIONS = 32u;
+
+  /// Newton iterations stop when the step is below this [meters].
+  static constexpr double SPIRAL_TOLERANCE = 1e-9;
+
+  /// Below this the change of curvature along a spiral is ignored and it is
+  /// evaluated as an arc [1/meters].
+  static constexpr double SPIRAL_MIN_CURVATURE_CHANGE = 1e-12;
+
+  /// Below this a curvature is considered a straight line [1/meters].
+  static constexpr double SPIRAL_MIN_CURVATURE = 1e-15;
+
+  /// Points processed together by DistancesTo, the inner loop over them
+  /// has no dependencies between iterations so the compiler can vectorize it.
+  static constexpr size_t SPIRAL_BLOCK_SIZE = 8u;
+
+  // ===========================================================================
+  // -- GeometrySpiral ---------------------------------------------------------
+  // ===========================================================================
+
+  void GeometrySpiral::SampleCurve() {
+    if (!(_length > 0.0)) {
+      return;
+    }
+    const auto number_of_samples = 1u + static_cast<size_t>(std::ceil(_length / SPIRAL_SAMPLE_STEP));
+    _sample_s.reserve(number_of_samples);
+    _sample_x.reserve(number_of_samples);
+    _sample_y.reserve(number_of_samples);
+    for (auto i = 0u; i < number_of_samples; ++i) {
+      const double s = _length * i / (number_of_samples - 1u);
+      const auto point = PosFromDist(s);
+      if (!std::isfinite(point.location.x) || !std::isfinite(point.location.y)) {
+        // This curve cannot be evaluated, there is no nearest point.
+        _sample_s.clear();
+        _sample_x.clear();
+        _sample_y.clear();
+        return;
+      }
+      _sample_s.emplace_back(s);
+      _sample_x.emplace_back(point.location.x);
+      _sample_y.emplace_back(point.location.y);
+    }
+  }
+
+  /// Position at @a t along the clothoid of curvature @a rate * t that starts
+  /// at the origin heading along x, given by the Fresnel integrals. A negative
+  /// @a rate turns right, the mirror image of the positive one.
+  static std::pair<double, double> StandardClothoid(const double rate, const double t) {
+    const double scale = std::sqrt(geom::Math::pi() / std::abs(rate));
+    double S, C;
+    fresnl(t / scale, &S, &C);
+    return {scale * C, rate > 0.0 ? scale * S : -scale * S};
+  }
+
+  const DirectedPoint GeometrySpiral::PosFromDist(double dist) const {
+    DEBUG_ASSERT(_length > 0.0);
+    const double k0 = _curve_start;
+    const double rate = _curvature_rate;
+
+    // Displacement in the frame of the start point, heading along x.
+    double x;
+    double y;
+    if (std::abs(rate * _length) < SPIRAL_MIN_CURVATURE_CHANGE) {
+      // Constant curvature, an arc or a line.
+      if (std::abs(k0) < SPIRAL_MIN_CURVATURE) {
+        x = dist;
+        y = 0.0;
+      } else {
+        x = std::sin(k0 * dist) / k0;
+        y = (1.0 - std::cos(k0 * dist)) / k0;
+      }
+    } else {
+      // The piece of the standard clothoid that starts where its curvature
+      // is k0, moved to the origin and rotated to head along x.
+      const double t0 = k0 / rate;
+      const auto start = StandardClothoid(rate, t0);
+      const auto end = StandardClothoid(rate, t0 + dist);
+      const double dx = end.first - start.first;
+      const double dy = end.second - start.second;
+      const double start_tangent = 0.5 * rate * t0 * t0;
+      const double cos_t = std::cos(start_tangent);
+      const double sin_t = std::sin(start_tangent);
+      x = dx * cos_t + dy * sin_t;
+      y = dy * cos_t - dx * sin_t;
+    }
+
+    DirectedPoint p(_start_position, _heading);
+    const double cos_a = std::cos(_heading);
+    const double sin_a = std::sin(_heading);
+    p.location.x += x * cos_a - y * sin_a;
+    p.location.y += x * sin_a + y * cos_a;
+    p.tangent += k0 * dist + 0.5 * rate * dist * dist;
+    return p;
+  }
+
+  long GeometrySpiral::FindNearestSample(const double x, const double y) const {
+    const auto *xs = _sample_x.data();
+    const auto *ys = _sample_y.data();
+    const auto size = _sample_x.size();
+    double nearest = std::numeric_limits<double>::max();
+    long index = -1;
+    for (size_t i = 0u; i < size; ++i) {
+      const double dx = xs[i] - x;
+      const double dy = ys[i] - y;
+      const double d2 = dx * dx + dy * dy;
+      if (d2 < nearest) {
+        nearest = d2;
+        index = static_cast<long>(i);
+      }
+    }
+    return index;
+  }
+
+  std::pair<double, double> GeometrySpiral::RefineDistanceTo(
+      const geom::Location &p,
+      const long sample) const {
+    if (sample < 0) {
+      return {0.0, std::numeric_limits<double>::max()};
+    }
+    const auto last = static_cast<long>(_sample_s.size()) - 1;
+    // The minimum is between the samples next to the nearest one.
+    double lo = _sample_s[std::max(sample - 1, 0l)];
+    double hi = _sample_s[std::min(sample + 1, last)];
+    double s = _sample_s[sample];
+
+    // Newton's method on f(s) = (P(s) - p) . T(s), the derivative of half the
+    // squared distance, falling back to bisection when it leaves [lo, hi].
+    for (auto i = 0u; i < SPIRAL_MAX_ITERATIONS; ++i) {
+      const auto point = PosFromDist(s);
+      const double dx = point.location.x - p.x;
+      const double dy = point.location.y - p.y;
+      const double cos_t = std::cos(point.tangent);
+      const double sin_t = std::sin(point.tangent);
+      const double f = dx * cos_t + dy * sin_t;
+      if (f > 0.0) {
+        hi = s;
+      } else {
+        lo = s;
+      }
+      // f'(s) = T . T + (P(s) - p) . N(s) * curvature(s)
+      const double curvature = _curve_start + _curvature_rate * s;
+      const double df = 1.0 + (dy * cos_t - dx * sin_t) * curvature;
+      double next = df > 0.0 ? s - f / df : 0.5 * (lo + hi);
+      if (!(next > lo) || !(next < hi)) {
+        next = 0.5 * (lo + hi);
+      }
+      const bool converged = std::abs(next - s) < SPIRAL_TOLERANCE;
+      s = next;
+      if (converged) {
+        break;
+      }
+    }
+
+    const double dist = geom::Math::Distance2D(PosFromDist(s).location, p);
+    const double sample_dist = geom::Math::Distance2D(PosFromDist(_sample_s[sample]).location, p);
+    return dist <= sample_dist ?
+        std::make_pair(s, dist) :
+        std::make_pair(_sample_s[sample], sample_dist);
+  }
+
+  std::pair<double, double> GeometrySpiral::DistanceTo(const geom::Location &p) const {
+    return RefineDistanceTo(p, FindNearestSample(p.x, p.y));
+  }
+
+  void GeometrySpiral::DistancesTo(
+      const geom::Location *points,
+      const size_t count,
+      std::pair<double, double> *out) const {
+    const auto *xs = _sample_x.data();
+    const auto *ys = _sample_y.data();
+    const auto size = _sample_x.size();
+    for (size_t begin = 0u; begin < count; begin += SPIRAL_BLOCK_SIZE) {
+      const auto block_size = std::min(SPIRAL_BLOCK_SIZE, count - begin);
+      double x[SPIRAL_BLOCK_SIZE];
+      double y[SPIRAL_BLOCK_SIZE];
+      double nearest[SPIRAL_BLOCK_SIZE];
+      long index[SPIRAL_BLOCK_SIZE];
+      for (size_t j = 0u; j < SPIRAL_BLOCK_SIZE; ++j) {
+        const auto &point = points[begin + std::min(j, block_size - 1u)];
+        x[j] = point.x;
+        y[j] = point.y;
+        nearest[j] = std::numeric_limits<double>::max();
+        index[j] = -1;
+      }
+      for (size_t i = 0u; i < size; ++i) {
+        const double sample_x = xs[i];
+        const double sample_y = ys[i];
+        for (size_t j = 0u; j < SPIRAL_BLOCK_SIZE; ++j) {
+          const double dx = sample_x - x[j];
+          const double dy = sample_y - y[j];
+          const double d2 = dx * dx + dy * dy;
+          const bool is_nearer = d2 < nearest[j];
+          nearest[j] = is_nearer ? d2 : nearest[j];
+          index[j] = is_nearer ? static_cast<long>(i) : index[j];
+        }
+      }
+      for (size_t j = 0u; j < block_size; ++j) {
+        out[begin + j] = RefineDistanceTo(points[begin + j], index[j]);
+      }
+    }
+  }
+
+} // namespace element
+} // namespace road
+} // namespace carla
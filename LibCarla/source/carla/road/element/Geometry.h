@@ -12,6 +12,8 @@
 #include "carla/road/element/cephes/fresnel.h"
 
 #include <cmath>
+#include <utility>
+#include <vector>
 
 namespace carla {
 namespace road {
@@ -37,6 +39,11 @@ namespace element {
 
     geom::Location location = {0, 0, 0};
     double tangent = 0; // [radians]
+    /// Slope of the road along the tangent, positive uphill [radians].
+    double pitch = 0;
+    /// Superelevation of the road, positive if it falls to the right of the
+    /// tangent [radians].
+    double roll = 0;
     bool valid = true;
 
     static DirectedPoint Invalid() {
@@ -45,12 +52,15 @@ namespace element {
       return d;
     }
 
+    /// Move the point @a lateral_offset meters along the cross section of the
+    /// road, which is tilted by the roll.
     void ApplyLateralOffset(double lateral_offset) {
-      /// @todo Z axis??
       auto normal_x =  std::sin(tangent);
       auto normal_y = -std::cos(tangent);
-      location.x += lateral_offset * normal_x;
-      location.y += lateral_offset * normal_y;
+      const auto horizontal_offset = lateral_offset * std::cos(roll);
+      location.x += horizontal_offset * normal_x;
+      location.y += horizontal_offset * normal_y;
+      location.z += lateral_offset * std::sin(roll);
     }
 
     friend bool operator==(const DirectedPoint &lhs, const DirectedPoint &rhs) {
@@ -74,7 +84,7 @@ namespace element {
       return _heading;
     }
 
-    const geom::Location &GetStartPosition() {
+    const geom::Location &GetStartPosition() const {
       return _start_position;
     }
 
@@ -84,6 +94,17 @@ namespace element {
 
     virtual std::pair<double, double> DistanceTo(const geom::Location &p) const = 0;
 
+    /// Batched version of DistanceTo, writes to @a out the result for each of
+    /// the @a count locations in @a points.
+    virtual void DistancesTo(
+        const geom::Location *points,
+        size_t count,
+        std::pair<double, double> *out) const {
+      for (size_t i = 0u; i < count; ++i) {
+        out[i] = DistanceTo(points[i]);
+      }
+    }
+
   protected:
 
     Geometry(
@@ -110,7 +131,7 @@ namespace element {
     geom::Location _start_position; // [meters]
   };
 
-  class GeometryLine : public Geometry {
+  class GeometryLine final : public Geometry {
   public:
 
     GeometryLine(
@@ -123,7 +144,14 @@ namespace element {
     const DirectedPoint PosFromDist(const double dist) const override {
       assert(dist > 0);
       assert(_length > 0.0);
-      DirectedPoint p(_start_position, _heading);
+      return PosFromDist(_start_position, _heading, dist);
+    }
+
+    static DirectedPoint PosFromDist(
+        const geom::Location &start_pos,
+        const double heading,
+        const double dist) {
+      DirectedPoint p(start_pos, heading);
       p.location.x += dist * std::cos(p.tangent);
       p.location.y += dist * std::sin(p.tangent);
       return p;
@@ -143,7 +171,7 @@ namespace element {
 
   };
 
-  class GeometryArc : public Geometry {
+  class GeometryArc final : public Geometry {
   public:
 
     GeometryArc(
@@ -158,12 +186,20 @@ namespace element {
     const DirectedPoint PosFromDist(double dist) const override {
       assert(dist > 0);
       assert(_length > 0.0);
-      assert(std::fabs(_curvature) > 1e-15);
-      const double radius = 1.0 / _curvature;
-      DirectedPoint p(_start_position, _heading);
+      return PosFromDist(_start_position, _heading, _curvature, dist);
+    }
+
+    static DirectedPoint PosFromDist(
+        const geom::Location &start_pos,
+        const double heading,
+        const double curvature,
+        const double dist) {
+      assert(std::fabs(curvature) > 1e-15);
+      const double radius = 1.0 / curvature;
+      DirectedPoint p(start_pos, heading);
       p.location.x -= radius * std::cos(p.tangent + geom::Math::pi_half());
       p.location.y -= radius * std::sin(p.tangent + geom::Math::pi_half());
-      p.tangent -= dist * _curvature;
+      p.tangent -= dist * curvature;
       p.location.x += radius * std::cos(p.tangent + geom::Math::pi_half());
       p.location.y += radius * std::sin(p.tangent + geom::Math::pi_half());
       return p;
@@ -183,7 +219,7 @@ namespace element {
           _curvature);
     }
 
-    double GetCurvature() {
+    double GetCurvature() const {
       return _curvature;
     }
 
@@ -192,7 +228,7 @@ namespace element {
     double _curvature;
   };
 
-  class GeometrySpiral : public Geometry {
+  class GeometrySpiral final : public Geometry {
   public:
 
     GeometrySpiral(
@@ -204,49 +240,61 @@ namespace element {
         double curv_e)
       : Geometry(GeometryType::SPIRAL, start_offset, length, heading, start_pos),
         _curve_start(curv_s),
-        _curve_end(curv_e) {}
+        _curve_end(curv_e),
+        _curvature_rate(length > 0.0 ? (curv_e - curv_s) / length : 0.0) {
+      SampleCurve();
+    }
 
-    double GetCurveStart() {
+    double GetCurveStart() const {
       return _curve_start;
     }
 
-    double GetCurveEnd() {
+    double GetCurveEnd() const {
       return _curve_end;
     }
 
-    const DirectedPoint PosFromDist(double dist) const override {
-      // not working yet with negative values
-      assert(dist > 0);
-      assert(_length > 0.0);
-      assert(std::fabs(_curve_end) > 1e-15);
-      const double radius = 1.0 / _curve_end;
-      const double extra_norm = 1.0 / std::sqrt(geom::Math::pi_half());
-      const double norm = 1.0 / std::sqrt(2.0 * radius * _length);
-      const double length = dist * norm;
-      double S, C;
-      fresnl(length * extra_norm, &S, &C);
-      S /= (norm * extra_norm);
-      C /= (norm * extra_norm);
-      DirectedPoint p(_start_position, _heading);
-      const double cos_a = std::cos(p.tangent);
-      const double sin_a = std::sin(p.tangent);
-      p.location.x += C * cos_a - S * sin_a;
-      p.location.y += S * cos_a + C * sin_a;
-      p.tangent += length * length;
+    /// Point at @a dist along the clothoid, its curvature changes linearly
+    /// from the start curvature to the end curvature. Either may be zero or
+    /// negative (turning right).
+    const DirectedPoint PosFromDist(double dist) const override;
 
-      return p;
-    }
+    /// Returns a pair containing:
+    /// - @b first:  distance to the nearest point in this spiral from the
+    ///              begining of the shape.
+    /// - @b second: Euclidean distance from the nearest point in this spiral
+    ///              to p.
+    ///   @param p point to calculate the distance
+    ///
+    /// The nearest of a set of points sampled along the spiral brackets the
+    /// solution, refined with Newton iterations.
+    std::pair<double, double> DistanceTo(const geom::Location &p) const override;
 
-    /// @todo
-    std::pair<double, double> DistanceTo(const geom::Location &) const override {
-      DEBUG_ERROR;
-      return {0.0, 0.0};
-    }
+    void DistancesTo(
+        const geom::Location *points,
+        size_t count,
+        std::pair<double, double> *out) const override;
 
   private:
 
+    /// Sample the curve for DistanceTo.
+    void SampleCurve();
+
+    /// Nearest sample to (x, y), or -1 if there are no samples.
+    long FindNearestSample(double x, double y) const;
+
+    std::pair<double, double> RefineDistanceTo(const geom::Location &p, long sample) const;
+
     double _curve_start;
     double _curve_end;
+
+    /// Change of curvature per meter.
+    double _curvature_rate;
+
+    /// Points sampled along the curve, as separate arrays to help vectorize
+    /// the search of the nearest one.
+    std::vector<double> _sample_s;
+    std::vector<double> _sample_x;
+    std::vector<double> _sample_y;
   };
 
 } // namespace element
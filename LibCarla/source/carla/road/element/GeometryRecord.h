@@ -0,0 +1,130 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/road/element/Geometry.h"
+
+#include <limits>
+#include <memory>
+
+namespace carla {
+namespace road {
+namespace element {
+
+  /// Geometry of a road segment stored by value. The road segments keep
+  /// their geometries as a contiguous array of these, evaluated with a switch
+  /// on the type instead of a virtual call through a pointer to the heap.
+  class GeometryRecord {
+  public:
+
+    /// Takes the place of @a geometry, only spirals are kept.
+    explicit GeometryRecord(std::unique_ptr<Geometry> geometry)
+      : _type(geometry->GetType()),
+        _start_offset(geometry->GetStartOffset()),
+        _length(geometry->GetLength()),
+        _heading(geometry->GetHeading()),
+        _start_position(geometry->GetStartPosition()) {
+      switch (_type) {
+        case GeometryType::LINE:
+          _end_position = GeometryLine::PosFromDist(_start_position, _heading, _length).location;
+          break;
+        case GeometryType::ARC:
+          _curvature = static_cast<const GeometryArc &>(*geometry).GetCurvature();
+          break;
+        case GeometryType::SPIRAL:
+          _spiral.reset(static_cast<const GeometrySpiral *>(geometry.release()));
+          break;
+      }
+    }
+
+    GeometryType GetType() const {
+      return _type;
+    }
+
+    double GetStartOffset() const {
+      return _start_offset;
+    }
+
+    double GetLength() const {
+      return _length;
+    }
+
+    double GetHeading() const {
+      return _heading;
+    }
+
+    const geom::Location &GetStartPosition() const {
+      return _start_position;
+    }
+
+    /// Curvature of an arc.
+    double GetCurvature() const {
+      DEBUG_ASSERT(_type == GeometryType::ARC);
+      return _curvature;
+    }
+
+    /// The geometry of a spiral.
+    const GeometrySpiral &GetSpiral() const {
+      DEBUG_ASSERT(_type == GeometryType::SPIRAL);
+      return *_spiral;
+    }
+
+    /// Same as Geometry::PosFromDist.
+    DirectedPoint PosFromDist(const double dist) const {
+      assert(dist > 0);
+      assert(_length > 0.0);
+      switch (_type) {
+        case GeometryType::LINE:
+          return GeometryLine::PosFromDist(_start_position, _heading, dist);
+        case GeometryType::ARC:
+          return GeometryArc::PosFromDist(_start_position, _heading, _curvature, dist);
+        case GeometryType::SPIRAL:
+          return _spiral->PosFromDist(dist);
+      }
+      return DirectedPoint::Invalid();
+    }
+
+    /// Same as Geometry::DistanceTo.
+    std::pair<double, double> DistanceTo(const geom::Location &p) const {
+      switch (_type) {
+        case GeometryType::LINE:
+          return geom::Math::DistSegmentPoint(p, _start_position, _end_position);
+        case GeometryType::ARC:
+          return geom::Math::DistArcPoint(p, _start_position, _length, _heading, _curvature);
+        case GeometryType::SPIRAL:
+          return _spiral->DistanceTo(p);
+      }
+      return {0.0, std::numeric_limits<double>::max()};
+    }
+
+  private:
+
+    GeometryType _type;
+
+    double _start_offset;
+
+    double _length;
+
+    double _heading;
+
+    geom::Location _start_position;
+
+    /// End of a line.
+    geom::Location _end_position;
+
+    /// Curvature of an arc.
+    double _curvature = 0.0;
+
+    /// Spirals are evaluated by their Geometry, DistanceTo needs the samples
+    /// it keeps along the curve.
+    std::unique_ptr<const GeometrySpiral> _spiral;
+  };
+
+} // namespace element
+} // namespace road
+} // namespace carla
@@ -7,8 +7,11 @@
 #include "carla/road/element/LaneCrossingCalculator.h"
 
 #include "carla/geom/Location.h"
+#include "carla/geom/Math.h"
 #include "carla/road/Map.h"
 
+#include <limits>
+
 namespace carla {
 namespace road {
 namespace element {
@@ -33,6 +36,10 @@ namespace element {
     }
   }
 
+  // ===========================================================================
+  // -- LaneCrossingCalculator -------------------------------------------------
+  // ===========================================================================
+
   static bool IsOffRoad(const Map &map, const geom::Location &location) {
     return !map.GetWaypoint(location).has_value();
   }
@@ -57,6 +64,100 @@ namespace element {
         IsOffRoad(map, destination));
   }
 
+  // ===========================================================================
+  // -- LaneCrossingTracker ----------------------------------------------------
+  // ===========================================================================
+
+  void LaneCrossingTracker::Move(
+      const Map &map,
+      const geom::Location &destination,
+      std::vector<LaneMarking> &out) {
+    Position position;
+    if (_has_position && FindNearby(map, destination, position)) {
+      ++_hit_count;
+    } else {
+      position = FindInMap(map, destination);
+      ++_miss_count;
+    }
+    if (_has_position &&
+        (_position.road_id == position.road_id) &&
+        !_position.is_intersection &&
+        !position.is_intersection) {
+      const auto crossed = CrossingAtSameSection(
+          _position.lane_id,
+          position.lane_id,
+          _position.is_offroad,
+          position.is_offroad);
+      out.insert(out.end(), crossed.begin(), crossed.end());
+    }
+    _position = position;
+    _has_position = true;
+  }
+
+  bool LaneCrossingTracker::FindNearby(
+      const Map &map,
+      const geom::Location &location,
+      Position &out) const {
+    const auto *road = map.GetData().GetRoad(_position.road_id);
+    if (road == nullptr) {
+      return false;
+    }
+
+    const RoadSegment *nearest_road = nullptr;
+    int nearest_lane_id = 0;
+    double nearest_s = 0.0;
+    double nearest_distance = std::numeric_limits<double>::max();
+    auto visit = [&](const RoadSegment &candidate) {
+      const auto point = candidate.GetNearestPoint(location);
+      const auto lane = candidate.GetNearestLane(point.first, location);
+      if ((lane.first != 0) && (lane.second < nearest_distance)) {
+        nearest_road = &candidate;
+        nearest_lane_id = lane.first;
+        nearest_s = point.first;
+        nearest_distance = lane.second;
+      }
+    };
+    visit(*road);
+    for (auto *successor : road->GetSuccessors()) {
+      visit(*successor);
+    }
+    for (auto *predecessor : road->GetPredecessors()) {
+      visit(*predecessor);
+    }
+    if (nearest_road == nullptr) {
+      return false;
+    }
+
+    // Only a hit if the location lies on the lane, otherwise it may be off
+    // road or on a road further away.
+    const auto *lanes = nearest_road->GetInfo<RoadInfoLane>(nearest_s);
+    const auto *lane = lanes != nullptr ? lanes->getLane(nearest_lane_id) : nullptr;
+    if ((lane == nullptr) || (nearest_distance >= lane->_width * 0.5)) {
+      return false;
+    }
+    const auto *general = nearest_road->GetInfo<RoadGeneralInfo>(nearest_s);
+    out.road_id = nearest_road->GetId();
+    out.lane_id = nearest_lane_id;
+    out.is_offroad = false;
+    out.is_intersection = (general != nullptr) && general->IsJunction();
+    return true;
+  }
+
+  LaneCrossingTracker::Position LaneCrossingTracker::FindInMap(
+      const Map &map,
+      const geom::Location &location) {
+    // A single query instead of the two of Calculate, GetWaypoint is the
+    // closest waypoint if the location is within its lane.
+    const auto waypoint = map.GetClosestWaypointOnRoad(location);
+    const auto distance = geom::Math::Distance2D(waypoint.ComputeTransform().location, location);
+    Position position;
+    position.road_id = waypoint.GetRoadId();
+    position.lane_id = waypoint.GetLaneId();
+    position.is_offroad = !(distance < waypoint.GetLaneWidth() * 0.5);
+    position.is_intersection = waypoint.IsIntersection();
+    return position;
+  }
+
 } // namespace element
 } // namespace road
 } // namespace carla
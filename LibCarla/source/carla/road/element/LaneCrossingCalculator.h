@@ -7,6 +7,7 @@
 #pragma once
 
 #include "carla/road/element/LaneMarking.h"
+#include "carla/road/element/Types.h"
 
 #include <vector>
 
@@ -27,6 +28,64 @@ namespace element {
         const geom::Location &destination);
   };
 
+  /// Incremental version of LaneCrossingCalculator for a point that moves a
+  /// short distance each step, like the corner of a vehicle.
+  ///
+  /// The road and lane of the point are kept between steps. The next
+  /// location is searched first in that road and the roads connected to it,
+  /// and only if it does not lie on any of their lanes the whole map is
+  /// queried. Where roads overlap the nearby road is preferred, otherwise the
+  /// result is the same as LaneCrossingCalculator::Calculate.
+  class LaneCrossingTracker {
+  public:
+
+    /// Move the point to @a destination, appending to @a out the lane
+    /// markings crossed since the previous location. The first call only
+    /// sets the location.
+    void Move(
+        const Map &map,
+        const geom::Location &destination,
+        std::vector<LaneMarking> &out);
+
+    /// Forget the location of the point.
+    void Reset() {
+      _has_position = false;
+    }
+
+    /// Number of locations found in the nearby roads.
+    size_t GetHitCount() const {
+      return _hit_count;
+    }
+
+    /// Number of locations that required querying the whole map.
+    size_t GetMissCount() const {
+      return _miss_count;
+    }
+
+  private:
+
+    struct Position {
+      id_type road_id = 0u;
+      int lane_id = 0;
+      bool is_offroad = true;
+      bool is_intersection = false;
+    };
+
+    /// Search @a location in the lanes of the current road and its
+    /// successors and predecessors.
+    bool FindNearby(const Map &map, const geom::Location &location, Position &out) const;
+
+    static Position FindInMap(const Map &map, const geom::Location &location);
+
+    bool _has_position = false;
+
+    Position _position;
+
+    size_t _hit_count = 0u;
+
+    size_t _miss_count = 0u;
+  };
+
 } // namespace element
 } // namespace road
 } // namespace carla
@@ -0,0 +1,80 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/ListView.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace road {
+namespace element {
+
+  /// Lanes linked to each lane of a road segment, as pairs of lane id and
+  /// road id. The links of every lane are stored in a single array so they
+  /// can be returned as a view instead of copying them.
+  class LaneLinkTable {
+  public:
+
+    using value_type = std::pair<int, int>;
+
+    using view_type = ListView<const value_type *>;
+
+    LaneLinkTable() = default;
+
+    explicit LaneLinkTable(const std::map<int, std::vector<value_type>> &links) {
+      _lanes.reserve(links.size());
+      for (auto &&lane : links) {
+        const auto begin = _links.size();
+        _links.insert(_links.end(), lane.second.begin(), lane.second.end());
+        _lanes.emplace_back(Lane{lane.first, begin, _links.size()});
+      }
+    }
+
+    /// Links of @a lane_id, empty if it has none.
+    view_type Get(const int lane_id) const {
+      auto it = std::lower_bound(_lanes.begin(), _lanes.end(), lane_id,
+          [](const Lane &lane, int id) { return lane.id < id; });
+      if ((it == _lanes.end()) || (it->id != lane_id)) {
+        return view_type(nullptr, nullptr);
+      }
+      return view_type(_links.data() + it->begin, _links.data() + it->end);
+    }
+
+    /// Number of lanes with links.
+    size_t size() const {
+      return _lanes.size();
+    }
+
+    /// Call @a callback with the id and the links of each lane, sorted by id.
+    template <typename F>
+    void ForEach(F &&callback) const {
+      for (auto &&lane : _lanes) {
+        callback(lane.id, view_type(_links.data() + lane.begin, _links.data() + lane.end));
+      }
+    }
+
+  private:
+
+    struct Lane {
+      int id;
+      size_t begin;
+      size_t end;
+    };
+
+    /// Sorted by id.
+    std::vector<Lane> _lanes;
+
+    std::vector<value_type> _links;
+  };
+
+} // namespace element
+} // namespace road
+} // namespace carla
@@ -0,0 +1,88 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace carla {
+namespace road {
+namespace element {
+
+  /// Lane types defined by OpenDRIVE 1.4.
+  enum class LaneType : uint8_t {
+    None,
+    Driving,
+    Stop,
+    Shoulder,
+    Biking,
+    Sidewalk,
+    Border,
+    Restricted,
+    Parking,
+    Bidirectional,
+    Median,
+    Special1,
+    Special2,
+    Special3,
+    RoadWorks,
+    Tram,
+    Rail,
+    Entry,
+    Exit,
+    OffRamp,
+    OnRamp,
+    Unknown
+  };
+
+  /// Name of each LaneType as it appears in OpenDRIVE files.
+  static constexpr const char *LANE_TYPE_NAMES[] = {
+    "none",
+    "driving",
+    "stop",
+    "shoulder",
+    "biking",
+    "sidewalk",
+    "border",
+    "restricted",
+    "parking",
+    "bidirectional",
+    "median",
+    "special1",
+    "special2",
+    "special3",
+    "roadWorks",
+    "tram",
+    "rail",
+    "entry",
+    "exit",
+    "offRamp",
+    "onRamp",
+    "unknown"
+  };
+
+  static_assert(
+      sizeof(LANE_TYPE_NAMES) / sizeof(*LANE_TYPE_NAMES) == static_cast<size_t>(LaneType::Unknown) + 1u,
+      "Missing names of lane types.");
+
+  inline const char *ToString(const LaneType type) {
+    return LANE_TYPE_NAMES[static_cast<size_t>(type)];
+  }
+
+  /// LaneType named @a name, or LaneType::Unknown if none is.
+  inline LaneType LaneTypeFromString(const char *name) {
+    for (size_t i = 0u; i < static_cast<size_t>(LaneType::Unknown); ++i) {
+      if (std::strcmp(name, LANE_TYPE_NAMES[i]) == 0) {
+        return static_cast<LaneType>(i);
+      }
+    }
+    return LaneType::Unknown;
+  }
+
+} // namespace element
+} // namespace road
+} // namespace carla
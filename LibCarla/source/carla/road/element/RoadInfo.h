@@ -6,8 +6,13 @@
 
 #pragma once
 
+#include "carla/ListView.h"
+#include "carla/road/element/LaneType.h"
 #include "carla/road/element/RoadInfoVisitor.h"
 
+#include <boost/iterator/transform_iterator.hpp>
+
+#include <algorithm>
 #include <string>
 #include <map>
 
@@ -92,16 +97,17 @@ namespace element {
     double _width;
     double _lane_center_offset;
 
-    std::string _type;
+    LaneType _type;
     std::vector<int> _successor;
     std::vector<int> _predecessor;
 
     LaneInfo()
       : _id(0),
         _width(0.0),
-        _lane_center_offset(0.0) {}
+        _lane_center_offset(0.0),
+        _type(LaneType::None) {}
 
-    LaneInfo(int id, double width, const std::string &type)
+    LaneInfo(int id, double width, LaneType type)
       : _id(id),
         _width(width),
         _lane_center_offset(0.0),
@@ -128,7 +134,7 @@ namespace element {
       Both
     };
 
-    void addLaneInfo(int id, double width, const std::string &type) {
+    void addLaneInfo(int id, double width, LaneType type) {
       _lanes[id] = LaneInfo(id, width, type);
     }
 
@@ -173,6 +179,15 @@ namespace element {
       return lanes_id;
     }
 
+    /// Lanes sorted by id, as getLanesIDs(which_lane_e::Both), without
+    /// allocating a list.
+    auto GetLanes() const {
+      auto get = [](const lane_t::value_type &pair) -> const LaneInfo & { return pair.second; };
+      return MakeListView(
+          boost::make_transform_iterator(_lanes.cbegin(), get),
+          boost::make_transform_iterator(_lanes.cend(), get));
+    }
+
     const LaneInfo *getLane(int id) const {
       lane_t::const_iterator it = _lanes.find(id);
       return it == _lanes.end() ? nullptr : &it->second;
@@ -6,38 +6,76 @@
 
 #pragma once
 
+#include "carla/ListView.h"
 #include "carla/NonCopyable.h"
 #include "carla/geom/Location.h"
+#include "carla/road/element/ArcLengthTable.h"
+#include "carla/road/element/CubicProfile.h"
+#include "carla/road/element/GeometryRecord.h"
+#include "carla/road/element/LaneLinkTable.h"
 #include "carla/road/element/RoadInfo.h"
 #include "carla/road/element/Types.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <limits>
 #include <memory>
-#include <set>
 #include <vector>
 
 namespace carla {
 namespace road {
 
   class MapBuilder;
+  class MapSerializer;
+  class SpatialIndex;
 
 namespace element {
 
-  class RoadSegment : private NonCopyable {
+  /// Index of each type of RoadInfo in RoadSegment::_info_by_type.
+  template <typename T>
+  struct RoadInfoTypeIndex;
+
+  template <>
+  struct RoadInfoTypeIndex<RoadInfoLane> {
+    static constexpr size_t value = 0u;
+  };
+
+  template <>
+  struct RoadInfoTypeIndex<RoadGeneralInfo> {
+    static constexpr size_t value = 1u;
+  };
+
+  template <>
+  struct RoadInfoTypeIndex<RoadInfoVelocity> {
+    static constexpr size_t value = 2u;
+  };
+
+  class RoadSegment : private MovableNonCopyable {
   public:
 
     RoadSegment(id_type id) : _id(id) {}
 
+    /// Takes the geometries, infos, profiles and lane links of @a def. The
+    /// links to other road segments are added by the MapBuilder.
     RoadSegment(RoadSegmentDefinition &&def)
       : _id(def.GetId()),
-        _successors_is_start(std::move(def._successor_is_start)),
-        _predecessors_is_start(std::move(def._predecessors_is_start)),
-        _geom(std::move(def._geom)),
-        _next_lane(std::move(def._next_lane)),
-        _prev_lane(std::move(def._prev_lane)) {
-      for (auto &&a : def._info) {
-        _info.insert(std::move(a));
+        _info(std::move(def._info)),
+        _elevation(std::move(def._elevation)),
+        _superelevation(std::move(def._superelevation)),
+        _next_lane(def._next_lane),
+        _prev_lane(def._prev_lane) {
+      _geometries.reserve(def._geom.size());
+      for (auto &&geometry : def._geom) {
+        _geometries.emplace_back(std::move(geometry));
       }
+      def._geom.clear();
+      // GetPlanarPointIn does a binary search by start offset.
+      std::stable_sort(_geometries.begin(), _geometries.end(),
+          [](const GeometryRecord &a, const GeometryRecord &b) {
+            return a.GetStartOffset() < b.GetStartOffset();
+          });
+      SortInfo();
     }
 
     id_type GetId() const {
@@ -48,18 +86,16 @@ namespace element {
     /// the start of the road (negative lanes)
     template <typename T>
     const T *GetInfo(double dist) const {
-      auto up_bound = decltype(_info)::reverse_iterator(_info.upper_bound(dist));
-      auto it = MakeRoadInfoIterator<T>(up_bound, _info.rend());
-      return it.IsAtEnd() ? nullptr : *it;
+      return FindInfo<T>(dist);
     }
 
     /// Returns single info given a type and a distance from
     /// the end of the road (positive lanes)
     template <typename T>
     const T *GetInfoReverse(double dist) const {
-      auto lo_bound = _info.lower_bound(dist);
-      auto it = MakeRoadInfoIterator<T>(lo_bound, _info.end());
-      return it.IsAtEnd() ? nullptr : *it;
+      const auto &infos = _info_by_type[RoadInfoTypeIndex<T>::value];
+      auto it = std::lower_bound(infos.begin(), infos.end(), dist, InfoEntry::Less());
+      return it == infos.end() ? nullptr : static_cast<const T *>(it->info);
     }
 
     // returns info vector given a type and a distance
@@ -69,12 +105,14 @@ namespace element {
       return std::vector<std::shared_ptr<const RoadInfo>>();
     }
 
-    void PredEmplaceBack(RoadSegment *s) {
+    void PredEmplaceBack(RoadSegment *s, bool is_start) {
       _predecessors.emplace_back(s);
+      _predecessors_is_start.emplace_back(is_start);
     }
 
-    void SuccEmplaceBack(RoadSegment *s) {
+    void SuccEmplaceBack(RoadSegment *s, bool is_start) {
       _successors.emplace_back(s);
+      _successors_is_start.emplace_back(is_start);
     }
 
     bool HaveSuccessors() const {
@@ -109,69 +147,68 @@ namespace element {
       return _predecessors_is_start;
     }
 
-    const std::vector<RoadSegment *> GetSuccessors() const {
-      return _successors;
+    auto GetSuccessors() const {
+      return MakeListView(_successors.cbegin(), _successors.cend());
     }
 
-    const std::vector<RoadSegment *> GetPredecessors() const {
-      return _predecessors;
+    auto GetPredecessors() const {
+      return MakeListView(_predecessors.cbegin(), _predecessors.cend());
     }
 
-    /// Given the current lane it gives an std::pair vector with the lane id and road
-    /// id where you can go. First integer of the pair is the lane id and the second
-    /// the road id.
+    /// Given the current lane it gives a list of pairs with the lane id and
+    /// road id where you can go. First integer of the pair is the lane id and
+    /// the second the road id.
     ///
     /// @param current_lane_id                for which lane do you want the next
     ///
     /// OUTPUT:
-    ///    std::vector<std::pair<int, int>>   return a pair with lane id (first
-    ///                                       int) and the road id (second int),
-    ///                                       if no lane has been found the given
-    ///                                       pair it will be (0, 0) as lane id
-    ///                                       zero used for the reference line
-    std::vector<std::pair<int, int>> GetNextLane(int current_lane_id) const {
-      std::map<int, std::vector<std::pair<int, int>>>::const_iterator it = _next_lane.find(current_lane_id);
-      return it == _next_lane.end() ? std::vector<std::pair<int, int>>() : it->second;
+    ///    ListView of std::pair<int, int>    pairs with lane id (first int) and
+    ///                                       the road id (second int), empty if
+    ///                                       no lane has been found. The view
+    ///                                       points to the segment, no copy is
+    ///                                       made.
+    LaneLinkTable::view_type GetNextLane(int current_lane_id) const {
+      return _next_lane.Get(current_lane_id);
     }
 
-    /// Given the current lane it gives an std::pair vector with the lane id and road
-    /// id where you can go. First integer of the pair is the lane id and the second
-    /// the road id.
+    /// Given the current lane it gives a list of pairs with the lane id and
+    /// road id where you can go. First integer of the pair is the lane id and
+    /// the second the road id.
     ///
     /// @param current_lane_id                for which lane do you want the next
     ///
     /// OUTPUT:
-    ///    std::vector<std::pair<int, int>>   return a pair with lane id (first
-    ///                                       int) and the road id (second int),
-    ///                                       if no lane has been found the given
-    ///                                       pair it will be (0, 0) as lane id
-    ///                                       zero used for the reference line
-    std::vector<std::pair<int, int>> GetPrevLane(int current_lane_id) const {
-      std::map<int, std::vector<std::pair<int, int>>>::const_iterator it = _prev_lane.find(current_lane_id);
-      return it == _prev_lane.end() ? std::vector<std::pair<int, int>>() : it->second;
+    ///    ListView of std::pair<int, int>    pairs with lane id (first int) and
+    ///                                       the road id (second int), empty if
+    ///                                       no lane has been found. The view
+    ///                                       points to the segment, no copy is
+    ///                                       made.
+    LaneLinkTable::view_type GetPrevLane(int current_lane_id) const {
+      return _prev_lane.Get(current_lane_id);
     }
 
-    // Search for the last geometry with less start_offset before 'dist'
+    /// Point of the reference line at @a dist, with its elevation, pitch and
+    /// roll given by the profiles of the road.
     DirectedPoint GetDirectedPointIn(double dist) const {
-      assert(_length > 0.0);
-      if (dist <= 0.0) {
-        return DirectedPoint(_geom.front()->GetStartPosition(),
-            _geom.front()->GetHeading());
+      auto point = GetPlanarPointIn(dist);
+      const double s = std::min(std::max(dist, 0.0), _length);
+      if (!_elevation.empty()) {
+        const auto elevation = _elevation.Evaluate(s);
+        point.location.z += static_cast<float>(elevation.first);
+        point.pitch = std::atan(elevation.second);
       }
-
-      if (dist >= _length) {
-        return _geom.back()->PosFromDist(
-            _length - _geom.back()->GetStartOffset());
+      if (!_superelevation.empty()) {
+        point.roll = _superelevation.Evaluate(s).first;
       }
+      return point;
+    }
 
-      for (auto &&g : _geom) {
-        if ((g->GetStartOffset() < dist) &&
-            (dist <= (g->GetStartOffset() + g->GetLength()))) {
-          return g->PosFromDist(dist - g->GetStartOffset());
-        }
-      }
+    const CubicProfile &GetElevationProfile() const {
+      return _elevation;
+    }
 
-      return _geom.back()->PosFromDist(dist - _geom.back()->GetStartOffset());
+    const CubicProfile &GetSuperelevationProfile() const {
+      return _superelevation;
     }
 
     /// Returns a pair containing:
@@ -181,19 +218,19 @@ namespace element {
     ///              this road segment to p.
     ///   @param loc point to calculate the distance
     std::pair<double, double> GetNearestPoint(const geom::Location &loc) const {
-      decltype(_geom)::const_iterator nearest_geom;
+      decltype(_geometries)::const_iterator nearest_geom;
       std::pair<double, double> last = {0.0, std::numeric_limits<double>::max()};
 
-      for (auto g = _geom.begin(); g != _geom.end(); ++g) {
-        auto d = (*g)->DistanceTo(loc);
+      for (auto g = _geometries.begin(); g != _geometries.end(); ++g) {
+        auto d = g->DistanceTo(loc);
         if (d.second < last.second) {
           last = d;
           nearest_geom = g;
         }
       }
 
-      for (auto g = _geom.begin(); g != nearest_geom; ++g) {
-        last.first += (*g)->GetLength();
+      for (auto g = _geometries.begin(); g != nearest_geom; ++g) {
+        last.first += g->GetLength();
       }
 
       return last;
@@ -210,18 +247,15 @@ namespace element {
       int nearest_lane_id = 0;
       double nearest_dist = std::numeric_limits<double>::max();
 
-      for (auto &&current_lane_id :
-          info->getLanesIDs(carla::road::element::RoadInfoLane::which_lane_e::Both)) {
-        const auto current_lane_info = info->getLane(current_lane_id);
-
-        if (current_lane_info->_type == "driving") {
+      for (auto &&current_lane_info : info->GetLanes()) {
+        if (current_lane_info._type == LaneType::Driving) {
           DirectedPoint dp_center_lane = dp_center_road;
-          dp_center_lane.ApplyLateralOffset(current_lane_info->_lane_center_offset);
+          dp_center_lane.ApplyLateralOffset(current_lane_info._lane_center_offset);
 
           const double current_dist = geom::Math::Distance2D(dp_center_lane.location, loc);
           if (current_dist < nearest_dist) {
             nearest_dist = current_dist;
-            nearest_lane_id = current_lane_id;
+            nearest_lane_id = current_lane_info._id;
           }
         }
       }
@@ -240,43 +274,122 @@ namespace element {
 
     friend class carla::road::MapBuilder;
 
-    struct LessComp {
-      using is_transparent = void;
-      bool operator()(
-          const std::shared_ptr<RoadInfo> &a,
-          const std::shared_ptr<RoadInfo> &b) const {
-        return a->d < b->d;
+    // Search for the last geometry with less start_offset before 'dist'
+    DirectedPoint GetPlanarPointIn(double dist) const {
+      assert(_length > 0.0);
+      if (dist <= 0.0) {
+        return DirectedPoint(_geometries.front().GetStartPosition(),
+            _geometries.front().GetHeading());
+      }
+
+      if (dist >= _length) {
+        return _geometries.back().PosFromDist(
+            _length - _geometries.back().GetStartOffset());
       }
-      bool operator()(
-          const double &a,
-          const std::shared_ptr<RoadInfo> &b) const {
-        return a < b->d;
+
+      if (!_arc_length_table.empty() &&
+          (_arc_length_table.GetStartOffset() <= dist) &&
+          (dist <= _arc_length_table.GetEndOffset())) {
+        return _arc_length_table.Evaluate(dist);
       }
-      bool operator()(
-          const std::shared_ptr<RoadInfo> &a,
-          const double &b) const {
-        return a->d < b;
+
+      // Geometries are sorted by start offset, the one containing dist is the
+      // last one starting before it.
+      auto it = std::lower_bound(_geometries.begin(), _geometries.end(), dist,
+          [](const GeometryRecord &g, double d) {
+            return g.GetStartOffset() < d;
+          });
+      if (it == _geometries.begin()) {
+        return DirectedPoint(_geometries.front().GetStartPosition(),
+            _geometries.front().GetHeading());
       }
+      const auto &g = *std::prev(it);
+      return g.PosFromDist(dist - g.GetStartOffset());
+    }
+
+    /// Info of a single type, with its distance next to it so searching does
+    /// not touch the info.
+    struct InfoEntry {
+      double d;
+      RoadInfo *info;
+
+      struct Less {
+        bool operator()(const InfoEntry &a, double b) const {
+          return a.d < b;
+        }
+        bool operator()(double a, const InfoEntry &b) const {
+          return a < b.d;
+        }
+      };
     };
 
+    /// Last info of type T starting before @a dist.
+    template <typename T>
+    T *FindInfo(double dist) const {
+      const auto &infos = _info_by_type[RoadInfoTypeIndex<T>::value];
+      auto it = std::upper_bound(infos.begin(), infos.end(), dist, InfoEntry::Less());
+      return it == infos.begin() ? nullptr : static_cast<T *>(std::prev(it)->info);
+    }
+
+    /// Sort _info by distance, infos at the same distance keep their order,
+    /// and split them by type.
+    void SortInfo() {
+      std::stable_sort(_info.begin(), _info.end(), [](const auto &a, const auto &b) {
+        return a->d < b->d;
+      });
+      struct Splitter : RoadInfoVisitor {
+        decltype(_info_by_type) &out;
+        explicit Splitter(decltype(out) o) : out(o) {}
+        void Add(size_t index, RoadInfo &info) {
+          out[index].emplace_back(InfoEntry{info.d, &info});
+        }
+        void Visit(RoadInfoLane &info) override {
+          Add(RoadInfoTypeIndex<RoadInfoLane>::value, info);
+        }
+        void Visit(RoadGeneralInfo &info) override {
+          Add(RoadInfoTypeIndex<RoadGeneralInfo>::value, info);
+        }
+        void Visit(RoadInfoVelocity &info) override {
+          Add(RoadInfoTypeIndex<RoadInfoVelocity>::value, info);
+        }
+      } splitter{_info_by_type};
+      for (auto &&info : _info) {
+        info->AcceptVisitor(splitter);
+      }
+    }
+
   private:
 
     friend class MapBuilder;
+    friend class carla::road::MapSerializer;
+    friend class carla::road::SpatialIndex;
 
     id_type _id;
     std::vector<RoadSegment *> _predecessors;
     std::vector<RoadSegment *> _successors;
     std::vector<bool> _successors_is_start;
     std::vector<bool> _predecessors_is_start;
-    std::vector<std::unique_ptr<Geometry>> _geom;
-    std::multiset<std::shared_ptr<RoadInfo>, LessComp> _info;
+
+    /// Sorted by start offset.
+    std::vector<GeometryRecord> _geometries;
+
+    /// Sorted by distance.
+    std::vector<std::shared_ptr<RoadInfo>> _info;
+
+    /// Elevation of the reference line [meters].
+    CubicProfile _elevation;
+
+    /// Roll of the road [radians].
+    CubicProfile _superelevation;
+
+    std::array<std::vector<InfoEntry>, 3u> _info_by_type;
     double _length = -1.0;
 
-    // first  int     current lane
-    // second int     to which lane
-    // third  int     to which road
-    std::map<int, std::vector<std::pair<int, int>>> _next_lane;
-    std::map<int, std::vector<std::pair<int, int>>> _prev_lane;
+    /// Optional samples of the geometries, see MapBuilder.
+    ArcLengthTable _arc_length_table;
+
+    LaneLinkTable _next_lane;
+    LaneLinkTable _prev_lane;
   };
 
 } // namespace element
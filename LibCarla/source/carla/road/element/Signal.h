@@ -0,0 +1,87 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/road/element/Types.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace road {
+namespace element {
+
+  enum class SignalOrientation : uint8_t {
+    /// Valid in the direction of the road, i.e. for the right lanes.
+    Positive,
+    /// Valid against the direction of the road, i.e. for the left lanes.
+    Negative,
+    Both
+  };
+
+  /// A signal placed along a road, e.g. a traffic light or a speed limit, as
+  /// defined in OpenDRIVE.
+  struct Signal {
+    int id = -1;
+
+    id_type road_id = 0u;
+
+    /// Distance from the beginning of the road [meters].
+    double s = 0.0;
+
+    /// Lateral offset from the reference line of the road [meters].
+    double t = 0.0;
+
+    double zoffset = 0.0;
+
+    /// Value of the signal, e.g. the speed of a speed limit.
+    double value = 0.0;
+
+    std::string name;
+
+    /// Whether the signal changes state, e.g. a traffic light.
+    bool is_dynamic = false;
+
+    SignalOrientation orientation = SignalOrientation::Both;
+
+    std::string country;
+
+    std::string type;
+
+    std::string subtype;
+
+    /// Ranges of lanes, from and to, the signal is valid for. If empty, the
+    /// signal is valid for every lane of its orientation.
+    std::vector<std::pair<int, int>> validity;
+
+    bool IsValidFor(const int lane_id) const {
+      if (!validity.empty()) {
+        for (auto &&range : validity) {
+          const auto minmax = std::minmax(range.first, range.second);
+          if ((minmax.first <= lane_id) && (lane_id <= minmax.second)) {
+            return true;
+          }
+        }
+        return false;
+      }
+      switch (orientation) {
+        case SignalOrientation::Positive:
+          return lane_id < 0;
+        case SignalOrientation::Negative:
+          return lane_id > 0;
+        default:
+          return true;
+      }
+    }
+  };
+
+} // namespace element
+} // namespace road
+} // namespace carla
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "carla/road/element/CubicProfile.h"
 #include "carla/road/element/Geometry.h"
 #include "carla/road/element/RoadInfo.h"
 
@@ -29,6 +30,8 @@ namespace element {
         _predecessors_is_start(std::move(rsd._predecessors_is_start)),
         _geom(std::move(rsd._geom)),
         _info(std::move(rsd._info)),
+        _elevation(std::move(rsd._elevation)),
+        _superelevation(std::move(rsd._superelevation)),
         _next_lane(std::move(rsd._next_lane)),
         _prev_lane(std::move(rsd._prev_lane)) {}
 
@@ -72,12 +75,28 @@ namespace element {
       return static_cast<T *>(_info.back().get());
     }
 
+    /// Elevation of the reference line, as OpenDRIVE <elevation>.
+    void AddElevation(const CubicProfile::Record &record) {
+      _elevation.Add(record);
+    }
+
+    /// Roll of the road in radians, as OpenDRIVE <superelevation>.
+    void AddSuperelevation(const CubicProfile::Record &record) {
+      _superelevation.Add(record);
+    }
+
     const std::vector<id_type> &GetPredecessorID() const {
       return _predecessor_id;
     }
     const std::vector<id_type> &GetSuccessorID() const {
       return _successor_id;
     }
+    const std::vector<bool> &GetPredecessorIsStart() const {
+      return _predecessors_is_start;
+    }
+    const std::vector<bool> &GetSuccessorIsStart() const {
+      return _successor_is_start;
+    }
     const std::vector<std::unique_ptr<Geometry>> &GetGeometry() const {
       return _geom;
     }
@@ -95,6 +114,8 @@ namespace element {
     std::vector<bool> _predecessors_is_start;
     std::vector<std::unique_ptr<Geometry>> _geom;
     std::vector<std::shared_ptr<RoadInfo>> _info;
+    CubicProfile _elevation;
+    CubicProfile _superelevation;
 
     // first  int     current lane
     // second int     to which lane
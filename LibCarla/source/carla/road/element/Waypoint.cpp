@@ -8,7 +8,7 @@
 #include "carla/Logging.h"
 #include "carla/road/Map.h"
 
-#include <algorithm>
+#include <limits>
 
 namespace carla {
 namespace road {
@@ -19,54 +19,24 @@ namespace element {
     DEBUG_ASSERT(_map != nullptr);
     // max_nearests represents the max nearests roads
     // where we will search for nearests lanes
-    constexpr int max_nearests = 10;
-    // in case that map has less than max_nearests lanes,
-    // we will use the maximum lanes
-    const int max_nearest_allowed = _map->GetData().GetRoadCount()  <
-        max_nearests ? _map->GetData().GetRoadCount() : max_nearests;
-
-    double nearest_dist[max_nearests];
-    std::fill(nearest_dist, nearest_dist + max_nearest_allowed,
-        std::numeric_limits<double>::max());
-
-    id_type ids[max_nearests];
-    std::fill(ids, ids + max_nearest_allowed, 0);
-
-    double dists[max_nearests];
-    std::fill(dists, dists + max_nearest_allowed, 0.0);
-
-
-    for (auto &&r : _map->GetData().GetRoadSegments()) {
-      auto current_dist = r.GetNearestPoint(loc);
-
-      // search for nearests points
-      for (int i = 0; i < max_nearest_allowed; ++i) {
-        if (current_dist.second < nearest_dist[i]) {
-          // reorder nearest_dist
-          for (int j = max_nearest_allowed - 1; j > i; --j) {
-            nearest_dist[j] = nearest_dist[j - 1];
-            ids[j] = ids[j - 1];
-            dists[j] = dists[j - 1];
-          }
-          nearest_dist[i] = current_dist.second;
-          ids[i] = r.GetId();
-          dists[i] = current_dist.first;
-
-          break;
-        }
-      }
-    }
-
-    // search for the nearest lane in nearest_dist
+    constexpr size_t max_nearests = 10u;
+    SpatialIndex::NearestRoad nearest_roads[max_nearests];
+    const auto count = _map->GetData().GetSpatialIndex().FindNearestRoads(
+        loc,
+        nearest_roads,
+        max_nearests);
+
+    // search for the nearest lane in nearest_roads
     auto nearest_lane_dist = std::numeric_limits<double>::max();
-    for (int i = 0; i < max_nearest_allowed; ++i) {
-      auto lane_dist = _map->GetData().GetRoad(ids[i])->GetNearestLane(dists[i], loc);
+    for (size_t i = 0u; i < count; ++i) {
+      const auto &nearest = nearest_roads[i];
+      auto lane_dist = nearest.road->GetNearestLane(nearest.distance_along_road, loc);
 
       if (lane_dist.second < nearest_lane_dist) {
         nearest_lane_dist = lane_dist.second;
         _lane_id = lane_dist.first;
-        _road_id = ids[i];
-        _dist = dists[i];
+        _road_id = nearest.road->GetId();
+        _dist = nearest.distance_along_road;
       }
     }
 
@@ -93,9 +63,16 @@ namespace element {
     road::element::DirectedPoint dp =
         _map->GetData().GetRoad(_road_id)->GetDirectedPointIn(_dist);
 
-    geom::Rotation rot(0.0, geom::Math::to_degrees(dp.tangent), 0.0);
+    geom::Rotation rot(
+        geom::Math::to_degrees(dp.pitch),
+        geom::Math::to_degrees(dp.tangent),
+        geom::Math::to_degrees(dp.roll));
     if (_lane_id > 0) {
+      // Driving backwards, the road looks downhill where it goes uphill and
+      // falls to the other side.
+      rot.pitch = -rot.pitch;
       rot.yaw += 180.0;
+      rot.roll = -rot.roll;
     }
 
     const auto *road_segment = _map->GetData().GetRoad(_road_id);
@@ -36,6 +36,11 @@ namespace element {
       return _lane_id;
     }
 
+    /// Distance from the beginning of the road.
+    double GetDistance() const {
+      return _dist;
+    }
+
     RoadInfoList GetRoadInfo() const;
 
     const RoadSegment &GetRoadSegment() const;
@@ -0,0 +1,67 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/geom/Transform.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace road {
+namespace element {
+
+  /// Waypoints stored as a struct of arrays, see
+  /// WaypointGenerator::GenerateAllArrays. Each array holds one field of
+  /// every waypoint, so they can be shared as raw memory.
+  struct WaypointArrays {
+    std::vector<uint32_t> road_id;
+    std::vector<int32_t> lane_id;
+    /// Distance from the beginning of the road [meters].
+    std::vector<double> s;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    /// Yaw of the waypoint transform [degrees].
+    std::vector<float> yaw;
+
+    size_t size() const {
+      return road_id.size();
+    }
+
+    bool empty() const {
+      return road_id.empty();
+    }
+
+    void reserve(size_t count) {
+      road_id.reserve(count);
+      lane_id.reserve(count);
+      s.reserve(count);
+      x.reserve(count);
+      y.reserve(count);
+      z.reserve(count);
+      yaw.reserve(count);
+    }
+
+    void push_back(
+        uint32_t road,
+        int32_t lane,
+        double distance,
+        const geom::Transform &transform) {
+      road_id.push_back(road);
+      lane_id.push_back(lane);
+      s.push_back(distance);
+      x.push_back(transform.location.x);
+      y.push_back(transform.location.y);
+      z.push_back(transform.location.z);
+      yaw.push_back(transform.rotation.yaw);
+    }
+  };
+
+} // namespace element
+} // namespace road
+} // namespace carla
@@ -0,0 +1,33 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/geom/Transform.h"
+
+#include <cstdint>
+
+namespace carla {
+namespace road {
+namespace element {
+
+  /// Compact result of a batched waypoint query, see Map::GetWaypoints. Plain
+  /// data with a fixed layout so a list of them can be shared as raw memory.
+  struct WaypointInfo {
+    uint32_t road_id = 0u;
+    int32_t lane_id = 0;
+    /// Distance from the beginning of the road [meters].
+    double s = 0.0;
+    geom::Transform transform;
+    /// False if no waypoint was found for the location.
+    bool is_valid = false;
+  };
+
+  static_assert(sizeof(WaypointInfo) == 48u, "Invalid WaypointInfo layout.");
+
+} // namespace element
+} // namespace road
+} // namespace carla
@@ -0,0 +1,98 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/geom/Transform.h"
+#include "carla/rpc/ActorDescription.h"
+#include "carla/rpc/ActorId.h"
+#include "carla/rpc/Variant.h"
+#include "carla/rpc/VehicleControl.h"
+
+#include <type_traits>
+#include <utility>
+
+namespace carla {
+namespace rpc {
+
+  /// A single operation of a batch, see Client::ApplyBatch. The whole batch
+  /// is sent in a single call and executed in order in the simulator.
+  class Command {
+  public:
+
+    // The commands have no default member initializers, they can't be used
+    // within Command before it is complete. Value-initialize them instead.
+
+    struct SpawnActor {
+      SpawnActor() = default;
+      SpawnActor(ActorDescription d, const geom::Transform &t)
+        : description(std::move(d)),
+          transform(t) {}
+      ActorDescription description;
+      geom::Transform transform;
+      MSGPACK_DEFINE_ARRAY(description, transform);
+    };
+
+    struct DestroyActor {
+      DestroyActor() = default;
+      explicit DestroyActor(actor_id_type id)
+        : actor(id) {}
+      actor_id_type actor;
+      MSGPACK_DEFINE_ARRAY(actor);
+    };
+
+    struct ApplyVehicleControl {
+      ApplyVehicleControl() = default;
+      ApplyVehicleControl(actor_id_type id, const VehicleControl &value)
+        : actor(id),
+          control(value) {}
+      actor_id_type actor;
+      VehicleControl control;
+      MSGPACK_DEFINE_ARRAY(actor, control);
+    };
+
+    struct ApplyTransform {
+      ApplyTransform() = default;
+      ApplyTransform(actor_id_type id, const geom::Transform &value)
+        : actor(id),
+          transform(value) {}
+      actor_id_type actor;
+      geom::Transform transform;
+      MSGPACK_DEFINE_ARRAY(actor, transform);
+    };
+
+    struct SetAutopilot {
+      SetAutopilot() = default;
+      SetAutopilot(actor_id_type id, bool value)
+        : actor(id),
+          enabled(value) {}
+      actor_id_type actor;
+      bool enabled;
+      MSGPACK_DEFINE_ARRAY(actor, enabled);
+    };
+
+    using CommandType = CompactVariant<
+        SpawnActor,
+        DestroyActor,
+        ApplyVehicleControl,
+        ApplyTransform,
+        SetAutopilot>;
+
+    Command() = default;
+
+    template <typename CommandT, typename = std::enable_if_t<
+        CommandType::IsAlternative<CommandT>::value>>
+    Command(CommandT &&value)
+      : command(std::forward<CommandT>(value)) {}
+
+    CommandType command;
+
+    MSGPACK_DEFINE_ARRAY(command);
+  };
+
+} // namespace rpc
+} // namespace carla
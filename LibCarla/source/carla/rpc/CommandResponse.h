@@ -0,0 +1,46 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/rpc/ActorId.h"
+
+#include <string>
+
+namespace carla {
+namespace rpc {
+
+  /// Result of a single Command of a batch.
+  class CommandResponse {
+  public:
+
+    CommandResponse() = default;
+
+    explicit CommandResponse(actor_id_type id)
+      : actor(id) {}
+
+    static CommandResponse Error(std::string message) {
+      CommandResponse response;
+      response.error = std::move(message);
+      return response;
+    }
+
+    bool HasError() const {
+      return !error.empty();
+    }
+
+    /// Actor spawned or affected by the command.
+    actor_id_type actor = 0u;
+
+    /// Empty if the command succeeded.
+    std::string error;
+
+    MSGPACK_DEFINE_ARRAY(actor, error);
+  };
+
+} // namespace rpc
+} // namespace carla
@@ -0,0 +1,139 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace carla {
+namespace rpc {
+
+  /// Copy of the counters of a function bound to the Server. Times are in
+  /// microseconds.
+  struct HandlerStats {
+
+    /// Number of calls completed, including the ones that responded an error.
+    uint64_t calls = 0u;
+
+    /// Calls waiting for the game thread right now. Only functions bound with
+    /// BindSync wait for the game thread.
+    uint64_t queued = 0u;
+
+    /// Maximum number of calls waiting for the game thread at the same time.
+    uint64_t max_queued = 0u;
+
+    /// Time from the call being received to the result being ready.
+    uint64_t total_latency = 0u;
+
+    uint64_t max_latency = 0u;
+
+    /// Time spent waiting for the game thread.
+    uint64_t total_queue_time = 0u;
+
+    double GetMeanLatency() const {
+      return calls > 0u ? static_cast<double>(total_latency) / calls : 0.0;
+    }
+
+    double GetMeanQueueTime() const {
+      return calls > 0u ? static_cast<double>(total_queue_time) / calls : 0.0;
+    }
+  };
+
+namespace detail {
+
+  /// Counters of a function bound to the Server, updated concurrently by the
+  /// threads that call it.
+  class HandlerMetrics : private NonCopyable {
+  public:
+
+    using clock = std::chrono::steady_clock;
+
+    /// Records the latency of a call when it goes out of scope, also when the
+    /// handler responds an error.
+    class CallScope : private NonCopyable {
+    public:
+
+      explicit CallScope(HandlerMetrics &metrics)
+        : _metrics(metrics),
+          _start(clock::now()) {}
+
+      ~CallScope() {
+        _metrics.OnCompleted(clock::now() - _start);
+      }
+
+      clock::time_point GetStart() const {
+        return _start;
+      }
+
+    private:
+
+      HandlerMetrics &_metrics;
+
+      const clock::time_point _start;
+    };
+
+    /// A call was posted to the game thread.
+    void OnQueued() {
+      AtomicMax(_max_queued, ++_queued);
+    }
+
+    /// A call posted at @a posted_at started running in the game thread.
+    void OnDequeued(clock::time_point posted_at) {
+      --_queued;
+      _total_queue_time += ToMicroseconds(clock::now() - posted_at);
+    }
+
+    HandlerStats GetStats() const {
+      HandlerStats stats;
+      stats.calls = _calls.load(std::memory_order_relaxed);
+      stats.queued = _queued.load(std::memory_order_relaxed);
+      stats.max_queued = _max_queued.load(std::memory_order_relaxed);
+      stats.total_latency = _total_latency.load(std::memory_order_relaxed);
+      stats.max_latency = _max_latency.load(std::memory_order_relaxed);
+      stats.total_queue_time = _total_queue_time.load(std::memory_order_relaxed);
+      return stats;
+    }
+
+  private:
+
+    void OnCompleted(clock::duration latency) {
+      const auto us = ToMicroseconds(latency);
+      ++_calls;
+      _total_latency += us;
+      AtomicMax(_max_latency, us);
+    }
+
+    static uint64_t ToMicroseconds(clock::duration duration) {
+      return static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+    }
+
+    static void AtomicMax(std::atomic<uint64_t> &target, uint64_t value) {
+      auto current = target.load(std::memory_order_relaxed);
+      while ((current < value) &&
+             !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+
+    std::atomic<uint64_t> _calls{0u};
+
+    std::atomic<uint64_t> _queued{0u};
+
+    std::atomic<uint64_t> _max_queued{0u};
+
+    std::atomic<uint64_t> _total_latency{0u};
+
+    std::atomic<uint64_t> _max_latency{0u};
+
+    std::atomic<uint64_t> _total_queue_time{0u};
+  };
+
+} // namespace detail
+} // namespace rpc
+} // namespace carla
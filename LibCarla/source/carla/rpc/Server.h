@@ -7,12 +7,16 @@
 #pragma once
 
 #include "carla/Time.h"
-
-#include <boost/asio/io_service.hpp>
+#include "carla/rpc/Metrics.h"
+#include "carla/rpc/SyncCallQueue.h"
 
 #include <rpc/server.h>
 
-#include <future>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
 
 namespace carla {
 namespace rpc {
@@ -33,32 +37,56 @@ namespace detail {
   template <typename R, typename... Args> struct wrapper_function_traits<R (*)(Args...)> {
     using result_type = R;
     using function_type = std::function<R(Args...)>;
-    using packaged_task_type = std::packaged_task<R()>;
   };
 
   /// Wraps @a functor into a function type with equivalent signature. The wrap
-  /// function returned, when called, posts @a functor into the io_service and
+  /// function returned, when called, pushes @a functor into the @a queue and
   /// waits for it to finish.
   ///
   /// This way, no matter from which thread the wrap function is called, the
-  /// @a functor provided is always called from the context of the io_service.
+  /// @a functor provided is always called from the thread that runs the
+  /// @a queue. Nothing is allocated per call, the task is the one of the
+  /// calling thread and the rest lives in the calling thread's stack.
+  ///
+  /// The time waiting for the queue and the latency of each call are recorded
+  /// in @a metrics.
   ///
-  /// @warning The wrap function blocks until @a functor is executed by the
-  /// io_service.
+  /// @warning The wrap function blocks until @a functor is executed.
   template <typename F>
-  inline auto WrapSyncCall(boost::asio::io_service &io, F functor) {
+  inline auto WrapSyncCall(SyncCallQueue &queue, HandlerMetrics &metrics, F functor) {
     using func_t = typename wrapper_function_traits<F>::function_type;
-    using task_t = typename wrapper_function_traits<F>::packaged_task_type;
-
-    return func_t([&io, functor=std::move(functor)](auto && ... args) {
-      // We can pass arguments by ref to the lambda because the task will be
-      // executed before this function exits.
-      task_t task([functor=std::move(functor), &args...]() {
-        return functor(std::forward<decltype(args)>(args)...);
-      });
-      auto result = task.get_future();
-      io.post([&]() mutable { task(); });
-      return result.get();
+    using result_t = typename wrapper_function_traits<F>::result_type;
+
+    return func_t([&queue, &metrics, functor=std::move(functor)](auto && ... args) -> result_t {
+      const HandlerMetrics::CallScope scope(metrics);
+      SyncCallResult<result_t> result;
+      // We can capture everything by ref because the task will be executed
+      // before this function exits.
+      auto call = [&]() {
+        metrics.OnDequeued(scope.GetStart());
+        result.Emplace([&]() -> result_t {
+          return functor(std::forward<decltype(args)>(args)...);
+        });
+      };
+      auto &task = SyncTask::ThisThreadTask();
+      task.Reset(call);
+      metrics.OnQueued();
+      queue.Push(task);
+      task.Wait();
+      return result.Take();
+    });
+  }
+
+  /// Wraps @a functor into a function type with equivalent signature that
+  /// records its latency in @a metrics. The wrap function calls @a functor
+  /// directly in the calling thread.
+  template <typename F>
+  inline auto WrapReadOnlyCall(HandlerMetrics &metrics, F functor) {
+    using func_t = typename wrapper_function_traits<F>::function_type;
+
+    return func_t([&metrics, functor=std::move(functor)](auto && ... args) {
+      const HandlerMetrics::CallScope scope(metrics);
+      return functor(std::forward<decltype(args)>(args)...);
     });
   }
 
@@ -72,7 +100,10 @@ namespace detail {
   ///
   /// Functions that are bind using `BindAsync` will run asynchronously in the
   /// worker threads. Functions that are bind using `BindSync` will run within
-  /// `SyncRunFor` function.
+  /// `SyncRunFor` function. Functions that are bind using `BindReadOnly` run
+  /// in the worker threads too, and keep metrics like `BindSync` ones.
+  ///
+  /// All the functions must be bind before calling `AsyncRun`.
   class Server {
   public:
 
@@ -91,16 +122,28 @@ namespace detail {
     void BindSync(const std::string &name, Functor functor) {
       _server.bind(
           name,
-          detail::WrapSyncCall(_sync_io_service, std::move(functor)));
+          detail::WrapSyncCall(_sync_queue, MakeMetrics(name), std::move(functor)));
+    }
+
+    /// Bind a function that only reads data safe to access concurrently, e.g.
+    /// a snapshot the game thread publishes in an AtomicSharedPtr. Any number
+    /// of calls run at the same time in the worker threads, they don't wait
+    /// for `SyncRunFor`.
+    template <typename Functor>
+    void BindReadOnly(const std::string &name, Functor functor) {
+      _server.bind(
+          name,
+          detail::WrapReadOnlyCall(MakeMetrics(name), std::move(functor)));
     }
 
     void AsyncRun(size_t worker_threads) {
       _server.async_run(worker_threads);
     }
 
+    /// Run the calls to functions bound with `BindSync` in the caller's
+    /// thread, until there are none waiting or @a duration expires.
     void SyncRunFor(time_duration duration) {
-      _sync_io_service.reset();
-      _sync_io_service.run_for(duration.to_chrono());
+      _sync_queue.RunFor(duration);
     }
 
     /// @warning does not stop the game thread.
@@ -110,9 +153,38 @@ namespace detail {
 
     static void RespondError(std::string error_message);
 
+    /// Counters of each function bound with `BindSync` or `BindReadOnly`, by
+    /// name.
+    std::map<std::string, HandlerStats> GetMetrics() const {
+      std::map<std::string, HandlerStats> result;
+      for (auto &&pair : _metrics) {
+        result.emplace(pair.first, pair.second->GetStats());
+      }
+      return result;
+    }
+
+    /// Number of calls waiting for the game thread right now.
+    uint64_t GetSyncQueueDepth() const {
+      uint64_t result = 0u;
+      for (auto &&pair : _metrics) {
+        result += pair.second->GetStats().queued;
+      }
+      return result;
+    }
+
   private:
 
-    boost::asio::io_service _sync_io_service;
+    detail::HandlerMetrics &MakeMetrics(const std::string &name) {
+      auto &metrics = _metrics[name];
+      metrics = std::make_unique<detail::HandlerMetrics>();
+      return *metrics;
+    }
+
+    detail::SyncCallQueue _sync_queue;
+
+    /// Only modified while binding, the handlers keep a reference to their
+    /// entry.
+    std::unordered_map<std::string, std::unique_ptr<detail::HandlerMetrics>> _metrics;
 
     ::rpc::server _server;
   };
@@ -0,0 +1,224 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/NonCopyable.h"
+#include "carla/Optional.h"
+#include "carla/Time.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace carla {
+namespace rpc {
+namespace detail {
+
+  // ===========================================================================
+  // -- SyncTask ---------------------------------------------------------------
+  // ===========================================================================
+
+  /// A call waiting to be executed by the game thread. The calling thread
+  /// blocks until its call is done, so it never has more than one in flight
+  /// and reuses the same task for all of them, see ThisThreadTask.
+  class SyncTask : private NonCopyable {
+  public:
+
+    /// The task of the calling thread, allocated on its first call.
+    static SyncTask &ThisThreadTask() {
+      static thread_local SyncTask task;
+      return task;
+    }
+
+    /// Prepare the task to invoke @a callable, which has to outlive the call.
+    template <typename CallableT>
+    void Reset(CallableT &callable) {
+      _invoke = [](void *ptr) { (*static_cast<CallableT *>(ptr))(); };
+      _callable = &callable;
+      _exception = nullptr;
+      _done = false;
+    }
+
+    /// Invoke the callable and wake up the calling thread. Exceptions are
+    /// rethrown in the calling thread.
+    void Run() {
+      DEBUG_ASSERT(_invoke != nullptr);
+      try {
+        _invoke(_callable);
+      } catch (...) {
+        _exception = std::current_exception();
+      }
+      _notifying.store(true, std::memory_order_relaxed);
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _done = true;
+      }
+      // Notifying after unlocking saves the calling thread from waking up just
+      // to block on the mutex again.
+      _cv.notify_one();
+      _notifying.store(false, std::memory_order_release);
+    }
+
+    /// Block until Run is done.
+    void Wait() {
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this]() { return _done; });
+      }
+      if (_exception != nullptr) {
+        std::rethrow_exception(std::exchange(_exception, nullptr));
+      }
+    }
+
+  private:
+
+    friend class SyncCallQueue;
+
+    SyncTask() = default;
+
+    /// The calling thread may be exiting while Run is still notifying it.
+    ~SyncTask() {
+      while (_notifying.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+    }
+
+    std::atomic<SyncTask *> _next{nullptr};
+
+    void (*_invoke)(void *) = nullptr;
+
+    void *_callable = nullptr;
+
+    std::exception_ptr _exception;
+
+    std::mutex _mutex;
+
+    std::condition_variable _cv;
+
+    bool _done = false;
+
+    std::atomic_bool _notifying{false};
+  };
+
+  // ===========================================================================
+  // -- SyncCallQueue ----------------------------------------------------------
+  // ===========================================================================
+
+  /// Lock-free intrusive queue of SyncTask with any number of producers and a
+  /// single consumer, the game thread. Based on Dmitry Vyukov's intrusive
+  /// MPSC node-based queue.
+  class SyncCallQueue : private NonCopyable {
+  public:
+
+    SyncCallQueue()
+      : _head(&_stub),
+        _tail(&_stub) {}
+
+    /// Thread-safe. @a task must not be in the queue already.
+    void Push(SyncTask &task) {
+      task._next.store(nullptr, std::memory_order_relaxed);
+      auto *previous = _head.exchange(&task, std::memory_order_acq_rel);
+      previous->_next.store(&task, std::memory_order_release);
+    }
+
+    /// Run the queued tasks in order until there are none left or @a budget
+    /// expires. At least one task is run if there is any. Only the consumer
+    /// thread may call this function.
+    void RunFor(time_duration budget) {
+      using clock = std::chrono::steady_clock;
+      const auto deadline = clock::now() + budget.to_chrono();
+      for (auto *task = Pop(); task != nullptr; task = Pop()) {
+        task->Run();
+        if (clock::now() >= deadline) {
+          break;
+        }
+      }
+    }
+
+  private:
+
+    /// Returns nullptr if the queue is empty, or if a producer is in the
+    /// middle of a Push; its task is returned by a later call.
+    SyncTask *Pop() {
+      auto *tail = _tail;
+      auto *next = tail->_next.load(std::memory_order_acquire);
+      if (tail == &_stub) {
+        if (next == nullptr) {
+          return nullptr;
+        }
+        _tail = next;
+        tail = next;
+        next = next->_next.load(std::memory_order_acquire);
+      }
+      if (next != nullptr) {
+        _tail = next;
+        return tail;
+      }
+      if (tail != _head.load(std::memory_order_acquire)) {
+        return nullptr;
+      }
+      // The tail is the last task, put the stub behind it to pop it.
+      Push(_stub);
+      next = tail->_next.load(std::memory_order_acquire);
+      if (next != nullptr) {
+        _tail = next;
+        return tail;
+      }
+      return nullptr;
+    }
+
+    SyncTask _stub;
+
+    std::atomic<SyncTask *> _head;
+
+    SyncTask *_tail;
+  };
+
+  // ===========================================================================
+  // -- SyncCallResult ---------------------------------------------------------
+  // ===========================================================================
+
+  /// Storage in the caller's stack for the result of a SyncTask.
+  template <typename T>
+  class SyncCallResult {
+  public:
+
+    template <typename F>
+    void Emplace(F &&function) {
+      _value.emplace(function());
+    }
+
+    T Take() {
+      DEBUG_ASSERT(_value.has_value());
+      return std::move(*_value);
+    }
+
+  private:
+
+    Optional<T> _value;
+  };
+
+  template <>
+  class SyncCallResult<void> {
+  public:
+
+    template <typename F>
+    void Emplace(F &&function) {
+      function();
+    }
+
+    void Take() {}
+  };
+
+} // namespace detail
+} // namespace rpc
+} // namespace carla
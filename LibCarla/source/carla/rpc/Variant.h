@@ -9,6 +9,8 @@
 #include "carla/MsgPack.h"
 
 #include <tuple>
+#include <type_traits>
+#include <utility>
 
 namespace carla {
 namespace rpc {
@@ -17,12 +19,14 @@ namespace rpc {
   /// quite inefficient memory-wise.
   template <typename... Ts>
   class Variant {
-  private:
+  protected:
 
     size_t _index = 0u;
 
     std::tuple<Ts...> _tuple;
 
+  private:
+
     template <typename T, typename Tuple>
     struct IndexFromType;
 
@@ -41,16 +45,37 @@ namespace rpc {
       std::initializer_list<int> ({ (_index == Is ? visitor(std::get<Is>(_tuple)), 0 : 0)... });
     }
 
+    template <typename T, typename... Types>
+    struct Contains : std::false_type {};
+
+    template <typename T, typename U, typename... Types>
+    struct Contains<T, U, Types...> : std::conditional_t<
+        std::is_same<T, U>::value,
+        std::true_type,
+        Contains<T, Types...>> {};
+
   public:
 
-    Variant() = default;
+    /// Whether @a ObjT is one of the alternatives, only these convert to a
+    /// Variant.
+    template <typename ObjT>
+    using IsAlternative = Contains<typename std::decay<ObjT>::type, Ts...>;
+
+  private:
 
     template <typename ObjT>
+    using EnableIfAlternative = std::enable_if_t<IsAlternative<ObjT>::value>;
+
+  public:
+
+    Variant() = default;
+
+    template <typename ObjT, typename = EnableIfAlternative<ObjT>>
     Variant(ObjT &&rhs) {
       (*this) = std::forward<ObjT>(rhs);
     }
 
-    template <typename ObjT>
+    template <typename ObjT, typename = EnableIfAlternative<ObjT>>
     Variant &operator=(ObjT &&rhs) {
       constexpr auto index = IndexFromType<typename std::decay<ObjT>::type, decltype(_tuple)>::value;
       _index = index;
@@ -63,8 +88,65 @@ namespace rpc {
       return ApplyVisitorImpl(visitor, std::make_index_sequence<sizeof...(Ts)>());
     }
 
+    size_t GetIndex() const {
+      return _index;
+    }
+
     MSGPACK_DEFINE_ARRAY(_index, _tuple);
   };
 
+  /// A Variant that packs only its active alternative, as an array
+  /// [index, value], instead of the whole tuple. The encoding differs from
+  /// the one of Variant, so existing Variant members keep theirs.
+  template <typename... Ts>
+  class CompactVariant : public Variant<Ts...> {
+  private:
+
+    using Super = Variant<Ts...>;
+
+    template <size_t... Is>
+    void UnpackImpl(const ::clmdep_msgpack::object &o, std::index_sequence<Is...>) {
+      std::initializer_list<int> ({ (this->_index == Is ? o.convert(std::get<Is>(this->_tuple)), 0 : 0)... });
+    }
+
+  public:
+
+    using Super::Super;
+
+    using Super::operator=;
+
+    CompactVariant() = default;
+
+    template <typename Packer>
+    void msgpack_pack(Packer &packer) const {
+      packer.pack_array(2u);
+      packer.pack(this->_index);
+      this->ApplyVisitor([&](const auto &value) { packer.pack(value); });
+    }
+
+    void msgpack_unpack(const ::clmdep_msgpack::object &o) {
+      if ((o.type != ::clmdep_msgpack::type::ARRAY) || (o.via.array.size != 2u)) {
+        throw ::clmdep_msgpack::type_error();
+      }
+      this->_index = o.via.array.ptr[0u].as<size_t>();
+      if (this->_index >= sizeof...(Ts)) {
+        throw ::clmdep_msgpack::type_error();
+      }
+      UnpackImpl(o.via.array.ptr[1u], std::make_index_sequence<sizeof...(Ts)>());
+    }
+
+    /// Used by rpclib to convert the results of the bound functions.
+    void msgpack_object(::clmdep_msgpack::object *o, ::clmdep_msgpack::zone &z) const {
+      o->type = ::clmdep_msgpack::type::ARRAY;
+      o->via.array.size = 2u;
+      o->via.array.ptr = static_cast<::clmdep_msgpack::object *>(
+          z.allocate_align(sizeof(::clmdep_msgpack::object) * 2u));
+      o->via.array.ptr[0u] = ::clmdep_msgpack::object(this->_index, z);
+      this->ApplyVisitor([&](const auto &value) {
+        o->via.array.ptr[1u] = ::clmdep_msgpack::object(value, z);
+      });
+    }
+  };
+
 } // namespace rpc
 } // namespace carla
@@ -12,7 +12,10 @@
 #include "carla/rpc/TrafficLightState.h"
 #include "carla/rpc/VehicleControl.h"
 
+#include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <limits>
 
 namespace carla {
 namespace sensor {
@@ -72,6 +75,110 @@ namespace detail {
       sizeof(ActorDynamicState) == 10u * sizeof(uint32_t) + sizeof(detail::PackedVehicleControl),
       "Invalid ActorDynamicState size!");
 
+namespace detail {
+
+#pragma pack(push, 1)
+
+  /// ActorDynamicState with the transform and velocity quantized, used by the
+  /// delta-encoded episode state. Locations have a resolution of 1/1024 m,
+  /// rotations of 360/65536 degrees, and velocities of 1/128 m/s clamped to
+  /// +-256 m/s.
+  ///
+  /// Quantizing a state that was already dequantized gives back the same
+  /// values, so keyframes and deltas decode to bitwise identical states.
+  class QuantizedActorDynamicState {
+  public:
+
+    QuantizedActorDynamicState() = default;
+
+    explicit QuantizedActorDynamicState(const ActorDynamicState &state)
+      : id(state.id) {
+      location[0u] = Quantize<int32_t>(state.transform.location.x, LOCATION_STEP);
+      location[1u] = Quantize<int32_t>(state.transform.location.y, LOCATION_STEP);
+      location[2u] = Quantize<int32_t>(state.transform.location.z, LOCATION_STEP);
+      rotation[0u] = QuantizeAngle(state.transform.rotation.pitch);
+      rotation[1u] = QuantizeAngle(state.transform.rotation.yaw);
+      rotation[2u] = QuantizeAngle(state.transform.rotation.roll);
+      velocity[0u] = Quantize<int16_t>(state.velocity.x, VELOCITY_STEP);
+      velocity[1u] = Quantize<int16_t>(state.velocity.y, VELOCITY_STEP);
+      velocity[2u] = Quantize<int16_t>(state.velocity.z, VELOCITY_STEP);
+      std::memcpy(&this->state, &state.state, sizeof(this->state));
+    }
+
+    operator ActorDynamicState() const {
+      ActorDynamicState result;
+      result.id = id;
+      result.transform.location.x = LOCATION_STEP * location[0u];
+      result.transform.location.y = LOCATION_STEP * location[1u];
+      result.transform.location.z = LOCATION_STEP * location[2u];
+      result.transform.rotation.pitch = ROTATION_STEP * rotation[0u];
+      result.transform.rotation.yaw = ROTATION_STEP * rotation[1u];
+      result.transform.rotation.roll = ROTATION_STEP * rotation[2u];
+      result.velocity.x = VELOCITY_STEP * velocity[0u];
+      result.velocity.y = VELOCITY_STEP * velocity[1u];
+      result.velocity.z = VELOCITY_STEP * velocity[2u];
+      std::memcpy(&result.state, &state, sizeof(state));
+      return result;
+    }
+
+    actor_id_type GetId() const {
+      return id;
+    }
+
+    /// Bitwise comparison, the encoder uses it to find the actors that
+    /// changed.
+    bool operator==(const QuantizedActorDynamicState &rhs) const {
+      return std::memcmp(this, &rhs, sizeof(rhs)) == 0;
+    }
+
+    bool operator!=(const QuantizedActorDynamicState &rhs) const {
+      return !(*this == rhs);
+    }
+
+  private:
+
+    // The steps are powers of two (45 times a power of two for the angles) so
+    // the dequantized values are exact.
+    static constexpr float LOCATION_STEP = 1.0f / 1024.0f;
+    static constexpr float ROTATION_STEP = 360.0f / 65536.0f;
+    static constexpr float VELOCITY_STEP = 1.0f / 128.0f;
+
+    template <typename T>
+    static T Quantize(float value, float step) {
+      constexpr double min = std::numeric_limits<T>::min();
+      constexpr double max = std::numeric_limits<T>::max();
+      const double q = std::round(static_cast<double>(value) / step);
+      if (std::isnan(q)) {
+        return T(0);
+      }
+      return static_cast<T>(q < min ? min : (q > max ? max : q));
+    }
+
+    /// Wraps the angle to [-180, 180).
+    static int16_t QuantizeAngle(float degrees) {
+      const auto q = Quantize<int32_t>(std::fmod(degrees, 360.0f), ROTATION_STEP);
+      return static_cast<int16_t>(static_cast<uint16_t>(q & 0xFFFF));
+    }
+
+    actor_id_type id;
+
+    int32_t location[3u];
+
+    int16_t rotation[3u];
+
+    int16_t velocity[3u];
+
+    ActorDynamicState::TypeDependentState state;
+  };
+
+#pragma pack(pop)
+
+  static_assert(
+      sizeof(QuantizedActorDynamicState) == 7u * sizeof(uint32_t) + sizeof(detail::PackedVehicleControl),
+      "Invalid QuantizedActorDynamicState size!");
+
+} // namespace detail
+
 } // namespace data
 } // namespace sensor
 } // namespace carla
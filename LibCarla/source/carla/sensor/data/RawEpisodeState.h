@@ -7,8 +7,10 @@
 #pragma once
 
 #include "carla/Debug.h"
+#include "carla/ListView.h"
+#include "carla/rpc/ActorId.h"
+#include "carla/sensor/SensorData.h"
 #include "carla/sensor/data/ActorDynamicState.h"
-#include "carla/sensor/data/Array.h"
 #include "carla/sensor/s11n/EpisodeStateSerializer.h"
 
 namespace carla {
@@ -16,8 +18,12 @@ namespace sensor {
 namespace data {
 
   /// State of the episode at a given frame.
-  class RawEpisodeState : public Array<ActorDynamicState> {
-    using Super = Array<ActorDynamicState>;
+  ///
+  /// Full frames contain the state of every actor. Keyframes and deltas
+  /// contain the quantized state of the actors that changed since the
+  /// previous frame, and the ids of the ones removed, see
+  /// s11n::EpisodeStateSerializer.
+  class RawEpisodeState : public SensorData {
   protected:
 
     using Serializer = s11n::EpisodeStateSerializer;
@@ -25,18 +31,41 @@ namespace data {
     friend Serializer;
 
     explicit RawEpisodeState(RawData data)
-      : Super(std::move(data)) {
-      Super::SetOffset(Serializer::header_offset);
+      : SensorData(data),
+        _data(std::move(data)) {
+      DEBUG_ASSERT(_data.size() >= Serializer::header_offset);
     }
 
   private:
 
-    auto GetHeader() const {
-      return Serializer::DeserializeHeader(Super::GetRawData());
+    const auto &GetHeader() const {
+      return Serializer::DeserializeHeader(_data);
+    }
+
+    const auto &GetDeltaHeader() const {
+      return Serializer::DeserializeDeltaHeader(_data);
+    }
+
+    template <typename T>
+    auto MakeView(size_t offset, size_t count) const {
+      auto begin = reinterpret_cast<const T *>(_data.begin() + offset);
+      DEBUG_ASSERT(begin + count <= reinterpret_cast<const T *>(_data.end()));
+      return MakeListView(begin, begin + count);
+    }
+
+    size_t GetUpdatedActorsOffset() const {
+      return
+          Serializer::header_offset +
+          sizeof(Serializer::DeltaHeader) +
+          sizeof(actor_id_type) * GetDeltaHeader().removed_count;
     }
 
   public:
 
+    using FrameType = Serializer::FrameType;
+
+    using QuantizedActorDynamicState = detail::QuantizedActorDynamicState;
+
     /// Simulation time-stamp, simulated seconds elapsed since the beginning of
     /// the current episode.
     double GetGameTimeStamp() const {
@@ -48,6 +77,48 @@ namespace data {
     double GetPlatformTimeStamp() const {
       return GetHeader().platform_timestamp;
     }
+
+    FrameType GetFrameType() const {
+      return GetHeader().frame_type;
+    }
+
+    /// State of every actor, only for full frames.
+    auto GetActors() const {
+      DEBUG_ASSERT(GetFrameType() == FrameType::Full);
+      const auto size = _data.size() - Serializer::header_offset;
+      DEBUG_ASSERT(size % sizeof(ActorDynamicState) == 0u);
+      return MakeView<ActorDynamicState>(
+          Serializer::header_offset,
+          size / sizeof(ActorDynamicState));
+    }
+
+    /// Sequence number of a keyframe or delta.
+    uint32_t GetSequence() const {
+      return GetDeltaHeader().sequence;
+    }
+
+    /// Ids of the actors removed since the previous frame sorted, only for
+    /// deltas.
+    auto GetRemovedActors() const {
+      return MakeView<actor_id_type>(
+          Serializer::header_offset + sizeof(Serializer::DeltaHeader),
+          GetDeltaHeader().removed_count);
+    }
+
+    /// Quantized state of the actors that changed since the previous frame
+    /// sorted by id, keyframes contain every actor.
+    auto GetUpdatedActors() const {
+      const auto offset = GetUpdatedActorsOffset();
+      const auto size = _data.size() - offset;
+      DEBUG_ASSERT(size % sizeof(QuantizedActorDynamicState) == 0u);
+      return MakeView<QuantizedActorDynamicState>(
+          offset,
+          size / sizeof(QuantizedActorDynamicState));
+    }
+
+  private:
+
+    RawData _data;
   };
 
 } // namespace data
@@ -0,0 +1,135 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/s11n/EpisodeStateEncoder.h"
+
+#include "carla/Debug.h"
+#include "carla/sensor/s11n/EpisodeStateSerializer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  using Serializer = EpisodeStateSerializer;
+
+  template <typename T>
+  static void WriteData(Buffer::iterator &it, const T *data, size_t count) {
+    const auto size = sizeof(T) * count;
+    if (size > 0u) {
+      std::memcpy(it, data, size);
+      it += size;
+    }
+  }
+
+  void EpisodeStateEncoder::Reset(
+      const double game_timestamp,
+      const double platform_timestamp,
+      const size_t actor_count) {
+    _game_timestamp = game_timestamp;
+    _platform_timestamp = platform_timestamp;
+    _actors.clear();
+    _quantized.clear();
+    if (IsDeltaEncoded()) {
+      _quantized.reserve(actor_count);
+    } else {
+      _actors.reserve(actor_count);
+    }
+  }
+
+  void EpisodeStateEncoder::WriteActor(const data::ActorDynamicState &state) {
+    if (IsDeltaEncoded()) {
+      _quantized.emplace_back(state);
+    } else {
+      _actors.emplace_back(state);
+    }
+  }
+
+  Buffer EpisodeStateEncoder::Encode(Buffer buffer) {
+    return IsDeltaEncoded() ?
+        EncodeDelta(std::move(buffer)) :
+        EncodeFull(std::move(buffer));
+  }
+
+  Buffer EpisodeStateEncoder::EncodeFull(Buffer buffer) {
+    const Serializer::Header header = {
+      _game_timestamp,
+      _platform_timestamp,
+      Serializer::FrameType::Full};
+    buffer.reset(sizeof(header) + sizeof(data::ActorDynamicState) * _actors.size());
+    auto it = buffer.begin();
+    WriteData(it, &header, 1u);
+    WriteData(it, _actors.data(), _actors.size());
+    DEBUG_ASSERT(it == buffer.end());
+    return buffer;
+  }
+
+  Buffer EpisodeStateEncoder::EncodeDelta(Buffer buffer) {
+    const bool is_keyframe =
+        _keyframe_requested ||
+        ((_sequence % _keyframe_interval) == 0u);
+    _keyframe_requested = false;
+
+    // Find the actors that changed or appeared since the previous frame.
+    _updated.clear();
+    for (auto &&actor : _quantized) {
+      auto result = _sent.emplace(actor.GetId(), SentState{actor, _sequence});
+      auto &sent = result.first->second;
+      if (is_keyframe || result.second || (sent.state != actor)) {
+        _updated.emplace_back(actor);
+        sent.state = actor;
+      }
+      sent.sequence = _sequence;
+    }
+
+    // Find the actors that disappeared. Keyframes replace the whole state so
+    // they don't need to list them.
+    _removed.clear();
+    for (auto it = _sent.begin(); it != _sent.end();) {
+      if (it->second.sequence != _sequence) {
+        if (!is_keyframe) {
+          _removed.emplace_back(it->first);
+        }
+        it = _sent.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    // Sorted so the client can merge them with its state in a single pass.
+    std::sort(_updated.begin(), _updated.end(), [](const auto &lhs, const auto &rhs) {
+      return lhs.GetId() < rhs.GetId();
+    });
+    std::sort(_removed.begin(), _removed.end());
+
+    const Serializer::Header header = {
+      _game_timestamp,
+      _platform_timestamp,
+      is_keyframe ? Serializer::FrameType::Keyframe : Serializer::FrameType::Delta};
+    const Serializer::DeltaHeader delta_header = {
+      _sequence,
+      static_cast<uint32_t>(_removed.size())};
+    buffer.reset(
+        sizeof(header) +
+        sizeof(delta_header) +
+        sizeof(actor_id_type) * _removed.size() +
+        sizeof(QuantizedState) * _updated.size());
+    auto it = buffer.begin();
+    WriteData(it, &header, 1u);
+    WriteData(it, &delta_header, 1u);
+    WriteData(it, _removed.data(), _removed.size());
+    WriteData(it, _updated.data(), _updated.size());
+    DEBUG_ASSERT(it == buffer.end());
+
+    ++_sequence;
+    return buffer;
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
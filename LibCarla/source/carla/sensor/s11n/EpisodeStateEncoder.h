@@ -0,0 +1,97 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/rpc/ActorId.h"
+#include "carla/sensor/data/ActorDynamicState.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  /// Helper class to store and serialize the state of the actors of the
+  /// episode, see EpisodeStateSerializer.
+  ///
+  /// With a keyframe interval of zero every frame is sent full. Otherwise the
+  /// state is delta encoded: every @a keyframe_interval frames a keyframe with
+  /// every actor is sent, and in between only the actors whose quantized state
+  /// changed plus the ids of the actors removed. Clients joining the stream in
+  /// between wait for the next keyframe.
+  ///
+  /// @warning Keeps the state sent in the previous frame, the same encoder
+  /// cannot be used for more than one stream.
+  class EpisodeStateEncoder : private MovableNonCopyable {
+  public:
+
+    explicit EpisodeStateEncoder(uint32_t keyframe_interval = 0u)
+      : _keyframe_interval(keyframe_interval) {}
+
+    bool IsDeltaEncoded() const {
+      return _keyframe_interval > 0u;
+    }
+
+    /// Start a new frame.
+    void Reset(double game_timestamp, double platform_timestamp, size_t actor_count);
+
+    void WriteActor(const data::ActorDynamicState &state);
+
+    /// Make the next frame a keyframe.
+    void RequestKeyframe() {
+      _keyframe_requested = true;
+    }
+
+  private:
+
+    friend class EpisodeStateSerializer;
+
+    Buffer Encode(Buffer buffer);
+
+    Buffer EncodeFull(Buffer buffer);
+
+    Buffer EncodeDelta(Buffer buffer);
+
+    using QuantizedState = data::detail::QuantizedActorDynamicState;
+
+    struct SentState {
+      QuantizedState state;
+      uint32_t sequence;
+    };
+
+    uint32_t _keyframe_interval;
+
+    uint32_t _sequence = 0u;
+
+    bool _keyframe_requested = true;
+
+    double _game_timestamp = 0.0;
+
+    double _platform_timestamp = 0.0;
+
+    /// Actors of the current frame if sent full.
+    std::vector<data::ActorDynamicState> _actors;
+
+    /// Actors of the current frame if delta encoded.
+    std::vector<QuantizedState> _quantized;
+
+    std::vector<QuantizedState> _updated;
+
+    std::vector<actor_id_type> _removed;
+
+    /// Last state sent of every actor, and the sequence number of the last
+    /// frame in which the actor was present.
+    std::unordered_map<actor_id_type, SentState> _sent;
+  };
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
@@ -13,6 +13,9 @@
 #include "carla/geom/Vector3D.h"
 #include "carla/sensor/RawData.h"
 #include "carla/sensor/data/ActorDynamicState.h"
+#include "carla/sensor/s11n/EpisodeStateEncoder.h"
+
+#include <cstdint>
 
 namespace carla {
 namespace sensor {
@@ -22,13 +25,33 @@ namespace sensor {
 namespace s11n {
 
   /// Serializes the current state of the whole episode.
+  ///
+  /// Every message starts with a Header. Full frames follow it with an array
+  /// of ActorDynamicState, one per actor. Keyframes and deltas, see
+  /// EpisodeStateEncoder, follow it with a DeltaHeader, the ids of the actors
+  /// removed since the previous frame, and the quantized state of the actors
+  /// that changed sorted by id. Keyframes contain every actor.
   class EpisodeStateSerializer {
   public:
 
+    enum class FrameType : uint8_t {
+      Full,
+      Keyframe,
+      Delta
+    };
+
 #pragma pack(push, 1)
     struct Header {
       double game_timestamp;
       double platform_timestamp;
+      FrameType frame_type;
+    };
+
+    struct DeltaHeader {
+      /// Incremented every frame, a delta can only be applied on top of the
+      /// frame with the previous sequence number.
+      uint32_t sequence;
+      uint32_t removed_count;
     };
 #pragma pack(pop)
 
@@ -38,14 +61,32 @@ namespace s11n {
       return *reinterpret_cast<const Header *>(message.begin());
     }
 
-    template <typename SensorT>
-    static Buffer Serialize(const SensorT &, Buffer buffer) {
-      return buffer;
+    static const DeltaHeader &DeserializeDeltaHeader(const RawData &message) {
+      DEBUG_ASSERT(DeserializeHeader(message).frame_type != FrameType::Full);
+      return *reinterpret_cast<const DeltaHeader *>(message.begin() + header_offset);
     }
 
+    template <typename SensorT>
+    static Buffer Serialize(
+        const SensorT &sensor,
+        EpisodeStateEncoder &encoder,
+        Buffer buffer);
+
     static SharedPtr<SensorData> Deserialize(RawData data);
   };
 
+  // ===========================================================================
+  // -- EpisodeStateSerializer implementation ----------------------------------
+  // ===========================================================================
+
+  template <typename SensorT>
+  inline Buffer EpisodeStateSerializer::Serialize(
+      const SensorT &,
+      EpisodeStateEncoder &encoder,
+      Buffer buffer) {
+    return encoder.Encode(std::move(buffer));
+  }
+
 } // namespace s11n
 } // namespace sensor
 } // namespace carla
@@ -33,6 +33,15 @@ namespace streaming {
       _service.Stop();
     }
 
+    /// Whether subsequent subscriptions may receive the data through shared
+    /// memory when the server is on the same host, disabled by default. With
+    /// shared memory the callbacks are called from a thread of each
+    /// subscription instead of the io_service, and a slow callback loses the
+    /// oldest messages (see tcp::ServerSession).
+    void EnableSharedMemory(bool enable) {
+      _client.EnableSharedMemory(enable);
+    }
+
     /// @warning cannot subscribe twice to the same stream (even if it's a
     /// MultiStream).
     template <typename Functor>
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "carla/streaming/detail/AsioThreadPool.h"
+#include "carla/streaming/detail/SendQueue.h"
 #include "carla/streaming/detail/tcp/Server.h"
 #include "carla/streaming/low_level/Server.h"
 
@@ -15,6 +16,8 @@
 namespace carla {
 namespace streaming {
 
+  using SendQueuePolicy = detail::SendQueuePolicy;
+
   /// A streaming server. Each new stream has a token associated, this token can
   /// be used by a client to subscribe to the stream.
   class Server {
@@ -44,6 +47,21 @@ namespace streaming {
       _server.SetTimeout(timeout);
     }
 
+    /// Set the policy applied when a client cannot keep up with a stream, and
+    /// the number of messages each session can hold waiting to be sent.
+    /// Applies only to newly connected clients.
+    void SetSendQueue(SendQueuePolicy policy, uint32_t max_size) {
+      detail::SendQueueSettings settings;
+      settings.policy = policy;
+      settings.max_size = max_size;
+      _server.SetSendQueue(settings);
+    }
+
+    /// Number of messages queued, sent and dropped by all the sessions.
+    detail::SendQueueStatistics GetSendQueueStatistics() const {
+      return _server.GetSendQueueStatistics();
+    }
+
     Stream MakeStream() {
       return _server.MakeStream();
     }
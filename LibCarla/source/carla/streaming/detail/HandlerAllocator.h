@@ -0,0 +1,87 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+
+  /// A block of memory reused by the handlers of a chain of asynchronous
+  /// operations, where only one handler is alive at a time. If the block is
+  /// in use or too small, memory is allocated on the heap.
+  template <size_t Size>
+  class HandlerMemory : private NonCopyable {
+  public:
+
+    void *Allocate(const size_t size) {
+      if ((size <= Size) && !_in_use.exchange(true, std::memory_order_acquire)) {
+        return &_storage;
+      }
+      return ::operator new(size);
+    }
+
+    void Deallocate(void *pointer) {
+      if (pointer == &_storage) {
+        _in_use.store(false, std::memory_order_release);
+      } else {
+        ::operator delete(pointer);
+      }
+    }
+
+  private:
+
+    typename std::aligned_storage<Size>::type _storage;
+
+    std::atomic_bool _in_use{false};
+  };
+
+  /// Wraps an asio completion handler so that asio allocates its operations
+  /// in @a memory.
+  template <typename MemoryT, typename HandlerT>
+  class AllocatingHandler {
+  public:
+
+    AllocatingHandler(MemoryT &memory, HandlerT handler)
+      : _memory(memory),
+        _handler(std::move(handler)) {}
+
+    template <typename... Args>
+    void operator()(Args &&... args) {
+      _handler(std::forward<Args>(args)...);
+    }
+
+    friend void *asio_handler_allocate(size_t size, AllocatingHandler *self) {
+      return self->_memory.Allocate(size);
+    }
+
+    friend void asio_handler_deallocate(void *pointer, size_t, AllocatingHandler *self) {
+      self->_memory.Deallocate(pointer);
+    }
+
+  private:
+
+    MemoryT &_memory;
+
+    HandlerT _handler;
+  };
+
+  template <typename MemoryT, typename HandlerT>
+  static inline auto MakeAllocatingHandler(MemoryT &memory, HandlerT handler) {
+    return AllocatingHandler<MemoryT, HandlerT>(memory, std::move(handler));
+  }
+
+} // namespace detail
+} // namespace streaming
+} // namespace carla
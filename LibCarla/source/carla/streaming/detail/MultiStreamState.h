@@ -9,6 +9,7 @@
 #include "carla/AtomicSharedPtr.h"
 #include "carla/streaming/detail/StreamStateBase.h"
 
+#include <algorithm>
 #include <mutex>
 #include <vector>
 
@@ -18,20 +19,32 @@ namespace detail {
 
   /// A stream state that can hold any number of sessions.
   ///
-  /// @todo Lacking some optimization.
+  /// The list of sessions is copied on write, writing to the stream only
+  /// needs to load the current list, while connecting and disconnecting
+  /// sessions (much less frequent) replaces the whole list.
   class MultiStreamState final : public StreamStateBase {
+
+    using session_list = std::vector<std::shared_ptr<Session>>;
+
   public:
 
-    using StreamStateBase::StreamStateBase;
+    explicit MultiStreamState(const token_type &token)
+      : StreamStateBase(token),
+        _sessions(std::make_shared<session_list>()) {}
 
     template <typename... Buffers>
     void Write(Buffers... buffers) {
+      auto sessions = _sessions.load();
+      if (sessions->empty()) {
+        return;
+      }
       auto message = Session::MakeMessage(std::move(buffers)...);
-      std::lock_guard<std::mutex> lock(_mutex);
-      for (auto &session : _sessions) {
-        if (session != nullptr) {
-          session->Write(message);
-        }
+      // Sessions that block the producer share a single deadline, so slow
+      // clients delay the producer one time-out at most, not one each.
+      const auto deadline = sessions->front()->GetWriteDeadline();
+      for (auto &session : *sessions) {
+        DEBUG_ASSERT(session != nullptr);
+        session->Write(message, deadline);
       }
     }
 
@@ -40,25 +53,30 @@ namespace detail {
     void ConnectSession(std::shared_ptr<Session> session) final {
       DEBUG_ASSERT(session != nullptr);
       std::lock_guard<std::mutex> lock(_mutex);
-      _sessions.emplace_back(std::move(session));
+      auto sessions = std::make_shared<session_list>(*_sessions.load());
+      sessions->emplace_back(std::move(session));
+      _sessions = std::move(sessions);
     }
 
     void DisconnectSession(std::shared_ptr<Session> session) final {
-      std::lock_guard<std::mutex> lock(_mutex);
       DEBUG_ASSERT(session != nullptr);
-      _sessions.erase(
-          std::remove(_sessions.begin(), _sessions.end(), session),
-          _sessions.end());
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto sessions = std::make_shared<session_list>(*_sessions.load());
+      sessions->erase(
+          std::remove(sessions->begin(), sessions->end(), session),
+          sessions->end());
+      _sessions = std::move(sessions);
     }
 
     void ClearSessions() final {
       std::lock_guard<std::mutex> lock(_mutex);
-      _sessions.clear();
+      _sessions = std::make_shared<session_list>();
     }
 
+    /// Serializes the modifications of the session list, Write never locks.
     std::mutex _mutex;
 
-    std::vector<std::shared_ptr<Session>> _sessions;
+    AtomicSharedPtr<const session_list> _sessions;
   };
 
 } // namespace detail
@@ -0,0 +1,96 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+
+  /// What to do with an outgoing message when the send queue of a session is
+  /// full.
+  enum class SendQueuePolicy : uint8_t {
+    /// Discard every queued message and keep only the incoming one, the client
+    /// jumps straight to the most recent data.
+    KeepLatest,
+    /// Discard the oldest queued message to make room for the incoming one.
+    DropOldest,
+    /// Block the producer until there is room in the queue, or until the
+    /// session time-out expires, in which case the message is discarded.
+    BlockProducer,
+    /// Replace the newest queued message with the incoming one. Older
+    /// messages keep their place, the client still receives them and the most
+    /// recent data.
+    ReplaceNewest
+  };
+
+  /// Settings of the outgoing message queue of a session. @a max_size is the
+  /// number of messages that can wait while another one is being written.
+  struct SendQueueSettings {
+    SendQueuePolicy policy = SendQueuePolicy::DropOldest;
+    uint32_t max_size = 3u;
+  };
+
+  /// Snapshot of the send queue counters.
+  struct SendQueueStatistics {
+    /// Messages accepted into the queue.
+    size_t queued = 0u;
+    /// Messages successfully written to the socket.
+    size_t sent = 0u;
+    /// Messages discarded, either by the queue policy or because the session
+    /// was closed.
+    size_t dropped = 0u;
+    /// Write operations issued to the socket, several queued messages are
+    /// gathered into a single write.
+    size_t writes = 0u;
+  };
+
+  /// Thread-safe counters of a send queue.
+  class SendQueueCounters {
+  public:
+
+    void AddQueued(size_t count = 1u) {
+      _queued.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void AddSent(size_t count = 1u) {
+      _sent.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void AddDropped(size_t count = 1u) {
+      _dropped.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void AddWrite() {
+      _writes.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    SendQueueStatistics GetStatistics() const {
+      SendQueueStatistics result;
+      result.queued = _queued.load(std::memory_order_relaxed);
+      result.sent = _sent.load(std::memory_order_relaxed);
+      result.dropped = _dropped.load(std::memory_order_relaxed);
+      result.writes = _writes.load(std::memory_order_relaxed);
+      return result;
+    }
+
+  private:
+
+    std::atomic_size_t _queued{0u};
+
+    std::atomic_size_t _sent{0u};
+
+    std::atomic_size_t _dropped{0u};
+
+    std::atomic_size_t _writes{0u};
+  };
+
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,357 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/shm/Ring.h"
+
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+
+#include <atomic>
+#include <climits>
+#include <limits>
+#include <new>
+
+#ifdef __linux__
+#  include <fcntl.h>
+#  include <linux/futex.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <sys/syscall.h>
+#  include <time.h>
+#  include <unistd.h>
+#endif // __linux__
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+  static_assert(ATOMIC_INT_LOCK_FREE == 2, "Shared memory requires lock-free atomics.");
+
+  static constexpr uint32_t RING_MAGIC = 0x43524e47; // "CRNG"
+
+  static constexpr size_t CACHE_LINE = 64u;
+
+  static constexpr size_t Align(size_t size) {
+    return (size + CACHE_LINE - 1u) & ~(CACHE_LINE - 1u);
+  }
+
+  struct RingHeader {
+    uint32_t magic;
+    uint32_t number_of_slots;
+    uint64_t slot_size;
+    /// Sequence number of the last message written, used as futex word.
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint32_t> waiters;
+    std::atomic<uint32_t> closed;
+  };
+
+  /// A slot is valid for message n while its sequence is 2n, and it is being
+  /// overwritten while it is odd.
+  struct SlotHeader {
+    std::atomic<uint32_t> sequence;
+    uint32_t size;
+  };
+
+  static size_t GetSlotStride(size_t slot_size) {
+    return Align(sizeof(SlotHeader)) + Align(slot_size);
+  }
+
+  static size_t GetMemorySize(size_t number_of_slots, size_t slot_size) {
+    return Align(sizeof(RingHeader)) + number_of_slots * GetSlotStride(slot_size);
+  }
+
+  /// Whether the header of a ring created by another process describes a
+  /// ring of exactly @a memory_size bytes. The values are read once, the
+  /// ring keeps its own copy.
+  static bool IsValidHeader(
+      const RingHeader &header,
+      const size_t memory_size,
+      uint32_t &number_of_slots,
+      size_t &slot_size) {
+    number_of_slots = header.number_of_slots;
+    slot_size = header.slot_size;
+    if ((header.magic != RING_MAGIC) ||
+        (number_of_slots == 0u) ||
+        (slot_size == 0u) ||
+        (slot_size > std::numeric_limits<uint32_t>::max()) ||
+        (memory_size < Align(sizeof(RingHeader)))) {
+      return false;
+    }
+    const auto available = memory_size - Align(sizeof(RingHeader));
+    const auto stride = GetSlotStride(slot_size);
+    // Compared by division so a corrupted header cannot overflow the size.
+    return (available / stride == number_of_slots) && (available % stride == 0u);
+  }
+
+  // ===========================================================================
+  // -- Platform specific ------------------------------------------------------
+  // ===========================================================================
+
+#ifdef __linux__
+
+  bool Ring::IsSupported() {
+    return true;
+  }
+
+  std::string Ring::MakeName(const std::string &tag) {
+    return "/carla-" + std::to_string(getpid()) + "-" + tag;
+  }
+
+  static void FutexWait(std::atomic<uint32_t> &word, uint32_t expected, time_duration timeout) {
+    const auto ms = timeout.milliseconds();
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(ms / 1000u);
+    ts.tv_nsec = static_cast<long>((ms % 1000u) * 1000000u);
+    // Not a private futex, the word is shared between processes.
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+  }
+
+  static void FutexWakeAll(std::atomic<uint32_t> &word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+  }
+
+  static void *MapSharedMemory(const std::string &name, size_t size, bool create) {
+    const int flags = create ? (O_CREAT | O_EXCL | O_RDWR) : O_RDWR;
+    const int fd = shm_open(name.c_str(), flags, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+      log_error("shared memory: cannot open", name);
+      return nullptr;
+    }
+    if (create && (ftruncate(fd, static_cast<off_t>(size)) != 0)) {
+      log_error("shared memory: cannot allocate", size, "bytes for", name);
+      close(fd);
+      shm_unlink(name.c_str());
+      return nullptr;
+    }
+    void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+      log_error("shared memory: cannot map", name);
+      if (create) {
+        shm_unlink(name.c_str());
+      }
+      return nullptr;
+    }
+    return memory;
+  }
+
+  static size_t GetSharedMemorySize(const std::string &name) {
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+      return 0u;
+    }
+    struct stat info;
+    const auto result = fstat(fd, &info);
+    close(fd);
+    return result == 0 ? static_cast<size_t>(info.st_size) : 0u;
+  }
+
+  static void UnmapSharedMemory(const std::string &name, void *memory, size_t size, bool unlink) {
+    munmap(memory, size);
+    if (unlink) {
+      shm_unlink(name.c_str());
+    }
+  }
+
+#else
+
+  bool Ring::IsSupported() {
+    return false;
+  }
+
+  std::string Ring::MakeName(const std::string &tag) {
+    return "/carla-" + tag;
+  }
+
+  static void FutexWait(std::atomic<uint32_t> &, uint32_t, time_duration) {}
+
+  static void FutexWakeAll(std::atomic<uint32_t> &) {}
+
+  static void *MapSharedMemory(const std::string &, size_t, bool) {
+    return nullptr;
+  }
+
+  static size_t GetSharedMemorySize(const std::string &) {
+    return 0u;
+  }
+
+  static void UnmapSharedMemory(const std::string &, void *, size_t, bool) {}
+
+#endif // __linux__
+
+  // ===========================================================================
+  // -- Ring -------------------------------------------------------------------
+  // ===========================================================================
+
+  std::unique_ptr<Ring> Ring::Create(
+      const std::string &name,
+      const size_t number_of_slots,
+      const size_t slot_size) {
+    DEBUG_ASSERT(number_of_slots > 0u);
+    DEBUG_ASSERT(slot_size > 0u);
+    const auto memory_size = GetMemorySize(number_of_slots, slot_size);
+    void *memory = MapSharedMemory(name, memory_size, true);
+    if (memory == nullptr) {
+      return nullptr;
+    }
+    auto *header = new (memory) RingHeader;
+    header->magic = RING_MAGIC;
+    header->number_of_slots = static_cast<uint32_t>(number_of_slots);
+    header->slot_size = slot_size;
+    header->sequence = 0u;
+    header->waiters = 0u;
+    header->closed = 0u;
+    std::unique_ptr<Ring> ring{new Ring(
+        name,
+        memory,
+        memory_size,
+        true,
+        header->number_of_slots,
+        slot_size)};
+    for (auto i = 0u; i < number_of_slots; ++i) {
+      auto *slot = new (&ring->GetSlot(i)) SlotHeader;
+      slot->sequence = 0u;
+      slot->size = 0u;
+    }
+    return ring;
+  }
+
+  std::unique_ptr<Ring> Ring::Open(const std::string &name) {
+    const auto memory_size = GetSharedMemorySize(name);
+    if (memory_size < sizeof(RingHeader)) {
+      log_error("shared memory: cannot open ring", name);
+      return nullptr;
+    }
+    void *memory = MapSharedMemory(name, memory_size, false);
+    if (memory == nullptr) {
+      return nullptr;
+    }
+    uint32_t number_of_slots;
+    size_t slot_size;
+    const auto *header = reinterpret_cast<const RingHeader *>(memory);
+    if (!IsValidHeader(*header, memory_size, number_of_slots, slot_size)) {
+      log_error("shared memory: invalid ring", name);
+      UnmapSharedMemory(name, memory, memory_size, false);
+      return nullptr;
+    }
+    return std::unique_ptr<Ring>{new Ring(
+        name,
+        memory,
+        memory_size,
+        false,
+        number_of_slots,
+        slot_size)};
+  }
+
+  Ring::Ring(
+      std::string name,
+      void *memory,
+      size_t memory_size,
+      bool is_owner,
+      uint32_t number_of_slots,
+      size_t slot_size)
+    : _name(std::move(name)),
+      _memory(memory),
+      _memory_size(memory_size),
+      _is_owner(is_owner),
+      _header(reinterpret_cast<RingHeader *>(memory)),
+      _number_of_slots(number_of_slots),
+      _slot_size(slot_size) {}
+
+  Ring::~Ring() {
+    if (_is_owner) {
+      Close();
+    }
+    UnmapSharedMemory(_name, _memory, _memory_size, _is_owner);
+  }
+
+  size_t Ring::slot_size() const {
+    return _slot_size;
+  }
+
+  SlotHeader &Ring::GetSlot(const uint32_t sequence) const {
+    const auto index = sequence % _number_of_slots;
+    auto *begin = reinterpret_cast<unsigned char *>(_memory) + Align(sizeof(RingHeader));
+    return *reinterpret_cast<SlotHeader *>(begin + index * GetSlotStride(_slot_size));
+  }
+
+  unsigned char *Ring::GetSlotData(SlotHeader &slot) const {
+    return reinterpret_cast<unsigned char *>(&slot) + Align(sizeof(SlotHeader));
+  }
+
+  unsigned char *Ring::BeginWrite(const size_t size) {
+    _write_sequence = _header->sequence.load(std::memory_order_relaxed) + 1u;
+    auto &slot = GetSlot(_write_sequence);
+    slot.sequence.store(2u * _write_sequence - 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.size = static_cast<uint32_t>(size);
+    return GetSlotData(slot);
+  }
+
+  void Ring::EndWrite() {
+    GetSlot(_write_sequence).sequence.store(2u * _write_sequence, std::memory_order_release);
+    _header->sequence.store(_write_sequence);
+    if (_header->waiters.load() > 0u) {
+      FutexWakeAll(_header->sequence);
+    }
+  }
+
+  void Ring::Close() {
+    _header->closed = 1u;
+    FutexWakeAll(_header->sequence);
+  }
+
+  Ring::ReadResult Ring::Read(Buffer &buffer, const time_duration timeout, size_t &dropped) {
+    const auto number_of_slots = _number_of_slots;
+    for (;;) {
+      const uint32_t last = _header->sequence.load();
+      if (last == _next_sequence - 1u) {
+        // Messages written before closing are still delivered.
+        if (_header->closed.load() != 0u) {
+          return ReadResult::Closed;
+        }
+        // Nothing new, sleep until the producer writes.
+        ++_header->waiters;
+        if (_header->sequence.load() == last) {
+          FutexWait(_header->sequence, last, timeout);
+        }
+        --_header->waiters;
+        if (_header->sequence.load() == last) {
+          return _header->closed.load() != 0u ? ReadResult::Closed : ReadResult::Timeout;
+        }
+        continue;
+      }
+      const uint32_t available = last - _next_sequence + 1u;
+      if (available > number_of_slots) {
+        // We've been lapped, skip the messages already overwritten.
+        dropped += available - number_of_slots;
+        _next_sequence = last - number_of_slots + 1u;
+      }
+      auto &slot = GetSlot(_next_sequence);
+      const uint32_t expected = 2u * _next_sequence;
+      if (slot.sequence.load(std::memory_order_acquire) != expected) {
+        continue; // overwritten meanwhile.
+      }
+      const auto size = slot.size;
+      if (size > _slot_size) {
+        continue;
+      }
+      buffer.reset(size);
+      std::memcpy(buffer.data(), GetSlotData(slot), size);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) != expected) {
+        continue; // overwritten while copying.
+      }
+      ++_next_sequence;
+      return ReadResult::Message;
+    }
+  }
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
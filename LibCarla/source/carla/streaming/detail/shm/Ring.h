@@ -0,0 +1,159 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/Time.h"
+#include "carla/streaming/detail/Types.h"
+
+#include <boost/asio/buffer.hpp>
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+  /// Set by a client in the stream id it sends to the server to request the
+  /// shared memory transport.
+  constexpr stream_id_type SHARED_MEMORY_FLAG = 1u << 31;
+
+  /// Sent by the server over TCP each time the client needs to (re)open a
+  /// ring. An empty name means the server could not create the ring and the
+  /// data follows over TCP.
+  struct RingNotice {
+    char name[64u];
+  };
+
+  struct RingHeader;
+  struct SlotHeader;
+
+  /// A ring of fixed-size slots in POSIX shared memory, written by a single
+  /// producer and read by a single consumer in another process. When the
+  /// consumer is too slow the oldest messages are overwritten, the consumer
+  /// detects it and skips them. The consumer sleeps on a futex placed in the
+  /// shared memory, the producer only wakes it up if it is sleeping.
+  ///
+  /// Only available on Linux, elsewhere Create and Open return nullptr.
+  class Ring : private NonCopyable {
+  public:
+
+    static bool IsSupported();
+
+    /// Make a name for a ring unique to this process.
+    static std::string MakeName(const std::string &tag);
+
+    /// Create a new ring with @a number_of_slots slots of @a slot_size bytes.
+    /// The shared memory is unlinked when the ring is destroyed. Returns
+    /// nullptr on failure.
+    static std::unique_ptr<Ring> Create(
+        const std::string &name,
+        size_t number_of_slots,
+        size_t slot_size);
+
+    /// Open a ring created by another process. Returns nullptr on failure, or
+    /// if its header does not describe a ring of the size of the shared memory.
+    static std::unique_ptr<Ring> Open(const std::string &name);
+
+    ~Ring();
+
+    const std::string &name() const {
+      return _name;
+    }
+
+    size_t slot_size() const;
+
+    /// @name Producer
+    /// @{
+
+    /// Copy @a buffers into the next slot and wake up the consumer. Returns
+    /// false if the data does not fit in a slot.
+    template <typename ConstBufferSequence>
+    bool Write(const ConstBufferSequence &buffers) {
+      const auto size = boost::asio::buffer_size(buffers);
+      if (size > slot_size()) {
+        return false;
+      }
+      auto *data = BeginWrite(size);
+      for (auto &&buffer : buffers) {
+        const auto length = boost::asio::buffer_size(buffer);
+        std::memcpy(data, buffer.data(), length);
+        data += length;
+      }
+      EndWrite();
+      return true;
+    }
+
+    /// Mark the ring as closed and wake up the consumer.
+    void Close();
+
+    /// @}
+    /// @name Consumer
+    /// @{
+
+    enum class ReadResult {
+      Message,
+      Timeout,
+      Closed
+    };
+
+    /// Wait up to @a timeout for the next message and copy it into @a buffer.
+    /// Messages overwritten before they could be read are added to @a
+    /// dropped.
+    ReadResult Read(Buffer &buffer, time_duration timeout, size_t &dropped);
+
+    /// @}
+
+  private:
+
+    Ring(
+        std::string name,
+        void *memory,
+        size_t memory_size,
+        bool is_owner,
+        uint32_t number_of_slots,
+        size_t slot_size);
+
+    unsigned char *BeginWrite(size_t size);
+
+    void EndWrite();
+
+    SlotHeader &GetSlot(uint32_t sequence) const;
+
+    unsigned char *GetSlotData(SlotHeader &slot) const;
+
+    const std::string _name;
+
+    void *_memory;
+
+    const size_t _memory_size;
+
+    const bool _is_owner;
+
+    RingHeader *_header;
+
+    /// Copied from the header when the ring is created or opened, the other
+    /// process can't change them afterwards.
+    const uint32_t _number_of_slots;
+
+    const size_t _slot_size;
+
+    /// Sequence number of the next message to read.
+    uint32_t _next_sequence = 1u;
+
+    /// Sequence number of the message being written.
+    uint32_t _write_sequence = 0u;
+  };
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -10,11 +10,13 @@
 #include "carla/Debug.h"
 #include "carla/Logging.h"
 #include "carla/Time.h"
+#include "carla/streaming/detail/shm/Ring.h"
 
 #include <boost/asio/connect.hpp>
 #include <boost/asio/read.hpp>
 #include <boost/asio/write.hpp>
 
+#include <cstring>
 #include <exception>
 
 namespace carla {
@@ -26,20 +28,19 @@ namespace tcp {
   // -- IncomingMessage --------------------------------------------------------
   // ===========================================================================
 
-  /// Helper for reading incoming TCP messages. Allocates the whole message in
-  /// a single buffer.
+  /// Helper for reading incoming TCP messages. Reused for every message of a
+  /// client, the whole message is read into a single buffer.
   class IncomingMessage {
   public:
 
-    explicit IncomingMessage(Buffer buffer) : _message(std::move(buffer)) {}
-
     boost::asio::mutable_buffer size_as_buffer() {
       return boost::asio::buffer(&_size, sizeof(_size));
     }
 
-    boost::asio::mutable_buffer buffer() {
+    /// Pop from @a pool a buffer big enough for the message.
+    boost::asio::mutable_buffer buffer(BufferPool &pool) {
       DEBUG_ASSERT(_size > 0u);
-      _message.reset(_size);
+      _message = pool.Pop(_size);
       return _message.buffer();
     }
 
@@ -73,13 +74,18 @@ namespace tcp {
       _socket(io_service),
       _strand(io_service),
       _connection_timer(io_service),
-      _buffer_pool(std::make_shared<BufferPool>()) {
+      _buffer_pool(std::make_shared<BufferPool>()),
+      _incoming(std::make_unique<IncomingMessage>()),
+      _ring_reader_flags(std::make_shared<RingReaderFlags>()),
+      _ring_readers_stopped(std::make_shared<std::atomic_bool>(false)) {
     if (!_token.protocol_is_tcp()) {
       throw std::invalid_argument("invalid token, only TCP tokens supported");
     }
   }
 
-  Client::~Client() = default;
+  Client::~Client() {
+    StopReadingRing();
+  }
 
   void Client::Connect() {
     auto self = shared_from_this();
@@ -93,6 +99,8 @@ namespace tcp {
       if (_socket.is_open()) {
         _socket.close();
       }
+      StopReadingRing();
+      _is_shared_memory = false;
 
       DEBUG_ASSERT(_token.is_valid());
       DEBUG_ASSERT(_token.protocol_is_tcp());
@@ -105,14 +113,21 @@ namespace tcp {
           }
           log_debug("streaming client: connected to", ep);
           // Send the stream id to subscribe to the stream.
-          const auto &stream_id = _token.get_stream_id();
-          log_debug("streaming client: sending stream id", stream_id);
+          _handshake_id = _token.get_stream_id();
+          _is_shared_memory =
+              _shared_memory_enabled &&
+              shm::Ring::IsSupported() &&
+              IsServerOnSameHost();
+          if (_is_shared_memory) {
+            _handshake_id |= shm::SHARED_MEMORY_FLAG;
+          }
+          log_debug("streaming client: sending stream id", _handshake_id);
           boost::asio::async_write(
               _socket,
-              boost::asio::buffer(&stream_id, sizeof(stream_id)),
+              boost::asio::buffer(&_handshake_id, sizeof(_handshake_id)),
               _strand.wrap([=](error_code ec, size_t DEBUG_ONLY(bytes)) {
             if (!ec) {
-              DEBUG_ASSERT_EQ(bytes, sizeof(stream_id));
+              DEBUG_ASSERT_EQ(bytes, sizeof(_handshake_id));
               // If succeeded start reading data.
               ReadData();
             } else {
@@ -134,12 +149,15 @@ namespace tcp {
 
   void Client::Stop() {
     _connection_timer.cancel();
+    // Stop calling the callback from the ring reader right away.
+    *_ring_readers_stopped = true;
     auto self = shared_from_this();
     _strand.post([this, self]() {
       _done = true;
       if (_socket.is_open()) {
         _socket.close();
       }
+      StopReadingRing();
     });
   }
 
@@ -154,64 +172,174 @@ namespace tcp {
   }
 
   void Client::ReadData() {
-    auto self = shared_from_this();
-    _strand.post([this, self]() {
-      if (_done) {
-        return;
-      }
-
-      log_debug("streaming client: Client::ReadData");
+    // Runs in the strand, every message is read into the same IncomingMessage
+    // and every handler reuses the same memory, no allocation is needed
+    // unless the pool has no buffer big enough.
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    if (_done) {
+      return;
+    }
 
-      auto message = std::make_shared<IncomingMessage>(_buffer_pool->Pop());
+    log_debug("streaming client: Client::ReadData");
 
-      auto handle_read_data = [this, self, message](boost::system::error_code ec, size_t DEBUG_ONLY(bytes)) {
-        DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read_data", bytes, "bytes"));
-        if (!ec) {
-          DEBUG_ASSERT_EQ(bytes, message->size());
-          DEBUG_ASSERT_NE(bytes, 0u);
-          // Move the buffer to the callback function and start reading the next
-          // piece of data.
-          log_debug("streaming client: success reading data, calling the callback");
-          _socket.get_io_service().post([self, message]() { self->_callback(message->pop()); });
-          ReadData();
-        } else {
-          // As usual, if anything fails start over from the very top.
-          log_info("streaming client: failed to read data:", ec.message());
-          Connect();
-        }
-      };
+    auto self = shared_from_this();
 
-      auto handle_read_header = [this, self, message, handle_read_data](
-          boost::system::error_code ec,
-          size_t DEBUG_ONLY(bytes)) {
-        DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read_header", bytes, "bytes"));
-        if (!ec && (message->size() > 0u)) {
-          DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type));
-          if (_done) {
+    auto handle_read_data = [this, self](boost::system::error_code ec, size_t DEBUG_ONLY(bytes)) {
+      DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read_data", bytes, "bytes"));
+      if (!ec) {
+        DEBUG_ASSERT_EQ(bytes, _incoming->size());
+        DEBUG_ASSERT_NE(bytes, 0u);
+        // Move the buffer to the callback function and start reading the next
+        // piece of data.
+        if (_is_shared_memory) {
+          if (!HandleRingNotice(_incoming->pop())) {
             return;
           }
-          // Now that we know the size of the coming buffer, we can allocate our
-          // buffer and start putting data into it.
-          boost::asio::async_read(
-              _socket,
-              message->buffer(),
-              _strand.wrap(handle_read_data));
         } else {
-          log_info("streaming client: failed to read header:", ec.message());
-          DEBUG_ONLY(log_debug("size  = ", message->size()));
-          DEBUG_ONLY(log_debug("bytes = ", bytes));
-          Connect();
+          log_debug("streaming client: success reading data, calling the callback");
+          // Asio handlers must be copyable, the buffer waits in a queue.
+          _received_messages.enqueue(_incoming->pop());
+          _socket.get_io_service().post(MakeAllocatingHandler(_callback_handler_memory, [self]() {
+            Buffer message;
+            if (self->_received_messages.try_dequeue(message)) {
+              self->_callback(std::move(message));
+            }
+          }));
         }
-      };
+        ReadData();
+      } else {
+        // As usual, if anything fails start over from the very top.
+        log_info("streaming client: failed to read data:", ec.message());
+        Connect();
+      }
+    };
+
+    auto handle_read_header = [this, self, handle_read_data](
+        boost::system::error_code ec,
+        size_t DEBUG_ONLY(bytes)) {
+      DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read_header", bytes, "bytes"));
+      if (!ec && (_incoming->size() > 0u)) {
+        DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type));
+        if (_done) {
+          return;
+        }
+        // Now that we know the size of the coming buffer, we can pop a buffer
+        // big enough from the pool and start putting data into it.
+        boost::asio::async_read(
+            _socket,
+            _incoming->buffer(*_buffer_pool),
+            _strand.wrap(MakeAllocatingHandler(_read_handler_memory, handle_read_data)));
+      } else {
+        log_info("streaming client: failed to read header:", ec.message());
+        DEBUG_ONLY(log_debug("size  = ", _incoming->size()));
+        DEBUG_ONLY(log_debug("bytes = ", bytes));
+        Connect();
+      }
+    };
+
+    // Read the size of the buffer that is coming.
+    boost::asio::async_read(
+        _socket,
+        _incoming->size_as_buffer(),
+        _strand.wrap(MakeAllocatingHandler(_read_handler_memory, handle_read_header)));
+  }
+
+  bool Client::HandleRingNotice(Buffer buffer) {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    shm::RingNotice notice;
+    if (buffer.size() != sizeof(notice)) {
+      log_error("streaming client: invalid shared memory notice");
+      return true;
+    }
+    std::memcpy(&notice, buffer.data(), sizeof(notice));
+    notice.name[sizeof(notice.name) - 1u] = '\0';
+    if (notice.name[0u] == '\0') {
+      // The server could not create the ring, data follows over TCP.
+      log_info("streaming client: server fell back to TCP");
+      _is_shared_memory = false;
+      return true;
+    }
+    auto ring = shm::Ring::Open(notice.name);
+    if (ring == nullptr) {
+      log_info("streaming client: cannot open shared memory, reconnecting over TCP");
+      _shared_memory_enabled = false;
+      _is_shared_memory = false;
+      Connect();
+      return false;
+    }
+    log_debug("streaming client: reading from shared memory", notice.name);
+    StartReadingRing(std::move(ring));
+    return true;
+  }
+
+  /// Whether the current thread is a ring reader, these can't join another
+  /// ring reader as it may be waiting for them.
+  static thread_local bool IS_RING_READER = false;
 
-      // Read the size of the buffer that is coming.
-      boost::asio::async_read(
-          _socket,
-          message->size_as_buffer(),
-          _strand.wrap(handle_read_header));
+  void Client::StartReadingRing(std::unique_ptr<shm::Ring> ring) {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    if (_done) {
+      return;
+    }
+    if (_ring_reader.joinable()) {
+      // Let the previous reader drain its ring to keep the messages in order,
+      // the server closed it before sending this notice. If the server died
+      // the ring is never closed, so the reader also exits once it is empty.
+      _ring_reader_flags->drain = true;
+    }
+    _ring_reader_flags = std::make_shared<RingReaderFlags>();
+    // The thread does not touch this object, it may be destroyed from within
+    // the callback. The new reader waits for the previous one, so the strand
+    // never blocks on a reader.
+    _ring_reader = std::thread([
+        previous=std::move(_ring_reader),
+        ring=std::shared_ptr<shm::Ring>(std::move(ring)),
+        flags=_ring_reader_flags,
+        stopped=_ring_readers_stopped,
+        pool=_buffer_pool,
+        callback=_callback]() mutable {
+      IS_RING_READER = true;
+      if (previous.joinable()) {
+        previous.join();
+      }
+      size_t dropped = 0u;
+      while (!flags->stop && !*stopped) {
+        auto buffer = pool->Pop();
+        const auto result = ring->Read(buffer, time_duration::milliseconds(100u), dropped);
+        if (result == shm::Ring::ReadResult::Message) {
+          callback(std::move(buffer));
+        } else if ((result == shm::Ring::ReadResult::Closed) || flags->drain) {
+          break;
+        }
+      }
+      if (dropped > 0u) {
+        log_debug("streaming client:", dropped, "messages overwritten in shared memory");
+      }
     });
   }
 
+  void Client::StopReadingRing() {
+    _ring_reader_flags->stop = true;
+    if (_ring_reader.joinable()) {
+      if (IS_RING_READER) {
+        // Stopped from within the callback, the reader exits by itself.
+        _ring_reader.detach();
+      } else {
+        _ring_reader.join();
+      }
+    }
+  }
+
+  bool Client::IsServerOnSameHost() const {
+    boost::system::error_code ec;
+    const auto local = _socket.local_endpoint(ec);
+    if (ec) {
+      return false;
+    }
+    const auto remote = _socket.remote_endpoint(ec);
+    return !ec && (local.address() == remote.address());
+  }
+
 } // namespace tcp
 } // namespace detail
 } // namespace streaming
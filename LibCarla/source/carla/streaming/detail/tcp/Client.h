@@ -9,9 +9,12 @@
 #include "carla/Buffer.h"
 #include "carla/NonCopyable.h"
 #include "carla/profiler/LifetimeProfiled.h"
+#include "carla/streaming/detail/HandlerAllocator.h"
 #include "carla/streaming/detail/Token.h"
 #include "carla/streaming/detail/Types.h"
 
+#include "moodycamel/ConcurrentQueue.h"
+
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/ip/tcp.hpp>
@@ -20,6 +23,7 @@
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <thread>
 
 namespace carla {
 
@@ -27,10 +31,18 @@ namespace carla {
 
 namespace streaming {
 namespace detail {
+namespace shm { class Ring; }
 namespace tcp {
 
+  class IncomingMessage;
+
   /// A client that connects to a single stream.
   ///
+  /// If shared memory is enabled and the server runs on the same host, the
+  /// client asks the server to send the data through shared memory, and the
+  /// socket is only used for notifications. In that case the callback is
+  /// called from a thread of the client instead of the io_service.
+  ///
   /// @warning This client should be stopped before releasing the shared pointer
   /// or won't be destroyed.
   class Client
@@ -50,6 +62,12 @@ namespace tcp {
 
     ~Client();
 
+    /// Whether to use shared memory when the server is on the same host,
+    /// disabled by default. Only applies to subsequent connections.
+    void EnableSharedMemory(bool enable) {
+      _shared_memory_enabled = enable;
+    }
+
     void Connect();
 
     stream_id_type GetStreamId() const {
@@ -64,6 +82,17 @@ namespace tcp {
 
     void ReadData();
 
+    /// Bytes read from the socket in shared memory mode are the notices of
+    /// the server telling which ring to read from. Returns false if the
+    /// client is reconnecting.
+    bool HandleRingNotice(Buffer buffer);
+
+    void StartReadingRing(std::unique_ptr<shm::Ring> ring);
+
+    void StopReadingRing();
+
+    bool IsServerOnSameHost() const;
+
     const token_type _token;
 
     callback_function_type _callback;
@@ -76,7 +105,46 @@ namespace tcp {
 
     std::shared_ptr<BufferPool> _buffer_pool;
 
+    const std::unique_ptr<IncomingMessage> _incoming;
+
+    /// Memory for the handlers of the read operations, one at a time.
+    HandlerMemory<512u> _read_handler_memory;
+
+    /// Messages read waiting for the callback to be called.
+    moodycamel::ConcurrentQueue<Buffer> _received_messages;
+
+    /// Memory for posting the callback, falls back to the heap if the
+    /// previous callback has not been called yet.
+    HandlerMemory<256u> _callback_handler_memory;
+
     std::atomic_bool _done{false};
+
+    std::atomic_bool _shared_memory_enabled{false};
+
+    /// Stream id sent to the server, only accessed within the strand.
+    stream_id_type _handshake_id = 0u;
+
+    /// Only accessed within the strand.
+    bool _is_shared_memory = false;
+
+    /// Flags shared with a ring reader thread, the thread may outlive this
+    /// client if it is destroyed from within the callback.
+    struct RingReaderFlags {
+
+      /// Exit right away.
+      std::atomic_bool stop{false};
+
+      /// Exit once the ring is empty.
+      std::atomic_bool drain{false};
+    };
+
+    std::thread _ring_reader;
+
+    /// Flags of the current ring reader, only replaced within the strand.
+    std::shared_ptr<RingReaderFlags> _ring_reader_flags;
+
+    /// Set by Stop, shared with every ring reader.
+    const std::shared_ptr<std::atomic_bool> _ring_readers_stopped;
   };
 
 } // namespace tcp
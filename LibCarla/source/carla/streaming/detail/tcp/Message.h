@@ -75,6 +75,12 @@ namespace tcp {
       return MakeListView(begin, begin + _number_of_buffers + 1u);
     }
 
+    /// Same as GetBufferSequence but without the size header.
+    auto GetBodyBufferSequence() const {
+      auto begin = _buffer_views.begin() + 1u;
+      return MakeListView(begin, begin + _number_of_buffers);
+    }
+
   private:
 
     message_size_type _number_of_buffers = 0u;
@@ -90,6 +96,82 @@ namespace tcp {
   /// header and body sort of messages.
   using Message = MessageTmpl<2u>;
 
+  /// A chain of messages sent with a single scatter/gather write. The bytes
+  /// written are identical to writing each message separately. Template
+  /// parameter @a MaxNumberOfMessages imposes a compile-time limit on the
+  /// number of messages in the chain, no memory is allocated.
+  template <size_t MaxNumberOfMessages, typename MessageT = Message>
+  class MessageChainTmpl : private NonCopyable {
+  public:
+
+    static constexpr size_t max_size() {
+      return MaxNumberOfMessages;
+    }
+
+    MessageChainTmpl() = default;
+
+    /// Number of messages in the chain.
+    size_t number_of_messages() const noexcept {
+      return _number_of_messages;
+    }
+
+    /// Size in bytes of the chain including the headers of every message.
+    size_t size() const noexcept {
+      return _total_size;
+    }
+
+    bool empty() const noexcept {
+      return _number_of_messages == 0u;
+    }
+
+    bool full() const noexcept {
+      return _number_of_messages == max_size();
+    }
+
+    void Append(std::shared_ptr<const MessageT> message) {
+      DEBUG_ASSERT(message != nullptr);
+      DEBUG_ASSERT(!full());
+      for (auto &&view : message->GetBufferSequence()) {
+        _buffer_views[_number_of_buffers++] = view;
+      }
+      _total_size += sizeof(message_size_type) + message->size();
+      _messages[_number_of_messages++] = std::move(message);
+    }
+
+    /// Release the messages in the chain.
+    void Clear() {
+      for (auto i = 0u; i < _number_of_messages; ++i) {
+        _messages[i] = nullptr;
+      }
+      _number_of_messages = 0u;
+      _number_of_buffers = 0u;
+      _total_size = 0u;
+    }
+
+    auto GetBufferSequence() const {
+      auto begin = _buffer_views.begin();
+      return MakeListView(begin, begin + _number_of_buffers);
+    }
+
+  private:
+
+    size_t _number_of_messages = 0u;
+
+    size_t _number_of_buffers = 0u;
+
+    size_t _total_size = 0u;
+
+    std::array<std::shared_ptr<const MessageT>, MaxNumberOfMessages> _messages;
+
+    std::array<
+        boost::asio::const_buffer,
+        MaxNumberOfMessages * (MessageT::max_size() + 1u)> _buffer_views;
+  };
+
+  /// A chain of up to 32 messages, well below the limit of buffers that a
+  /// single scatter/gather operation can handle.
+  using MessageChain = MessageChainTmpl<32u>;
+
 } // namespace tcp
 } // namespace detail
 } // namespace streaming
@@ -17,7 +17,9 @@ namespace tcp {
 
   Server::Server(boost::asio::io_service &io_service, endpoint ep)
     : _acceptor(io_service, std::move(ep)),
-      _timeout(time_duration::seconds(10u)) {}
+      _timeout(time_duration::seconds(10u)),
+      _send_queue(SendQueueSettings{}),
+      _send_queue_counters(std::make_shared<SendQueueCounters>()) {}
 
   void Server::OpenSession(
       time_duration timeout,
@@ -25,7 +27,11 @@ namespace tcp {
       ServerSession::callback_function_type on_closed) {
     using boost::system::error_code;
 
-    auto session = std::make_shared<ServerSession>(_acceptor.get_io_service(), timeout);
+    auto session = std::make_shared<ServerSession>(
+        _acceptor.get_io_service(),
+        timeout,
+        _send_queue.load(),
+        _send_queue_counters);
 
     auto handle_query = [on_opened, on_closed, session](const error_code &ec) {
       if (!ec) {
@@ -8,12 +8,14 @@
 
 #include "carla/NonCopyable.h"
 #include "carla/Time.h"
+#include "carla/streaming/detail/SendQueue.h"
 #include "carla/streaming/detail/tcp/ServerSession.h"
 
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
 #include <atomic>
+#include <memory>
 
 namespace carla {
 namespace streaming {
@@ -36,6 +38,17 @@ namespace tcp {
       _timeout = timeout;
     }
 
+    /// Set the policy and size of the outgoing message queue of each session.
+    /// Applies only to newly created sessions.
+    void SetSendQueue(SendQueueSettings settings) {
+      _send_queue = settings;
+    }
+
+    /// Counters accumulated by all the sessions of this server.
+    SendQueueStatistics GetSendQueueStatistics() const {
+      return _send_queue_counters->GetStatistics();
+    }
+
     /// Start listening for connections. On each new connection, @a
     /// on_session_opened is called, and @a on_session_closed when the session
     /// is closed.
@@ -59,6 +72,10 @@ namespace tcp {
     boost::asio::ip::tcp::acceptor _acceptor;
 
     std::atomic<time_duration> _timeout;
+
+    std::atomic<SendQueueSettings> _send_queue;
+
+    const std::shared_ptr<SendQueueCounters> _send_queue_counters;
   };
 
 } // namespace tcp
@@ -12,7 +12,9 @@
 #include <boost/asio/read.hpp>
 #include <boost/asio/write.hpp>
 
+#include <algorithm>
 #include <atomic>
+#include <cstring>
 
 namespace carla {
 namespace streaming {
@@ -21,31 +23,58 @@ namespace tcp {
 
   static std::atomic_size_t SESSION_COUNTER{0u};
 
+  /// Queued messages are gathered into a single write up to this size, a
+  /// message bigger than this is always written on its own.
+  static constexpr size_t MAX_BYTES_PER_WRITE = 1024u * 1024u;
+
+  static constexpr size_t MIN_SHARED_MEMORY_SLOT_SIZE = 64u * 1024u;
+
+  static SendQueueSettings ValidateSettings(SendQueueSettings settings) {
+    // There must be room for at least one message waiting.
+    settings.max_size = std::max(settings.max_size, 1u);
+    return settings;
+  }
+
   ServerSession::ServerSession(
       boost::asio::io_service &io_service,
-      const time_duration timeout)
+      const time_duration timeout,
+      const SendQueueSettings send_queue,
+      std::shared_ptr<SendQueueCounters> server_counters)
     : LIBCARLA_INITIALIZE_LIFETIME_PROFILER(
           std::string("tcp server session ") + std::to_string(SESSION_COUNTER)),
       _session_id(SESSION_COUNTER++),
       _socket(io_service),
       _timeout(timeout),
       _deadline(io_service),
-      _strand(io_service) {}
+      _strand(io_service),
+      _send_queue_settings(ValidateSettings(send_queue)),
+      _server_counters(std::move(server_counters)) {}
 
   void ServerSession::Open(
       callback_function_type on_opened,
       callback_function_type on_closed) {
     DEBUG_ASSERT(on_opened && on_closed);
     _on_closed = std::move(on_closed);
-    StartTimer();
     auto self = shared_from_this(); // To keep myself alive.
     _strand.post([=]() {
 
       auto handle_query = [this, self, callback=std::move(on_opened)](
           const boost::system::error_code &ec,
           size_t DEBUG_ONLY(bytes_received)) {
-        DEBUG_ASSERT_EQ(bytes_received, sizeof(_stream_id));
         if (!ec) {
+          DEBUG_ASSERT_EQ(bytes_received, sizeof(_stream_id));
+          if ((_stream_id & shm::SHARED_MEMORY_FLAG) != 0u) {
+            _stream_id &= ~shm::SHARED_MEMORY_FLAG;
+            WatchForClientClose();
+            // The ring overwrites the oldest messages, it can't block the
+            // producer; such sessions keep writing to the socket.
+            _use_shared_memory =
+                shm::Ring::IsSupported() &&
+                (_send_queue_settings.policy != SendQueuePolicy::BlockProducer);
+            if (!_use_shared_memory) {
+              QueueRingNotice("");
+            }
+          }
           log_debug("session", _session_id, "for stream", _stream_id, " started");
           _socket.get_io_service().post([=]() { callback(self); });
         } else {
@@ -56,6 +85,7 @@ namespace tcp {
 
       // Read the stream id.
       _deadline.expires_from_now(_timeout);
+      StartTimer();
       boost::asio::async_read(
           _socket,
           boost::asio::buffer(&_stream_id, sizeof(_stream_id)),
@@ -63,39 +93,263 @@ namespace tcp {
     });
   }
 
-  void ServerSession::Write(std::shared_ptr<const Message> message) {
+  void ServerSession::Write(
+      std::shared_ptr<const Message> message,
+      const clock_type::time_point deadline) {
     DEBUG_ASSERT(message != nullptr);
     DEBUG_ASSERT(!message->empty());
-    auto self = shared_from_this();
-    _strand.post([=]() {
-      if (!_socket.is_open()) {
-        return;
-      }
-      if (_is_writing) {
+    if (_send_queue_settings.policy == SendQueuePolicy::BlockProducer) {
+      if (!WaitForRoomInQueue(deadline)) {
         log_debug("session", _session_id, ": connection too slow: message discarded");
+        DropMessages(1u);
         return;
       }
-      _is_writing = true;
+    } else {
+      ++_pending_messages;
+    }
+    auto self = shared_from_this();
+    _strand.post([this, self, message]() { EnqueueMessage(message); });
+  }
 
-      auto handle_sent = [this, self, message](const boost::system::error_code &ec, size_t DEBUG_ONLY(bytes)) {
-        _is_writing = false;
-        if (ec) {
-          log_info("session", _session_id, ": error sending data :", ec.message());
-          CloseNow();
-        } else {
-          DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
-          DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type) + message->size());
+  bool ServerSession::WaitForRoomInQueue(const clock_type::time_point deadline) {
+    std::unique_lock<std::mutex> lock(_send_queue_mutex);
+    const bool has_room = _send_queue_cv.wait_until(lock, deadline, [this]() {
+      return _pending_messages < _send_queue_settings.max_size;
+    });
+    if (has_room) {
+      ++_pending_messages;
+    }
+    return has_room;
+  }
+
+  void ServerSession::EnqueueMessage(std::shared_ptr<const Message> message) {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    if (!_socket.is_open()) {
+      ReleaseQueueSlots(1u);
+      DropMessages(1u);
+      return;
+    }
+    if (_use_shared_memory && WriteToSharedMemory(message)) {
+      return;
+    }
+    PushToSendQueue(std::move(message));
+  }
+
+  void ServerSession::PushToSendQueue(std::shared_ptr<const Message> message) {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    if (_send_queue.size() >= _send_queue_settings.max_size) {
+      log_debug("session", _session_id, ": connection too slow: send queue full");
+      size_t dropped = 0u;
+      switch (_send_queue_settings.policy) {
+        case SendQueuePolicy::KeepLatest:
+          dropped = _send_queue.size();
+          _send_queue.clear();
+          break;
+        case SendQueuePolicy::DropOldest:
+          dropped = 1u;
+          _send_queue.pop_front();
+          break;
+        case SendQueuePolicy::ReplaceNewest:
+          dropped = 1u;
+          _send_queue.pop_back();
+          break;
+        case SendQueuePolicy::BlockProducer:
+          // The producer already waited for a free slot.
+          break;
+      }
+      ReleaseQueueSlots(dropped);
+      DropMessages(dropped);
+    }
+    _send_queue.emplace_back(std::move(message));
+    _counters.AddQueued();
+    if (_server_counters != nullptr) {
+      _server_counters->AddQueued();
+    }
+    WriteNextMessage();
+  }
+
+  void ServerSession::WriteNextMessage() {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    if (_is_writing) {
+      return;
+    }
+    if (_ring_notice != nullptr) {
+      // Notices are not counted as messages and go before the queue, the
+      // queue only holds messages if the ring could not be created.
+      WriteRingNotice();
+      return;
+    }
+    if (_send_queue.empty()) {
+      return;
+    }
+    _is_writing = true;
+
+    DEBUG_ASSERT(_message_chain.empty());
+    do {
+      _message_chain.Append(std::move(_send_queue.front()));
+      _send_queue.pop_front();
+    } while (
+        !_send_queue.empty() &&
+        !_message_chain.full() &&
+        (_message_chain.size() + sizeof(message_size_type) + _send_queue.front()->size() <= MAX_BYTES_PER_WRITE));
+    const auto number_of_messages = _message_chain.number_of_messages();
+    ReleaseQueueSlots(number_of_messages);
+
+    auto self = shared_from_this();
+    auto handle_sent = [this, self, number_of_messages](const boost::system::error_code &ec, size_t DEBUG_ONLY(bytes)) {
+      _is_writing = false;
+      if (ec) {
+        log_info("session", _session_id, ": error sending data :", ec.message());
+        _message_chain.Clear();
+        DropMessages(number_of_messages);
+        CloseNow();
+      } else {
+        DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
+        DEBUG_ASSERT_EQ(bytes, _message_chain.size());
+        _message_chain.Clear();
+        _counters.AddSent(number_of_messages);
+        if (_server_counters != nullptr) {
+          _server_counters->AddSent(number_of_messages);
         }
-      };
+        WriteNextMessage();
+      }
+    };
 
-      log_debug("session", _session_id, ": sending message of", message->size(), "bytes");
+    log_debug(
+        "session", _session_id, ": sending", number_of_messages,
+        "messages,", _message_chain.size(), "bytes");
 
-      _deadline.expires_from_now(_timeout);
-      boost::asio::async_write(
-          _socket,
-          message->GetBufferSequence(),
-          _strand.wrap(handle_sent));
-    });
+    _counters.AddWrite();
+    if (_server_counters != nullptr) {
+      _server_counters->AddWrite();
+    }
+
+    _deadline.expires_from_now(_timeout);
+    boost::asio::async_write(
+        _socket,
+        _message_chain.GetBufferSequence(),
+        _strand.wrap(handle_sent));
+  }
+
+  bool ServerSession::WriteToSharedMemory(const std::shared_ptr<const Message> &message) {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    if ((_ring == nullptr) || (message->size() > _ring->slot_size())) {
+      if (!CreateRing(message->size())) {
+        return false;
+      }
+    }
+    // The ring keeps the size of each message, the header is not needed. If
+    // the client is too slow the ring overwrites the oldest message, so the
+    // message always counts as sent here.
+    _ring->Write(message->GetBodyBufferSequence());
+    _deadline.expires_from_now(_timeout);
+    ReleaseQueueSlots(1u);
+    _counters.AddQueued();
+    _counters.AddWrite();
+    _counters.AddSent();
+    if (_server_counters != nullptr) {
+      _server_counters->AddQueued();
+      _server_counters->AddWrite();
+      _server_counters->AddSent();
+    }
+    return true;
+  }
+
+  bool ServerSession::CreateRing(const size_t message_size) {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    size_t slot_size = MIN_SHARED_MEMORY_SLOT_SIZE;
+    while (slot_size < message_size) {
+      slot_size *= 2u;
+    }
+    const auto name = shm::Ring::MakeName(
+        std::to_string(_session_id) + "-" + std::to_string(_ring_generation++));
+    // Like the send queue, the ring holds max_size messages waiting plus the
+    // one being read.
+    auto ring = shm::Ring::Create(name, _send_queue_settings.max_size + 1u, slot_size);
+    if (ring != nullptr) {
+      log_debug("session", _session_id, ": writing to shared memory", name);
+    } else {
+      log_info("session", _session_id, ": shared memory not available, falling back to TCP");
+      _use_shared_memory = false;
+    }
+    // The previous ring, if any, is closed here; the client still reads the
+    // messages left in it before switching to the new one.
+    _ring = std::move(ring);
+    QueueRingNotice(_use_shared_memory ? name : "");
+    return _use_shared_memory;
+  }
+
+  void ServerSession::QueueRingNotice(const std::string &name) {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    shm::RingNotice notice;
+    std::memset(&notice, 0, sizeof(notice));
+    DEBUG_ASSERT(name.size() < sizeof(notice.name));
+    std::strncpy(notice.name, name.c_str(), sizeof(notice.name) - 1u);
+    // Only the latest notice matters, it replaces any notice not yet sent.
+    _ring_notice = MakeMessage(Buffer(reinterpret_cast<const unsigned char *>(&notice), sizeof(notice)));
+    WriteNextMessage();
+  }
+
+  void ServerSession::WriteRingNotice() {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    DEBUG_ASSERT(!_is_writing);
+    DEBUG_ASSERT(_ring_notice != nullptr);
+    _is_writing = true;
+    auto notice = std::move(_ring_notice);
+    auto self = shared_from_this();
+    _deadline.expires_from_now(_timeout);
+    boost::asio::async_write(
+        _socket,
+        notice->GetBufferSequence(),
+        _strand.wrap([this, self, notice](const boost::system::error_code &ec, size_t) {
+      _is_writing = false;
+      if (ec) {
+        log_info("session", _session_id, ": error sending shared memory notice :", ec.message());
+        CloseNow();
+      } else {
+        WriteNextMessage();
+      }
+    }));
+  }
+
+  void ServerSession::WatchForClientClose() {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    auto self = shared_from_this();
+    boost::asio::async_read(
+        _socket,
+        boost::asio::buffer(&_client_close_byte, sizeof(_client_close_byte)),
+        _strand.wrap([this, self](const boost::system::error_code &ec, size_t) {
+      if (!ec) {
+        WatchForClientClose();
+      } else if (_socket.is_open()) {
+        log_debug("session", _session_id, ": client closed the connection");
+        CloseNow();
+      }
+    }));
+  }
+
+  void ServerSession::DropMessages(const size_t count) {
+    if (count > 0u) {
+      _counters.AddDropped(count);
+      if (_server_counters != nullptr) {
+        _server_counters->AddDropped(count);
+      }
+    }
+  }
+
+  void ServerSession::ReleaseQueueSlots(const size_t count) {
+    if (count == 0u) {
+      return;
+    }
+    if (_send_queue_settings.policy == SendQueuePolicy::BlockProducer) {
+      {
+        std::lock_guard<std::mutex> lock(_send_queue_mutex);
+        _pending_messages -= count;
+      }
+      _send_queue_cv.notify_all();
+    } else {
+      _pending_messages -= count;
+    }
   }
 
   void ServerSession::Close() {
@@ -103,18 +357,24 @@ namespace tcp {
   }
 
   void ServerSession::StartTimer() {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    if (!_socket.is_open()) {
+      return;
+    }
     if (_deadline.expires_at() <= boost::asio::deadline_timer::traits_type::now()) {
       log_debug("session", _session_id, "timed out");
-      Close();
-    } else {
-      _deadline.async_wait([this, self=shared_from_this()](boost::system::error_code ec) {
-        if (!ec) {
-          StartTimer();
-        } else {
-          log_debug("session", _session_id, "timed out error:", ec.message());
-        }
-      });
+      CloseNow();
+      return;
     }
+    _deadline.async_wait(_strand.wrap([this, self=shared_from_this()](boost::system::error_code ec) {
+      // The wait is aborted too each time a write moves the deadline, the
+      // timer is armed again with the new deadline.
+      if (!ec || (ec == boost::asio::error::operation_aborted)) {
+        StartTimer();
+      } else {
+        log_debug("session", _session_id, "timed out error:", ec.message());
+      }
+    }));
   }
 
   void ServerSession::CloseNow() {
@@ -123,6 +383,12 @@ namespace tcp {
     if (_socket.is_open()) {
       _socket.close();
     }
+    const auto discarded = _send_queue.size();
+    _send_queue.clear();
+    ReleaseQueueSlots(discarded);
+    DropMessages(discarded);
+    _ring.reset();
+    _ring_notice = nullptr;
     _socket.get_io_service().post([self=shared_from_this()]() {
       DEBUG_ASSERT(self->_on_closed);
       self->_on_closed(self);
@@ -10,7 +10,9 @@
 #include "carla/Time.h"
 #include "carla/TypeTraits.h"
 #include "carla/profiler/LifetimeProfiled.h"
+#include "carla/streaming/detail/SendQueue.h"
 #include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/shm/Ring.h"
 #include "carla/streaming/detail/tcp/Message.h"
 
 #include <boost/asio/deadline_timer.hpp>
@@ -18,8 +20,14 @@
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/strand.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <string>
 
 namespace carla {
 namespace streaming {
@@ -28,17 +36,37 @@ namespace tcp {
 
   /// A TCP server session. When a session opens, it reads from the socket a
   /// stream id object and passes itself to the callback functor. The session
-  /// closes itself after @a timeout of inactivity is met.
+  /// closes itself if nothing is written to it for @a timeout, or if writing
+  /// a message takes longer than that.
+  ///
+  /// Outgoing messages wait in a bounded queue while the socket is busy, what
+  /// happens when the queue is full is decided by the SendQueuePolicy. Once
+  /// the socket is ready, all the queued messages are gathered into a single
+  /// write.
+  ///
+  /// If the client requests it in the stream id, and the platform supports
+  /// it, the messages are written to a shared memory ring instead and only
+  /// the name of the ring goes through the socket (see shm::Ring). The ring
+  /// holds as many messages as the send queue; when the client falls behind
+  /// the oldest messages are overwritten whatever the send queue policy, like
+  /// DropOldest, and the client counts them as dropped. Sessions with the
+  /// BlockProducer policy never use the ring, they write to the socket.
   class ServerSession
     : public std::enable_shared_from_this<ServerSession>,
       private profiler::LifetimeProfiled,
       private NonCopyable {
   public:
 
+    using clock_type = std::chrono::steady_clock;
+
     using socket_type = boost::asio::ip::tcp::socket;
     using callback_function_type = std::function<void(std::shared_ptr<ServerSession>)>;
 
-    explicit ServerSession(boost::asio::io_service &io_service, time_duration timeout);
+    explicit ServerSession(
+        boost::asio::io_service &io_service,
+        time_duration timeout,
+        SendQueueSettings send_queue = SendQueueSettings{},
+        std::shared_ptr<SendQueueCounters> server_counters = nullptr);
 
     /// Starts the session and calls @a on_opened after successfully reading the
     /// stream id, and @a on_closed once the session is closed.
@@ -60,8 +88,22 @@ namespace tcp {
       return std::make_shared<const Message>(std::move(buffers)...);
     }
 
-    /// Writes some data to the socket.
-    void Write(std::shared_ptr<const Message> message);
+    /// Writes some data to the socket. If the socket is busy the message is
+    /// queued according to the send queue policy of this session.
+    void Write(std::shared_ptr<const Message> message) {
+      Write(std::move(message), GetWriteDeadline());
+    }
+
+    /// Like above, but with the BlockProducer policy the producer waits for
+    /// room in the queue at most until @a deadline. Writing a message to
+    /// several sessions with the same deadline bounds the total time the
+    /// producer is blocked.
+    void Write(std::shared_ptr<const Message> message, clock_type::time_point deadline);
+
+    /// Deadline for a write starting now, one time-out from now.
+    clock_type::time_point GetWriteDeadline() const {
+      return clock_type::now() + _timeout.to_chrono();
+    }
 
     /// Writes some data to the socket.
     template <typename... Buffers>
@@ -72,8 +114,46 @@ namespace tcp {
     /// Post a job to close the session.
     void Close();
 
+    /// Counters of the messages written to this session.
+    SendQueueStatistics GetStatistics() const {
+      return _counters.GetStatistics();
+    }
+
   private:
 
+    /// Wait until there is room in the send queue, returns false if
+    /// @a deadline passed first.
+    bool WaitForRoomInQueue(clock_type::time_point deadline);
+
+    void EnqueueMessage(std::shared_ptr<const Message> message);
+
+    void PushToSendQueue(std::shared_ptr<const Message> message);
+
+    /// Returns false if the ring could not be created, in which case the
+    /// session falls back to TCP.
+    bool WriteToSharedMemory(const std::shared_ptr<const Message> &message);
+
+    /// Create a ring big enough for @a message_size bytes and send its name to
+    /// the client.
+    bool CreateRing(size_t message_size);
+
+    /// Send the client the name of the ring to read from, an empty name tells
+    /// it to read from the socket instead.
+    void QueueRingNotice(const std::string &name);
+
+    void WriteRingNotice();
+
+    /// The client does not send anything after the stream id, reading from
+    /// the socket is the way to notice it is gone when we are not writing to
+    /// it.
+    void WatchForClientClose();
+
+    void WriteNextMessage();
+
+    void DropMessages(size_t count);
+
+    void ReleaseQueueSlots(size_t count);
+
     void StartTimer();
 
     void CloseNow();
@@ -94,7 +174,40 @@ namespace tcp {
 
     callback_function_type _on_closed;
 
+    const SendQueueSettings _send_queue_settings;
+
+    /// Only accessed within the strand.
+    std::deque<std::shared_ptr<const Message>> _send_queue;
+
+    /// Messages being written, only accessed within the strand.
+    MessageChain _message_chain;
+
+    /// Messages posted by Write that have not yet left the queue.
+    std::atomic_size_t _pending_messages{0u};
+
+    std::mutex _send_queue_mutex;
+
+    std::condition_variable _send_queue_cv;
+
+    SendQueueCounters _counters;
+
+    std::shared_ptr<SendQueueCounters> _server_counters;
+
     bool _is_writing = false;
+
+    /// Only accessed within the strand.
+    bool _use_shared_memory = false;
+
+    /// Only accessed within the strand.
+    std::unique_ptr<shm::Ring> _ring;
+
+    /// Notice with the name of the current ring waiting to be sent, only
+    /// accessed within the strand.
+    std::shared_ptr<const Message> _ring_notice;
+
+    size_t _ring_generation = 0u;
+
+    char _client_close_byte;
   };
 
 } // namespace tcp
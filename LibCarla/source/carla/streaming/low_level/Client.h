@@ -46,6 +46,12 @@ namespace low_level {
       }
     }
 
+    /// Whether subsequent subscriptions may receive the data through shared
+    /// memory when the server is on the same host, disabled by default.
+    void EnableSharedMemory(bool enable) {
+      _shared_memory_enabled = enable;
+    }
+
     /// @warning cannot subscribe twice to the same stream (even if it's a
     /// MultiStream).
     template <typename Functor>
@@ -61,6 +67,7 @@ namespace low_level {
           io_service,
           token,
           std::forward<Functor>(callback));
+      client->EnableSharedMemory(_shared_memory_enabled);
       client->Connect();
       _clients.emplace(token.get_stream_id(), std::move(client));
     }
@@ -77,6 +84,8 @@ namespace low_level {
 
     boost::asio::ip::address _fallback_address;
 
+    bool _shared_memory_enabled = false;
+
     std::unordered_map<
         detail::stream_id_type,
         std::shared_ptr<underlying_client>> _clients;
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "carla/streaming/detail/Dispatcher.h"
+#include "carla/streaming/detail/SendQueue.h"
 #include "carla/streaming/Stream.h"
 
 #include <boost/asio/io_service.hpp>
@@ -61,6 +62,14 @@ namespace low_level {
       _server.SetTimeout(timeout);
     }
 
+    void SetSendQueue(detail::SendQueueSettings settings) {
+      _server.SetSendQueue(settings);
+    }
+
+    detail::SendQueueStatistics GetSendQueueStatistics() const {
+      return _server.GetSendQueueStatistics();
+    }
+
     Stream MakeStream() {
       return _dispatcher.MakeStream();
     }
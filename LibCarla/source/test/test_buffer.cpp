@@ -8,11 +8,14 @@
 
 #include <carla/Buffer.h>
 #include <carla/BufferPool.h>
+#include <carla/ThreadGroup.h>
 
 #include <array>
+#include <chrono>
 #include <list>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace util::buffer;
@@ -131,3 +134,124 @@ TEST(buffer, buffer_pool) {
   // Now delete the pool to test the weak reference inside the buffers.
   pool.reset();
 }
+
+TEST(buffer, buffer_pool_reuses_size_classes) {
+  auto pool = std::make_shared<carla::BufferPool>();
+  { auto buff = pool->Pop(1000u); ASSERT_EQ(buff.capacity(), 1024u); }
+  {
+    auto buff = pool->Pop(600u);
+    ASSERT_EQ(buff.size(), 600u);
+    ASSERT_EQ(buff.capacity(), 1024u);
+  }
+  // Too small for the pooled buffer's size class, a new one is allocated.
+  { auto buff = pool->Pop(2000u); ASSERT_EQ(buff.capacity(), 2048u); }
+  auto stats = pool->GetStatistics();
+  ASSERT_EQ(stats.hits, 1u);
+  ASSERT_EQ(stats.misses, 2u);
+  ASSERT_EQ(stats.pooled_buffers, 2u);
+  ASSERT_EQ(stats.pooled_bytes, 1024u + 2048u);
+  ASSERT_EQ(stats.evictions, 0u);
+  // The biggest buffers are returned first.
+  auto buff = pool->Pop();
+  ASSERT_EQ(buff.capacity(), 2048u);
+}
+
+TEST(buffer, buffer_pool_accounting) {
+  auto pool = std::make_shared<carla::BufferPool>();
+  {
+    auto buff0 = pool->Pop(4096u);
+    auto buff1 = pool->Pop(100u);
+    auto stats = pool->GetStatistics();
+    ASSERT_EQ(stats.outstanding_bytes, 4096u + 128u);
+    ASSERT_EQ(stats.pooled_bytes, 0u);
+    // Growing a buffer out of the pool is accounted too.
+    buff1.reset(10000u);
+    ASSERT_EQ(pool->GetStatistics().outstanding_bytes, 4096u + 10000u);
+  }
+  auto stats = pool->GetStatistics();
+  ASSERT_EQ(stats.outstanding_bytes, 0u);
+  ASSERT_EQ(stats.pooled_bytes, 4096u + 10000u);
+  ASSERT_EQ(stats.pooled_buffers, 2u);
+  pool->Clear();
+  stats = pool->GetStatistics();
+  ASSERT_EQ(stats.pooled_bytes, 0u);
+  ASSERT_EQ(stats.pooled_buffers, 0u);
+  ASSERT_EQ(stats.evictions, 2u);
+}
+
+TEST(buffer, buffer_pool_evicts_to_fit) {
+  auto pool = std::make_shared<carla::BufferPool>();
+  pool->SetMaxPooledBytes(3u * 1024u);
+  {
+    auto buff0 = pool->Pop(1024u);
+    auto buff1 = pool->Pop(2048u);
+    auto buff2 = pool->Pop(1024u);
+    // Returned in order: buff2, buff1, buff0.
+  }
+  // buff0 did not fit, buff2 was the oldest of its size class.
+  auto stats = pool->GetStatistics();
+  ASSERT_EQ(stats.pooled_bytes, 3u * 1024u);
+  ASSERT_EQ(stats.pooled_buffers, 2u);
+  ASSERT_EQ(stats.evictions, 1u);
+  // Buffers bigger than the limit are never pooled.
+  { auto buff = pool->Pop(8192u); }
+  stats = pool->GetStatistics();
+  ASSERT_EQ(stats.pooled_bytes, 3u * 1024u);
+  ASSERT_EQ(stats.evictions, 2u);
+  // Lowering the limit evicts right away, the biggest buffers first.
+  pool->SetMaxPooledBytes(2048u);
+  stats = pool->GetStatistics();
+  ASSERT_EQ(stats.pooled_bytes, 1024u);
+  ASSERT_EQ(stats.evictions, 3u);
+  auto buff = pool->Pop(1000u);
+  ASSERT_EQ(buff.capacity(), 1024u);
+  ASSERT_EQ(pool->GetStatistics().hits, 1u);
+}
+
+TEST(buffer, buffer_pool_concurrent) {
+  constexpr size_t number_of_threads = 4u;
+  constexpr size_t pops_per_thread = 10000u;
+  auto pool = std::make_shared<carla::BufferPool>();
+  pool->SetMaxPooledBytes(64u * 1024u);
+  carla::ThreadGroup threads;
+  threads.CreateThreads(number_of_threads, [&]() {
+    std::vector<carla::Buffer> buffers;
+    for (auto i = 0u; i < pops_per_thread; ++i) {
+      buffers.emplace_back(pool->Pop(64u << (i % 8u)));
+      if (buffers.size() == 4u) {
+        buffers.clear();
+      }
+    }
+  });
+  threads.JoinAll();
+  auto stats = pool->GetStatistics();
+  ASSERT_EQ(stats.hits + stats.misses, number_of_threads * pops_per_thread);
+  ASSERT_EQ(stats.outstanding_bytes, 0u);
+  ASSERT_LE(stats.pooled_bytes, 64u * 1024u);
+  pool->Clear();
+  stats = pool->GetStatistics();
+  ASSERT_EQ(stats.pooled_bytes, 0u);
+  ASSERT_EQ(stats.pooled_buffers, 0u);
+  ASSERT_EQ(stats.misses, stats.evictions);
+}
+
+TEST(buffer, buffer_pool_trims_idle_buffers) {
+  using namespace std::chrono_literals;
+  auto pool = std::make_shared<carla::BufferPool>();
+  { auto buff = pool->Pop(1024u); }
+  std::this_thread::sleep_for(20ms);
+  { auto buff = pool->Pop(4096u); }
+  pool->Trim(10ms);
+  auto stats = pool->GetStatistics();
+  ASSERT_EQ(stats.pooled_buffers, 1u);
+  ASSERT_EQ(stats.pooled_bytes, 4096u);
+  ASSERT_EQ(stats.evictions, 1u);
+  // Idle buffers are also deleted when other buffers return to the pool.
+  pool->SetMaxIdleTime(carla::time_duration::milliseconds(10u));
+  std::this_thread::sleep_for(20ms);
+  { auto buff = pool->Pop(256u); }
+  stats = pool->GetStatistics();
+  ASSERT_EQ(stats.pooled_buffers, 1u);
+  ASSERT_EQ(stats.pooled_bytes, 256u);
+  ASSERT_EQ(stats.evictions, 2u);
+}
@@ -0,0 +1,345 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/detail/EpisodeState.h>
+#include <carla/sensor/Deserializer.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/data/RawEpisodeState.h>
+#include <carla/sensor/s11n/EpisodeStateEncoder.h>
+#include <carla/sensor/s11n/EpisodeStateSerializer.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+
+#include <boost/asio/buffer.hpp>
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+using carla::Buffer;
+using carla::client::detail::EpisodeState;
+using carla::sensor::data::ActorDynamicState;
+using carla::sensor::data::RawEpisodeState;
+using carla::sensor::data::detail::QuantizedActorDynamicState;
+using carla::sensor::s11n::EpisodeStateEncoder;
+using carla::sensor::s11n::EpisodeStateSerializer;
+
+// =============================================================================
+// -- Helpers ------------------------------------------------------------------
+// =============================================================================
+
+static ActorDynamicState Snap(const ActorDynamicState &state) {
+  return QuantizedActorDynamicState{state};
+}
+
+/// Generates the state of a few moving vehicles, and a lot of static actors,
+/// some of them traffic lights. Every now and then an actor is destroyed and a
+/// new one spawned.
+class Simulation {
+public:
+
+  Simulation(size_t number_of_actors, double moving_ratio, bool snap)
+    : _snap(snap) {
+    for (auto i = 0u; i < number_of_actors; ++i) {
+      Spawn(Uniform(0.0, 1.0) < moving_ratio);
+    }
+  }
+
+  const std::vector<ActorDynamicState> &Tick() {
+    constexpr float dt = 0.05f;
+    ++_frame;
+    for (auto &&actor : _actors) {
+      auto &state = actor.state;
+      if (actor.is_moving) {
+        state.velocity.x += Uniform(-0.5, 0.5);
+        state.velocity.y += Uniform(-0.5, 0.5);
+        state.transform.location.x += dt * state.velocity.x;
+        state.transform.location.y += dt * state.velocity.y;
+        state.transform.rotation.yaw += Uniform(-2.0, 2.0);
+        state.state.vehicle_control = carla::rpc::VehicleControl{
+            static_cast<float>(Uniform(0.0, 1.0)),
+            static_cast<float>(Uniform(-1.0, 1.0)),
+            0.0f,
+            false,
+            false};
+      } else if (actor.is_traffic_light && ((_frame % 50u) == 0u)) {
+        auto &tls = state.state.traffic_light_state;
+        using TLS = carla::rpc::TrafficLightState;
+        tls = (tls == TLS::Green ? TLS::Red : TLS::Green);
+      }
+      if (_snap) {
+        state = Snap(state);
+      }
+    }
+    if ((_frame % 10u) == 0u) {
+      _actors.erase(_actors.begin() + RandomIndex(_actors.size()));
+      Spawn(Uniform(0.0, 1.0) < 0.5);
+    }
+    _states.clear();
+    for (auto &&actor : _actors) {
+      _states.emplace_back(actor.state);
+    }
+    return _states;
+  }
+
+  double GetGameTimeStamp() const {
+    return 0.05 * _frame;
+  }
+
+private:
+
+  struct Actor {
+    ActorDynamicState state;
+    bool is_moving;
+    bool is_traffic_light;
+  };
+
+  double Uniform(double min, double max) {
+    return std::uniform_real_distribution<double>(min, max)(_rng);
+  }
+
+  size_t RandomIndex(size_t size) {
+    return std::uniform_int_distribution<size_t>(0u, size - 1u)(_rng);
+  }
+
+  void Spawn(bool is_moving) {
+    Actor actor;
+    std::memset(static_cast<void *>(&actor.state), 0, sizeof(actor.state));
+    actor.state.id = ++_last_id;
+    actor.state.transform.location.x = Uniform(-1000.0, 1000.0);
+    actor.state.transform.location.y = Uniform(-1000.0, 1000.0);
+    actor.state.transform.location.z = Uniform(0.0, 10.0);
+    actor.state.transform.rotation.yaw = Uniform(-180.0, 180.0);
+    actor.is_moving = is_moving;
+    actor.is_traffic_light = !is_moving && (Uniform(0.0, 1.0) < 0.1);
+    if (actor.is_traffic_light) {
+      actor.state.state.traffic_light_state = carla::rpc::TrafficLightState::Red;
+    }
+    if (_snap) {
+      actor.state = Snap(actor.state);
+    }
+    // Insert at a random position, the simulator doesn't sort them by id.
+    _actors.insert(_actors.begin() + RandomIndex(_actors.size() + 1u), actor);
+  }
+
+  std::mt19937 _rng{42u};
+
+  const bool _snap;
+
+  size_t _frame = 0u;
+
+  carla::actor_id_type _last_id = 0u;
+
+  std::vector<Actor> _actors;
+
+  std::vector<ActorDynamicState> _states;
+};
+
+static Buffer Encode(
+    EpisodeStateEncoder &encoder,
+    double game_timestamp,
+    const std::vector<ActorDynamicState> &actors) {
+  encoder.Reset(game_timestamp, 0.0, actors.size());
+  for (auto &&actor : actors) {
+    encoder.WriteActor(actor);
+  }
+  return EpisodeStateSerializer::Serialize(encoder, encoder, Buffer{});
+}
+
+/// Decodes the messages of an episode state stream as the client does.
+class Decoder {
+public:
+
+  /// Returns whether the state changed.
+  bool Decode(uint64_t frame, const Buffer &payload) {
+    using namespace carla::sensor;
+    constexpr auto index = SensorRegistry::get<AWorldObserver *>::index;
+    auto header = s11n::SensorHeaderSerializer::Serialize(index, frame, {});
+    std::array<boost::asio::const_buffer, 2u> seq = {header.buffer(), payload.buffer()};
+    Buffer message;
+    message.copy_from(seq);
+    auto data = Deserializer::Deserialize(std::move(message));
+    auto *raw = dynamic_cast<const RawEpisodeState *>(data.get());
+    EXPECT_NE(raw, nullptr);
+    auto next = _state->DeriveNextStep(*raw);
+    if (next == nullptr) {
+      return false;
+    }
+    _state = next;
+    return true;
+  }
+
+  const EpisodeState &GetState() const {
+    return *_state;
+  }
+
+private:
+
+  std::shared_ptr<const EpisodeState> _state = std::make_shared<EpisodeState>();
+};
+
+template <typename T>
+static bool BitwiseEqual(const T &lhs, const T &rhs) {
+  return std::memcmp(&lhs, &rhs, sizeof(T)) == 0;
+}
+
+static void ExpectBitwiseEqual(const EpisodeState &lhs, const EpisodeState &rhs) {
+  ASSERT_EQ(lhs.GetTimestamp().frame_count, rhs.GetTimestamp().frame_count);
+  ASSERT_TRUE(BitwiseEqual(lhs.GetTimestamp().delta_seconds, rhs.GetTimestamp().delta_seconds));
+  const auto lhs_ids = lhs.GetActorIds();
+  const auto rhs_ids = rhs.GetActorIds();
+  ASSERT_TRUE(std::equal(lhs_ids.begin(), lhs_ids.end(), rhs_ids.begin(), rhs_ids.end()));
+  for (auto id : lhs_ids) {
+    const auto a = lhs.GetActorState(id);
+    const auto b = rhs.GetActorState(id);
+    ASSERT_TRUE(BitwiseEqual(a.transform, b.transform)) << "actor " << id;
+    ASSERT_TRUE(BitwiseEqual(a.velocity, b.velocity)) << "actor " << id;
+    ASSERT_TRUE(BitwiseEqual(a.acceleration, b.acceleration)) << "actor " << id;
+    ASSERT_TRUE(BitwiseEqual(a.state, b.state)) << "actor " << id;
+  }
+}
+
+// =============================================================================
+// -- Tests --------------------------------------------------------------------
+// =============================================================================
+
+TEST(episode_state, quantization) {
+  ActorDynamicState state;
+  std::memset(static_cast<void *>(&state), 0, sizeof(state));
+  state.id = 42u;
+  state.transform.location = {123.4567f, -9876.54321f, 0.1234f};
+  state.transform.rotation = {-45.678f, 190.0f, -540.25f};
+  state.velocity = {12.345f, -0.001f, 1000.0f};
+  const auto snapped = Snap(state);
+  ASSERT_EQ(snapped.id, 42u);
+  const auto &l0 = state.transform.location;
+  const auto &l1 = snapped.transform.location;
+  ASSERT_NEAR(l0.x, l1.x, 1.0f / 2048.0f);
+  ASSERT_NEAR(l0.y, l1.y, 1.0f / 2048.0f);
+  ASSERT_NEAR(l0.z, l1.z, 1.0f / 2048.0f);
+  const auto &r1 = snapped.transform.rotation;
+  ASSERT_NEAR(r1.pitch, -45.678f, 0.003f);
+  ASSERT_NEAR(r1.yaw, -170.0f, 0.003f);
+  ASSERT_NEAR(r1.roll, 179.75f, 0.003f);
+  ASSERT_NEAR(snapped.velocity.x, 12.345f, 1.0f / 256.0f);
+  ASSERT_NEAR(snapped.velocity.y, -0.001f, 1.0f / 256.0f);
+  ASSERT_NEAR(snapped.velocity.z, 256.0f, 1.0f / 128.0f);
+  // Quantizing again gives back the same values.
+  const auto snapped_twice = Snap(snapped);
+  ASSERT_TRUE(BitwiseEqual(snapped, snapped_twice));
+}
+
+TEST(episode_state, delta_matches_full_frames) {
+  // Input values already quantized, so full frames carry the same values.
+  Simulation simulation(500u, 0.2, true);
+  EpisodeStateEncoder full_encoder;
+  EpisodeStateEncoder delta_encoder{30u};
+  Decoder full;
+  Decoder delta;
+  for (auto frame = 1u; frame <= 200u; ++frame) {
+    const auto &actors = simulation.Tick();
+    const auto timestamp = simulation.GetGameTimeStamp();
+    ASSERT_TRUE(full.Decode(frame, Encode(full_encoder, timestamp, actors)));
+    ASSERT_TRUE(delta.Decode(frame, Encode(delta_encoder, timestamp, actors)));
+    ASSERT_EQ(static_cast<size_t>(full.GetState().GetActorIds().size()), actors.size());
+    ExpectBitwiseEqual(full.GetState(), delta.GetState());
+  }
+}
+
+TEST(episode_state, delta_matches_keyframes) {
+  Simulation simulation(500u, 0.2, false);
+  EpisodeStateEncoder keyframe_encoder{1u};
+  EpisodeStateEncoder delta_encoder{30u};
+  Decoder keyframes;
+  Decoder delta;
+  for (auto frame = 1u; frame <= 200u; ++frame) {
+    const auto &actors = simulation.Tick();
+    const auto timestamp = simulation.GetGameTimeStamp();
+    ASSERT_TRUE(keyframes.Decode(frame, Encode(keyframe_encoder, timestamp, actors)));
+    ASSERT_TRUE(delta.Decode(frame, Encode(delta_encoder, timestamp, actors)));
+    ExpectBitwiseEqual(keyframes.GetState(), delta.GetState());
+  }
+}
+
+TEST(episode_state, delta_waits_for_keyframe) {
+  constexpr auto keyframe_interval = 10u;
+  Simulation simulation(100u, 0.5, false);
+  EpisodeStateEncoder encoder{keyframe_interval};
+  Decoder reference;
+  Decoder late;
+  Decoder lossy;
+  for (auto frame = 1u; frame <= 45u; ++frame) {
+    const auto buffer = Encode(encoder, simulation.GetGameTimeStamp(), simulation.Tick());
+    ASSERT_TRUE(reference.Decode(frame, buffer));
+    ASSERT_EQ(reference.GetState().GetTimestamp().frame_count, frame);
+    // Joins the stream at frame 5.
+    if (frame >= 5u) {
+      ASSERT_EQ(late.Decode(frame, buffer), frame > keyframe_interval);
+    }
+    // Loses frame 25.
+    if (frame != 25u) {
+      ASSERT_EQ(lossy.Decode(frame, buffer), (frame < 25u) || (frame > 30u));
+    }
+    // The first frame after a keyframe restores the acceleration too.
+    if (frame > 31u) {
+      ExpectBitwiseEqual(reference.GetState(), late.GetState());
+      ExpectBitwiseEqual(reference.GetState(), lossy.GetState());
+    }
+  }
+  // A requested keyframe can be applied by any client.
+  encoder.RequestKeyframe();
+  Decoder joining;
+  ASSERT_TRUE(joining.Decode(46u, Encode(encoder, simulation.GetGameTimeStamp(), simulation.Tick())));
+}
+
+TEST(episode_state, benchmark_bytes_per_tick) {
+  constexpr auto number_of_actors = 5000u;
+  constexpr auto number_of_ticks = 300u;
+  constexpr auto keyframe_interval = 30u;
+  // Mostly static props and traffic lights, 5% of moving vehicles.
+  Simulation simulation(number_of_actors, 0.05, false);
+  EpisodeStateEncoder full_encoder;
+  EpisodeStateEncoder delta_encoder{keyframe_interval};
+  Decoder full;
+  Decoder delta;
+  size_t full_bytes = 0u;
+  size_t delta_bytes = 0u;
+  size_t keyframe_bytes = 0u;
+  std::chrono::nanoseconds full_decode_time{0};
+  std::chrono::nanoseconds delta_decode_time{0};
+  using clock = std::chrono::steady_clock;
+  for (auto frame = 1u; frame <= number_of_ticks; ++frame) {
+    const auto &actors = simulation.Tick();
+    const auto timestamp = simulation.GetGameTimeStamp();
+    const auto full_buffer = Encode(full_encoder, timestamp, actors);
+    const auto delta_buffer = Encode(delta_encoder, timestamp, actors);
+    full_bytes += full_buffer.size();
+    delta_bytes += delta_buffer.size();
+    if (((frame - 1u) % keyframe_interval) == 0u) {
+      keyframe_bytes += delta_buffer.size();
+    }
+    auto start = clock::now();
+    ASSERT_TRUE(full.Decode(frame, full_buffer));
+    full_decode_time += clock::now() - start;
+    start = clock::now();
+    ASSERT_TRUE(delta.Decode(frame, delta_buffer));
+    delta_decode_time += clock::now() - start;
+  }
+  const auto us = [](auto time) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time).count() / number_of_ticks;
+  };
+  std::cout << number_of_actors << " actors, bytes per tick: full = " << full_bytes / number_of_ticks
+            << ", delta = " << delta_bytes / number_of_ticks
+            << " (keyframes " << keyframe_bytes / (number_of_ticks / keyframe_interval)
+            << ", deltas " << (delta_bytes - keyframe_bytes) / (number_of_ticks - number_of_ticks / keyframe_interval)
+            << ")\n";
+  std::cout << "decode time per tick (us): full = " << us(full_decode_time)
+            << ", delta = " << us(delta_decode_time) << '\n';
+  ASSERT_LT(4u * delta_bytes, full_bytes);
+}
@@ -6,8 +6,77 @@
 
 #include "test.h"
 
+#include <carla/LruCache.h>
 #include <carla/Version.h>
+#include <carla/WorkerPool.h>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
 
 TEST(miscellaneous, version) {
   std::cout << "LibCarla " << carla::version() << std::endl;
 }
+
+TEST(miscellaneous, lru_cache) {
+  carla::LruCache<int, std::string> cache(2u);
+  ASSERT_EQ(cache.Get(1), nullptr);
+  cache.Put(1, "one");
+  cache.Put(2, "two");
+  ASSERT_EQ(cache.size(), 2u);
+  ASSERT_EQ(*cache.Get(1), "one");
+  // 2 is the least recently used.
+  cache.Put(3, "three");
+  ASSERT_EQ(cache.size(), 2u);
+  ASSERT_EQ(cache.Get(2), nullptr);
+  ASSERT_EQ(*cache.Get(1), "one");
+  ASSERT_EQ(*cache.Get(3), "three");
+  cache.Put(1, "uno");
+  ASSERT_EQ(*cache.Get(1), "uno");
+  cache.Put(4, "four");
+  ASSERT_EQ(cache.Get(3), nullptr);
+  cache.clear();
+  ASSERT_EQ(cache.size(), 0u);
+  ASSERT_EQ(cache.Get(1), nullptr);
+}
+
+TEST(miscellaneous, worker_pool) {
+  carla::WorkerPool pool(3u);
+  ASSERT_EQ(pool.size(), 4u);
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  for (size_t count : {0u, 1u, 10u, 1000u}) {
+    std::vector<std::atomic_int> calls(count);
+    for (auto &c : calls) {
+      c = 0;
+    }
+    pool.ParallelFor(count, [&](size_t i) {
+      ++calls[i];
+      std::lock_guard<std::mutex> lock(mutex);
+      threads.insert(std::this_thread::get_id());
+    });
+    for (auto &c : calls) {
+      ASSERT_EQ(c, 1);
+    }
+  }
+  // The same workers run every loop.
+  ASSERT_LE(threads.size(), pool.size());
+  // Exceptions reach the caller, and the pool is still usable afterwards.
+  for (size_t thrower : {0u, 1u, 999u}) {
+    std::atomic_size_t calls{0u};
+    ASSERT_THROW(pool.ParallelFor(1000u, [&](size_t i) {
+      ++calls;
+      if (i == thrower) {
+        throw std::runtime_error("failed");
+      }
+    }), std::runtime_error);
+    ASSERT_LE(calls, 1000u);
+  }
+  std::atomic_size_t calls{0u};
+  pool.ParallelFor(100u, [&](size_t) { ++calls; });
+  ASSERT_EQ(calls, 100u);
+  ASSERT_GE(carla::WorkerPool::GetShared().size(), 1u);
+}
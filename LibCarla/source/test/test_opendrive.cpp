@@ -0,0 +1,499 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/StopWatch.h>
+#include <carla/opendrive/OpenDrive.h>
+#include <carla/road/MapSerializer.h>
+#include <carla/road/WaypointGenerator.h>
+
+#include "carla/opendrive/parser/pugixml/pugixml.hpp"
+
+#include <boost/filesystem/operations.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+using namespace carla::opendrive;
+using namespace carla::road;
+using namespace carla::road::element;
+
+/// OpenDRIVE with a chain of @a count roads, each one made of a line, an arc
+/// and a spiral, ending in a junction with a turn to the first road. Road i
+/// starts at a height of i meters, see ExpectedElevation.
+static std::string MakeOpenDrive(const int count) {
+  std::ostringstream out;
+  out.precision(17);
+  out << "<?xml version=\"1.0\" standalone=\"yes\"?>\n<OpenDRIVE>\n";
+  double x = 0.0;
+  double y = 0.0;
+  for (int i = 0; i <= count; ++i) {
+    const bool is_junction = (i == count);
+    out << "<road name=\"Road " << i << "\" length=\"105\" id=\"" << i
+        << "\" junction=\"" << (is_junction ? 1000 : -1) << "\">\n<link>\n";
+    if (is_junction) {
+      out << "<predecessor elementType=\"road\" elementId=\"" << i - 1 << "\" contactPoint=\"end\"/>\n"
+          << "<successor elementType=\"road\" elementId=\"0\" contactPoint=\"start\"/>\n";
+    } else {
+      if (i > 0) {
+        out << "<predecessor elementType=\"road\" elementId=\"" << i - 1 << "\" contactPoint=\"end\"/>\n";
+      }
+      if (i + 1 < count) {
+        out << "<successor elementType=\"road\" elementId=\"" << i + 1 << "\" contactPoint=\"start\"/>\n";
+      } else {
+        out << "<successor elementType=\"junction\" elementId=\"1000\"/>\n";
+      }
+    }
+    out << "</link>\n<planView>\n"
+        << "<geometry s=\"0\" x=\"" << x << "\" y=\"" << y << "\" hdg=\"0\" length=\"50\"><line/></geometry>\n"
+        << "<geometry s=\"50\" x=\"" << x + 50.0 << "\" y=\"" << y << "\" hdg=\"0\" length=\"30\">"
+        << "<arc curvature=\"0.01\"/></geometry>\n"
+        << "<geometry s=\"80\" x=\"" << x + 80.0 << "\" y=\"" << y + 4.0 << "\" hdg=\"0.3\" length=\"25\">"
+        << "<spiral curvStart=\"0\" curvEnd=\"0.02\"/></geometry>\n"
+        << "</planView>\n<elevationProfile>\n"
+        << "<elevation s=\"0\" a=\"" << i << "\" b=\"0.05\" c=\"0\" d=\"0\"/>\n"
+        << "<elevation s=\"60\" a=\"" << i + 3 << "\" b=\"0.05\" c=\"-0.002\" d=\"0.00001\"/>\n"
+        << "</elevationProfile>\n<lateralProfile>\n"
+        << "<superelevation s=\"0\" a=\"0\" b=\"0.001\" c=\"0\" d=\"0\"/>\n"
+        << "</lateralProfile>\n<lanes>\n"
+        << "<laneOffset s=\"0\" a=\"0.5\" b=\"0\" c=\"0\" d=\"0\"/>\n"
+        << "<laneSection s=\"0\">\n";
+    for (auto side : {"left", "right"}) {
+      const int sign = (side[0] == 'l') ? 1 : -1;
+      out << "<" << side << ">\n";
+      for (int lane = 1; lane <= 2; ++lane) {
+        out << "<lane id=\"" << sign * lane << "\" type=\"" << (lane == 1 ? "driving" : "sidewalk")
+            << "\" level=\"false\">\n<link>"
+            << "<predecessor id=\"" << sign * lane << "\"/><successor id=\"" << sign * lane << "\"/>"
+            << "</link>\n<width sOffset=\"0\" a=\"" << 3.0 + 0.5 * lane << "\" b=\"0\" c=\"0\" d=\"0\"/>\n"
+            << "<roadMark sOffset=\"0\" type=\"" << (lane == 1 ? "broken" : "solid")
+            << "\" weight=\"standard\" color=\"white\" width=\"0.15\" laneChange=\"both\"/>\n"
+            << "</lane>\n";
+      }
+      out << "</" << side << ">\n";
+    }
+    out << "</laneSection>\n</lanes>\n<signals>\n"
+        << "<signal name=\"Speed " << i << "\" id=\"" << i << "\" s=\"10\" t=\"-4\" zOffset=\"1.5\" "
+        << "dynamic=\"no\" orientation=\"-\" country=\"OpenDRIVE\" type=\"274\" subtype=\"-1\" value=\"30\"/>\n";
+    if (i == 0) {
+      out << "<signal name=\"Light\" id=\"100\" s=\"20\" t=\"4\" zOffset=\"3\" dynamic=\"yes\" "
+          << "orientation=\"+\" country=\"OpenDRIVE\" type=\"1000001\" subtype=\"-1\" value=\"-1\">\n"
+          << "<validity fromLane=\"-1\" toLane=\"-2\"/>\n</signal>\n";
+    }
+    out << "</signals>\n</road>\n";
+    y += 10.0;
+  }
+  out << "<junction id=\"1000\" name=\"Junction\">\n"
+      << "<connection id=\"0\" incomingRoad=\"" << count - 1 << "\" connectingRoad=\"" << count
+      << "\" contactPoint=\"start\">\n"
+      << "<laneLink from=\"-1\" to=\"-1\"/>\n"
+      << "</connection>\n</junction>\n</OpenDRIVE>\n";
+  return out.str();
+}
+
+/// Elevation (first) and its derivative (second) at @a s of road @a i of
+/// MakeOpenDrive.
+static std::pair<double, double> ExpectedElevation(const int i, const double s) {
+  if (s < 60.0) {
+    return {i + 0.05 * s, 0.05};
+  }
+  const double ds = s - 60.0;
+  return {
+    i + 3.0 + ds * (0.05 + ds * (-0.002 + ds * 0.00001)),
+    0.05 + ds * (-0.004 + ds * 0.00003)};
+}
+
+static carla::SharedPtr<Map> LoadOpenDrive(const std::string &opendrive) {
+  std::istringstream stream(opendrive);
+  return OpenDrive::Load(stream);
+}
+
+template <typename View>
+static auto ToVector(const View &view) {
+  return std::vector<typename View::value_type>(view.begin(), view.end());
+}
+
+static void CompareMaps(const Map &lhs, const Map &rhs) {
+  const auto &lhs_data = lhs.GetData();
+  const auto &rhs_data = rhs.GetData();
+  ASSERT_EQ(lhs_data.GetRoadCount(), rhs_data.GetRoadCount());
+  for (auto &&road : lhs_data.GetRoadSegments()) {
+    const auto *other = rhs_data.GetRoad(road.GetId());
+    ASSERT_NE(other, nullptr);
+    ASSERT_EQ(road.GetLength(), other->GetLength());
+    ASSERT_EQ(road.GetSuccessorsIds(), other->GetSuccessorsIds());
+    ASSERT_EQ(road.GetSuccessorsIsSTart(), other->GetSuccessorsIsSTart());
+    ASSERT_EQ(road.GetPredecessorsIds(), other->GetPredecessorsIds());
+    ASSERT_EQ(road.GetPredecessorsIsStart(), other->GetPredecessorsIsStart());
+    for (auto i = 0; i <= 100; ++i) {
+      const double s = road.GetLength() * i / 100.0;
+      const auto point = road.GetDirectedPointIn(s);
+      const auto other_point = other->GetDirectedPointIn(s);
+      ASSERT_EQ(point, other_point);
+      ASSERT_EQ(point.pitch, other_point.pitch);
+      ASSERT_EQ(point.roll, other_point.roll);
+    }
+    const auto *lanes = road.GetInfo<RoadInfoLane>(0.0);
+    const auto *other_lanes = other->GetInfo<RoadInfoLane>(0.0);
+    ASSERT_NE(lanes, nullptr);
+    ASSERT_NE(other_lanes, nullptr);
+    ASSERT_EQ(lanes->getLanesIDs(), other_lanes->getLanesIDs());
+    for (auto id : lanes->getLanesIDs()) {
+      ASSERT_EQ(lanes->getLane(id)->_width, other_lanes->getLane(id)->_width);
+      ASSERT_EQ(lanes->getLane(id)->_type, other_lanes->getLane(id)->_type);
+      ASSERT_EQ(lanes->getLane(id)->_lane_center_offset, other_lanes->getLane(id)->_lane_center_offset);
+      ASSERT_EQ(ToVector(road.GetNextLane(id)), ToVector(other->GetNextLane(id)));
+      ASSERT_EQ(ToVector(road.GetPrevLane(id)), ToVector(other->GetPrevLane(id)));
+    }
+    const auto *general = road.GetInfo<RoadGeneralInfo>(0.0);
+    const auto *other_general = other->GetInfo<RoadGeneralInfo>(0.0);
+    ASSERT_NE(general, nullptr);
+    ASSERT_NE(other_general, nullptr);
+    ASSERT_EQ(general->GetJunctionId(), other_general->GetJunctionId());
+    ASSERT_EQ(general->GetLanesOffset(), other_general->GetLanesOffset());
+  }
+  const auto &junctions = lhs_data.GetJunctionInformation();
+  const auto &other_junctions = rhs_data.GetJunctionInformation();
+  ASSERT_EQ(junctions.size(), other_junctions.size());
+  for (auto i = 0u; i < junctions.size(); ++i) {
+    ASSERT_EQ(junctions[i].junction_id, other_junctions[i].junction_id);
+    ASSERT_EQ(junctions[i].connection_road, other_junctions[i].connection_road);
+    ASSERT_EQ(junctions[i].incomming_road, other_junctions[i].incomming_road);
+    ASSERT_EQ(junctions[i].from_lane, other_junctions[i].from_lane);
+    ASSERT_EQ(junctions[i].to_lane, other_junctions[i].to_lane);
+  }
+  const auto &signals = lhs_data.GetSignals();
+  const auto &other_signals = rhs_data.GetSignals();
+  ASSERT_EQ(signals.size(), other_signals.size());
+  for (auto i = 0u; i < signals.size(); ++i) {
+    ASSERT_EQ(signals[i].id, other_signals[i].id);
+    ASSERT_EQ(signals[i].road_id, other_signals[i].road_id);
+    ASSERT_EQ(signals[i].s, other_signals[i].s);
+    ASSERT_EQ(signals[i].t, other_signals[i].t);
+    ASSERT_EQ(signals[i].name, other_signals[i].name);
+    ASSERT_EQ(signals[i].is_dynamic, other_signals[i].is_dynamic);
+    ASSERT_EQ(signals[i].orientation, other_signals[i].orientation);
+    ASSERT_EQ(signals[i].type, other_signals[i].type);
+    ASSERT_EQ(signals[i].validity, other_signals[i].validity);
+  }
+}
+
+TEST(opendrive, signals_and_junctions) {
+  const auto map = LoadOpenDrive(MakeOpenDrive(5));
+  const auto &data = map->GetData();
+  ASSERT_EQ(data.GetSignals().size(), 7u);
+
+  // Orientation "-", valid for the left driving lane.
+  const auto *signal = data.GetNextSignal(1u, 1, 20.0);
+  ASSERT_NE(signal, nullptr);
+  ASSERT_EQ(signal->id, 1);
+  ASSERT_EQ(signal->road_id, 1u);
+  ASSERT_EQ(signal->s, 10.0);
+  ASSERT_EQ(signal->orientation, SignalOrientation::Negative);
+  ASSERT_EQ(data.GetNextSignal(1u, 1, 5.0), nullptr);
+  ASSERT_EQ(data.GetNextSignal(1u, -1, 5.0), nullptr);
+
+  // Orientation "+" with validity.
+  signal = data.GetNextSignal(0u, -1, 12.0);
+  ASSERT_NE(signal, nullptr);
+  ASSERT_EQ(signal->id, 100);
+  ASSERT_TRUE(signal->is_dynamic);
+  ASSERT_EQ(signal->validity.size(), 1u);
+  ASSERT_EQ(data.GetNextSignal(0u, -1, 21.0), nullptr);
+  ASSERT_EQ(data.GetNextSignal(0u, 1, 30.0)->id, 0);
+
+  const auto connections = data.GetJunctionConnections(1000);
+  ASSERT_EQ(connections.size(), 1);
+  ASSERT_EQ(connections.begin()->incomming_road, 4);
+  ASSERT_EQ(connections.begin()->connection_road, 5);
+  ASSERT_TRUE(data.GetJunctionConnections(999).empty());
+}
+
+TEST(opendrive, elevation_and_superelevation) {
+  const auto map = LoadOpenDrive(MakeOpenDrive(5));
+  for (auto &&road : map->GetData().GetRoadSegments()) {
+    const auto id = static_cast<int>(road.GetId());
+    ASSERT_TRUE(road.GetElevationProfile().IsBaked());
+    for (auto i = 0; i <= 1000; ++i) {
+      const double s = road.GetLength() * i / 1000.0;
+      const auto point = road.GetDirectedPointIn(s);
+      const auto expected = ExpectedElevation(id, s);
+      // The default tolerance of the baked tables is 1 cm.
+      ASSERT_NEAR(point.location.z, expected.first, 0.0101);
+      ASSERT_NEAR(point.pitch, std::atan(expected.second), 0.01);
+      ASSERT_NEAR(point.roll, 0.001 * s, 0.01);
+    }
+  }
+  const auto waypoints = WaypointGenerator::GenerateAll(*map, 10.0);
+  ASSERT_FALSE(waypoints.empty());
+  for (auto &&waypoint : waypoints) {
+    const auto &road = waypoint.GetRoadSegment();
+    const auto point = road.GetDirectedPointIn(waypoint.GetDistance());
+    const auto *lanes = road.GetInfo<RoadInfoLane>(0.0);
+    ASSERT_NE(lanes, nullptr);
+    const double offset = lanes->getLane(waypoint.GetLaneId())->_lane_center_offset;
+    const auto transform = waypoint.ComputeTransform();
+    ASSERT_NEAR(transform.location.z, point.location.z + offset * std::sin(point.roll), 1e-4);
+    // Lanes driving backwards see the road the other way around.
+    const double sign = waypoint.GetLaneId() < 0 ? 1.0 : -1.0;
+    ASSERT_NEAR(transform.rotation.pitch, sign * carla::geom::Math::to_degrees(point.pitch), 1e-3);
+    ASSERT_NEAR(transform.rotation.roll, sign * carla::geom::Math::to_degrees(point.roll), 1e-3);
+  }
+}
+
+TEST(opendrive, map_serializer_round_trip) {
+  const auto opendrive = MakeOpenDrive(20);
+  const auto map = LoadOpenDrive(opendrive);
+  ASSERT_EQ(map->GetData().GetRoadCount(), 21u);
+  const auto key = MapSerializer::Hash(opendrive);
+  const auto data = MapSerializer::Serialize(*map, key);
+  const auto result = MapSerializer::Deserialize(data.data(), data.size(), key);
+  ASSERT_NE(result, nullptr);
+  CompareMaps(*map, *result);
+  ASSERT_EQ(MapSerializer::Serialize(*result, key), data);
+}
+
+TEST(opendrive, map_serializer_rejects_invalid_data) {
+  const auto opendrive = MakeOpenDrive(5);
+  const auto key = MapSerializer::Hash(opendrive);
+  const auto data = MapSerializer::Serialize(*LoadOpenDrive(opendrive), key);
+  ASSERT_NE(MapSerializer::Deserialize(data.data(), data.size(), key), nullptr);
+  // Different OpenDRIVE.
+  ASSERT_NE(MapSerializer::Hash(MakeOpenDrive(6)), key);
+  ASSERT_EQ(MapSerializer::Deserialize(data.data(), data.size(), key + 1u), nullptr);
+  // Truncated.
+  for (auto size : {size_t(0u), size_t(10u), data.size() / 2u, data.size() - 1u}) {
+    ASSERT_EQ(MapSerializer::Deserialize(data.data(), size, key), nullptr);
+  }
+  // Corrupted.
+  auto corrupted = data;
+  corrupted[corrupted.size() / 2u] ^= 0xFFu;
+  ASSERT_EQ(MapSerializer::Deserialize(corrupted.data(), corrupted.size(), key), nullptr);
+  // Another version.
+  corrupted = data;
+  corrupted[8u] ^= 0xFFu;
+  ASSERT_EQ(MapSerializer::Deserialize(corrupted.data(), corrupted.size(), key), nullptr);
+}
+
+TEST(opendrive, load_cached) {
+  namespace fs = boost::filesystem;
+  const auto directory = fs::temp_directory_path() / fs::unique_path();
+  const auto opendrive = MakeOpenDrive(10);
+
+  const auto miss = OpenDrive::LoadCached(opendrive, directory.string());
+  ASSERT_NE(miss, nullptr);
+  ASSERT_EQ(std::distance(fs::directory_iterator(directory), fs::directory_iterator()), 1);
+  CompareMaps(*LoadOpenDrive(opendrive), *miss);
+
+  const auto hit = OpenDrive::LoadCached(opendrive, directory.string());
+  ASSERT_NE(hit, nullptr);
+  CompareMaps(*miss, *hit);
+
+  // A different map goes to a different file.
+  const auto other = OpenDrive::LoadCached(MakeOpenDrive(11), directory.string());
+  ASSERT_EQ(other->GetData().GetRoadCount(), 12u);
+  ASSERT_EQ(std::distance(fs::directory_iterator(directory), fs::directory_iterator()), 2);
+
+  // A corrupt file is ignored and replaced.
+  for (auto &&entry : fs::directory_iterator(directory)) {
+    fs::resize_file(entry.path(), 100u);
+  }
+  CompareMaps(*miss, *OpenDrive::LoadCached(opendrive, directory.string()));
+  CompareMaps(*miss, *OpenDrive::LoadCached(opendrive, directory.string()));
+
+  fs::remove_all(directory);
+}
+
+TEST(opendrive, benchmark_load_cached) {
+  namespace fs = boost::filesystem;
+  const auto directory = fs::temp_directory_path() / fs::unique_path();
+  const auto opendrive = MakeOpenDrive(2000);
+  auto measure = [&](const char *name, auto &&load) {
+    carla::StopWatch stop_watch;
+    const auto map = load();
+    stop_watch.Stop();
+    std::cout << "  " << name << ": " << stop_watch.GetElapsedTime() << " ms" << std::endl;
+    return map;
+  };
+  std::cout << opendrive.size() / 1024u << " KiB of OpenDRIVE" << std::endl;
+  const auto parsed = measure("parse", [&]() { return LoadOpenDrive(opendrive); });
+  measure("cache miss", [&]() { return OpenDrive::LoadCached(opendrive, directory.string()); });
+  const auto cached = measure("cache hit", [&]() { return OpenDrive::LoadCached(opendrive, directory.string()); });
+  CompareMaps(*parsed, *cached);
+  fs::remove_all(directory);
+}
+
+static void ParseOpenDrive(
+    std::string opendrive,
+    types::OpenDriveData &out,
+    const size_t number_of_threads) {
+  std::string error;
+  ASSERT_TRUE(OpenDriveParser::ParseInPlace(&opendrive[0], opendrive.size(), out, &error, number_of_threads));
+  ASSERT_TRUE(error.empty());
+}
+
+static void CompareLanes(const std::vector<types::LaneInfo> &lhs, const std::vector<types::LaneInfo> &rhs) {
+  ASSERT_EQ(lhs.size(), rhs.size());
+  for (auto i = 0u; i < lhs.size(); ++i) {
+    ASSERT_EQ(lhs[i].attributes.id, rhs[i].attributes.id);
+    ASSERT_EQ(lhs[i].attributes.type, rhs[i].attributes.type);
+    ASSERT_EQ(lhs[i].lane_width.size(), rhs[i].lane_width.size());
+    ASSERT_EQ(lhs[i].road_marker.size(), rhs[i].road_marker.size());
+    for (auto j = 0u; j < lhs[i].road_marker.size(); ++j) {
+      ASSERT_EQ(lhs[i].road_marker[j].type, rhs[i].road_marker[j].type);
+      ASSERT_EQ(lhs[i].road_marker[j].color, rhs[i].road_marker[j].color);
+    }
+  }
+}
+
+static void CompareOpenDriveData(const types::OpenDriveData &lhs, const types::OpenDriveData &rhs) {
+  ASSERT_EQ(lhs.roads.size(), rhs.roads.size());
+  for (auto i = 0u; i < lhs.roads.size(); ++i) {
+    const auto &road = lhs.roads[i];
+    const auto &other = rhs.roads[i];
+    ASSERT_EQ(road.attributes.id, other.attributes.id);
+    ASSERT_EQ(road.attributes.name, other.attributes.name);
+    ASSERT_EQ(road.attributes.length, other.attributes.length);
+    ASSERT_EQ(road.attributes.junction, other.attributes.junction);
+    ASSERT_EQ(road.geometry_attributes.size(), other.geometry_attributes.size());
+    ASSERT_EQ(road.trafic_signals.size(), other.trafic_signals.size());
+    ASSERT_EQ(road.lanes.lane_sections.size(), other.lanes.lane_sections.size());
+    for (auto j = 0u; j < road.lanes.lane_sections.size(); ++j) {
+      CompareLanes(road.lanes.lane_sections[j].left, other.lanes.lane_sections[j].left);
+      CompareLanes(road.lanes.lane_sections[j].right, other.lanes.lane_sections[j].right);
+    }
+  }
+  ASSERT_EQ(lhs.junctions.size(), rhs.junctions.size());
+}
+
+TEST(opendrive, parse_enum_attributes) {
+  types::OpenDriveData data;
+  ParseOpenDrive(MakeOpenDrive(2), data, 1u);
+  ASSERT_EQ(data.roads.size(), 3u);
+  const auto &road = data.roads[1];
+  ASSERT_NE(road.road_link.predecessor, nullptr);
+  ASSERT_EQ(road.road_link.predecessor->element_type, types::ElementType::Road);
+  ASSERT_EQ(road.road_link.predecessor->contact_point, types::ContactPoint::End);
+  ASSERT_NE(road.road_link.successor, nullptr);
+  ASSERT_EQ(road.road_link.successor->element_type, types::ElementType::Junction);
+  ASSERT_EQ(road.road_link.successor->contact_point, types::ContactPoint::Unknown);
+
+  const auto &lanes = road.lanes.lane_sections.at(0u).right;
+  ASSERT_EQ(lanes.size(), 2u);
+  ASSERT_EQ(lanes[0].attributes.type, LaneType::Driving);
+  ASSERT_EQ(lanes[1].attributes.type, LaneType::Sidewalk);
+  ASSERT_FALSE(lanes[0].attributes.level);
+  ASSERT_EQ(lanes[0].road_marker.at(0u).type, types::RoadMarkType::Broken);
+  ASSERT_EQ(lanes[1].road_marker.at(0u).type, types::RoadMarkType::Solid);
+  ASSERT_EQ(lanes[0].road_marker[0u].weigth, types::RoadMarkWeight::Standard);
+  ASSERT_EQ(lanes[0].road_marker[0u].color, types::RoadMarkColor::White);
+  ASSERT_EQ(lanes[0].road_marker[0u].lange_change, types::LaneChange::Both);
+
+  const auto &signal = road.trafic_signals.at(0u);
+  ASSERT_FALSE(signal.dynamic);
+  ASSERT_EQ(signal.orientation, types::SignalOrientation::Negative);
+  ASSERT_EQ(signal.name, "Speed 1");
+  ASSERT_EQ(signal.type, "274");
+
+  const auto &connection = data.junctions.at(0u).connections.at(0u);
+  ASSERT_EQ(connection.attributes.contact_point, types::ContactPoint::Start);
+
+  ASSERT_EQ(LaneTypeFromString("driving"), LaneType::Driving);
+  ASSERT_EQ(LaneTypeFromString("onRamp"), LaneType::OnRamp);
+  ASSERT_EQ(LaneTypeFromString("highway"), LaneType::Unknown);
+  ASSERT_STREQ(ToString(LaneType::Sidewalk), "sidewalk");
+}
+
+TEST(opendrive, parse_in_parallel) {
+  const auto opendrive = MakeOpenDrive(1000);
+  types::OpenDriveData expected;
+  std::string error;
+  ASSERT_TRUE(OpenDriveParser::Parse(opendrive.c_str(), expected, XmlInputType::CONTENT, &error));
+  ASSERT_EQ(expected.roads.size(), 1001u);
+  for (auto number_of_threads : {1u, 2u, 3u, 8u}) {
+    types::OpenDriveData data;
+    ParseOpenDrive(opendrive, data, number_of_threads);
+    CompareOpenDriveData(expected, data);
+  }
+  // Invalid XML is still reported.
+  std::string invalid = "<OpenDRIVE><road>";
+  types::OpenDriveData data;
+  ASSERT_FALSE(OpenDriveParser::ParseInPlace(&invalid[0], invalid.size(), data, &error));
+  ASSERT_FALSE(error.empty());
+}
+
+TEST(opendrive, parse_malformed_attribute) {
+  // The length of the last road is not a number, with several threads it is
+  // parsed by a thread other than the caller.
+  auto opendrive = MakeOpenDrive(1000);
+  const auto position = opendrive.rfind("length=\"105\"");
+  ASSERT_NE(position, std::string::npos);
+  opendrive.replace(position, 12u, "length=\"abc\"");
+  for (auto number_of_threads : {1u, 2u, 3u, 8u}) {
+    types::OpenDriveData data;
+    std::string copy = opendrive;
+    ASSERT_THROW(
+        OpenDriveParser::ParseInPlace(&copy[0], copy.size(), data, nullptr, number_of_threads),
+        std::invalid_argument);
+  }
+}
+
+/// Bytes currently allocated by pugixml, and the maximum reached.
+static std::atomic<size_t> PUGI_ALLOCATED{0u};
+static std::atomic<size_t> PUGI_PEAK{0u};
+
+static void *CountingAllocate(size_t size) {
+  auto *block = static_cast<size_t *>(std::malloc(size + sizeof(max_align_t)));
+  if (block == nullptr) {
+    return nullptr;
+  }
+  *block = size;
+  const auto allocated = PUGI_ALLOCATED += size;
+  auto peak = PUGI_PEAK.load();
+  while (allocated > peak && !PUGI_PEAK.compare_exchange_weak(peak, allocated));
+  return reinterpret_cast<unsigned char *>(block) + sizeof(max_align_t);
+}
+
+static void CountingDeallocate(void *ptr) {
+  if (ptr != nullptr) {
+    auto *block = reinterpret_cast<size_t *>(static_cast<unsigned char *>(ptr) - sizeof(max_align_t));
+    PUGI_ALLOCATED -= *block;
+    std::free(block);
+  }
+}
+
+TEST(opendrive, benchmark_parse_opendrive) {
+  const auto opendrive = MakeOpenDrive(10000);
+  std::cout << opendrive.size() / (1024u * 1024u) << " MiB of OpenDRIVE" << std::endl;
+  const auto allocate = pugi::get_memory_allocation_function();
+  const auto deallocate = pugi::get_memory_deallocation_function();
+  pugi::set_memory_management_functions(CountingAllocate, CountingDeallocate);
+  auto measure = [&](const char *name, auto &&parse) {
+    PUGI_PEAK = 0u;
+    types::OpenDriveData data;
+    carla::StopWatch stop_watch;
+    parse(data);
+    stop_watch.Stop();
+    std::cout << "  " << name << ": " << stop_watch.GetElapsedTime() << " ms, "
+              << PUGI_PEAK / (1024u * 1024u) << " MiB peak in pugixml" << std::endl;
+    ASSERT_EQ(data.roads.size(), 10001u);
+  };
+  measure("copy, 1 thread", [&](auto &data) {
+    OpenDriveParser::Parse(opendrive.c_str(), data, XmlInputType::CONTENT);
+  });
+  measure("in place, 1 thread", [&](auto &data) {
+    auto copy = opendrive;
+    OpenDriveParser::ParseInPlace(&copy[0], copy.size(), data, nullptr, 1u);
+  });
+  measure("in place, all threads", [&](auto &data) {
+    auto copy = opendrive;
+    OpenDriveParser::ParseInPlace(&copy[0], copy.size(), data);
+  });
+  pugi::set_memory_management_functions(allocate, deallocate);
+}
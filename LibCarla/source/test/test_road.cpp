@@ -5,12 +5,24 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include "test.h"
+#include "test/util/Allocations.h"
 
+#include <carla/StopWatch.h>
 #include <carla/road/MapBuilder.h>
+#include <carla/road/Router.h>
+#include <carla/road/WaypointGenerator.h>
 #include <carla/geom/Location.h>
 #include <carla/geom/Math.h>
 #include <carla/road/element/RoadInfoVisitor.h>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
 using namespace carla::road;
 using namespace carla::road::element;
 using namespace carla::geom;
@@ -81,6 +93,27 @@ TEST(road, set_and_get_connections_for) {
   }
 }
 
+TEST(road, connections_to_missing_roads) {
+  MapBuilder builder;
+  RoadSegmentDefinition def0(0);
+  def0.AddPredecessorID(7, true);
+  def0.AddPredecessorID(1, false);
+  def0.AddSuccessorID(1, true);
+  def0.AddSuccessorID(9, false);
+  def0.AddSuccessorID(1, false);
+  builder.AddRoadSegmentDefinition(def0);
+  RoadSegmentDefinition def1(1);
+  builder.AddRoadSegmentDefinition(def1);
+  auto map_ptr = builder.Build();
+  // The links to roads 7 and 9 are dropped together with their contact
+  // point.
+  const auto &road = *map_ptr->GetData().GetRoad(0);
+  ASSERT_EQ(road.GetPredecessorsIds(), std::vector<id_type>({1u}));
+  ASSERT_EQ(road.GetPredecessorsIsStart(), std::vector<bool>({false}));
+  ASSERT_EQ(road.GetSuccessorsIds(), std::vector<id_type>({1u, 1u}));
+  ASSERT_EQ(road.GetSuccessorsIsSTart(), std::vector<bool>({true, false}));
+}
+
 void AssertNear(
     const element::DirectedPoint &d0,
     const element::DirectedPoint &d1) {
@@ -132,6 +165,21 @@ TEST(road, geom_line) {
       element::DirectedPoint(15.0, 5.0, 0, 0));
 }
 
+TEST(road, geom_unsorted) {
+  MapBuilder builder;
+  RoadSegmentDefinition def1(1);
+  def1.MakeGeometry<GeometryLine>(15, 5, 0, Location(10, 5, 0));
+  def1.MakeGeometry<GeometryLine>(0, 10, 0, Location(0, 0, 0));
+  def1.MakeGeometry<GeometryLine>(10, 5, Math::pi_half(), Location(10, 0, 0));
+  builder.AddRoadSegmentDefinition(def1);
+  auto map_ptr = builder.Build();
+  const auto &road = *map_ptr->GetData().GetRoad(1);
+  ASSERT_EQ(road.GetLength(), 20.0);
+  AssertNear(road.GetDirectedPointIn(3.0), element::DirectedPoint(3.0, 0, 0, 0));
+  AssertNear(road.GetDirectedPointIn(11.0), element::DirectedPoint(10.0, 1.0, 0, Math::pi_half()));
+  AssertNear(road.GetDirectedPointIn(17.0), element::DirectedPoint(12.0, 5.0, 0, 0));
+}
+
 TEST(road, geom_arc) {
   MapBuilder builder;
   RoadSegmentDefinition def1(1);
@@ -182,6 +230,297 @@ TEST(road, geom_spiral) {
   }*/
 }
 
+/// Nearest point of @a geometry to @a p found evaluating it every 1 mm.
+static std::pair<double, double> DistanceToDenseSampling(
+    const Geometry &geometry,
+    const Location &p) {
+  std::pair<double, double> nearest{0.0, std::numeric_limits<double>::max()};
+  const auto count = static_cast<int>(geometry.GetLength() * 1000.0);
+  for (auto i = 0; i <= count; ++i) {
+    const double s = geometry.GetLength() * i / count;
+    const double dist = Math::Distance2D(geometry.PosFromDist(s).location, p);
+    if (dist < nearest.second) {
+      nearest = {s, dist};
+    }
+  }
+  return nearest;
+}
+
+TEST(road, geom_spiral_distance_to) {
+  const GeometrySpiral spirals[] = {
+    {0.0, 25.0, -1.7, Location(50.0, 40.0, 0.0), 0.0, 0.08},
+    {0.0, 60.0, 0.4, Location(-10.0, 5.0, 0.0), 0.0, 0.01},
+    {0.0, 15.0, 2.0, Location(0.0, 0.0, 0.0), 0.0, 0.3}};
+  std::mt19937_64 rng(42u);
+  std::uniform_real_distribution<double> offset(-30.0, 30.0);
+  for (auto &&spiral : spirals) {
+    const auto middle = spiral.PosFromDist(0.5 * spiral.GetLength()).location;
+    std::vector<Location> points;
+    for (auto i = 0; i < 50; ++i) {
+      points.emplace_back(middle.x + offset(rng), middle.y + offset(rng), 0.0);
+    }
+    std::vector<std::pair<double, double>> batch(points.size());
+    spiral.DistancesTo(points.data(), points.size(), batch.data());
+    for (auto i = 0u; i < points.size(); ++i) {
+      const auto &p = points[i];
+      const auto result = spiral.DistanceTo(p);
+      const auto expected = DistanceToDenseSampling(spiral, p);
+      ASSERT_GE(result.first, 0.0);
+      ASSERT_LE(result.first, spiral.GetLength());
+      ASSERT_NEAR(result.second, expected.second, 1e-3);
+      // The distance returned is the one to the point returned, locations are
+      // single precision.
+      const auto location = spiral.PosFromDist(result.first).location;
+      ASSERT_NEAR(Math::Distance2D(location, p), result.second, 1e-5);
+      ASSERT_EQ(batch[i], result);
+    }
+  }
+  // Every point of the curve is at distance zero.
+  const auto &spiral = spirals[0];
+  for (auto i = 1; i <= 10; ++i) {
+    const double s = spiral.GetLength() * i / 10.0;
+    const auto result = spiral.DistanceTo(spiral.PosFromDist(s).location);
+    ASSERT_NEAR(result.first, s, 1e-4);
+    ASSERT_NEAR(result.second, 0.0, 1e-4);
+  }
+}
+
+TEST(road, geom_spiral_curvatures) {
+  struct Curvatures { double start; double end; };
+  const Curvatures cases[] = {
+    {0.05, 0.0},    // curve to straight
+    {0.02, 0.06},   // non-zero start
+    {0.0, -0.08},   // turning right
+    {-0.03, 0.01},  // changing side
+    {0.04, 0.04}};  // arc
+  const double length = 30.0;
+  const double heading = 0.7;
+  const Location start(12.0, -4.0, 0.0);
+  std::mt19937_64 rng(42u);
+  std::uniform_real_distribution<double> offset(-20.0, 20.0);
+  for (auto &&curvatures : cases) {
+    const GeometrySpiral spiral(0.0, length, heading, start, curvatures.start, curvatures.end);
+    // Integrate the heading of the curve to compare against.
+    double x = start.x;
+    double y = start.y;
+    constexpr auto steps = 30000;
+    const double ds = length / steps;
+    for (auto i = 0; i <= steps; ++i) {
+      const double s = i * ds;
+      const auto point = spiral.PosFromDist(s);
+      ASSERT_NEAR(point.location.x, x, 1e-4);
+      ASSERT_NEAR(point.location.y, y, 1e-4);
+      const double curvature = curvatures.start + (curvatures.end - curvatures.start) * s / length;
+      ASSERT_NEAR(point.tangent, heading + 0.5 * (curvatures.start + curvature) * s, 1e-9);
+      const double sm = s + 0.5 * ds;
+      const double tangent =
+          heading + curvatures.start * sm + 0.5 * (curvatures.end - curvatures.start) * sm * sm / length;
+      x += ds * std::cos(tangent);
+      y += ds * std::sin(tangent);
+    }
+    // Mirrored curvatures give the mirrored curve.
+    const GeometrySpiral mirror(0.0, length, -heading, Location(start.x, -start.y, 0.0), -curvatures.start, -curvatures.end);
+    for (auto i = 0; i <= 10; ++i) {
+      const auto point = spiral.PosFromDist(length * i / 10.0);
+      const auto mirrored = mirror.PosFromDist(length * i / 10.0);
+      ASSERT_NEAR(point.location.x, mirrored.location.x, 1e-5);
+      ASSERT_NEAR(point.location.y, -mirrored.location.y, 1e-5);
+      ASSERT_NEAR(point.tangent, -mirrored.tangent, 1e-9);
+    }
+    const auto middle = spiral.PosFromDist(0.5 * length).location;
+    for (auto i = 0; i < 20; ++i) {
+      const Location p(middle.x + offset(rng), middle.y + offset(rng), 0.0);
+      const auto result = spiral.DistanceTo(p);
+      ASSERT_LE(result.second, std::numeric_limits<double>::max() / 2.0);
+      ASSERT_NEAR(result.second, DistanceToDenseSampling(spiral, p).second, 1e-3);
+    }
+  }
+}
+
+TEST(road, benchmark_geom_distance_to) {
+  const GeometryLine line(0.0, 25.0, -1.7, Location(50.0, 40.0, 0.0));
+  const GeometryArc arc(0.0, 25.0, -1.7, Location(50.0, 40.0, 0.0), 0.08);
+  const GeometrySpiral spiral(0.0, 25.0, -1.7, Location(50.0, 40.0, 0.0), 0.0, 0.08);
+  std::mt19937_64 rng(42u);
+  std::uniform_real_distribution<double> coordinate(20.0, 80.0);
+  std::vector<Location> points;
+  constexpr auto count = 100000u;
+  for (auto i = 0u; i < count; ++i) {
+    points.emplace_back(coordinate(rng), coordinate(rng), 0.0);
+  }
+  std::vector<std::pair<double, double>> results(count);
+  auto report = [](const char *name, const carla::StopWatch &stop_watch) {
+    std::cout << "  " << name << ": "
+              << stop_watch.GetElapsedTime<std::chrono::microseconds>() * 1000.0 / count
+              << " ns per point" << std::endl;
+  };
+  auto evaluate = [&](const char *name, const Geometry &geometry) {
+    carla::StopWatch stop_watch;
+    for (auto i = 0u; i < count; ++i) {
+      results[i] = geometry.DistanceTo(points[i]);
+    }
+    stop_watch.Stop();
+    report(name, stop_watch);
+  };
+  evaluate("line", line);
+  evaluate("arc", arc);
+  evaluate("spiral", spiral);
+  carla::StopWatch stop_watch;
+  spiral.DistancesTo(points.data(), count, results.data());
+  stop_watch.Stop();
+  report("spiral batched", stop_watch);
+}
+
+static void AddTestGeometries(RoadSegmentDefinition &def) {
+  def.MakeGeometry<GeometryLine>(0.0, 30.0, 0.3, Location(0, 0, 0));
+  def.MakeGeometry<GeometryArc>(30.0, 40.0, 0.3, Location(28.66, 8.87, 0), -0.05);
+  def.MakeGeometry<GeometrySpiral>(70.0, 25.0, -1.7, Location(50.0, 40.0, 0), 0.0, 0.08);
+  def.MakeGeometry<GeometryLine>(95.0, 20.0, -0.7, Location(60.0, 30.0, 0));
+}
+
+TEST(road, arc_length_table_tolerance) {
+  // Same geometries to evaluate them directly.
+  RoadSegmentDefinition reference(0);
+  AddTestGeometries(reference);
+  const auto &geometries = reference.GetGeometry();
+
+  for (auto tolerance : {0.1, 0.01, 0.001}) {
+    MapBuilder builder;
+    builder.SetArcLengthTableTolerance(tolerance);
+    RoadSegmentDefinition def(1);
+    AddTestGeometries(def);
+    builder.AddRoadSegmentDefinition(def);
+    auto map = builder.Build();
+    const auto &road = *map->GetData().GetRoad(1);
+    double max_error = 0.0;
+    for (auto &&geometry : geometries) {
+      for (auto i = 1; i <= 1000; ++i) {
+        const double dist = geometry->GetLength() * i / 1000.0;
+        const auto expected = geometry->PosFromDist(dist);
+        const auto actual = road.GetDirectedPointIn(geometry->GetStartOffset() + dist);
+        const auto error = Math::Distance(expected.location, actual.location);
+        ASSERT_LE(error, tolerance);
+        ASSERT_LE(std::abs(expected.tangent - actual.tangent), tolerance);
+        max_error = std::max<double>(max_error, error);
+      }
+    }
+    ASSERT_GT(max_error, 0.0);
+  }
+}
+
+TEST(road, arc_length_table_disabled) {
+  RoadSegmentDefinition reference(0);
+  AddTestGeometries(reference);
+  MapBuilder builder;
+  builder.SetArcLengthTableTolerance(0.0);
+  RoadSegmentDefinition def(1);
+  AddTestGeometries(def);
+  builder.AddRoadSegmentDefinition(def);
+  auto map = builder.Build();
+  const auto &road = *map->GetData().GetRoad(1);
+  for (auto &&geometry : reference.GetGeometry()) {
+    for (auto i = 1; i <= 100; ++i) {
+      const double s = geometry->GetStartOffset() + geometry->GetLength() * i / 100.0;
+      ASSERT_EQ(
+          road.GetDirectedPointIn(s),
+          geometry->PosFromDist(s - geometry->GetStartOffset()));
+    }
+  }
+}
+
+TEST(road, benchmark_arc_length_table) {
+  auto evaluate = [](double tolerance) {
+    MapBuilder builder;
+    builder.SetArcLengthTableTolerance(tolerance);
+    RoadSegmentDefinition def(1);
+    AddTestGeometries(def);
+    builder.AddRoadSegmentDefinition(def);
+    auto map = builder.Build();
+    const auto &road = *map->GetData().GetRoad(1);
+    carla::StopWatch stop_watch;
+    double sum = 0.0;
+    constexpr int count = 1000000;
+    for (auto i = 0; i < count; ++i) {
+      sum += road.GetDirectedPointIn(road.GetLength() * i / count).location.x;
+    }
+    stop_watch.Stop();
+    std::cout << "  tolerance " << tolerance << ": "
+              << stop_watch.GetElapsedTime<std::chrono::microseconds>() * 1000.0 / count
+              << " ns per point" << std::endl;
+    return sum;
+  };
+  evaluate(0.0);
+  evaluate(0.01);
+  evaluate(0.001);
+}
+
+/// Smooth profile over [0, 300] meters, with a change of slope at 200.
+static CubicProfile MakeTestProfile() {
+  CubicProfile profile;
+  profile.Add({100.0, 5.0, 0.02, -0.001, 0.00001});
+  profile.Add({0.0, 0.0, 0.05, 0.0, 0.0});
+  profile.Add({200.0, 7.0, -0.01, 0.0, 0.0});
+  return profile;
+}
+
+TEST(road, cubic_profile) {
+  const auto reference = MakeTestProfile();
+  ASSERT_FALSE(reference.IsBaked());
+  ASSERT_EQ(reference.GetRecords().size(), 3u);
+  ASSERT_EQ(reference.GetRecords()[0u].s, 0.0);
+  ASSERT_EQ(reference.GetRecords()[1u].s, 100.0);
+  ASSERT_EQ(reference.Evaluate(50.0).first, 2.5);
+  ASSERT_EQ(reference.Evaluate(50.0).second, 0.05);
+  ASSERT_DOUBLE_EQ(reference.Evaluate(110.0).first, 5.0 + 0.2 - 0.1 + 0.01);
+  ASSERT_DOUBLE_EQ(reference.Evaluate(110.0).second, 0.02 - 0.02 + 0.003);
+  ASSERT_EQ(reference.Evaluate(250.0).first, 6.5);
+  ASSERT_EQ(CubicProfile().Evaluate(10.0).first, 0.0);
+
+  for (auto tolerance : {0.1, 0.01, 0.001}) {
+    auto profile = MakeTestProfile();
+    profile.Bake(300.0, tolerance);
+    ASSERT_TRUE(profile.IsBaked());
+    double max_error = 0.0;
+    for (auto i = 0; i <= 10000; ++i) {
+      const double s = 300.0 * i / 10000.0;
+      const auto error = std::abs(profile.Evaluate(s).first - reference.Evaluate(s).first);
+      ASSERT_LE(error, tolerance);
+      max_error = std::max(max_error, error);
+    }
+    ASSERT_GT(max_error, 0.0);
+    // Out of the table the records are evaluated.
+    ASSERT_EQ(profile.Evaluate(400.0), reference.Evaluate(400.0));
+  }
+
+  // Jumps can't be interpolated.
+  auto profile = MakeTestProfile();
+  profile.Add({250.0, 10.0, 0.0, 0.0, 0.0});
+  profile.Bake(300.0, 0.01);
+  ASSERT_FALSE(profile.IsBaked());
+  profile.Bake(300.0, 0.0);
+  ASSERT_FALSE(profile.IsBaked());
+}
+
+TEST(road, benchmark_cubic_profile) {
+  auto evaluate = [](double tolerance) {
+    auto profile = MakeTestProfile();
+    profile.Bake(300.0, tolerance);
+    carla::StopWatch stop_watch;
+    double sum = 0.0;
+    constexpr int count = 1000000;
+    for (auto i = 0; i < count; ++i) {
+      sum += profile.Evaluate(300.0 * i / count).first;
+    }
+    stop_watch.Stop();
+    std::cout << "  tolerance " << tolerance << ": "
+              << stop_watch.GetElapsedTime<std::chrono::microseconds>() * 1000.0 / count
+              << " ns per evaluation" << std::endl;
+    return sum;
+  };
+  evaluate(0.0);
+  evaluate(0.01);
+}
+
 TEST(road, get_information) {
   MapBuilder builder;
   RoadSegmentDefinition def(0);
@@ -201,3 +540,872 @@ TEST(road, get_information) {
   const RoadInfoVelocity *r = m.GetData().GetRoad(0)->GetInfo<RoadInfoVelocity>(0.0);
   (void)r;
 }
+
+// =============================================================================
+// -- Spatial index ------------------------------------------------------------
+// =============================================================================
+
+static void AddDrivingLanes(RoadSegmentDefinition &def) {
+  auto *lanes = def.MakeInfo<RoadInfoLane>();
+  lanes->addLaneInfo(-1, 3.5, LaneType::Driving);
+  lanes->addLaneInfo(1, 3.5, LaneType::Driving);
+}
+
+/// Build a grid of @a size x @a size junctions, connected by straight roads
+/// and with curved roads turning at every junction.
+static carla::SharedPtr<Map> MakeTown(const int size, const double block = 80.0) {
+  MapBuilder builder;
+  id_type id = 0u;
+  for (int i = 0; i < size; ++i) {
+    for (int j = 0; j < size; ++j) {
+      const Location junction(i * block, j * block, 0.0);
+      for (int k = 0; k < 2; ++k) {
+        if ((k == 0 ? i : j) + 1 == size) {
+          continue;
+        }
+        // Straight road to the next junction, made of several geometries.
+        RoadSegmentDefinition def(id++);
+        const double heading = k * Math::pi_half();
+        const double length = block - 20.0;
+        const int pieces = 4;
+        for (int p = 0; p < pieces; ++p) {
+          const double offset = 10.0 + p * length / pieces;
+          def.MakeGeometry<GeometryLine>(
+              p * length / pieces,
+              length / pieces,
+              heading,
+              Location(
+                  junction.x + offset * std::cos(heading),
+                  junction.y + offset * std::sin(heading),
+                  0.0));
+        }
+        AddDrivingLanes(def);
+        builder.AddRoadSegmentDefinition(def);
+      }
+      for (int k = 0; k < 4; ++k) {
+        // Turn inside the junction.
+        RoadSegmentDefinition def(id++);
+        const double heading = k * Math::pi_half();
+        def.MakeGeometry<GeometryArc>(
+            0.0,
+            Math::pi_half() * 10.0,
+            heading,
+            Location(
+                junction.x - 10.0 * std::cos(heading),
+                junction.y - 10.0 * std::sin(heading),
+                0.0),
+            -0.1);
+        AddDrivingLanes(def);
+        builder.AddRoadSegmentDefinition(def);
+      }
+    }
+  }
+  return builder.Build();
+}
+
+/// Distance to the nearest driving lane as the waypoint lookup computed it
+/// before having a spatial index, visiting every road segment.
+static double FindNearestLaneBruteForce(const Map &map, const Location &loc) {
+  constexpr size_t max_nearests = 10u;
+  std::vector<std::pair<double, const RoadSegment *>> nearest;
+  std::vector<double> dists;
+  for (auto &&road : map.GetData().GetRoadSegments()) {
+    const auto d = road.GetNearestPoint(loc);
+    nearest.emplace_back(d.second, &road);
+    dists.emplace_back(d.first);
+  }
+  std::vector<size_t> order(nearest.size());
+  for (auto i = 0u; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  const auto count = std::min(max_nearests, order.size());
+  std::partial_sort(order.begin(), order.begin() + count, order.end(), [&](auto a, auto b) {
+    return nearest[a].first < nearest[b].first;
+  });
+  double result = std::numeric_limits<double>::max();
+  for (auto i = 0u; i < count; ++i) {
+    const auto index = order[i];
+    result = std::min(result, nearest[index].second->GetNearestLane(dists[index], loc).second);
+  }
+  return result;
+}
+
+static std::vector<Location> MakeRandomLocations(size_t count, double max) {
+  std::mt19937_64 rng(42u);
+  std::uniform_real_distribution<double> dist(-20.0, max + 20.0);
+  std::vector<Location> result;
+  for (auto i = 0u; i < count; ++i) {
+    result.emplace_back(dist(rng), dist(rng), 0.0);
+  }
+  return result;
+}
+
+TEST(road, spatial_index_finds_nearest_lane) {
+  constexpr int size = 6;
+  auto map = MakeTown(size);
+  ASSERT_GT(map->GetData().GetSpatialIndex().size(), map->GetData().GetRoadCount());
+  for (auto &&loc : MakeRandomLocations(2000u, size * 80.0)) {
+    const auto waypoint = map->GetClosestWaypointOnRoad(loc);
+    const auto expected = FindNearestLaneBruteForce(*map, loc);
+    const auto location = waypoint.ComputeTransform().location;
+    ASSERT_NEAR(Math::Distance2D(location, loc), expected, 1e-6);
+  }
+}
+
+TEST(road, spatial_index_nearest_roads_sorted) {
+  auto map = MakeTown(4);
+  SpatialIndex::NearestRoad nearest[10u];
+  const Location loc(85.0, 42.0, 0.0);
+  const auto count = map->GetData().GetSpatialIndex().FindNearestRoads(loc, nearest, 10u);
+  ASSERT_EQ(count, 10u);
+  for (auto i = 0u; i < count; ++i) {
+    const auto d = nearest[i].road->GetNearestPoint(loc);
+    ASSERT_NEAR(nearest[i].distance, d.second, 1e-9);
+    ASSERT_NEAR(nearest[i].distance_along_road, d.first, 1e-9);
+    if (i > 0u) {
+      ASSERT_LE(nearest[i - 1u].distance, nearest[i].distance);
+    }
+  }
+  // Nothing nearer left out.
+  for (auto &&road : map->GetData().GetRoadSegments()) {
+    bool found = false;
+    for (auto i = 0u; i < count; ++i) {
+      found = found || (nearest[i].road == &road);
+    }
+    if (!found) {
+      ASSERT_GE(road.GetNearestPoint(loc).second, nearest[count - 1u].distance);
+    }
+  }
+}
+
+TEST(road, benchmark_get_waypoint) {
+  // About the number of road segments of a town map.
+  constexpr int size = 20;
+  carla::StopWatch build_time;
+  auto map = MakeTown(size);
+  build_time.Stop();
+  const auto locations = MakeRandomLocations(2000u, size * 80.0);
+
+  carla::StopWatch brute_force_time;
+  double brute_force_sum = 0.0;
+  for (auto &&loc : locations) {
+    brute_force_sum += FindNearestLaneBruteForce(*map, loc);
+  }
+  brute_force_time.Stop();
+
+  carla::StopWatch index_time;
+  double index_sum = 0.0;
+  for (auto &&loc : locations) {
+    const auto waypoint = map->GetClosestWaypointOnRoad(loc);
+    index_sum += Math::Distance2D(waypoint.ComputeTransform().location, loc);
+  }
+  index_time.Stop();
+
+  const auto to_us = [&](const auto &watch) {
+    return static_cast<double>(watch.template GetElapsedTime<std::chrono::microseconds>()) /
+        static_cast<double>(locations.size());
+  };
+  std::cout << map->GetData().GetRoadCount() << " roads, index built in "
+            << build_time.GetElapsedTime() << " ms\n"
+            << "  brute force: " << to_us(brute_force_time) << " us per lookup\n"
+            << "  spatial index: " << to_us(index_time) << " us per lookup" << std::endl;
+  ASSERT_NEAR(brute_force_sum, index_sum, 1e-6 * locations.size());
+  ASSERT_LT(index_time.GetDuration(), brute_force_time.GetDuration());
+}
+
+TEST(road, get_waypoints_batch) {
+  constexpr int size = 6;
+  auto map = MakeTown(size);
+  const auto locations = MakeRandomLocations(3000u, size * 80.0);
+  for (auto project_to_road : {true, false}) {
+    const auto result = map->GetWaypoints(locations, project_to_road);
+    ASSERT_EQ(result.size(), locations.size());
+    for (auto i = 0u; i < locations.size(); ++i) {
+      const auto expected = project_to_road ?
+          carla::Optional<Waypoint>(map->GetClosestWaypointOnRoad(locations[i])) :
+          map->GetWaypoint(locations[i]);
+      const auto &info = result[i];
+      ASSERT_EQ(info.is_valid, expected.has_value());
+      if (info.is_valid) {
+        ASSERT_EQ(info.road_id, expected->GetRoadId());
+        ASSERT_EQ(info.lane_id, expected->GetLaneId());
+        ASSERT_EQ(info.s, expected->GetDistance());
+        ASSERT_EQ(info.transform, expected->ComputeTransform());
+      }
+    }
+  }
+}
+
+TEST(road, benchmark_get_waypoints_batch) {
+  constexpr int size = 20;
+  auto map = MakeTown(size);
+  const auto locations = MakeRandomLocations(10000u, size * 80.0);
+
+  // What a client does calling GetWaypoint for each location.
+  carla::StopWatch loop_time;
+  std::vector<std::shared_ptr<std::pair<Waypoint, Transform>>> loop_result;
+  for (auto &&loc : locations) {
+    const auto waypoint = map->GetClosestWaypointOnRoad(loc);
+    loop_result.emplace_back(std::make_shared<std::pair<Waypoint, Transform>>(
+        waypoint,
+        waypoint.ComputeTransform()));
+  }
+  loop_time.Stop();
+
+  carla::StopWatch batch_time;
+  const auto batch_result = map->GetWaypoints(locations);
+  batch_time.Stop();
+
+  ASSERT_EQ(batch_result.size(), loop_result.size());
+  for (auto i = 0u; i < batch_result.size(); ++i) {
+    ASSERT_EQ(batch_result[i].transform, loop_result[i]->second);
+  }
+  std::cout << locations.size() << " locations on " << std::thread::hardware_concurrency()
+            << " threads:\n"
+            << "  loop:  " << loop_time.GetElapsedTime() << " ms\n"
+            << "  batch: " << batch_time.GetElapsedTime() << " ms" << std::endl;
+}
+
+TEST(road, benchmark_road_queries) {
+  constexpr int size = 20;
+  auto map = MakeTown(size);
+  const auto &data = map->GetData();
+  const auto locations = MakeRandomLocations(200000u, size * 80.0);
+  const auto road_count = data.GetRoadCount();
+
+  carla::StopWatch lookup_time;
+  double sum = 0.0;
+  for (auto i = 0u; i < locations.size(); ++i) {
+    const auto *road = data.GetRoad(i % road_count);
+    const double s = road->GetLength() * (i % 100u) / 100.0;
+    sum += road->GetInfo<RoadInfoLane>(s)->getLane(-1)->_width;
+    sum += road->GetInfoReverse<RoadInfoVelocity>(s) != nullptr ? 1.0 : 0.0;
+    sum += road->GetDirectedPointIn(s).tangent;
+  }
+  lookup_time.Stop();
+
+  carla::StopWatch nearest_time;
+  for (auto i = 0u; i < locations.size(); ++i) {
+    sum += data.GetRoad(i % road_count)->GetNearestPoint(locations[i]).second;
+  }
+  nearest_time.Stop();
+
+  const auto to_ns = [&](const auto &watch) {
+    return static_cast<double>(watch.template GetElapsedTime<std::chrono::nanoseconds>()) /
+        static_cast<double>(locations.size());
+  };
+  std::cout << road_count << " roads (" << sum << ")\n"
+            << "  road, info and point: " << to_ns(lookup_time) << " ns per query\n"
+            << "  nearest point: " << to_ns(nearest_time) << " ns per query" << std::endl;
+}
+
+/// Lane layout of the roads of a ring, see MakeRing.
+enum class RingLanes {
+  /// Lanes -1 and 1. Lane -1 of each road leads to lane -1 of the next road,
+  /// and on even roads also to lane 1 of it. Lane 1 leads to lane 1 of the
+  /// previous road.
+  Branching,
+  /// Lanes -1 and -2, each leading to the same lane of the next road.
+  TwoLanes
+};
+
+/// Ring of @a count straight roads of @a length with the given @a lanes. With
+/// @a spirals the roads are slightly curved spirals instead, not joined to
+/// each other.
+static carla::SharedPtr<Map> MakeRing(
+    const int count,
+    const double length = 50.0,
+    const RingLanes lanes = RingLanes::Branching,
+    const bool spirals = false) {
+  MapBuilder builder;
+  double x = 0.0;
+  double y = 0.0;
+  for (int i = 0; i < count; ++i) {
+    RoadSegmentDefinition def(i);
+    const double heading = 2.0 * Math::pi() * i / count;
+    if (spirals) {
+      def.MakeGeometry<GeometrySpiral>(0.0, length, heading, Location(x, y, 0.0), 0.0, 0.001);
+    } else {
+      def.MakeGeometry<GeometryLine>(0.0, length, heading, Location(x, y, 0.0));
+    }
+    x += length * std::cos(heading);
+    y += length * std::sin(heading);
+    const int next = (i + 1) % count;
+    const int previous = (i + count - 1) % count;
+    def.AddSuccessorID(next);
+    def.AddPredecessorID(previous);
+    switch (lanes) {
+      case RingLanes::Branching:
+        AddDrivingLanes(def);
+        def.AddNextLaneInfo(-1, -1, next);
+        if (i % 2 == 0) {
+          def.AddNextLaneInfo(-1, 1, next);
+        }
+        def.AddPrevLaneInfo(1, 1, previous);
+        break;
+      case RingLanes::TwoLanes: {
+        auto *info = def.MakeInfo<RoadInfoLane>();
+        info->addLaneInfo(-1, 3.5, LaneType::Driving);
+        info->addLaneInfo(-2, 3.5, LaneType::Driving);
+        def.AddNextLaneInfo(-1, -1, next);
+        def.AddNextLaneInfo(-2, -2, next);
+        break;
+      }
+    }
+    builder.AddRoadSegmentDefinition(def);
+  }
+  return builder.Build();
+}
+
+static Waypoint FindWaypoint(const std::vector<Waypoint> &waypoints, id_type road_id, int lane_id) {
+  auto it = std::find_if(waypoints.begin(), waypoints.end(), [&](const Waypoint &w) {
+    return (w.GetRoadId() == road_id) && (w.GetLaneId() == lane_id);
+  });
+  DEBUG_ASSERT(it != waypoints.end());
+  return *it;
+}
+
+TEST(road, waypoint_get_next) {
+  constexpr double length = 50.0;
+  auto map = MakeRing(10, length);
+
+  const auto &road = *map->GetData().GetRoad(0);
+  ASSERT_EQ(road.GetSuccessors().size(), 1);
+  ASSERT_EQ((*road.GetSuccessors().begin())->GetId(), 1u);
+  ASSERT_EQ(road.GetNextLane(-1).size(), 2);
+  ASSERT_EQ(road.GetNextLane(-1).begin()->second, 1);
+  ASSERT_TRUE(road.GetNextLane(1).empty());
+  ASSERT_TRUE(road.GetNextLane(5).empty());
+  ASSERT_EQ(road.GetPrevLane(1).size(), 1);
+
+  const auto waypoints = WaypointGenerator::GenerateAll(*map, length);
+  const auto start = FindWaypoint(waypoints, 0u, -1);
+  ASSERT_EQ(start.GetDistance(), 0.0);
+
+  const auto next = WaypointGenerator::GetNext(start, length + 1.0);
+  ASSERT_EQ(next.size(), 2u);
+  ASSERT_EQ(next[0].GetRoadId(), 1u);
+  ASSERT_EQ(next[0].GetLaneId(), -1);
+  ASSERT_NEAR(next[0].GetDistance(), 1.0, 1e-9);
+  ASSERT_EQ(next[1].GetRoadId(), 1u);
+  ASSERT_EQ(next[1].GetLaneId(), 1);
+  ASSERT_NEAR(next[1].GetDistance(), length - 1.0, 1e-9);
+
+  // Lane 1 goes backward, to the previous road.
+  const auto back = WaypointGenerator::GetNext(next[1], length);
+  ASSERT_EQ(back.size(), 1u);
+  ASSERT_EQ(back[0].GetRoadId(), 0u);
+  ASSERT_EQ(back[0].GetLaneId(), 1);
+  ASSERT_NEAR(back[0].GetDistance(), length - 1.0, 1e-9);
+
+  // Odd roads do not branch.
+  ASSERT_EQ(WaypointGenerator::GetNext(next[0], length).size(), 1u);
+
+  std::vector<Waypoint> out;
+  WaypointGenerator::GetNext(start, 1.0, out);
+  WaypointGenerator::GetNext(start, length + 1.0, out);
+  ASSERT_EQ(out.size(), 3u);
+  ASSERT_NEAR(out[0].GetDistance(), 1.0, 1e-9);
+  ASSERT_EQ(out[0].GetRoadId(), 0u);
+  ASSERT_EQ(out[2].GetLaneId(), 1);
+}
+
+TEST(road, benchmark_waypoint_get_next) {
+  constexpr size_t steps = 1000000u;
+  constexpr size_t warm_up = 1000u;
+  auto map = MakeRing(100);
+  const auto start = FindWaypoint(WaypointGenerator::GenerateAll(*map, 50.0), 0u, -1);
+
+  auto walk = [&](const char *name, auto &&step) {
+    auto current = start;
+    for (auto i = 0u; i < warm_up; ++i) {
+      current = step(current, i);
+    }
+    const size_t allocations_before = util::allocations::count();
+    carla::StopWatch stop_watch;
+    util::allocations::enable_counting();
+    for (auto i = 0u; i < steps; ++i) {
+      current = step(current, i);
+    }
+    util::allocations::enable_counting(false);
+    stop_watch.Stop();
+    const size_t allocations = util::allocations::count() - allocations_before;
+    std::cout << "  " << name << ": "
+              << static_cast<double>(stop_watch.GetElapsedTime<std::chrono::nanoseconds>()) / steps
+              << " ns and " << static_cast<double>(allocations) / steps << " allocations per step"
+              << std::endl;
+    return allocations;
+  };
+
+  std::cout << steps << " steps of GetNext(2.0)" << std::endl;
+  walk("returning a vector", [](const Waypoint &current, size_t i) {
+    const auto next = WaypointGenerator::GetNext(current, 2.0);
+    return next[i % next.size()];
+  });
+  std::vector<Waypoint> buffer;
+  const auto allocations = walk("appending to a buffer", [&](const Waypoint &current, size_t i) {
+    buffer.clear();
+    WaypointGenerator::GetNext(current, 2.0, buffer);
+    return buffer[i % buffer.size()];
+  });
+  ASSERT_EQ(allocations, 0u);
+}
+
+/// Waypoint at the entrance of every lane with successors.
+static std::vector<Waypoint> GetLaneEntries(const Map &map) {
+  std::vector<Waypoint> result;
+  for (auto &&pair : WaypointGenerator::GenerateTopology(map)) {
+    result.push_back(pair.first);
+  }
+  return result;
+}
+
+/// Waypoint @a distance meters after the entrance of the given lane.
+static Waypoint MakeWaypoint(
+    const std::vector<Waypoint> &entries,
+    id_type road_id,
+    int lane_id,
+    double distance) {
+  const auto entry = FindWaypoint(entries, road_id, lane_id);
+  if (distance == 0.0) {
+    return entry;
+  }
+  const auto next = WaypointGenerator::GetNext(entry, distance);
+  DEBUG_ASSERT(!next.empty());
+  return next.front();
+}
+
+TEST(road, router_compute_route) {
+  constexpr double length = 50.0;
+  auto map = MakeRing(10, length);
+  const auto waypoints = GetLaneEntries(*map);
+  Router router(*map);
+  ASSERT_EQ(router.GetNodeCount(), 20u);
+
+  // Ahead in the same lane.
+  {
+    auto route = router.ComputeRoute(
+        MakeWaypoint(waypoints, 0u, -1, 5.0),
+        MakeWaypoint(waypoints, 0u, -1, 30.0));
+    ASSERT_EQ(route.waypoints.size(), 2u);
+    ASSERT_NEAR(route.length, 25.0, 1e-9);
+    ASSERT_EQ(route.lane_changes, 0u);
+  }
+  // Along several roads.
+  {
+    auto route = router.ComputeRoute(
+        MakeWaypoint(waypoints, 0u, -1, 5.0),
+        MakeWaypoint(waypoints, 3u, -1, 10.0));
+    ASSERT_EQ(route.waypoints.size(), 5u);
+    ASSERT_EQ(route.waypoints[1].GetRoadId(), 1u);
+    ASSERT_EQ(route.waypoints[3].GetRoadId(), 3u);
+    ASSERT_NEAR(route.length, 155.0, 1e-9);
+  }
+  // Behind in the same lane, going around the ring.
+  {
+    auto route = router.ComputeRoute(
+        MakeWaypoint(waypoints, 0u, -1, 30.0),
+        MakeWaypoint(waypoints, 0u, -1, 5.0));
+    ASSERT_EQ(route.waypoints.size(), 12u);
+    ASSERT_NEAR(route.length, 475.0, 1e-9);
+  }
+  // Taking the branch to lane 1, that goes backwards.
+  {
+    auto route = router.ComputeRoute(
+        MakeWaypoint(waypoints, 0u, -1, 5.0),
+        MakeWaypoint(waypoints, 0u, 1, 10.0));
+    ASSERT_EQ(route.waypoints.size(), 4u);
+    ASSERT_EQ(route.waypoints[1].GetRoadId(), 1u);
+    ASSERT_EQ(route.waypoints[1].GetLaneId(), 1);
+    ASSERT_NEAR(route.length, 105.0, 1e-9);
+    ASSERT_NEAR(route.waypoints.back().GetDistance(), length - 10.0, 1e-9);
+  }
+  // Lane 1 never leads back to lane -1.
+  {
+    auto route = router.ComputeRoute(
+        MakeWaypoint(waypoints, 0u, 1, 5.0),
+        MakeWaypoint(waypoints, 3u, -1, 5.0));
+    ASSERT_TRUE(route.empty());
+  }
+}
+
+TEST(road, router_lane_change) {
+  auto map = MakeRing(10, 50.0, RingLanes::TwoLanes);
+  const auto waypoints = GetLaneEntries(*map);
+  Router router(*map, 10.0);
+
+  {
+    auto route = router.ComputeRoute(
+        MakeWaypoint(waypoints, 0u, -1, 5.0),
+        MakeWaypoint(waypoints, 0u, -2, 20.0));
+    ASSERT_EQ(route.waypoints.size(), 2u);
+    ASSERT_EQ(route.lane_changes, 1u);
+    ASSERT_NEAR(route.length, 15.0, 1e-9);
+  }
+  {
+    auto route = router.ComputeRoute(
+        MakeWaypoint(waypoints, 0u, -1, 5.0),
+        MakeWaypoint(waypoints, 2u, -2, 10.0));
+    ASSERT_EQ(route.waypoints.back().GetLaneId(), -2);
+    ASSERT_EQ(route.lane_changes, 1u);
+    ASSERT_NEAR(route.length, 105.0, 1e-9);
+  }
+}
+
+TEST(road, router_cache_and_batch) {
+  auto map = MakeRing(20, 50.0, RingLanes::TwoLanes);
+  const auto waypoints = GetLaneEntries(*map);
+  Router router(*map, 10.0, 2u);
+  ASSERT_EQ(router.GetCachedRouteCount(), 0u);
+
+  const auto origin = MakeWaypoint(waypoints, 0u, -1, 5.0);
+  std::vector<std::pair<Waypoint, Waypoint>> pairs;
+  for (id_type road = 0u; road < 20u; ++road) {
+    for (int lane : {-1, -2}) {
+      pairs.emplace_back(
+          MakeWaypoint(waypoints, road, lane, 10.0),
+          MakeWaypoint(waypoints, (road * 7u) % 20u, -1 - (lane == -1 ? 1 : 0), 20.0));
+    }
+  }
+
+  // Routes within a lane are not cached.
+  router.ComputeRoute(origin, MakeWaypoint(waypoints, 0u, -1, 10.0));
+  ASSERT_EQ(router.GetCachedRouteCount(), 0u);
+  const auto first = router.ComputeRoute(origin, MakeWaypoint(waypoints, 5u, -1, 10.0));
+  ASSERT_EQ(router.GetCachedRouteCount(), 1u);
+  const auto cached = router.ComputeRoute(origin, MakeWaypoint(waypoints, 5u, -1, 10.0));
+  ASSERT_EQ(router.GetCachedRouteCount(), 1u);
+  ASSERT_EQ(cached.waypoints.size(), first.waypoints.size());
+  ASSERT_EQ(cached.length, first.length);
+  router.ComputeRoute(origin, MakeWaypoint(waypoints, 6u, -1, 10.0));
+  router.ComputeRoute(origin, MakeWaypoint(waypoints, 7u, -1, 10.0));
+  ASSERT_EQ(router.GetCachedRouteCount(), 2u);
+
+  const auto routes = router.ComputeRoutes(pairs);
+  ASSERT_EQ(routes.size(), pairs.size());
+  for (auto i = 0u; i < pairs.size(); ++i) {
+    const auto expected = router.ComputeRoute(pairs[i].first, pairs[i].second);
+    ASSERT_FALSE(routes[i].empty());
+    ASSERT_EQ(routes[i].waypoints.size(), expected.waypoints.size());
+    ASSERT_NEAR(routes[i].length, expected.length, 1e-9);
+    ASSERT_EQ(routes[i].lane_changes, expected.lane_changes);
+    ASSERT_EQ(routes[i].waypoints.back().GetRoadId(), pairs[i].second.GetRoadId());
+  }
+}
+
+TEST(road, benchmark_router) {
+  constexpr int road_count = 2000;
+  constexpr size_t route_count = 1000u;
+  auto map = MakeRing(road_count, 50.0, RingLanes::TwoLanes);
+  const auto waypoints = GetLaneEntries(*map);
+  Router router(*map, 10.0, route_count);
+
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<id_type> road(0u, road_count - 1u);
+  std::uniform_int_distribution<int> lane(-2, -1);
+  std::vector<std::pair<Waypoint, Waypoint>> pairs;
+  pairs.reserve(route_count);
+  for (auto i = 0u; i < route_count; ++i) {
+    const auto origin = road(rng);
+    // Destinations not too far away, as in a typical navigation query.
+    const auto destination = (origin + 1u + road(rng) % 50u) % road_count;
+    pairs.emplace_back(
+        MakeWaypoint(waypoints, origin, lane(rng), 10.0),
+        MakeWaypoint(waypoints, destination, lane(rng), 20.0));
+  }
+
+  auto run = [&](const char *name, auto &&compute) {
+    carla::StopWatch stop_watch;
+    double sum = compute();
+    stop_watch.Stop();
+    std::cout << "  " << name << ": "
+              << static_cast<double>(stop_watch.GetElapsedTime<std::chrono::microseconds>()) / route_count
+              << " us per route (" << sum << ")" << std::endl;
+    return sum;
+  };
+
+  std::cout << route_count << " routes on a ring of " << road_count << " roads, "
+            << std::thread::hardware_concurrency() << " threads" << std::endl;
+  const auto compute_one_by_one = [&]() {
+    double sum = 0.0;
+    for (auto &&pair : pairs) {
+      sum += router.ComputeRoute(pair.first, pair.second).length;
+    }
+    return sum;
+  };
+  const auto uncached = run("uncached", compute_one_by_one);
+  const auto cached = run("cached", compute_one_by_one);
+  const auto batch = run("batch, cached", [&]() {
+    double sum = 0.0;
+    for (auto &&route : router.ComputeRoutes(pairs)) {
+      sum += route.length;
+    }
+    return sum;
+  });
+  ASSERT_NEAR(uncached, cached, 1e-6);
+  ASSERT_NEAR(uncached, batch, 1e-6);
+}
+
+TEST(road, generate_all_arrays) {
+  auto map = MakeTown(6);
+  for (double distance : {0.5, 7.0}) {
+    const auto waypoints = WaypointGenerator::GenerateAll(*map, distance);
+    const auto arrays = WaypointGenerator::GenerateAllArrays(*map, distance);
+    ASSERT_FALSE(waypoints.empty());
+    ASSERT_EQ(arrays.size(), waypoints.size());
+    ASSERT_EQ(arrays.yaw.size(), waypoints.size());
+    for (auto i = 0u; i < waypoints.size(); ++i) {
+      const auto transform = waypoints[i].ComputeTransform();
+      ASSERT_EQ(arrays.road_id[i], waypoints[i].GetRoadId());
+      ASSERT_EQ(arrays.lane_id[i], waypoints[i].GetLaneId());
+      ASSERT_EQ(arrays.s[i], waypoints[i].GetDistance());
+      ASSERT_EQ(arrays.x[i], transform.location.x);
+      ASSERT_EQ(arrays.y[i], transform.location.y);
+      ASSERT_EQ(arrays.z[i], transform.location.z);
+      ASSERT_EQ(arrays.yaw[i], transform.rotation.yaw);
+    }
+  }
+}
+
+TEST(road, benchmark_generate_all) {
+  constexpr double distance = 0.5;
+  auto map = MakeTown(20);
+
+  auto run = [](const char *name, auto &&generate) {
+    const size_t allocations_before = util::allocations::count();
+    carla::StopWatch stop_watch;
+    util::allocations::enable_counting();
+    const size_t count = generate();
+    util::allocations::enable_counting(false);
+    stop_watch.Stop();
+    std::cout << "  " << name << ": " << stop_watch.GetElapsedTime() << " ms, "
+              << util::allocations::count() - allocations_before << " allocations" << std::endl;
+    return count;
+  };
+
+  std::cout << "generate waypoints every " << distance << " m, "
+            << std::thread::hardware_concurrency() << " threads" << std::endl;
+  const auto expected = run("waypoints and transforms", [&]() {
+    const auto waypoints = WaypointGenerator::GenerateAll(*map, distance);
+    std::vector<Transform> transforms;
+    transforms.reserve(waypoints.size());
+    for (auto &&waypoint : waypoints) {
+      transforms.emplace_back(waypoint.ComputeTransform());
+    }
+    return transforms.size();
+  });
+  const auto count = run("arrays", [&]() {
+    return WaypointGenerator::GenerateAllArrays(*map, distance).size();
+  });
+  std::cout << "  " << count << " waypoints" << std::endl;
+  ASSERT_EQ(count, expected);
+}
+
+/// Vehicle driving along a straight road of MakeTown, weaving across the
+/// lanes and off the road.
+struct WeavingVehicle {
+  const RoadSegment *road;
+  double speed;
+  double phase;
+
+  /// Corners of the vehicle at @a step.
+  std::array<Location, 4u> GetCorners(const size_t step) const {
+    const double s = 12.0 + std::fmod(speed * step, 36.0);
+    const double offset = 4.5 * std::sin(phase + 0.2 * step);
+    std::array<Location, 4u> result;
+    auto it = result.begin();
+    for (double ds : {-2.0, 2.0}) {
+      for (double dl : {-0.9, 0.9}) {
+        auto point = road->GetDirectedPointIn(s + ds);
+        point.ApplyLateralOffset(offset + dl);
+        *it++ = point.location;
+      }
+    }
+    return result;
+  }
+};
+
+static std::vector<WeavingVehicle> MakeWeavingVehicles(const Map &map, const size_t count) {
+  std::vector<const RoadSegment *> roads;
+  for (auto &&road : map.GetData().GetRoadSegments()) {
+    if (road.GetLength() > 50.0) {
+      roads.push_back(&road);
+    }
+  }
+  std::mt19937_64 rng(7);
+  std::uniform_int_distribution<size_t> road(0u, roads.size() - 1u);
+  std::uniform_real_distribution<double> speed(0.1, 1.0);
+  std::uniform_real_distribution<double> phase(0.0, 2.0 * Math::pi());
+  std::vector<WeavingVehicle> result;
+  for (auto i = 0u; i < count; ++i) {
+    result.push_back(WeavingVehicle{roads[road(rng)], speed(rng), phase(rng)});
+  }
+  return result;
+}
+
+TEST(road, lane_crossing_tracker) {
+  auto map = MakeTown(4);
+  size_t crossings = 0u;
+  size_t hits = 0u;
+  for (auto &&vehicle : MakeWeavingVehicles(*map, 10u)) {
+    std::array<LaneCrossingTracker, 4u> trackers;
+    auto previous = vehicle.GetCorners(0u);
+    std::vector<LaneMarking> crossed;
+    for (auto &tracker : trackers) {
+      tracker.Move(*map, previous[&tracker - trackers.data()], crossed);
+    }
+    ASSERT_TRUE(crossed.empty());
+    for (auto step = 1u; step < 200u; ++step) {
+      const auto corners = vehicle.GetCorners(step);
+      for (auto i = 0u; i < corners.size(); ++i) {
+        const auto expected = map->CalculateCrossedLanes(previous[i], corners[i]);
+        crossed.clear();
+        map->CalculateCrossedLanes(trackers[i], corners[i], crossed);
+        ASSERT_EQ(crossed, expected) << "step " << step << ", corner " << i;
+        crossings += crossed.size();
+      }
+      previous = corners;
+    }
+    for (auto &tracker : trackers) {
+      hits += tracker.GetHitCount();
+    }
+  }
+  ASSERT_GT(crossings, 0u);
+  ASSERT_GT(hits, 0u);
+}
+
+TEST(road, benchmark_lane_detectors) {
+  constexpr size_t detector_count = 200u;
+  constexpr size_t steps = 100u;
+  auto map = MakeTown(20);
+  const auto vehicles = MakeWeavingVehicles(*map, detector_count);
+
+  auto run = [&](const char *name, auto &&move) {
+    size_t crossings = 0u;
+    carla::StopWatch stop_watch;
+    for (auto step = 1u; step < steps; ++step) {
+      for (auto i = 0u; i < vehicles.size(); ++i) {
+        crossings += move(i, vehicles[i].GetCorners(step - 1u), vehicles[i].GetCorners(step));
+      }
+    }
+    stop_watch.Stop();
+    std::cout << "  " << name << ": "
+              << static_cast<double>(stop_watch.GetElapsedTime<std::chrono::microseconds>()) /
+                 (detector_count * (steps - 1u))
+              << " us per detector and tick (" << crossings << " crossings)" << std::endl;
+    return crossings;
+  };
+
+  std::cout << detector_count << " lane detectors, " << steps << " ticks" << std::endl;
+  const auto expected = run("origin and destination", [&](size_t, const auto &from, const auto &to) {
+    size_t crossings = 0u;
+    for (auto i = 0u; i < from.size(); ++i) {
+      crossings += map->CalculateCrossedLanes(from[i], to[i]).size();
+    }
+    return crossings;
+  });
+
+  std::vector<std::array<LaneCrossingTracker, 4u>> trackers(vehicles.size());
+  std::vector<LaneMarking> crossed;
+  for (auto i = 0u; i < vehicles.size(); ++i) {
+    const auto corners = vehicles[i].GetCorners(0u);
+    for (auto j = 0u; j < corners.size(); ++j) {
+      trackers[i][j].Move(*map, corners[j], crossed);
+    }
+  }
+  const auto crossings = run("tracker", [&](size_t index, const auto &, const auto &to) {
+    crossed.clear();
+    for (auto i = 0u; i < to.size(); ++i) {
+      map->CalculateCrossedLanes(trackers[index][i], to[i], crossed);
+    }
+    return crossed.size();
+  });
+
+  size_t hits = 0u;
+  size_t misses = 0u;
+  for (auto &&vehicle_trackers : trackers) {
+    for (auto &&tracker : vehicle_trackers) {
+      hits += tracker.GetHitCount();
+      misses += tracker.GetMissCount();
+    }
+  }
+  std::cout << "  " << hits << " hits, " << misses << " misses" << std::endl;
+  ASSERT_EQ(crossings, expected);
+}
+
+/// The signal GetNextSignal should find, scanning all the signals.
+static const Signal *FindNextSignalBruteForce(
+    const MapData &data,
+    const id_type road_id,
+    const int lane_id,
+    const double s) {
+  const Signal *result = nullptr;
+  for (auto &&signal : data.GetSignals()) {
+    if ((signal.road_id != road_id) || !signal.IsValidFor(lane_id)) {
+      continue;
+    }
+    if ((lane_id < 0) && (signal.s >= s) && ((result == nullptr) || (signal.s < result->s))) {
+      result = &signal;
+    } else if ((lane_id > 0) && (signal.s <= s) && ((result == nullptr) || (signal.s >= result->s))) {
+      result = &signal;
+    }
+  }
+  return result;
+}
+
+TEST(road, benchmark_signal_index) {
+  constexpr int road_count = 1000;
+  constexpr double length = 100.0;
+  constexpr size_t queries = 1000000u;
+  MapBuilder builder;
+  std::mt19937_64 rng(11);
+  std::uniform_real_distribution<double> position(0.0, length);
+  for (int i = 0; i < road_count; ++i) {
+    RoadSegmentDefinition def(i);
+    def.MakeGeometry<GeometryLine>(0.0, length, 0.0, Location(0.0, 10.0 * i, 0.0));
+    AddDrivingLanes(def);
+    builder.AddRoadSegmentDefinition(def);
+    for (int j = 0; j < 4; ++j) {
+      Signal signal;
+      signal.id = 4 * i + j;
+      signal.road_id = i;
+      signal.s = position(rng);
+      signal.orientation = static_cast<SignalOrientation>(j % 3);
+      if (j == 3) {
+        signal.validity.emplace_back(-1, -1);
+      }
+      builder.AddSignal(signal);
+    }
+  }
+  auto map = builder.Build();
+  const auto &data = map->GetData();
+  ASSERT_EQ(data.GetSignals().size(), 4u * road_count);
+
+  struct Query {
+    id_type road_id;
+    int lane_id;
+    double s;
+  };
+  std::uniform_int_distribution<id_type> road(0u, road_count - 1u);
+  std::vector<Query> input(queries);
+  for (auto &query : input) {
+    query = Query{road(rng), (rng() % 2u) == 0u ? -1 : 1, position(rng)};
+  }
+  for (auto i = 0u; i < 1000u; ++i) {
+    const auto &query = input[i];
+    ASSERT_EQ(
+        data.GetNextSignal(query.road_id, query.lane_id, query.s),
+        FindNextSignalBruteForce(data, query.road_id, query.lane_id, query.s));
+  }
+
+  int sum = 0;
+  carla::StopWatch stop_watch;
+  for (auto &&query : input) {
+    const auto *signal = data.GetNextSignal(query.road_id, query.lane_id, query.s);
+    sum += signal != nullptr ? signal->id : 0;
+  }
+  stop_watch.Stop();
+  std::cout << queries << " signal queries on " << road_count << " roads: "
+            << static_cast<double>(stop_watch.GetElapsedTime<std::chrono::nanoseconds>()) / queries
+            << " ns per query (" << sum << ")" << std::endl;
+}
@@ -5,13 +5,28 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include "test.h"
+#include "test/util/Allocations.h"
 
+#include <carla/AtomicSharedPtr.h>
+#include <carla/StopWatch.h>
 #include <carla/ThreadGroup.h>
+#include <carla/client/detail/Future.h>
 #include <carla/rpc/Actor.h>
 #include <carla/rpc/Client.h>
+#include <carla/rpc/Command.h>
+#include <carla/rpc/CommandResponse.h>
+#include <carla/rpc/DebugShape.h>
 #include <carla/rpc/Server.h>
 
+#include <boost/asio/io_service.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <string>
 #include <thread>
+#include <tuple>
+#include <vector>
 
 using namespace carla::rpc;
 
@@ -75,3 +90,463 @@ TEST(rpc, msgpack) {
   ASSERT_EQ(result.description.id, actor.description.id);
   ASSERT_EQ(result.bounding_box, actor.bounding_box);
 }
+
+TEST(rpc, msgpack_command) {
+  namespace c = carla;
+  namespace cg = carla::geom;
+  ActorDescription description;
+  description.id = "vehicle.random.whatever";
+  const cg::Transform transform{cg::Location{1.0f, 2.0f, 3.0f}, cg::Rotation{4.0f, 5.0f, 6.0f}};
+  std::vector<Command> commands = {
+    Command::SpawnActor{description, transform},
+    Command::ApplyVehicleControl{42u, VehicleControl{1.0f, -0.5f, 0.0f, false, true}},
+    Command::SetAutopilot{43u, true},
+    Command::DestroyActor{44u}};
+
+  auto buffer = c::MsgPack::Pack(commands);
+  auto result = c::MsgPack::UnPack<std::vector<Command>>(buffer);
+
+  ASSERT_EQ(result.size(), commands.size());
+  for (auto i = 0u; i < result.size(); ++i) {
+    ASSERT_EQ(result[i].command.GetIndex(), commands[i].command.GetIndex());
+  }
+  size_t visited = 0u;
+  result[0u].command.ApplyVisitor([&](const auto &item) { ++visited; (void) item; });
+  ASSERT_EQ(visited, 1u);
+  struct Checker {
+    const cg::Transform &transform;
+    void operator()(const Command::SpawnActor &command) const {
+      EXPECT_EQ(command.description.id, "vehicle.random.whatever");
+      EXPECT_EQ(command.transform, transform);
+    }
+    void operator()(const Command::ApplyVehicleControl &command) const {
+      EXPECT_EQ(command.actor, 42u);
+      EXPECT_EQ(command.control, (VehicleControl{1.0f, -0.5f, 0.0f, false, true}));
+    }
+    void operator()(const Command::SetAutopilot &command) const {
+      EXPECT_EQ(command.actor, 43u);
+      EXPECT_TRUE(command.enabled);
+    }
+    void operator()(const Command::DestroyActor &command) const {
+      EXPECT_EQ(command.actor, 44u);
+    }
+    void operator()(const Command::ApplyTransform &) const {
+      ADD_FAILURE();
+    }
+  };
+  for (auto &&command : result) {
+    command.command.ApplyVisitor(Checker{transform});
+  }
+
+  // Only the active command is packed, [index, value].
+  ::clmdep_msgpack::zone zone;
+  const ::clmdep_msgpack::object destroy(commands[3u].command, zone);
+  ASSERT_EQ(destroy.via.array.size, 2u);
+  ASSERT_EQ(destroy.via.array.ptr[0u].as<size_t>(), 1u);
+  ASSERT_EQ(destroy.via.array.ptr[1u].via.array.size, 1u);
+}
+
+TEST(rpc, msgpack_debug_shape) {
+  namespace c = carla;
+  namespace cg = carla::geom;
+  const cg::Location begin{1.0f, 2.0f, 3.0f};
+  const cg::Location end{4.0f, 5.0f, 6.0f};
+  DebugShape shape;
+  shape.primitive = DebugShape::Line{begin, end, 0.5f};
+  shape.life_time = 2.0f;
+
+  struct Checker {
+    const cg::Location &begin;
+    const cg::Location &end;
+    void operator()(const DebugShape::Line &line) const {
+      EXPECT_EQ(line.begin, begin);
+      EXPECT_EQ(line.end, end);
+      EXPECT_EQ(line.thickness, 0.5f);
+    }
+    void operator()(const DebugShape::Point &) const { ADD_FAILURE(); }
+    void operator()(const DebugShape::Arrow &) const { ADD_FAILURE(); }
+    void operator()(const DebugShape::Box &) const { ADD_FAILURE(); }
+    void operator()(const DebugShape::String &) const { ADD_FAILURE(); }
+  };
+  auto check = [&](const DebugShape &result) {
+    ASSERT_EQ(result.primitive.GetIndex(), 1u);
+    result.primitive.ApplyVisitor(Checker{begin, end});
+    ASSERT_EQ(result.life_time, 2.0f);
+  };
+
+  check(c::MsgPack::UnPack<DebugShape>(c::MsgPack::Pack(shape)));
+
+  // As rpclib converts the result of a bound function.
+  ::clmdep_msgpack::zone zone;
+  check(::clmdep_msgpack::object(shape, zone).as<DebugShape>());
+
+  // The primitive keeps its encoding, [index, tuple of every alternative].
+  const ::clmdep_msgpack::object primitive(shape.primitive, zone);
+  ASSERT_EQ(primitive.via.array.size, 2u);
+  ASSERT_EQ(primitive.via.array.ptr[1u].via.array.size, 5u);
+}
+
+/// Stand-in for the simulator, only knows how to control vehicles.
+class StandInSimulator {
+public:
+
+  explicit StandInSimulator(size_t number_of_vehicles)
+    : _controls(number_of_vehicles) {}
+
+  const std::vector<VehicleControl> &GetControls() const {
+    return _controls;
+  }
+
+  CommandResponse Execute(const Command::ApplyVehicleControl &command) {
+    if (command.actor >= _controls.size()) {
+      return CommandResponse::Error("unable to apply control: vehicle not found");
+    }
+    _controls[command.actor] = command.control;
+    return CommandResponse{command.actor};
+  }
+
+  template <typename CommandT>
+  CommandResponse Execute(const CommandT &) {
+    return CommandResponse::Error("not supported");
+  }
+
+  std::vector<CommandResponse> ExecuteBatch(const std::vector<Command> &commands) {
+    std::vector<CommandResponse> responses;
+    responses.reserve(commands.size());
+    for (auto &&command : commands) {
+      command.command.ApplyVisitor([&](const auto &item) {
+        responses.emplace_back(Execute(item));
+      });
+    }
+    return responses;
+  }
+
+private:
+
+  std::vector<VehicleControl> _controls;
+};
+
+TEST(rpc, apply_batch) {
+  constexpr actor_id_type number_of_vehicles = 500u;
+
+  // Only accessed from the game thread.
+  StandInSimulator simulator(number_of_vehicles);
+
+  Server server(TESTING_PORT);
+  server.BindSync("apply_control_to_actor", [&](actor_id_type id, VehicleControl control) {
+    simulator.Execute(Command::ApplyVehicleControl{id, control});
+  });
+  server.BindSync("apply_batch", [&](const std::vector<Command> &commands) {
+    return simulator.ExecuteBatch(commands);
+  });
+  server.BindSync("get_controls", [&]() {
+    return simulator.GetControls();
+  });
+  server.AsyncRun(1u);
+
+  std::atomic_bool done{false};
+
+  carla::ThreadGroup threads;
+  threads.CreateThread([&]() {
+    Client client("localhost", TESTING_PORT);
+
+    const VehicleControl first{1.0f, 0.0f, 0.0f, false, false};
+    for (auto id = 0u; id < number_of_vehicles; ++id) {
+      client.call("apply_control_to_actor", id, first);
+    }
+    EXPECT_EQ(client.call("get_controls").as<std::vector<VehicleControl>>().back(), first);
+
+    const VehicleControl second{0.5f, 0.2f, 0.0f, false, false};
+    std::vector<Command> commands;
+    commands.reserve(number_of_vehicles + 1u);
+    for (auto id = 0u; id < number_of_vehicles; ++id) {
+      commands.emplace_back(Command::ApplyVehicleControl{id, second});
+    }
+    commands.emplace_back(Command::ApplyVehicleControl{number_of_vehicles, second});
+    const auto responses =
+        client.call("apply_batch", commands).as<std::vector<CommandResponse>>();
+
+    EXPECT_EQ(responses.size(), commands.size());
+    for (auto id = 0u; id < number_of_vehicles; ++id) {
+      EXPECT_FALSE(responses[id].HasError());
+      EXPECT_EQ(responses[id].actor, id);
+    }
+    EXPECT_TRUE(responses.back().HasError());
+
+    // Fire and forget, the calls of a client are executed in order.
+    const VehicleControl third{0.0f, 0.0f, 1.0f, true, false};
+    for (auto &command : commands) {
+      command = Command::ApplyVehicleControl{0u, third};
+    }
+    client.async_call("apply_batch", commands);
+    const auto controls = client.call("get_controls").as<std::vector<VehicleControl>>();
+    EXPECT_EQ(controls.front(), third);
+    EXPECT_EQ(controls.back(), second);
+    done = true;
+  });
+
+  for (auto i = 0u; i < 1'000'000u; ++i) {
+    server.SyncRunFor(2ms);
+    if (done) {
+      break;
+    }
+  }
+  ASSERT_TRUE(done);
+}
+
+TEST(rpc, pipelined_calls) {
+  using carla::client::detail::Future;
+  using carla::client::detail::WaitAll;
+  constexpr int number_of_queries = 8;
+
+  Server server(TESTING_PORT);
+  server.BindSync("square", [](int x) { return x * x; });
+  server.AsyncRun(1u);
+
+  std::atomic_bool done{false};
+
+  carla::ThreadGroup threads;
+  threads.CreateThread([&]() {
+    Client client("localhost", TESTING_PORT);
+    EXPECT_EQ(client.call("square", 2).as<int>(), 4);
+
+    auto square_async = [&](int x) {
+      auto future = client.async_call("square", x).share();
+      return Future<int>{
+        [future](carla::time_duration timeout) {
+          return future.wait_for(timeout.to_chrono()) == std::future_status::ready;
+        },
+        [future]() { return future.get().get().as<int>(); }};
+    };
+
+    std::vector<Future<int>> futures;
+    for (auto i = 0; i < number_of_queries; ++i) {
+      futures.emplace_back(square_async(i));
+    }
+    const auto results = WaitAll(futures);
+
+    ASSERT_EQ(results.size(), futures.size());
+    for (auto i = 0; i < number_of_queries; ++i) {
+      EXPECT_TRUE(futures[i].IsReady());
+      EXPECT_EQ(results[i], i * i);
+    }
+
+    const auto mixed = WaitAll(
+        square_async(3),
+        square_async(4).Then([](int x) { return std::to_string(x); }));
+    EXPECT_EQ(std::get<0>(mixed), 9);
+    EXPECT_EQ(std::get<1>(mixed), "16");
+    done = true;
+  });
+
+  // Emulate a game thread that serves the calls once per tick.
+  for (auto i = 0u; (i < 1000u) && !done; ++i) {
+    server.SyncRunFor(1ms);
+    std::this_thread::sleep_for(10ms);
+  }
+  ASSERT_TRUE(done);
+}
+
+TEST(rpc, read_only_calls) {
+  constexpr size_t number_of_clients = 8u;
+  constexpr size_t read_only_calls = 200u;
+  constexpr size_t sync_calls = 10u;
+
+  using snapshot_type = std::vector<int>;
+  auto make_snapshot = [](int value) {
+    return std::make_shared<const snapshot_type>(64u, value);
+  };
+
+  // Published by the game thread at every tick.
+  carla::AtomicSharedPtr<const snapshot_type> snapshot{make_snapshot(0)};
+  // Only accessed from the game thread.
+  int game_state = 0;
+
+  Server server(TESTING_PORT);
+  server.BindReadOnly("read_snapshot", [&]() -> snapshot_type {
+    return *snapshot.load();
+  });
+  server.BindSync("read_game_state", [&]() {
+    return game_state;
+  });
+  server.AsyncRun(number_of_clients);
+
+  std::atomic_bool consistent{true};
+
+  // Run @a number_of_clients clients that call @a function @a calls times
+  // each, while the main thread emulates a game thread that serves the
+  // synchronous calls once per tick.
+  auto run_clients = [&](const std::string &function, size_t calls) {
+    std::atomic_size_t done{0u};
+    carla::ThreadGroup clients;
+    clients.CreateThreads(number_of_clients, [&]() {
+      Client client("localhost", TESTING_PORT);
+      for (auto i = 0u; i < calls; ++i) {
+        auto result = client.call(function);
+        if (function == "read_snapshot") {
+          const auto data = result.as<snapshot_type>();
+          if (std::adjacent_find(data.begin(), data.end(), std::not_equal_to<int>()) != data.end()) {
+            consistent = false;
+          }
+        } else {
+          result.as<int>();
+        }
+      }
+      ++done;
+    });
+    for (auto i = 0u; (i < 10'000u) && (done < number_of_clients); ++i) {
+      ++game_state;
+      snapshot = make_snapshot(game_state);
+      server.SyncRunFor(1ms);
+      std::this_thread::sleep_for(10ms);
+    }
+    clients.JoinAll();
+    EXPECT_EQ(done.load(), number_of_clients);
+  };
+
+  run_clients("read_snapshot", read_only_calls);
+  run_clients("read_game_state", sync_calls);
+
+  EXPECT_TRUE(consistent);
+
+  const auto metrics = server.GetMetrics();
+  ASSERT_EQ(metrics.size(), 2u);
+  const auto &read_only = metrics.at("read_snapshot");
+  const auto &sync = metrics.at("read_game_state");
+  EXPECT_EQ(read_only.calls, number_of_clients * read_only_calls);
+  EXPECT_EQ(read_only.max_queued, 0u);
+  EXPECT_EQ(sync.calls, number_of_clients * sync_calls);
+  EXPECT_GE(sync.max_queued, 1u);
+  EXPECT_EQ(sync.queued, 0u);
+  EXPECT_EQ(server.GetSyncQueueDepth(), 0u);
+  EXPECT_LE(sync.total_queue_time, sync.total_latency);
+}
+
+TEST(rpc, sync_call_queue) {
+  using namespace carla::rpc::detail;
+  constexpr auto number_of_calls = 1000u;
+  SyncCallQueue queue;
+  HandlerMetrics metrics;
+  auto twice = WrapSyncCall(queue, metrics, [](int x) { return 2 * x; });
+  auto fail = WrapSyncCall(queue, metrics, []() { throw std::runtime_error("failed"); });
+  auto nothing = WrapSyncCall(queue, metrics, []() {});
+
+  std::atomic_bool done{false};
+  size_t allocations = 0u;
+  carla::ThreadGroup threads;
+  threads.CreateThread([&]() {
+    EXPECT_EQ(twice(21), 42);
+    EXPECT_THROW(fail(), std::runtime_error);
+    nothing();
+    util::allocations::enable_counting();
+    const auto allocations_before = util::allocations::count();
+    for (auto i = 0u; i < number_of_calls; ++i) {
+      twice(static_cast<int>(i));
+    }
+    allocations = util::allocations::count() - allocations_before;
+    util::allocations::enable_counting(false);
+    done = true;
+  });
+  util::allocations::enable_counting();
+  for (auto i = 0u; (i < 10'000'000u) && !done; ++i) {
+    // A zero budget still runs one call.
+    queue.RunFor(0ms);
+  }
+  util::allocations::enable_counting(false);
+  threads.JoinAll();
+  ASSERT_TRUE(done);
+  EXPECT_EQ(allocations, 0u);
+  const auto stats = metrics.GetStats();
+  EXPECT_EQ(stats.calls, number_of_calls + 3u);
+  EXPECT_EQ(stats.queued, 0u);
+}
+
+/// Dispatch used by Server::BindSync before the SyncCallQueue, to compare
+/// against.
+template <typename F>
+static auto LegacyWrapSyncCall(boost::asio::io_service &io, F functor) {
+  return std::function<int(int)>([&io, functor=std::move(functor)](int x) {
+    std::packaged_task<int()> task([functor=std::move(functor), x]() {
+      return functor(x);
+    });
+    auto result = task.get_future();
+    io.post([&]() mutable { task(); });
+    return result.get();
+  });
+}
+
+/// Calls @a call from several threads while the main thread runs
+/// @a run_some, prints calls per second and latency percentiles.
+template <typename CallF, typename RunF>
+static void BenchmarkSyncDispatch(const char *name, CallF &&call, RunF &&run_some) {
+  using clock = std::chrono::steady_clock;
+  constexpr size_t number_of_threads = 4u;
+  constexpr size_t calls_per_thread = 20'000u;
+
+  std::vector<std::vector<double>> latencies(number_of_threads);
+  std::atomic_size_t done{0u};
+  std::atomic_size_t errors{0u};
+
+  carla::StopWatch stop_watch;
+  {
+    carla::ThreadGroup threads;
+    for (auto t = 0u; t < number_of_threads; ++t) {
+      latencies[t].resize(calls_per_thread);
+      threads.CreateThread([&, t]() {
+        for (auto i = 0u; i < calls_per_thread; ++i) {
+          const auto start = clock::now();
+          const int x = static_cast<int>(i);
+          if (call(x) != 2 * x) {
+            ++errors;
+          }
+          latencies[t][i] = std::chrono::duration<double, std::micro>(clock::now() - start).count();
+        }
+        ++done;
+      });
+    }
+    while (done < number_of_threads) {
+      run_some();
+    }
+  }
+  stop_watch.Stop();
+  ASSERT_EQ(errors.load(), 0u);
+
+  std::vector<double> all;
+  all.reserve(number_of_threads * calls_per_thread);
+  for (auto &&item : latencies) {
+    all.insert(all.end(), item.begin(), item.end());
+  }
+  auto percentile = [&](double p) {
+    auto it = all.begin() + static_cast<long>(p * (all.size() - 1u));
+    std::nth_element(all.begin(), it, all.end());
+    return *it;
+  };
+  const auto seconds = stop_watch.GetElapsedTime<std::chrono::microseconds>() * 1e-6;
+  std::cout << name << ": " << static_cast<size_t>(all.size() / seconds)
+            << " calls/s, p50 " << percentile(0.5)
+            << " us, p99 " << percentile(0.99) << " us" << std::endl;
+}
+
+TEST(rpc, benchmark_sync_dispatch) {
+  auto functor = [](int x) { return 2 * x; };
+
+  {
+    boost::asio::io_service io;
+    auto call = LegacyWrapSyncCall(io, functor);
+    BenchmarkSyncDispatch("io_service + packaged_task", call, [&]() {
+      io.reset();
+      io.run_for(1ms);
+    });
+  }
+
+  {
+    using namespace carla::rpc::detail;
+    SyncCallQueue queue;
+    HandlerMetrics metrics;
+    auto call = WrapSyncCall(queue, metrics, functor);
+    BenchmarkSyncDispatch("SyncCallQueue", call, [&]() {
+      queue.RunFor(1ms);
+    });
+    EXPECT_EQ(metrics.GetStats().calls, 4u * 20'000u);
+  }
+}
@@ -5,17 +5,29 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include "test.h"
+#include "test/util/Allocations.h"
 
 #include <carla/ThreadGroup.h>
 #include <carla/streaming/Client.h>
 #include <carla/streaming/Server.h>
 #include <carla/streaming/detail/Dispatcher.h>
+#include <carla/streaming/detail/shm/Ring.h>
 #include <carla/streaming/detail/tcp/Client.h>
 #include <carla/streaming/detail/tcp/Server.h>
 #include <carla/streaming/low_level/Client.h>
 #include <carla/streaming/low_level/Server.h>
 
+#include <boost/asio/write.hpp>
+
 #include <atomic>
+#include <cstring>
+#include <mutex>
+
+#ifdef __linux__
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif // __linux__
 
 // This is required for low level to properly stop the threads in case of
 // exception/assert.
@@ -253,3 +265,404 @@ TEST(streaming, multi_stream) {
     }
   }
 }
+
+TEST(streaming, send_queue_absorbs_burst) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  constexpr size_t number_of_bursts = 10u;
+  constexpr size_t burst_size = 3u;
+  const std::string message = "Hello client!";
+
+  Server srv(TESTING_PORT);
+  srv.SetSendQueue(SendQueuePolicy::DropOldest, burst_size);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+
+  std::atomic_size_t message_count{0u};
+
+  Client c;
+  c.AsyncRun(2u);
+  c.Subscribe(stream.token(), [&](auto buffer) {
+    const std::string result = as_string(buffer);
+    ASSERT_EQ(result, message);
+    ++message_count;
+  });
+
+  std::this_thread::sleep_for(20ms);
+  for (auto i = 0u; i < number_of_bursts; ++i) {
+    for (auto j = 0u; j < burst_size; ++j) {
+      stream << message;
+    }
+    std::this_thread::sleep_for(10ms);
+  }
+  std::this_thread::sleep_for(20ms);
+
+  ASSERT_EQ(message_count, number_of_bursts * burst_size);
+  const auto stats = srv.GetSendQueueStatistics();
+  ASSERT_EQ(stats.dropped, 0u);
+  ASSERT_EQ(stats.sent, number_of_bursts * burst_size);
+}
+
+TEST(streaming, send_queue_policies) {
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  constexpr size_t number_of_messages = 32u;
+  constexpr uint32_t queue_size = 2u;
+
+  // A message big enough to fill the socket buffers of a client that never
+  // reads.
+  auto message = tcp::ServerSession::MakeMessage(carla::Buffer(std::vector<uint32_t>(1024u * 1024u, 42u)));
+
+  for (auto policy : {
+      SendQueuePolicy::KeepLatest,
+      SendQueuePolicy::DropOldest,
+      SendQueuePolicy::BlockProducer,
+      SendQueuePolicy::ReplaceNewest}) {
+    io_service_running io;
+
+    tcp::Server srv(io.service, tcp::Server::endpoint(boost::asio::ip::tcp::v4(), TESTING_PORT));
+    srv.SetTimeout(200ms);
+    srv.SetSendQueue(SendQueueSettings{policy, queue_size});
+
+    std::atomic_bool done{false};
+    std::atomic_bool closed{false};
+    srv.Listen([&](std::shared_ptr<tcp::ServerSession> session) {
+      for (auto i = 0u; i < number_of_messages; ++i) {
+        session->Write(message);
+      }
+      done = true;
+    }, [&](std::shared_ptr<tcp::ServerSession>) { closed = true; });
+
+    // Connect a client that never reads.
+    boost::asio::ip::tcp::socket socket(io.service);
+    socket.connect(tcp::Server::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), TESTING_PORT));
+    const stream_id_type stream_id = 1u;
+    boost::asio::write(socket, boost::asio::buffer(&stream_id, sizeof(stream_id)));
+
+    // Wait for the session to time-out before tearing down the io_service.
+    for (auto i = 0u; (i < 500u) && !(done && closed); ++i) {
+      std::this_thread::sleep_for(10ms);
+    }
+    ASSERT_TRUE(done);
+    ASSERT_TRUE(closed);
+
+    const auto stats = srv.GetSendQueueStatistics();
+    ASSERT_GT(stats.dropped, 0u);
+    ASSERT_EQ(stats.sent + stats.dropped, number_of_messages);
+    if (policy == SendQueuePolicy::BlockProducer) {
+      // The producer was throttled, the rest was discarded.
+      ASSERT_LT(stats.queued, number_of_messages);
+    } else {
+      ASSERT_EQ(stats.queued, number_of_messages);
+    }
+  }
+}
+
+TEST(streaming, session_handshake_timeout) {
+  using namespace carla::streaming::detail;
+  io_service_running io;
+
+  tcp::Server srv(io.service, tcp::Server::endpoint(boost::asio::ip::tcp::v4(), TESTING_PORT));
+  srv.SetTimeout(200ms);
+  std::atomic_bool opened{false};
+  srv.Listen(
+      [&](std::shared_ptr<tcp::ServerSession>) { opened = true; },
+      [](std::shared_ptr<tcp::ServerSession>) {});
+
+  // Connect a client that never sends its stream id, the session closes the
+  // connection when the time-out expires.
+  boost::asio::ip::tcp::socket socket(io.service);
+  socket.connect(tcp::Server::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), TESTING_PORT));
+  char data;
+  boost::system::error_code ec;
+  socket.read_some(boost::asio::buffer(&data, 1u), ec);
+  ASSERT_TRUE(ec);
+  ASSERT_FALSE(opened);
+}
+
+TEST(streaming, session_idle_timeout) {
+  using namespace carla::streaming::detail;
+  io_service_running io;
+
+  tcp::Server srv(io.service, tcp::Server::endpoint(boost::asio::ip::tcp::v4(), TESTING_PORT));
+  srv.SetTimeout(200ms);
+  std::atomic_bool opened{false};
+  std::atomic_bool closed{false};
+  srv.Listen(
+      [&](std::shared_ptr<tcp::ServerSession>) { opened = true; },
+      [&](std::shared_ptr<tcp::ServerSession>) { closed = true; });
+
+  // Nothing is ever written to the session, it closes the connection when the
+  // time-out expires.
+  boost::asio::ip::tcp::socket socket(io.service);
+  socket.connect(tcp::Server::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), TESTING_PORT));
+  const stream_id_type stream_id = 1u;
+  boost::asio::write(socket, boost::asio::buffer(&stream_id, sizeof(stream_id)));
+  char data;
+  boost::system::error_code ec;
+  socket.read_some(boost::asio::buffer(&data, 1u), ec);
+  ASSERT_TRUE(ec);
+  ASSERT_TRUE(opened);
+  for (auto i = 0u; (i < 100u) && !closed; ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  ASSERT_TRUE(closed);
+}
+
+TEST(streaming, send_queue_block_producer_deadline) {
+  using namespace carla::streaming::detail;
+  using clock_type = tcp::ServerSession::clock_type;
+  auto message = tcp::ServerSession::MakeMessage(carla::Buffer(std::vector<uint32_t>(1024u * 1024u, 42u)));
+
+  io_service_running io;
+  tcp::Server srv(io.service, tcp::Server::endpoint(boost::asio::ip::tcp::v4(), TESTING_PORT));
+  srv.SetTimeout(10s);
+  srv.SetSendQueue(SendQueueSettings{SendQueuePolicy::BlockProducer, 2u});
+  std::mutex mutex;
+  std::shared_ptr<tcp::ServerSession> session;
+  std::atomic_bool closed{false};
+  srv.Listen([&](std::shared_ptr<tcp::ServerSession> s) {
+    std::lock_guard<std::mutex> lock(mutex);
+    session = s;
+  }, [&](std::shared_ptr<tcp::ServerSession>) { closed = true; });
+
+  // Connect a client that never reads.
+  boost::asio::ip::tcp::socket socket(io.service);
+  socket.connect(tcp::Server::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), TESTING_PORT));
+  const stream_id_type stream_id = 1u;
+  boost::asio::write(socket, boost::asio::buffer(&stream_id, sizeof(stream_id)));
+  for (auto i = 0u; i < 100u; ++i) {
+    std::this_thread::sleep_for(10ms);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (session != nullptr) {
+      break;
+    }
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_NE(session, nullptr);
+
+  // One message being written and two queued.
+  for (auto i = 0u; i < 3u; ++i) {
+    session->Write(message);
+  }
+  std::this_thread::sleep_for(50ms);
+
+  // The queue is full, the producer waits until the deadline given instead
+  // of the session time-out.
+  const auto begin = clock_type::now();
+  session->Write(message, begin + 100ms);
+  const auto elapsed = clock_type::now() - begin;
+  ASSERT_GE(elapsed, 100ms);
+  ASSERT_LT(elapsed, 5s);
+  ASSERT_EQ(srv.GetSendQueueStatistics().dropped, 1u);
+
+  session->Close();
+  for (auto i = 0u; (i < 100u) && !closed; ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  ASSERT_TRUE(closed);
+  session = nullptr;
+}
+
+TEST(streaming, shared_memory_ring) {
+  using namespace carla::streaming::detail;
+  using namespace util::buffer;
+  if (!shm::Ring::IsSupported()) {
+    return;
+  }
+  constexpr size_t number_of_slots = 4u;
+  const auto name = shm::Ring::MakeName("test-ring");
+  auto producer = shm::Ring::Create(name, number_of_slots, 1024u);
+  ASSERT_NE(producer, nullptr);
+  auto consumer = shm::Ring::Open(name);
+  ASSERT_NE(consumer, nullptr);
+  ASSERT_EQ(consumer->slot_size(), 1024u);
+
+  carla::Buffer buffer;
+  size_t dropped = 0u;
+  ASSERT_EQ(consumer->Read(buffer, 1ms, dropped), shm::Ring::ReadResult::Timeout);
+
+  auto write = [&](const std::string &str) {
+    return producer->Write(std::array<boost::asio::const_buffer, 1u>{boost::asio::buffer(str)});
+  };
+  ASSERT_FALSE(write(std::string(2048u, 'x')));
+
+  // Overwrite the oldest messages.
+  for (auto i = 0u; i < number_of_slots + 2u; ++i) {
+    ASSERT_TRUE(write("message " + std::to_string(i)));
+  }
+  for (auto i = 2u; i < number_of_slots + 2u; ++i) {
+    ASSERT_EQ(consumer->Read(buffer, 1ms, dropped), shm::Ring::ReadResult::Message);
+    ASSERT_EQ(as_string(buffer), "message " + std::to_string(i));
+  }
+  ASSERT_EQ(dropped, 2u);
+
+  // Wake up a sleeping consumer.
+  carla::ThreadGroup threads;
+  threads.CreateThread([&]() {
+    std::this_thread::sleep_for(10ms);
+    write("Hi!");
+    producer->Close();
+  });
+  ASSERT_EQ(consumer->Read(buffer, 1s, dropped), shm::Ring::ReadResult::Message);
+  ASSERT_EQ(as_string(buffer), "Hi!");
+  ASSERT_EQ(consumer->Read(buffer, 1s, dropped), shm::Ring::ReadResult::Closed);
+}
+
+#ifdef __linux__
+TEST(streaming, shared_memory_ring_invalid_header) {
+  using namespace carla::streaming::detail;
+  const auto name = shm::Ring::MakeName("test-invalid-ring");
+  auto producer = shm::Ring::Create(name, 4u, 1024u);
+  ASSERT_NE(producer, nullptr);
+  const int fd = shm_open(name.c_str(), O_RDWR, 0);
+  ASSERT_GE(fd, 0);
+  void *memory = mmap(nullptr, 64u, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  ASSERT_NE(memory, MAP_FAILED);
+  // The header starts with the magic number followed by the number of slots.
+  auto *number_of_slots = reinterpret_cast<uint32_t *>(memory) + 1;
+  ASSERT_EQ(*number_of_slots, 4u);
+  for (uint32_t corrupted : {0u, 3u, 5u, 0xffffffffu}) {
+    *number_of_slots = corrupted;
+    ASSERT_EQ(shm::Ring::Open(name), nullptr);
+  }
+  *number_of_slots = 4u;
+  ASSERT_NE(shm::Ring::Open(name), nullptr);
+  munmap(memory, 64u);
+}
+#endif // __linux__
+
+TEST(streaming, shared_memory_transport) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  // Growing sizes force the server to replace the ring.
+  const std::vector<size_t> sizes = {16u, 1024u, 100u * 1024u, 4u * 1024u * 1024u, 32u};
+
+  // BlockProducer sessions can't use the ring, they answer a request for
+  // shared memory by writing to the socket.
+  const std::pair<bool, SendQueuePolicy> cases[] = {
+    {true, SendQueuePolicy::DropOldest},
+    {false, SendQueuePolicy::DropOldest},
+    {true, SendQueuePolicy::BlockProducer}};
+
+  for (auto &&test_case : cases) {
+    const bool use_shared_memory = test_case.first;
+    Server srv(TESTING_PORT);
+    srv.SetSendQueue(test_case.second, 8u);
+    srv.AsyncRun(2u);
+    auto stream = srv.MakeStream();
+
+    std::mutex mutex;
+    std::vector<std::pair<size_t, uint32_t>> received;
+
+    Client c;
+    c.EnableSharedMemory(use_shared_memory);
+    c.AsyncRun(2u);
+    c.Subscribe(stream.token(), [&](carla::Buffer buffer) {
+      // Over TCP the callbacks may run in parallel, the lock keeps them in
+      // order.
+      std::lock_guard<std::mutex> lock(mutex);
+      ASSERT_GE(buffer.size(), sizeof(uint32_t));
+      uint32_t index;
+      std::memcpy(&index, buffer.data(), sizeof(index));
+      // Every byte after the index carries the index too.
+      for (auto i = sizeof(index); i < buffer.size(); ++i) {
+        ASSERT_EQ(buffer.data()[i], static_cast<unsigned char>(index));
+      }
+      received.emplace_back(buffer.size(), index);
+    });
+
+    std::this_thread::sleep_for(20ms);
+    for (auto i = 0u; i < sizes.size(); ++i) {
+      carla::Buffer buffer(sizes[i]);
+      std::memset(buffer.data(), static_cast<int>(i), buffer.size());
+      const uint32_t index = i;
+      std::memcpy(buffer.data(), &index, sizeof(index));
+      stream.Write(std::move(buffer));
+      std::this_thread::sleep_for(20ms);
+    }
+    for (auto i = 0u; i < 100u; ++i) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (received.size() >= sizes.size()) {
+          break;
+        }
+      }
+      std::this_thread::sleep_for(10ms);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(received.size(), sizes.size());
+    for (auto i = 0u; i < sizes.size(); ++i) {
+      ASSERT_EQ(received[i].first, sizes[i]);
+      ASSERT_EQ(received[i].second, i);
+    }
+  }
+}
+
+TEST(streaming, client_receive_path_does_not_allocate) {
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  constexpr size_t warm_up = 200u;
+  constexpr size_t number_of_messages = 1000u;
+
+  // Messages of two different size classes.
+  const std::array<std::shared_ptr<const tcp::Message>, 2u> messages = {
+      tcp::ServerSession::MakeMessage(carla::Buffer(std::vector<char>(1000u, 'a'))),
+      tcp::ServerSession::MakeMessage(carla::Buffer(std::vector<char>(30000u, 'b')))};
+
+  io_service_running client_io(1u);
+  client_io.service.post([]() { util::allocations::enable_counting(); });
+  io_service_running server_io;
+
+  tcp::Server::endpoint ep(boost::asio::ip::tcp::v4(), TESTING_PORT);
+  tcp::Server srv(server_io.service, ep);
+  srv.SetTimeout(1s);
+  std::shared_ptr<tcp::ServerSession> session;
+  std::mutex mutex;
+  srv.Listen([&](std::shared_ptr<tcp::ServerSession> s) {
+    std::lock_guard<std::mutex> lock(mutex);
+    session = s;
+  }, [](std::shared_ptr<tcp::ServerSession>) {});
+
+  std::atomic_size_t message_count{0u};
+  Dispatcher dispatcher{make_endpoint<tcp::Client::protocol_type>(ep)};
+  auto stream = dispatcher.MakeStream();
+  auto c = std::make_shared<tcp::Client>(client_io.service, stream.token(), [&](carla::Buffer message) {
+    ASSERT_EQ(message.size(), messages[message_count % 2u]->size());
+    ++message_count;
+  });
+  c->EnableSharedMemory(false);
+  c->Connect();
+
+  for (auto i = 0u; i < 100u; ++i) {
+    std::this_thread::sleep_for(10ms);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (session != nullptr) {
+      break;
+    }
+  }
+  ASSERT_NE(session, nullptr);
+
+  // One message at a time, so the callback of the previous message has
+  // returned.
+  auto send = [&](size_t count) {
+    for (auto i = 0u; i < count; ++i) {
+      const auto expected = message_count + 1u;
+      session->Write(messages[message_count % 2u]);
+      for (auto j = 0u; (j < 10000u) && (message_count != expected); ++j) {
+        std::this_thread::sleep_for(100us);
+      }
+      ASSERT_EQ(message_count, expected);
+    }
+  };
+
+  send(warm_up);
+  const size_t allocations_after_warm_up = util::allocations::count();
+  send(number_of_messages);
+  const size_t allocations = util::allocations::count() - allocations_after_warm_up;
+  std::cout << "client allocations after warm-up: " << allocations << std::endl;
+  ASSERT_EQ(allocations, 0u);
+  c->Stop();
+}
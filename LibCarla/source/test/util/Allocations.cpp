@@ -0,0 +1,48 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Allocations.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Count the heap allocations made by the threads that enable it.
+static thread_local bool COUNT_ALLOCATIONS = false;
+static std::atomic_size_t ALLOCATION_COUNT{0u};
+
+void *operator new(std::size_t size) {
+  if (COUNT_ALLOCATIONS) {
+    ++ALLOCATION_COUNT;
+  }
+  void *pointer = std::malloc(size == 0u ? 1u : size);
+  if (pointer == nullptr) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void operator delete(void *pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+namespace util {
+namespace allocations {
+
+  void enable_counting(const bool enable) {
+    COUNT_ALLOCATIONS = enable;
+  }
+
+  size_t count() {
+    return ALLOCATION_COUNT;
+  }
+
+} // namespace allocations
+} // namespace util
@@ -0,0 +1,22 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+
+namespace util {
+namespace allocations {
+
+  /// Count, or stop counting, the heap allocations made by the calling
+  /// thread.
+  void enable_counting(bool enable = true);
+
+  /// Number of heap allocations counted so far, by any thread.
+  size_t count();
+
+} // namespace allocations
+} // namespace util
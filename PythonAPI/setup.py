@@ -33,7 +33,8 @@ def get_libcarla_extensions():
                 os.path.join(pwd, 'dependencies/lib/libcarla_client.a'),
                 os.path.join(pwd, 'dependencies/lib/librpc.a'),
                 os.path.join(pwd, 'dependencies/lib/libboost_filesystem.a'),
-                os.path.join(pwd, 'dependencies/lib', pylib)]
+                os.path.join(pwd, 'dependencies/lib', pylib),
+                '-lrt']
             extra_compile_args = [
                 '-fPIC', '-std=c++14', '-Wno-missing-braces',
                 '-DBOOST_ERROR_CODE_HEADER_ONLY', '-DLIBCARLA_WITH_PYTHON_SUPPORT',
@@ -7,11 +7,40 @@
 #include <carla/PythonUtil.h>
 #include <carla/client/Client.h>
 #include <carla/client/World.h>
+#include <carla/rpc/Command.h>
+#include <carla/rpc/CommandResponse.h>
+
+#include <boost/python/stl_iterator.hpp>
 
 static void SetTimeout(carla::client::Client &client, double seconds) {
   client.SetTimeout(TimeDurationFromSeconds(seconds));
 }
 
+static auto MakeCommandList(const boost::python::object &commands) {
+  using Iterator = boost::python::stl_input_iterator<carla::rpc::Command>;
+  return std::vector<carla::rpc::Command>(Iterator(commands), Iterator());
+}
+
+static void ApplyBatch(const carla::client::Client &self, const boost::python::object &commands) {
+  auto command_list = MakeCommandList(commands);
+  carla::PythonUtil::ReleaseGIL unlock;
+  self.ApplyBatchAsync(std::move(command_list));
+}
+
+static auto ApplyBatchSync(const carla::client::Client &self, const boost::python::object &commands) {
+  auto command_list = MakeCommandList(commands);
+  std::vector<carla::rpc::CommandResponse> responses;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    responses = self.ApplyBatch(std::move(command_list));
+  }
+  boost::python::list result;
+  for (auto &&response : responses) {
+    result.append(std::move(response));
+  }
+  return result;
+}
+
 void export_client() {
   using namespace boost::python;
   namespace cc = carla::client;
@@ -19,8 +48,12 @@ void export_client() {
   class_<cc::Client>("Client",
       init<std::string, uint16_t, size_t>((arg("host"), arg("port"), arg("worker_threads")=0u)))
     .def("set_timeout", &::SetTimeout, (arg("seconds")))
+    .def("set_map_cache_directory", &cc::Client::SetMapCacheDirectory, (arg("path")))
     .def("get_client_version", &cc::Client::GetClientVersion)
     .def("get_server_version", CONST_CALL_WITHOUT_GIL(cc::Client, GetServerVersion))
+    .def("get_server_version_async", CALL_RETURNING_FUTURE(cc::Client, GetServerVersionAsync))
     .def("get_world", &cc::Client::GetWorld)
+    .def("apply_batch", &::ApplyBatch, (arg("commands")))
+    .def("apply_batch_sync", &::ApplyBatchSync, (arg("commands")))
   ;
 }
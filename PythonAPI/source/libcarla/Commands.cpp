@@ -0,0 +1,85 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/client/ActorBlueprint.h>
+#include <carla/rpc/Command.h>
+#include <carla/rpc/CommandResponse.h>
+
+#include <ostream>
+
+namespace carla {
+namespace rpc {
+
+  std::ostream &operator<<(std::ostream &out, const CommandResponse &self) {
+    if (self.HasError()) {
+      out << "CommandResponse(error=" << self.error << ')';
+    } else {
+      out << "CommandResponse(actor_id=" << self.actor << ')';
+    }
+    return out;
+  }
+
+} // namespace rpc
+} // namespace carla
+
+void export_commands() {
+  using namespace boost::python;
+  namespace cc = carla::client;
+  namespace cg = carla::geom;
+  namespace cr = carla::rpc;
+
+  using ActorPtr = carla::SharedPtr<cc::Actor>;
+
+  object command_module(handle<>(borrowed(PyImport_AddModule("libcarla.command"))));
+  scope().attr("command") = command_module;
+  scope submodule_scope = command_module;
+
+  class_<cr::CommandResponse>("Response", no_init)
+    .def_readonly("actor_id", &cr::CommandResponse::actor)
+    .def_readonly("error", &cr::CommandResponse::error)
+    .def("has_error", &cr::CommandResponse::HasError)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::Command::SpawnActor>("SpawnActor")
+    .def("__init__", make_constructor(+[](const cc::ActorBlueprint &blueprint, const cg::Transform &transform) {
+      return boost::make_shared<cr::Command::SpawnActor>(blueprint.MakeActorDescription(), transform);
+    }))
+    .def_readwrite("transform", &cr::Command::SpawnActor::transform)
+  ;
+
+  class_<cr::Command::DestroyActor>("DestroyActor")
+    .def("__init__", make_constructor(+[](const ActorPtr &actor) {
+      return boost::make_shared<cr::Command::DestroyActor>(actor->GetId());
+    }))
+    .def(init<cr::actor_id_type>((arg("actor_id"))))
+    .def_readwrite("actor_id", &cr::Command::DestroyActor::actor)
+  ;
+
+  class_<cr::Command::ApplyVehicleControl>("ApplyVehicleControl")
+    .def(init<cr::actor_id_type, cr::VehicleControl>((arg("actor_id"), arg("control"))))
+    .def_readwrite("actor_id", &cr::Command::ApplyVehicleControl::actor)
+    .def_readwrite("control", &cr::Command::ApplyVehicleControl::control)
+  ;
+
+  class_<cr::Command::ApplyTransform>("ApplyTransform")
+    .def(init<cr::actor_id_type, cg::Transform>((arg("actor_id"), arg("transform"))))
+    .def_readwrite("actor_id", &cr::Command::ApplyTransform::actor)
+    .def_readwrite("transform", &cr::Command::ApplyTransform::transform)
+  ;
+
+  class_<cr::Command::SetAutopilot>("SetAutopilot")
+    .def(init<cr::actor_id_type, bool>((arg("actor_id"), arg("enabled"))))
+    .def_readwrite("actor_id", &cr::Command::SetAutopilot::actor)
+    .def_readwrite("enabled", &cr::Command::SetAutopilot::enabled)
+  ;
+
+  implicitly_convertible<cr::Command::SpawnActor, cr::Command>();
+  implicitly_convertible<cr::Command::DestroyActor, cr::Command>();
+  implicitly_convertible<cr::Command::ApplyVehicleControl, cr::Command>();
+  implicitly_convertible<cr::Command::ApplyTransform, cr::Command>();
+  implicitly_convertible<cr::Command::SetAutopilot, cr::Command>();
+}
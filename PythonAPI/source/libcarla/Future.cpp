@@ -0,0 +1,32 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <boost/python/stl_iterator.hpp>
+
+static boost::python::list WaitAll(const boost::python::object &futures) {
+  namespace py = boost::python;
+  using Iterator = py::stl_input_iterator<py::object>;
+  py::list result;
+  // The queries are already in flight, waiting for each of them in turn costs
+  // about as much as waiting for the slowest one.
+  for (auto it = Iterator(futures); it != Iterator(); ++it) {
+    const PythonFuture &future = py::extract<const PythonFuture &>(*it);
+    result.append(future.Get());
+  }
+  return result;
+}
+
+void export_future() {
+  using namespace boost::python;
+
+  class_<PythonFuture>("Future", no_init)
+    .def("done", &PythonFuture::IsReady)
+    .def("wait", &PythonFuture::WaitFor, (arg("seconds")))
+    .def("result", &PythonFuture::Get)
+  ;
+
+  def("wait_all", &::WaitAll, (arg("futures")));
+}
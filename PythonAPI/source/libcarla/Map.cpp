@@ -8,8 +8,12 @@
 #include <carla/PythonUtil.h>
 #include <carla/client/Map.h>
 #include <carla/client/Waypoint.h>
+#include <carla/road/MapData.h>
 
 #include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace carla {
 namespace client {
@@ -25,6 +29,30 @@ namespace client {
   }
 
 } // namespace client
+
+namespace road {
+namespace element {
+
+  std::ostream &operator<<(std::ostream &out, const Signal &signal) {
+    out << "Signal(id=" << signal.id
+        << ", road_id=" << signal.road_id
+        << ", s=" << signal.s
+        << ", name=" << signal.name
+        << ", is_dynamic=" << (signal.is_dynamic ? "True" : "False") << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const WaypointInfo &info) {
+    out << "WaypointInfo(road_id=" << info.road_id
+        << ", lane_id=" << info.lane_id
+        << ", s=" << info.s
+        << ", transform=" << info.transform
+        << ", is_valid=" << (info.is_valid ? "True" : "False") << ')';
+    return out;
+  }
+
+} // namespace element
+} // namespace road
 } // namespace carla
 
 static void SaveOpenDriveToDisk(const carla::client::Map &self, std::string path) {
@@ -47,17 +75,213 @@ static auto GetTopology(const carla::client::Map &self) {
   return result;
 }
 
+static boost::python::list RouteToList(const carla::client::Map::Route &route) {
+  boost::python::list result;
+  for (auto &&waypoint : route) {
+    result.append(waypoint);
+  }
+  return result;
+}
+
+static auto ComputeRoute(
+    const carla::client::Map &self,
+    const carla::client::Waypoint &origin,
+    const carla::client::Waypoint &destination) {
+  carla::client::Map::Route route;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    route = self.ComputeRoute(origin, destination);
+  }
+  return RouteToList(route);
+}
+
+/// @a pairs is a sequence of (origin, destination) tuples of waypoints.
+static auto ComputeRoutes(const carla::client::Map &self, const boost::python::object &pairs) {
+  namespace py = boost::python;
+  using WaypointPtr = carla::SharedPtr<carla::client::Waypoint>;
+  std::vector<std::pair<WaypointPtr, WaypointPtr>> input;
+  for (auto it = py::stl_input_iterator<py::object>(pairs);
+       it != py::stl_input_iterator<py::object>();
+       ++it) {
+    const py::object pair = *it;
+    WaypointPtr origin = py::extract<WaypointPtr>(pair[0]);
+    WaypointPtr destination = py::extract<WaypointPtr>(pair[1]);
+    if ((origin == nullptr) || (destination == nullptr)) {
+      PyErr_SetString(PyExc_ValueError, "expected pairs of waypoints");
+      py::throw_error_already_set();
+    }
+    input.emplace_back(std::move(origin), std::move(destination));
+  }
+  std::vector<carla::client::Map::Route> routes;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    routes = self.ComputeRoutes(input);
+  }
+  py::list result;
+  for (auto &&route : routes) {
+    result.append(RouteToList(route));
+  }
+  return result;
+}
+
+static auto GetSignals(const carla::client::Map &self) {
+  boost::python::list result;
+  for (auto &&signal : self.GetSignals()) {
+    result.append(signal);
+  }
+  return result;
+}
+
+static boost::python::object GetNextSignal(
+    const carla::client::Map &self,
+    const carla::client::Waypoint &waypoint) {
+  const auto *signal = self.GetNextSignal(waypoint);
+  return signal != nullptr ? boost::python::object(*signal) : boost::python::object();
+}
+
+static auto GetJunctionConnections(const carla::client::Map &self, int junction_id) {
+  boost::python::list result;
+  for (auto &&connection : self.GetJunctionConnections(junction_id)) {
+    result.append(connection);
+  }
+  return result;
+}
+
+/// List of (from_lane, to_lane) tuples.
+static auto GetLaneLinks(const carla::road::lane_junction_t &self) {
+  DEBUG_ASSERT(self.from_lane.size() == self.to_lane.size());
+  boost::python::list result;
+  for (auto i = 0u; i < self.from_lane.size(); ++i) {
+    result.append(boost::python::make_tuple(self.from_lane[i], self.to_lane[i]));
+  }
+  return result;
+}
+
+using WaypointInfoList = std::vector<carla::road::element::WaypointInfo>;
+
+/// Accepts any object with the buffer protocol of shape (N, 3), like a numpy
+/// array of float32 or float64, or else a sequence of carla.Location.
+static std::vector<carla::geom::Location> ToLocations(const boost::python::object &input) {
+  namespace py = boost::python;
+  std::vector<carla::geom::Location> result;
+  PyObject *object = input.ptr();
+  if (!PyObject_CheckBuffer(object)) {
+    for (auto it = py::stl_input_iterator<carla::geom::Location>(input);
+         it != py::stl_input_iterator<carla::geom::Location>();
+         ++it) {
+      result.emplace_back(*it);
+    }
+    return result;
+  }
+  Py_buffer view;
+  if (PyObject_GetBuffer(object, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+    py::throw_error_already_set();
+  }
+  std::unique_ptr<Py_buffer, decltype(&PyBuffer_Release)> release(&view, &PyBuffer_Release);
+  std::string format = view.format != nullptr ? view.format : "B";
+  if ((format.size() == 2u) && ((format[0u] == '@') || (format[0u] == '=') || (format[0u] == '<'))) {
+    format.erase(0u, 1u);
+  }
+  if ((view.ndim != 2) || (view.shape[1u] != 3) || ((format != "f") && (format != "d"))) {
+    PyErr_SetString(PyExc_ValueError, "expected an array of shape (N, 3) of float32 or float64");
+    py::throw_error_already_set();
+  }
+  const auto count = static_cast<size_t>(view.shape[0u]);
+  result.reserve(count);
+  auto copy = [&](const auto *data) {
+    for (auto i = 0u; i < count; ++i, data += 3) {
+      result.emplace_back(
+          static_cast<float>(data[0u]),
+          static_cast<float>(data[1u]),
+          static_cast<float>(data[2u]));
+    }
+  };
+  if (format == "f") {
+    copy(static_cast<const float *>(view.buf));
+  } else {
+    copy(static_cast<const double *>(view.buf));
+  }
+  return result;
+}
+
+static WaypointInfoList GetWaypoints(
+    const carla::client::Map &self,
+    const boost::python::object &locations,
+    bool project_to_road) {
+  auto input = ToLocations(locations);
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.GetWaypoints(input, project_to_road);
+}
+
+static auto GetWaypointInfo(const WaypointInfoList &self, int pos) {
+  if (pos < 0) {
+    pos += static_cast<int>(self.size());
+  }
+  if ((pos < 0) || (static_cast<size_t>(pos) >= self.size())) {
+    PyErr_SetString(PyExc_IndexError, "index out of range");
+    boost::python::throw_error_already_set();
+  }
+  return self[static_cast<size_t>(pos)];
+}
+
+/// The raw data can be read with numpy as
+///
+///   numpy.frombuffer(waypoints.raw_data, dtype=numpy.dtype([
+///       ('road_id', 'u4'), ('lane_id', 'i4'), ('s', 'f8'),
+///       ('location', 'f4', 3), ('rotation', 'f4', 3),
+///       ('is_valid', '?'), ('_', 'V7')]))
+///
+/// with rotation as (pitch, yaw, roll).
+static auto GetWaypointInfoRawData(boost::python::object self) {
+  const WaypointInfoList &list = boost::python::extract<const WaypointInfoList &>(self);
+  return MakeReadOnlyBuffer(self, list.data(), sizeof(WaypointInfoList::value_type) * list.size());
+}
+
+using WaypointArraysPtr = boost::shared_ptr<carla::road::element::WaypointArrays>;
+
+static WaypointArraysPtr GenerateWaypointArrays(const carla::client::Map &self, double distance) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return WaypointArraysPtr(new carla::road::element::WaypointArrays(
+      self.GenerateWaypointArrays(distance)));
+}
+
+/// Each array can be read with numpy as
+///
+///   numpy.frombuffer(arrays.x, dtype=numpy.float32)
+///
+/// with dtypes u4 for road_id, i4 for lane_id, f8 for s and f4 for x, y, z and
+/// yaw. Each buffer keeps the arrays object alive.
+template <typename T>
+static auto GetArrayRawData(boost::python::object owner, const std::vector<T> &array) {
+  return MakeReadOnlyBuffer(owner, array.data(), sizeof(T) * array.size());
+}
+
+#define WAYPOINT_ARRAY(field) \
+  +[](boost::python::object self) { \
+    const carla::road::element::WaypointArrays &arrays = \
+        boost::python::extract<const carla::road::element::WaypointArrays &>(self); \
+    return GetArrayRawData(self, arrays.field); \
+  }
+
 void export_map() {
   using namespace boost::python;
   namespace cc = carla::client;
   namespace cg = carla::geom;
+  namespace cre = carla::road::element;
 
   class_<cc::Map, boost::noncopyable, boost::shared_ptr<cc::Map>>("Map", no_init)
     .add_property("name", CALL_RETURNING_COPY(cc::Map, GetName))
     .def("get_spawn_points", CALL_RETURNING_LIST(cc::Map, GetRecommendedSpawnPoints))
     .def("get_waypoint", &cc::Map::GetWaypoint, (arg("location"), arg("project_to_road")=true))
+    .def("get_waypoints", &GetWaypoints, (arg("locations"), arg("project_to_road")=true))
     .def("get_topology", &GetTopology)
+    .def("compute_route", &ComputeRoute, (arg("origin"), arg("destination")))
+    .def("compute_routes", &ComputeRoutes, (arg("pairs")))
     .def("generate_waypoints", CALL_RETURNING_LIST_1(cc::Map, GenerateWaypoints, double), (args("distance")))
+    .def("generate_waypoint_arrays", &GenerateWaypointArrays, (args("distance")))
+    .def("get_signals", &GetSignals)
+    .def("get_next_signal", &GetNextSignal, (arg("waypoint")))
+    .def("get_junction_connections", &GetJunctionConnections, (arg("junction_id")))
     .def("to_opendrive", CALL_RETURNING_COPY(cc::Map, GetOpenDrive))
     .def("save_to_disk", &SaveOpenDriveToDisk, (arg("path")=""))
     .def(self_ns::str(self_ns::self))
@@ -72,4 +296,62 @@ void export_map() {
     .def("next", CALL_RETURNING_LIST_1(cc::Waypoint, Next, double), (args("distance")))
     .def(self_ns::str(self_ns::self))
   ;
+
+  enum_<cre::SignalOrientation>("SignalOrientation")
+    .value("Positive", cre::SignalOrientation::Positive)
+    .value("Negative", cre::SignalOrientation::Negative)
+    .value("Both", cre::SignalOrientation::Both)
+  ;
+
+  class_<cre::Signal>("Signal")
+    .def_readonly("id", &cre::Signal::id)
+    .def_readonly("road_id", &cre::Signal::road_id)
+    .def_readonly("s", &cre::Signal::s)
+    .def_readonly("t", &cre::Signal::t)
+    .def_readonly("zoffset", &cre::Signal::zoffset)
+    .def_readonly("value", &cre::Signal::value)
+    .def_readonly("name", &cre::Signal::name)
+    .def_readonly("is_dynamic", &cre::Signal::is_dynamic)
+    .def_readonly("orientation", &cre::Signal::orientation)
+    .def_readonly("country", &cre::Signal::country)
+    .def_readonly("type", &cre::Signal::type)
+    .def_readonly("subtype", &cre::Signal::subtype)
+    .def("is_valid_for", &cre::Signal::IsValidFor, (arg("lane_id")))
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<carla::road::lane_junction_t>("JunctionConnection")
+    .def_readonly("junction_id", &carla::road::lane_junction_t::junction_id)
+    .def_readonly("incoming_road", &carla::road::lane_junction_t::incomming_road)
+    .def_readonly("connecting_road", &carla::road::lane_junction_t::connection_road)
+    .def_readonly("contact_point", &carla::road::lane_junction_t::contact_point)
+    .add_property("lane_links", &GetLaneLinks)
+  ;
+
+  class_<cre::WaypointInfo>("WaypointInfo")
+    .def_readonly("road_id", &cre::WaypointInfo::road_id)
+    .def_readonly("lane_id", &cre::WaypointInfo::lane_id)
+    .def_readonly("s", &cre::WaypointInfo::s)
+    .def_readonly("transform", &cre::WaypointInfo::transform)
+    .def_readonly("is_valid", &cre::WaypointInfo::is_valid)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cre::WaypointArrays, boost::noncopyable, WaypointArraysPtr>("WaypointArrays", no_init)
+    .add_property("road_id", WAYPOINT_ARRAY(road_id))
+    .add_property("lane_id", WAYPOINT_ARRAY(lane_id))
+    .add_property("s", WAYPOINT_ARRAY(s))
+    .add_property("x", WAYPOINT_ARRAY(x))
+    .add_property("y", WAYPOINT_ARRAY(y))
+    .add_property("z", WAYPOINT_ARRAY(z))
+    .add_property("yaw", WAYPOINT_ARRAY(yaw))
+    .def("__len__", &cre::WaypointArrays::size)
+  ;
+
+  class_<WaypointInfoList>("WaypointInfoList", no_init)
+    .add_property("raw_data", &GetWaypointInfoRawData)
+    .def("__len__", &WaypointInfoList::size)
+    .def("__iter__", iterator<WaypointInfoList>())
+    .def("__getitem__", &GetWaypointInfo)
+  ;
 }
@@ -62,15 +62,9 @@ enum class EColorConverter {
 };
 
 template <typename T>
-static auto GetRawDataAsBuffer(T &self) {
-  auto *data = reinterpret_cast<unsigned char *>(self.data());
-  auto size = sizeof(typename T::value_type) * self.size();
-#if PY_MAJOR_VERSION >= 3 // NOTE(Andrei): python 3
-  auto *ptr = PyMemoryView_FromMemory(reinterpret_cast<char *>(data), size, PyBUF_READ);
-#else        // NOTE(Andrei): python 2
-  auto *ptr = PyBuffer_FromMemory(data, size);
-#endif
-  return boost::python::object(boost::python::handle<>(ptr));
+static auto GetRawDataAsBuffer(boost::python::object self) {
+  const T &data = boost::python::extract<const T &>(self);
+  return MakeReadOnlyBuffer(self, data.data(), sizeof(typename T::value_type) * data.size());
 }
 
 template <typename T>
@@ -89,6 +89,10 @@ void export_world() {
     .def("get_map", CONST_CALL_WITHOUT_GIL(cc::World, GetMap))
     .def("get_spectator", CONST_CALL_WITHOUT_GIL(cc::World, GetSpectator))
     .def("get_weather", CONST_CALL_WITHOUT_GIL(cc::World, GetWeather))
+    .def("get_blueprint_library_async", CALL_RETURNING_FUTURE(cc::World, GetBlueprintLibraryAsync))
+    .def("get_map_async", CALL_RETURNING_FUTURE(cc::World, GetMapAsync))
+    .def("get_spectator_async", CALL_RETURNING_FUTURE(cc::World, GetSpectatorAsync))
+    .def("get_weather_async", CALL_RETURNING_FUTURE(cc::World, GetWeatherAsync))
     .def("set_weather", &cc::World::SetWeather)
     .def("get_actors", CONST_CALL_WITHOUT_GIL(cc::World, GetActors))
     .def("spawn_actor", SPAWN_ACTOR_WITHOUT_GIL(SpawnActor))
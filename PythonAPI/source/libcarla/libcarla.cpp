@@ -7,7 +7,9 @@
 #include <carla/Memory.h>
 #include <carla/PythonUtil.h>
 #include <carla/Time.h>
+#include <carla/client/detail/Future.h>
 
+#include <functional>
 #include <ostream>
 #include <type_traits>
 #include <vector>
@@ -53,6 +55,11 @@
       return result; \
     }
 
+// Convenient for const requests returning a future, wrapped in a PythonFuture.
+#define CALL_RETURNING_FUTURE(cls, fn) +[](const cls &self) { \
+      return PythonFuture{self.fn()}; \
+    }
+
 template <typename T>
 static void PrintListItem_(std::ostream &out, const T &item) {
   out << item;
@@ -91,6 +98,102 @@ namespace std {
 
 } // namespace std
 
+/// Python object that exposes a read-only buffer over memory owned by
+/// another Python object, and keeps a reference to the owner.
+struct PythonBufferOwner {
+  PyObject_HEAD
+  PyObject *owner;
+  char *data;
+  Py_ssize_t size;
+};
+
+static void PythonBufferOwner_Dealloc(PyObject *self) {
+  Py_XDECREF(reinterpret_cast<PythonBufferOwner *>(self)->owner);
+  PyObject_Del(self);
+}
+
+#if PY_MAJOR_VERSION >= 3 // NOTE(Andrei): python 3
+
+static int PythonBufferOwner_GetBuffer(PyObject *self, Py_buffer *view, int flags) {
+  auto *buffer = reinterpret_cast<PythonBufferOwner *>(self);
+  return PyBuffer_FillInfo(view, self, buffer->data, buffer->size, 1, flags);
+}
+
+static PyBufferProcs PythonBufferOwner_AsBuffer = {
+  PythonBufferOwner_GetBuffer,
+  nullptr
+};
+
+#else        // NOTE(Andrei): python 2
+
+static Py_ssize_t PythonBufferOwner_GetReadBuffer(PyObject *self, Py_ssize_t segment, void **ptr) {
+  if (segment != 0) {
+    PyErr_SetString(PyExc_SystemError, "accessing non-existent buffer segment");
+    return -1;
+  }
+  auto *buffer = reinterpret_cast<PythonBufferOwner *>(self);
+  *ptr = buffer->data;
+  return buffer->size;
+}
+
+static Py_ssize_t PythonBufferOwner_GetSegCount(PyObject *self, Py_ssize_t *length) {
+  if (length != nullptr) {
+    *length = reinterpret_cast<PythonBufferOwner *>(self)->size;
+  }
+  return 1;
+}
+
+static PyBufferProcs PythonBufferOwner_AsBuffer = {
+  PythonBufferOwner_GetReadBuffer,
+  nullptr,
+  PythonBufferOwner_GetSegCount,
+  nullptr,
+  nullptr,
+  nullptr
+};
+
+#endif
+
+static PyTypeObject PythonBufferOwner_Type = {
+  PyVarObject_HEAD_INIT(nullptr, 0)
+  "libcarla.BufferOwner",
+  sizeof(PythonBufferOwner),
+  0,
+  PythonBufferOwner_Dealloc,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  &PythonBufferOwner_AsBuffer,
+  Py_TPFLAGS_DEFAULT,
+  "Memory owned by another object."
+};
+
+/// Read-only buffer of @a size bytes at @a data, valid as long as @a owner is
+/// alive; the buffer keeps a reference to @a owner.
+static boost::python::object MakeReadOnlyBuffer(
+    boost::python::object owner,
+    const void *data,
+    size_t size) {
+  namespace py = boost::python;
+  static const bool is_ready = (PyType_Ready(&PythonBufferOwner_Type) == 0);
+  if (!is_ready) {
+    py::throw_error_already_set();
+  }
+  auto *buffer = PyObject_New(PythonBufferOwner, &PythonBufferOwner_Type);
+  if (buffer == nullptr) {
+    py::throw_error_already_set();
+  }
+  buffer->owner = py::incref(owner.ptr());
+  // Read-only, the const_cast is only required by the signatures.
+  buffer->data = reinterpret_cast<char *>(const_cast<void *>(data));
+  buffer->size = static_cast<Py_ssize_t>(size);
+  py::handle<> holder(reinterpret_cast<PyObject *>(buffer));
+#if PY_MAJOR_VERSION >= 3 // NOTE(Andrei): python 3
+  auto *ptr = PyMemoryView_FromObject(holder.get());
+#else        // NOTE(Andrei): python 2
+  auto *ptr = PyBuffer_FromObject(holder.get(), 0, Py_END_OF_BUFFER);
+#endif
+  return py::object(py::handle<>(ptr));
+}
+
 static carla::time_duration TimeDurationFromSeconds(double seconds) {
   size_t ms = static_cast<size_t>(1e3 * seconds);
   return carla::time_duration::milliseconds(ms);
@@ -119,11 +222,53 @@ static auto MakeCallback(boost::python::object callback) {
   };
 }
 
+/// Type-erased handle to a carla::client::detail::Future. The result is
+/// retrieved without the GIL and converted to a Python object afterwards.
+class PythonFuture {
+public:
+
+  template <typename T>
+  explicit PythonFuture(carla::client::detail::Future<T> future)
+    : _wait_for([future](carla::time_duration timeout) {
+        return future.WaitFor(timeout);
+      }),
+      _get([future]() -> std::function<boost::python::object()> {
+        auto result = std::make_shared<T>(future.Get());
+        return [result]() { return boost::python::object(*result); };
+      }) {}
+
+  bool IsReady() const {
+    return _wait_for(carla::time_duration{});
+  }
+
+  bool WaitFor(double seconds) const {
+    carla::PythonUtil::ReleaseGIL unlock;
+    return _wait_for(TimeDurationFromSeconds(seconds));
+  }
+
+  boost::python::object Get() const {
+    std::function<boost::python::object()> convert;
+    {
+      carla::PythonUtil::ReleaseGIL unlock;
+      convert = _get();
+    }
+    return convert();
+  }
+
+private:
+
+  std::function<bool(carla::time_duration)> _wait_for;
+
+  std::function<std::function<boost::python::object()>()> _get;
+};
+
 #include "Actor.cpp"
 #include "Blueprint.cpp"
 #include "Client.cpp"
+#include "Commands.cpp"
 #include "Control.cpp"
 #include "Exception.cpp"
+#include "Future.cpp"
 #include "Geom.cpp"
 #include "Map.cpp"
 #include "Sensor.cpp"
@@ -136,6 +281,7 @@ BOOST_PYTHON_MODULE(libcarla) {
   PyEval_InitThreads();
   scope().attr("__path__") = "libcarla";
   export_geom();
+  export_future();
   export_control();
   export_blueprint();
   export_actor();
@@ -145,5 +291,6 @@ BOOST_PYTHON_MODULE(libcarla) {
   export_world();
   export_map();
   export_client();
+  export_commands();
   export_exception();
 }
@@ -72,18 +72,20 @@ def main():
             blueprints = [x for x in blueprints if int(x.get_attribute('number_of_wheels')) == 4]
             blueprints = [x for x in blueprints if not x.id.endswith('isetta')]
 
-        def try_spawn_random_vehicle_at(transform):
+        def make_spawn_command(transform):
             blueprint = random.choice(blueprints)
             if blueprint.has_attribute('color'):
                 color = random.choice(blueprint.get_attribute('color').recommended_values)
                 blueprint.set_attribute('color', color)
-            vehicle = world.try_spawn_actor(blueprint, transform)
-            if vehicle is not None:
-                actor_list.append(vehicle)
-                vehicle.set_autopilot()
-                print('spawned %r at %s' % (vehicle.type_id, transform.location))
-                return True
-            return False
+            return carla.command.SpawnActor(blueprint, transform)
+
+        def try_spawn_random_vehicles_at(transforms):
+            # Spawn all of them in a single call, and then start their autopilot.
+            responses = client.apply_batch_sync([make_spawn_command(x) for x in transforms])
+            spawned = [x.actor_id for x in responses if not x.has_error()]
+            client.apply_batch([carla.command.SetAutopilot(x, True) for x in spawned])
+            actor_list.extend(spawned)
+            return len(spawned)
 
         # @todo Needs to be converted to list to be shuffled.
         spawn_points = list(world.get_map().get_spawn_points())
@@ -93,16 +95,14 @@ def main():
 
         count = args.number_of_vehicles
 
-        for spawn_point in spawn_points:
-            if try_spawn_random_vehicle_at(spawn_point):
-                count -= 1
-            if count <= 0:
-                break
+        available = spawn_points
+        while count > 0 and available:
+            batch, available = available[:count], available[count:]
+            count -= try_spawn_random_vehicles_at(batch)
 
         while count > 0:
             time.sleep(args.delay)
-            if try_spawn_random_vehicle_at(random.choice(spawn_points)):
-                count -= 1
+            count -= try_spawn_random_vehicles_at([random.choice(spawn_points)])
 
         print('spawned %d vehicles, press Ctrl+C to exit.' % args.number_of_vehicles)
 
@@ -112,8 +112,8 @@ def main():
     finally:
 
         print('\ndestroying %d actors' % len(actor_list))
-        for actor in actor_list:
-            actor.destroy()
+        if actor_list:
+            client.apply_batch_sync([carla.command.DestroyActor(x) for x in actor_list])
 
 
 if __name__ == '__main__':
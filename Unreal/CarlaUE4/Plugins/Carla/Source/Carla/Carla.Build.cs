@@ -125,6 +125,8 @@ public class Carla : ModuleRules
       {
         PublicAdditionalLibraries.Add(Path.Combine(LibCarlaInstallPath, "lib", GetLibName("carla_server")));
       }
+      // Shared memory streaming (shm_open).
+      PublicAdditionalLibraries.Add("rt");
     }
 
     // Include path.
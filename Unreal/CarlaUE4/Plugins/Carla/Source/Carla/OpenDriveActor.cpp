@@ -192,7 +192,7 @@ TArray<TArray<FVector>> AOpenDriveActor::GenerateRightLaneWaypoints(
     currentOffset += laneInfo->_width * 0.5;
     TArray<FVector> roadWaypoints;
 
-    if (laneInfo->_type == "driving")
+    if (laneInfo->_type == carla::road::element::LaneType::Driving)
     {
       for (int i = 0; i < laneZeroPoints.Num(); ++i)
       {
@@ -230,7 +230,7 @@ TArray<TArray<FVector>> AOpenDriveActor::GenerateLeftLaneWaypoints(
     currentOffset += laneInfo->_width * 0.5;
     TArray<FVector> roadWaypoints;
 
-    if (laneInfo->_type == "driving")
+    if (laneInfo->_type == carla::road::element::LaneType::Driving)
     {
       for (int i = 0; i < laneZeroPoints.Num(); ++i)
       {
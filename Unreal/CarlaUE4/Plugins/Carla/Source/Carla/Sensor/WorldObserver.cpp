@@ -7,6 +7,7 @@
 #include "Carla.h"
 #include "Carla/Sensor/WorldObserver.h"
 
+#include "Carla/Game/CarlaGameInstance.h"
 #include "Carla/Traffic/TrafficLightBase.h"
 
 #include "CoreGlobals.h"
@@ -21,6 +22,8 @@ static auto AWorldObserver_GetActorState(const FActorView &View)
   using AType = FActorView::ActorType;
 
   carla::sensor::data::ActorDynamicState::TypeDependentState state;
+  // Zero the unused bytes, the delta encoding compares the state bitwise.
+  std::memset(&state, 0, sizeof(state));
 
   if (AType::Vehicle == View.GetActorType())
   {
@@ -43,28 +46,16 @@ static auto AWorldObserver_GetActorState(const FActorView &View)
   return state;
 }
 
-static carla::Buffer AWorldObserver_Serialize(
-    carla::Buffer buffer,
+static void AWorldObserver_WriteActors(
+    carla::sensor::s11n::EpisodeStateEncoder &Encoder,
     double game_timestamp,
     double platform_timestamp,
     const FActorRegistry &Registry)
 {
-  using Serializer = carla::sensor::s11n::EpisodeStateSerializer;
   using ActorDynamicState = carla::sensor::data::ActorDynamicState;
 
-  // Set up buffer for writing.
-  buffer.reset(sizeof(Serializer::Header) + sizeof(ActorDynamicState) * Registry.Num());
-  auto begin = buffer.begin();
-  auto write_data = [&begin](const auto &data) {
-    std::memcpy(begin, &data, sizeof(data));
-    begin += sizeof(data);
-  };
+  Encoder.Reset(game_timestamp, platform_timestamp, Registry.Num());
 
-  // Write header.
-  Serializer::Header header = {game_timestamp, platform_timestamp};
-  write_data(header);
-
-  // Write every actor.
   for (auto &&pair : Registry) {
     auto &&actor_view = pair.second;
     check(actor_view.GetActor() != nullptr);
@@ -76,11 +67,8 @@ static carla::Buffer AWorldObserver_Serialize(
       carla::geom::Vector3D{velocity.X, velocity.Y, velocity.Z},
       AWorldObserver_GetActorState(actor_view)
     };
-    write_data(info);
+    Encoder.WriteActor(info);
   }
-
-  check(begin == buffer.end());
-  return buffer;
 }
 
 AWorldObserver::AWorldObserver(const FObjectInitializer& ObjectInitializer)
@@ -97,11 +85,21 @@ void AWorldObserver::Tick(float DeltaSeconds)
 
   GameTimeStamp += DeltaSeconds;
 
-  auto buffer = AWorldObserver_Serialize(
-      Stream.PopBufferFromPool(),
+  AWorldObserver_WriteActors(
+      Encoder,
       GameTimeStamp,
       FPlatformTime::Seconds(),
       Episode->GetActorRegistry());
 
-  Stream.Send_GameThread(*this, std::move(buffer));
+  Stream.Send_GameThread(*this, Encoder, Stream.PopBufferFromPool());
+}
+
+void AWorldObserver::BeginPlay()
+{
+  Super::BeginPlay();
+
+  const auto *GameInstance = Cast<UCarlaGameInstance>(GetGameInstance());
+  check(GameInstance != nullptr);
+  const auto &Settings = GameInstance->GetCarlaSettings();
+  Encoder = FEpisodeStateEncoder(Settings.EpisodeStateKeyframeInterval);
 }
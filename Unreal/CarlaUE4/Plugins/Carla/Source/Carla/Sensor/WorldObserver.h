@@ -10,6 +10,10 @@
 
 #include "Carla/Sensor/DataStream.h"
 
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/s11n/EpisodeStateEncoder.h>
+#include <compiler/enable-ue4-macros.h>
+
 #include "WorldObserver.generated.h"
 
 class UCarlaEpisode;
@@ -20,6 +24,8 @@ class CARLA_API AWorldObserver : public AActor
 {
   GENERATED_BODY()
 
+  using FEpisodeStateEncoder = carla::sensor::s11n::EpisodeStateEncoder;
+
 public:
 
   using not_spawnable = void;
@@ -48,11 +54,17 @@ public:
 
   void Tick(float DeltaSeconds) final;
 
+protected:
+
+  void BeginPlay() override;
+
 private:
 
   UCarlaEpisode *Episode = nullptr;
 
   FDataMultiStream Stream;
 
+  FEpisodeStateEncoder Encoder;
+
   double GameTimeStamp = 0.0;
 };
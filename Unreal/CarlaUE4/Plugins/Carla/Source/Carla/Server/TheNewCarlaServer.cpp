@@ -15,10 +15,13 @@
 #include "GameFramework/SpectatorPawn.h"
 
 #include <compiler/disable-ue4-macros.h>
+#include <carla/AtomicSharedPtr.h>
 #include <carla/Version.h>
 #include <carla/rpc/Actor.h>
 #include <carla/rpc/ActorDefinition.h>
 #include <carla/rpc/ActorDescription.h>
+#include <carla/rpc/Command.h>
+#include <carla/rpc/CommandResponse.h>
 #include <carla/rpc/DebugShape.h>
 #include <carla/rpc/EpisodeInfo.h>
 #include <carla/rpc/MapInfo.h>
@@ -29,6 +32,7 @@
 #include <carla/streaming/Server.h>
 #include <compiler/enable-ue4-macros.h>
 
+#include <memory>
 #include <vector>
 
 // =============================================================================
@@ -67,8 +71,36 @@ public:
 
   UCarlaEpisode *Episode = nullptr;
 
+  /// Build the snapshot of the current episode, call it from the game thread
+  /// once the episode is initialized.
+  void PublishEpisodeSnapshot()
+  {
+    check(Episode != nullptr);
+    auto Snapshot = std::make_shared<FEpisodeSnapshot>();
+    Snapshot->MapInfo = MakeMapInfo();
+    Snapshot->ActorDefinitions =
+        MakeVectorFromTArray<carla::rpc::ActorDefinition>(Episode->GetActorDefinitions());
+    EpisodeSnapshot = std::move(Snapshot);
+  }
+
+  void ClearEpisodeSnapshot()
+  {
+    EpisodeSnapshot.reset();
+  }
+
 private:
 
+  /// Data that doesn't change during an episode. It is built once by the game
+  /// thread, so the read-only functions can serve it from the worker threads.
+  struct FEpisodeSnapshot
+  {
+    carla::rpc::MapInfo MapInfo;
+
+    std::vector<carla::rpc::ActorDefinition> ActorDefinitions;
+  };
+
+  carla::AtomicSharedPtr<const FEpisodeSnapshot> EpisodeSnapshot;
+
   void BindActions();
 
   void RespondErrorStr(const std::string &ErrorMessage) {
@@ -88,6 +120,34 @@ private:
     }
   }
 
+  /// Safe to call from any thread. Responding an error does not abort the
+  /// call, the caller must check for nullptr.
+  std::shared_ptr<const FEpisodeSnapshot> RequireEpisodeSnapshot()
+  {
+    auto Snapshot = EpisodeSnapshot.load();
+    if (Snapshot == nullptr)
+    {
+      RespondErrorStr("episode not ready");
+    }
+    return Snapshot;
+  }
+
+  carla::rpc::MapInfo MakeMapInfo()
+  {
+    auto FileContents = FOpenDrive::Load(Episode->GetMapName());
+    const auto &SpawnPoints = Episode->GetRecommendedStartTransforms();
+    std::vector<carla::geom::Transform> spawn_points;
+    spawn_points.reserve(SpawnPoints.Num());
+    for (const auto &Transform : SpawnPoints)
+    {
+      spawn_points.emplace_back(Transform);
+    }
+    return {
+        carla::rpc::FromFString(Episode->GetMapName()),
+        carla::rpc::FromFString(FileContents),
+        spawn_points};
+  }
+
   auto SpawnActor(const FTransform &Transform, FActorDescription Description)
   {
     auto Result = Episode->SpawnActorWithInfo(Transform, std::move(Description));
@@ -112,6 +172,94 @@ private:
     ::AttachActors(Child.GetActor(), Parent.GetActor());
   }
 
+  /// Commands of a batch report their errors in their response instead of
+  /// failing the whole batch.
+  using FCommandResponse = carla::rpc::CommandResponse;
+
+  FCommandResponse ExecuteCommand(const carla::rpc::Command::SpawnActor &Command)
+  {
+    auto Result = Episode->SpawnActorWithInfo(Command.transform, Command.description);
+    if (Result.Key != EActorSpawnResultStatus::Success)
+    {
+      return FCommandResponse::Error(
+          carla::rpc::FromFString(FActorSpawnResult::StatusToString(Result.Key)));
+    }
+    return FCommandResponse{Result.Value.GetActorId()};
+  }
+
+  FCommandResponse ExecuteCommand(const carla::rpc::Command::DestroyActor &Command)
+  {
+    auto ActorView = Episode->GetActorRegistry().Find(Command.actor);
+    if (!ActorView.IsValid() || !Episode->DestroyActor(ActorView.GetActor()))
+    {
+      return FCommandResponse::Error("unable to destroy actor: not found");
+    }
+    return FCommandResponse{Command.actor};
+  }
+
+  FCommandResponse ExecuteCommand(const carla::rpc::Command::ApplyVehicleControl &Command)
+  {
+    auto *Vehicle = FindVehicle(Command.actor);
+    if (Vehicle == nullptr)
+    {
+      return FCommandResponse::Error("unable to apply control: vehicle not found");
+    }
+    Vehicle->ApplyVehicleControl(Command.control);
+    return FCommandResponse{Command.actor};
+  }
+
+  FCommandResponse ExecuteCommand(const carla::rpc::Command::ApplyTransform &Command)
+  {
+    auto ActorView = Episode->GetActorRegistry().Find(Command.actor);
+    if (!ActorView.IsValid() || ActorView.GetActor()->IsPendingKill())
+    {
+      return FCommandResponse::Error("unable to set actor transform: actor not found");
+    }
+    ActorView.GetActor()->SetActorRelativeTransform(
+        Command.transform,
+        false,
+        nullptr,
+        ETeleportType::TeleportPhysics);
+    return FCommandResponse{Command.actor};
+  }
+
+  FCommandResponse ExecuteCommand(const carla::rpc::Command::SetAutopilot &Command)
+  {
+    auto *Vehicle = FindVehicle(Command.actor);
+    auto *Controller = Vehicle != nullptr ?
+        Cast<AWheeledVehicleAIController>(Vehicle->GetController()) :
+        nullptr;
+    if (Controller == nullptr)
+    {
+      return FCommandResponse::Error("unable to set autopilot: vehicle not found");
+    }
+    Controller->SetAutopilot(Command.enabled);
+    return FCommandResponse{Command.actor};
+  }
+
+  ACarlaWheeledVehicle *FindVehicle(FActorView::IdType Id)
+  {
+    auto ActorView = Episode->GetActorRegistry().Find(Id);
+    if (!ActorView.IsValid() || ActorView.GetActor()->IsPendingKill())
+    {
+      return nullptr;
+    }
+    return Cast<ACarlaWheeledVehicle>(ActorView.GetActor());
+  }
+
+  std::vector<FCommandResponse> ExecuteBatch(const std::vector<carla::rpc::Command> &Commands)
+  {
+    std::vector<FCommandResponse> Responses;
+    Responses.reserve(Commands.size());
+    for (const auto &Command : Commands)
+    {
+      Command.command.ApplyVisitor([&](const auto &Item) {
+        Responses.emplace_back(ExecuteCommand(Item));
+      });
+    }
+    return Responses;
+  }
+
   carla::geom::BoundingBox GetActorBoundingBox(const AActor &Actor)
   {
     /// @todo Bounding boxes only available for vehicles.
@@ -182,7 +330,7 @@ void FTheNewCarlaServer::FPimpl::BindActions()
 
   Server.BindAsync("ping", []() { return true; });
 
-  Server.BindAsync("version", []() -> std::string { return carla::version(); });
+  Server.BindReadOnly("version", []() -> std::string { return carla::version(); });
 
   Server.BindSync("get_episode_info", [this]() -> cr::EpisodeInfo {
     RequireEpisode();
@@ -193,25 +341,20 @@ void FTheNewCarlaServer::FPimpl::BindActions()
     return {Episode->GetId(), cr::FromFString(Episode->GetMapName()), WorldObserver->GetStreamToken()};
   });
 
-  Server.BindSync("get_map_info", [this]() -> cr::MapInfo {
-    RequireEpisode();
-    auto FileContents = FOpenDrive::Load(Episode->GetMapName());
-    const auto &SpawnPoints = Episode->GetRecommendedStartTransforms();
-    std::vector<carla::geom::Transform> spawn_points;
-    spawn_points.reserve(SpawnPoints.Num());
-    for (const auto &Transform : SpawnPoints)
-    {
-      spawn_points.emplace_back(Transform);
+  Server.BindReadOnly("get_map_info", [this]() -> cr::MapInfo {
+    auto Snapshot = RequireEpisodeSnapshot();
+    if (Snapshot == nullptr) {
+      return {};
     }
-    return {
-        cr::FromFString(Episode->GetMapName()),
-        cr::FromFString(FileContents),
-        spawn_points};
+    return Snapshot->MapInfo;
   });
 
-  Server.BindSync("get_actor_definitions", [this]() {
-    RequireEpisode();
-    return MakeVectorFromTArray<cr::ActorDefinition>(Episode->GetActorDefinitions());
+  Server.BindReadOnly("get_actor_definitions", [this]() -> std::vector<cr::ActorDefinition> {
+    auto Snapshot = RequireEpisodeSnapshot();
+    if (Snapshot == nullptr) {
+      return {};
+    }
+    return Snapshot->ActorDefinitions;
   });
 
   Server.BindSync("get_spectator", [this]() -> cr::Actor {
@@ -385,6 +528,14 @@ void FTheNewCarlaServer::FPimpl::BindActions()
     Controller->SetAutopilot(bEnabled);
   });
 
+  Server.BindSync("apply_batch", [this](const std::vector<cr::Command> &Commands) {
+    RequireEpisode();
+    if (Episode == nullptr) {
+      return std::vector<FCommandResponse>{};
+    }
+    return ExecuteBatch(Commands);
+  });
+
   Server.BindSync("draw_debug_shape", [this](const cr::DebugShape &shape) {
     RequireEpisode();
     auto *World = Episode->GetWorld();
@@ -412,10 +563,12 @@ void FTheNewCarlaServer::NotifyBeginEpisode(UCarlaEpisode &Episode)
 {
   UE_LOG(LogCarlaServer, Log, TEXT("New episode '%s' started"), *Episode.GetMapName());
   Pimpl->Episode = &Episode;
+  Pimpl->PublishEpisodeSnapshot();
 }
 
 void FTheNewCarlaServer::NotifyEndEpisode()
 {
+  Pimpl->ClearEpisodeSnapshot();
   Pimpl->Episode = nullptr;
 }
 
@@ -436,6 +589,23 @@ void FTheNewCarlaServer::RunSome(uint32 Milliseconds)
 void FTheNewCarlaServer::Stop()
 {
   Pimpl->Server.Stop();
+  for (const auto &Pair : Pimpl->Server.GetMetrics())
+  {
+    const auto &Stats = Pair.second;
+    if (Stats.calls > 0u)
+    {
+      UE_LOG(
+          LogCarlaServer,
+          Log,
+          TEXT("rpc '%s': %llu calls, latency %.0f us (max %llu us), queue time %.0f us (max queued %llu)"),
+          *carla::rpc::ToFString(Pair.first),
+          static_cast<uint64>(Stats.calls),
+          Stats.GetMeanLatency(),
+          static_cast<uint64>(Stats.max_latency),
+          Stats.GetMeanQueueTime(),
+          static_cast<uint64>(Stats.max_queued));
+    }
+  }
 }
 
 carla::rpc::Actor FTheNewCarlaServer::SerializeActor(FActorView View) const
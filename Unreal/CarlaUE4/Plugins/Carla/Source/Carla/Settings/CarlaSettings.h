@@ -132,6 +132,12 @@ public:
   UPROPERTY(Category = "CARLA Server", VisibleAnywhere)
   bool bDisableRendering = false;
 
+  /// If greater than zero, the state of the actors is delta encoded: every
+  /// frame only the actors that changed are sent, and every this many frames
+  /// a keyframe with all of them. Zero sends every actor every frame.
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bUseNetworking))
+  uint32 EpisodeStateKeyframeInterval = 0u;
+
   /// @}
   // ===========================================================================
   /// @name Level Settings